@@ -13,9 +13,11 @@ class MyApp : public SampleApp
 public:
 	Error sampleExtraInit()
 	{
+		ANKI_CHECK(getResourceManager().beginLoadPlan("sponza"));
 		ScriptResourcePtr script;
 		ANKI_CHECK(getResourceManager().loadResource("assets/scene.lua", script));
 		ANKI_CHECK(getScriptManager().evalString(script->getSource()));
+		ANKI_CHECK(getResourceManager().endLoadPlan());
 
 		getMainRenderer().getOffscreenRenderer().getVolumetricFog().setFogParticleColor(Vec3(1.0f, 0.9f, 0.9f));
 		getMainRenderer().getOffscreenRenderer().getVolumetricFog().setParticleDensity(2.0f);
@@ -13,17 +13,24 @@
 // Vert input
 //
 #if defined(ANKI_VERTEX_SHADER)
-layout(location = POSITION_LOCATION) in Vec3 in_position;
+layout(location = POSITION_LOCATION) in Vec3 in_position; // Quantized, see u_positionsScale
 #	if ANKI_PASS == PASS_GB
 layout(location = TEXTURE_COORDINATE_LOCATION) in Vec2 in_uv;
-layout(location = NORMAL_LOCATION) in Vec3 in_normal;
-layout(location = TANGENT_LOCATION) in Vec4 in_tangent;
+layout(location = NORMAL_LOCATION) in Vec2 in_normal; // Octahedral encoded
+layout(location = TANGENT_LOCATION) in Vec3 in_tangent; // Octahedral encoded plus the handedness in z
 #	endif
 
 #	if ANKI_BONES
 layout(location = BONE_WEIGHTS_LOCATION) in Vec4 in_boneWeights;
 layout(location = BONE_INDICES_LOCATION) in UVec4 in_boneIndices;
 #	endif
+
+// Transforms the positions to the model space
+layout(push_constant, std430) uniform pc_
+{
+	Vec4 u_positionsScale;
+	Vec4 u_positionsTranslation;
+};
 #endif
 
 //
@@ -87,6 +94,26 @@ layout(location = 3) out Vec2 out_gbuffer3;
 // Functions
 //
 
+// Decode the vertex attributes
+#if defined(ANKI_VERTEX_SHADER)
+Vec3 decodePosition()
+{
+	return in_position * u_positionsScale.xyz + u_positionsTranslation.xyz;
+}
+
+#	if ANKI_PASS == PASS_GB
+Vec3 decodeNormal()
+{
+	return octahedralDecode(in_normal);
+}
+
+Vec4 decodeTangent()
+{
+	return Vec4(octahedralDecode(in_tangent.xy), (in_tangent.z >= 0.0) ? 1.0 : -1.0);
+}
+#	endif
+#endif
+
 // Write the data to RTs
 #if defined(ANKI_FRAGMENT_SHADER) && ANKI_PASS == PASS_GB
 void writeGBuffer(Vec3 diffColor,
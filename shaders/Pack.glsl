@@ -59,6 +59,19 @@ Vec3 signedOctDecode(const Vec3 n)
 	return outn;
 }
 
+// The opposite of packUnitVectorToOctahedral of the C++ code. The input is in [-1.0, 1.0]
+Vec3 octahedralDecode(const Vec2 oct)
+{
+	Vec3 n = Vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+
+	// Unfold the lower hemisphere
+	const F32 t = max(-n.z, 0.0);
+	n.x += (n.x >= 0.0) ? -t : t;
+	n.y += (n.y >= 0.0) ? -t : t;
+
+	return normalize(n);
+}
+
 // Vectorized version. See clean one at <= r1048
 U32 newPackUnorm4x8(const Vec4 v)
 {
@@ -186,6 +186,7 @@
 #	include <intrin.h>
 #	define __builtin_popcount __popcnt
 #	define __builtin_clzll(x) ((int)__lzcnt64(x))
+#	define __builtin_ctzll(x) ((int)_tzcnt_u64(x))
 #endif
 
 // Constants
@@ -16,6 +16,7 @@
 #include <anki/util/Enum.h>
 #include <anki/util/File.h>
 #include <anki/util/Filesystem.h>
+#include <anki/util/MemoryMappedFile.h>
 #include <anki/util/Functions.h>
 #include <anki/util/Hash.h>
 #include <anki/util/HighRezTimer.h>
@@ -29,6 +30,7 @@
 #include <anki/util/StdTypes.h>
 #include <anki/util/String.h>
 #include <anki/util/StringList.h>
+#include <anki/util/InternedString.h>
 #include <anki/util/System.h>
 #include <anki/util/Thread.h>
 #include <anki/util/ThreadPool.h>
@@ -38,6 +40,7 @@
 #include <anki/util/SparseArray.h>
 #include <anki/util/ObjectAllocator.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/TracerFile.h>
 #include <anki/util/Serializer.h>
 #include <anki/util/Xml.h>
 
@@ -26,7 +26,7 @@
 #include <anki/core/StagingGpuMemoryManager.h>
 #include <anki/ui/UiManager.h>
 #include <anki/ui/Canvas.h>
-#include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/resource/ShaderProgramResourceSystem.h>
 
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
@@ -204,15 +204,16 @@ void* App::MemStats::allocCallback(void* userData, void* ptr, PtrSize size, PtrS
 {
 	ANKI_ASSERT(userData);
 
-	static const PtrSize MAX_ALIGNMENT = 64;
+	static const PtrSize HEADER_ALIGNMENT = 64;
 
-	struct alignas(MAX_ALIGNMENT) Header
+	struct alignas(HEADER_ALIGNMENT) Header
 	{
 		PtrSize m_allocatedSize;
-		Array<U8, MAX_ALIGNMENT - sizeof(PtrSize)> _m_padding;
+		PtrSize m_offset; ///< From the original allocation to the header.
+		Array<U8, HEADER_ALIGNMENT - sizeof(PtrSize) * 2> _m_padding;
 	};
-	static_assert(sizeof(Header) == MAX_ALIGNMENT, "See file");
-	static_assert(alignof(Header) == MAX_ALIGNMENT, "See file");
+	static_assert(sizeof(Header) == HEADER_ALIGNMENT, "See file");
+	static_assert(alignof(Header) == HEADER_ALIGNMENT, "See file");
 
 	void* out = nullptr;
 
@@ -220,16 +221,20 @@ void* App::MemStats::allocCallback(void* userData, void* ptr, PtrSize size, PtrS
 	{
 		// Need to allocate
 		ANKI_ASSERT(size > 0);
-		ANKI_ASSERT(alignment > 0 && alignment <= MAX_ALIGNMENT);
+		ANKI_ASSERT(alignment > 0 && isPowerOfTwo(alignment));
 
-		const PtrSize newAlignment = MAX_ALIGNMENT;
-		const PtrSize newSize = sizeof(Header) + size;
+		// Bigger alignments than the header's have padding in front of the header
+		const PtrSize newAlignment = max(HEADER_ALIGNMENT, alignment);
+		const PtrSize offset = getAlignedRoundUp(newAlignment, sizeof(Header));
+		const PtrSize newSize = offset + size;
 
 		// Allocate
 		MemStats* self = static_cast<MemStats*>(userData);
-		Header* allocation = static_cast<Header*>(
+		U8* mem = static_cast<U8*>(
 			self->m_originalAllocCallback(self->m_originalUserData, nullptr, newSize, newAlignment));
+		Header* allocation = reinterpret_cast<Header*>(mem + offset) - 1;
 		allocation->m_allocatedSize = size;
+		allocation->m_offset = offset - sizeof(Header);
 		++allocation;
 		out = static_cast<void*>(allocation);
 
@@ -252,7 +257,8 @@ void* App::MemStats::allocCallback(void* userData, void* ptr, PtrSize size, PtrS
 		self->m_allocatedMem.fetchSub(allocation->m_allocatedSize);
 
 		// Free
-		self->m_originalAllocCallback(self->m_originalUserData, allocation, 0, 0);
+		self->m_originalAllocCallback(
+			self->m_originalUserData, reinterpret_cast<U8*>(allocation) - allocation->m_offset, 0, 0);
 	}
 
 	return out;
@@ -285,12 +291,16 @@ void App::cleanup()
 	m_heapAlloc.deleteInstance(m_input);
 	m_heapAlloc.deleteInstance(m_window);
 
+	reportMemoryLeaks();
+
 #if ANKI_ENABLE_TRACE
 	m_heapAlloc.deleteInstance(m_coreTracer);
 #endif
 
 	m_settingsDir.destroy(m_heapAlloc);
 	m_cacheDir.destroy(m_heapAlloc);
+
+	LoggerSingleton::get().disableAsync();
 }
 
 Error App::init(const ConfigSet& config, AllocAlignedCallback allocCb, void* allocCbUserData)
@@ -309,6 +319,12 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 {
 	ConfigSet config = config_;
 	m_displayStats = config.getNumberU32("core_displayStats");
+	m_memTracking = config.getNumberU32("core_memoryTracking");
+
+	if(config.getNumberU32("core_asyncLogging"))
+	{
+		LoggerSingleton::get().enableAsync();
+	}
 
 	initMemoryCallbacks(allocCb, allocCbUserData);
 	m_heapAlloc = HeapAllocator<U8>(m_allocCb, m_allocCbData);
@@ -395,8 +411,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	// Graphics API
 	//
 	GrManagerInitInfo grInit;
-	grInit.m_allocCallback = m_allocCb;
-	grInit.m_allocCallbackUserData = m_allocCbData;
+	grInit.m_allocCallback = getSubsystemAllocCallback(TrackedSubsystem::GR);
+	grInit.m_allocCallbackUserData = getSubsystemAllocCallbackData(TrackedSubsystem::GR);
 	grInit.m_cacheDirectory = m_cacheDir.toCString();
 	grInit.m_config = &config;
 	grInit.m_window = m_window;
@@ -414,7 +430,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	m_physics = m_heapAlloc.newInstance<PhysicsWorld>();
 
-	ANKI_CHECK(m_physics->create(m_allocCb, m_allocCbData));
+	ANKI_CHECK(m_physics->create(getSubsystemAllocCallback(TrackedSubsystem::PHYSICS),
+		getSubsystemAllocCallbackData(TrackedSubsystem::PHYSICS)));
 
 	//
 	// Resource FS
@@ -431,8 +448,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	rinit.m_resourceFs = m_resourceFs;
 	rinit.m_config = &config;
 	rinit.m_cacheDir = m_cacheDir.toCString();
-	rinit.m_allocCallback = m_allocCb;
-	rinit.m_allocCallbackData = m_allocCbData;
+	rinit.m_allocCallback = getSubsystemAllocCallback(TrackedSubsystem::RESOURCE);
+	rinit.m_allocCallbackData = getSubsystemAllocCallbackData(TrackedSubsystem::RESOURCE);
 	m_resources = m_heapAlloc.newInstance<ResourceManager>();
 
 	ANKI_CHECK(m_resources->init(rinit));
@@ -442,7 +459,12 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	// UI
 	//
 	m_ui = m_heapAlloc.newInstance<UiManager>();
-	ANKI_CHECK(m_ui->init(m_allocCb, m_allocCbData, m_resources, m_gr, m_stagingMem, m_input));
+	ANKI_CHECK(m_ui->init(getSubsystemAllocCallback(TrackedSubsystem::UI),
+		getSubsystemAllocCallbackData(TrackedSubsystem::UI),
+		m_resources,
+		m_gr,
+		m_stagingMem,
+		m_input));
 
 	//
 	// Renderer
@@ -455,22 +477,36 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 
 	m_renderer = m_heapAlloc.newInstance<MainRenderer>();
 
-	ANKI_CHECK(m_renderer->init(
-		m_threadHive, m_resources, m_gr, m_stagingMem, m_ui, m_allocCb, m_allocCbData, config, &m_globalTimestamp));
+	ANKI_CHECK(m_renderer->init(m_threadHive,
+		m_resources,
+		m_gr,
+		m_stagingMem,
+		m_ui,
+		getSubsystemAllocCallback(TrackedSubsystem::RENDERER),
+		getSubsystemAllocCallbackData(TrackedSubsystem::RENDERER),
+		config,
+		&m_globalTimestamp));
 
 	//
 	// Script
 	//
 	m_script = m_heapAlloc.newInstance<ScriptManager>();
-	ANKI_CHECK(m_script->init(m_allocCb, m_allocCbData));
+	ANKI_CHECK(m_script->init(getSubsystemAllocCallback(TrackedSubsystem::SCRIPT),
+		getSubsystemAllocCallbackData(TrackedSubsystem::SCRIPT)));
 
 	//
 	// Scene
 	//
 	m_scene = m_heapAlloc.newInstance<SceneGraph>();
 
-	ANKI_CHECK(m_scene->init(
-		m_allocCb, m_allocCbData, m_threadHive, m_resources, m_input, m_script, &m_globalTimestamp, config));
+	ANKI_CHECK(m_scene->init(getSubsystemAllocCallback(TrackedSubsystem::SCENE),
+		getSubsystemAllocCallbackData(TrackedSubsystem::SCENE),
+		m_threadHive,
+		m_resources,
+		m_input,
+		m_script,
+		&m_globalTimestamp,
+		config));
 
 	// Inform the script engine about some subsystems
 	m_script->setRenderer(m_renderer);
@@ -647,6 +683,14 @@ Error App::mainLoop()
 		}
 
 #if ANKI_ENABLE_TRACE
+		if(m_memTracking)
+		{
+			for(MemoryTracker& tracker : m_memTrackers)
+			{
+				tracker.traceCounters();
+			}
+		}
+
 		static U64 frame = 1;
 		m_coreTracer->flushFrame(frame++);
 #endif
@@ -706,161 +750,47 @@ void App::initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserDat
 		m_allocCb = allocCb;
 		m_allocCbData = allocCbUserData;
 	}
-}
 
-Error App::compileAllShaders()
-{
-	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
-	ANKI_CORE_LOGI("Compiling shader programs");
-	U32 shadersCompileCount = 0;
-
-	// Compute hash for both
-	const GpuDeviceCapabilities caps = m_gr->getDeviceCapabilities();
-	const BindlessLimits limits = m_gr->getBindlessLimits();
-	U64 gpuHash = computeHash(&caps, sizeof(caps));
-	gpuHash = appendHash(&limits, sizeof(limits), gpuHash);
-	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
-
-	ANKI_CHECK(m_resourceFs->iterateAllFilenames([&](CString fname) -> Error {
-		// Check file extension
-		StringAuto extension(m_heapAlloc);
-		getFilepathExtension(fname, extension);
-		if(extension.getLength() != 8 || extension != "ankiprog")
-		{
-			return Error::NONE;
-		}
-
-		// Get some filenames
-		StringAuto baseFname(m_heapAlloc);
-		getFilepathFilename(fname, baseFname);
-		StringAuto metaFname(m_heapAlloc);
-		metaFname.sprintf("%s/%smeta", m_cacheDir.cstr(), baseFname.cstr());
-
-		// Get the hash from the meta file
-		U64 metafileHash = 0;
-		if(fileExists(metaFname))
+	if(m_memTracking)
+	{
+		const Array<CString, U32(TrackedSubsystem::COUNT)> names = {
+			{"GR", "PHYSICS", "RESOURCE", "UI", "RENDERER", "SCRIPT", "SCENE"}};
+		for(U32 i = 0; i < U32(TrackedSubsystem::COUNT); ++i)
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
-			ANKI_CHECK(metaFile.read(&metafileHash, sizeof(metafileHash)));
+			m_memTrackers[i].init(names[i], m_allocCb, m_allocCbData);
 		}
+	}
+}
 
-		// Load interface
-		class FSystem : public ShaderProgramFilesystemInterface
-		{
-		public:
-			ResourceFilesystem* m_fsystem = nullptr;
-
-			Error readAllText(CString filename, StringAuto& txt) final
-			{
-				ResourceFilePtr file;
-				ANKI_CHECK(m_fsystem->openFile(filename, file));
-				ANKI_CHECK(file->readAllText(txt));
-				return Error::NONE;
-			}
-		} fsystem;
-		fsystem.m_fsystem = m_resourceFs;
-
-		// Skip interface
-		class Skip : public ShaderProgramPostParseInterface
-		{
-		public:
-			U64 m_metafileHash;
-			U64 m_newHash;
-			U64 m_gpuHash;
-			CString m_fname;
-
-			Bool skipCompilation(U64 hash)
-			{
-				ANKI_ASSERT(hash != 0);
-				const Array<U64, 2> hashes = {{hash, m_gpuHash}};
-				const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
-
-				m_newHash = finalHash;
-				const Bool skip = finalHash == m_metafileHash;
-
-				if(!skip)
-				{
-					ANKI_CORE_LOGI("\t%s", m_fname.cstr());
-				}
-
-				return skip;
-			};
-		} skip;
-		skip.m_metafileHash = metafileHash;
-		skip.m_newHash = 0;
-		skip.m_gpuHash = gpuHash;
-		skip.m_fname = fname;
-
-		// Threading interface
-		class TaskManager : public ShaderProgramAsyncTaskInterface
-		{
-		public:
-			ThreadHive* m_hive = nullptr;
-			HeapAllocator<U8> m_alloc;
-
-			void enqueueTask(void (*callback)(void* userData), void* userData)
-			{
-				struct Ctx
-				{
-					void (*m_callback)(void* userData);
-					void* m_userData;
-					HeapAllocator<U8> m_alloc;
-				};
-				Ctx* ctx = m_alloc.newInstance<Ctx>();
-				ctx->m_callback = callback;
-				ctx->m_userData = userData;
-				ctx->m_alloc = m_alloc;
-
-				m_hive->submitTask(
-					[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-						Ctx* ctx = static_cast<Ctx*>(userData);
-						ctx->m_callback(ctx->m_userData);
-						auto alloc = ctx->m_alloc;
-						alloc.deleteInstance(ctx);
-					},
-					ctx);
-			}
-
-			Error joinTasks()
-			{
-				m_hive->waitAllTasks();
-				return Error::NONE;
-			}
-		} taskManager;
-		taskManager.m_hive = m_threadHive;
-		taskManager.m_alloc = m_heapAlloc;
-
-		// Compile
-		ShaderProgramBinaryWrapper binary(m_heapAlloc);
-		ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, m_heapAlloc, caps, limits, binary));
-
-		const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
-		if(!cachedBinIsUpToDate)
-		{
-			++shadersCompileCount;
-		}
+void App::reportMemoryLeaks()
+{
+	if(!m_memTracking)
+	{
+		return;
+	}
 
-		// Update the meta file
-		if(!cachedBinIsUpToDate)
-		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-			ANKI_CHECK(metaFile.write(&skip.m_newHash, sizeof(skip.m_newHash)));
-		}
+	Array<const MemoryTracker*, U32(TrackedSubsystem::COUNT)> trackers;
+	for(U32 i = 0; i < U32(TrackedSubsystem::COUNT); ++i)
+	{
+		trackers[i] = &m_memTrackers[i];
+		trackers[i]->logLeaks();
+	}
 
-		// Save the binary to the cache
-		if(!cachedBinIsUpToDate)
+#if ANKI_ENABLE_TRACE
+	if(m_coreTracer)
+	{
+		const Error err = m_coreTracer->writeMemoryReport(trackers);
+		if(err)
 		{
-			StringAuto storeFname(m_heapAlloc);
-			storeFname.sprintf("%s/%sbin", m_cacheDir.cstr(), baseFname.cstr());
-			ANKI_CHECK(binary.serializeToFile(storeFname));
+			ANKI_CORE_LOGE("Failed to write the memory report");
 		}
+	}
+#endif
+}
 
-		return Error::NONE;
-	}));
-
-	ANKI_CORE_LOGI("Compiled %u shader programs", shadersCompileCount);
+Error App::compileAllShaders()
+{
+	ANKI_CHECK(m_resources->getShaderProgramResourceSystem().compileAllPrograms(*m_threadHive));
 	return Error::NONE;
 }
 
@@ -9,6 +9,7 @@
 #include <anki/util/Allocator.h>
 #include <anki/util/String.h>
 #include <anki/util/Ptr.h>
+#include <anki/util/MemoryTracker.h>
 #include <anki/ui/UiImmediateModeBuilder.h>
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
@@ -207,8 +208,38 @@ private:
 		static void* allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 	} m_memStats;
 
+	/// The subsystems that have their own MemoryTracker.
+	enum class TrackedSubsystem : U8
+	{
+		GR,
+		PHYSICS,
+		RESOURCE,
+		UI,
+		RENDERER,
+		SCRIPT,
+		SCENE,
+
+		COUNT
+	};
+
+	Array<MemoryTracker, U32(TrackedSubsystem::COUNT)> m_memTrackers;
+	Bool m_memTracking = false;
+
 	void initMemoryCallbacks(AllocAlignedCallback allocCb, void* allocCbUserData);
 
+	/// Get the allocation callback of a subsystem. It goes through the subsystem's tracker if tracking is enabled.
+	AllocAlignedCallback getSubsystemAllocCallback(TrackedSubsystem subsystem) const
+	{
+		return (m_memTracking) ? MemoryTracker::allocCallback : m_allocCb;
+	}
+
+	void* getSubsystemAllocCallbackData(TrackedSubsystem subsystem)
+	{
+		return (m_memTracking) ? &m_memTrackers[U32(subsystem)] : m_allocCbData;
+	}
+
+	void reportMemoryLeaks();
+
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& config, AllocAlignedCallback allocCb, void* allocCbUserData);
 
 	ANKI_USE_RESULT Error initDirs(const ConfigSet& cfg);
@@ -13,5 +13,7 @@ ANKI_CONFIG_OPTION(height, 768, 16, 16 * 1024, "Height")
 ANKI_CONFIG_OPTION(core_targetFps, 60u, 30u, MAX_U32, "Target FPS")
 ANKI_CONFIG_OPTION(core_mainThreadCount, max(2u, getCpuCoresCount() / 2u), 2u, 1024u)
 ANKI_CONFIG_OPTION(core_displayStats, 0, 0, 1)
+ANKI_CONFIG_OPTION(core_memoryTracking, 0, 0, 1, "Track the memory of every subsystem")
+ANKI_CONFIG_OPTION(core_asyncLogging, 0, 0, 1, "Pass the log messages to the handlers from a separate thread")
 ANKI_CONFIG_OPTION(core_clearCaches, 0, 0, 1)
 ANKI_CONFIG_OPTION(window_fullscreen, 0, 0, 1)
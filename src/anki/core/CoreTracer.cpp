@@ -6,8 +6,11 @@
 #include <anki/core/CoreTracer.h>
 #include <anki/util/DynamicArray.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/MemoryTracker.h>
+#include <anki/util/HighRezTimer.h>
 #include <anki/math/Functions.h>
 #include <ctime>
+#include <cinttypes>
 
 namespace anki
 {
@@ -75,9 +78,9 @@ CoreTracer::~CoreTracer()
 	(void)err;
 
 	// Finalize trace file
-	if(m_traceJsonFile.isOpen())
+	if(m_traceFile.isOpen())
 	{
-		err = m_traceJsonFile.writeText("{}\n]\n");
+		err = m_traceFile.flush();
 	}
 
 	// Write counter file
@@ -96,12 +99,10 @@ CoreTracer::~CoreTracer()
 		m_alloc.deleteInstance(item);
 	}
 
-	for(String& s : m_counterNames)
-	{
-		s.destroy(m_alloc);
-	}
 	m_counterNames.destroy(m_alloc);
 
+	m_filenamePrefix.destroy(m_alloc);
+
 	// Destroy the tracer
 	TracerSingleton::destroy();
 }
@@ -109,7 +110,20 @@ CoreTracer::~CoreTracer()
 Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 {
 	TracerSingleton::init(alloc);
-	const Bool enableTracer = getenv("ANKI_CORE_TRACER_ENABLED") && getenv("ANKI_CORE_TRACER_ENABLED")[0] == '1';
+	Bool enableTracer = getenv("ANKI_CORE_TRACER_ENABLED") && getenv("ANKI_CORE_TRACER_ENABLED")[0] == '1';
+
+	// The rolling window is set to the min frame time in ms that counts as a hitch
+	const char* rollingWindow = getenv("ANKI_CORE_TRACER_ROLLING_WINDOW");
+	if(rollingWindow && rollingWindow[0] != '\0')
+	{
+		F64 hitchMs;
+		ANKI_CHECK(CString(rollingWindow).toNumber(hitchMs));
+		m_rollingWindow = true;
+		m_hitchFrameTime = hitchMs / 1000.0;
+		enableTracer = true;
+		ANKI_CORE_LOGI("Tracer rolling window is enabled. Frames longer than %fms will be dumped", hitchMs);
+	}
+
 	TracerSingleton::get().setEnabled(enableTracer);
 	ANKI_CORE_LOGI("Tracing is %s from the beginning", (enableTracer) ? "enabled" : "disabled");
 
@@ -119,8 +133,8 @@ Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 
 	std::time_t t = std::time(nullptr);
 	std::tm* tm = std::localtime(&t);
-	StringAuto fname(m_alloc);
-	fname.sprintf("%s/%d%02d%02d-%02d%02d_",
+	m_filenamePrefix.sprintf(m_alloc,
+		"%s/%d%02d%02d-%02d%02d_",
 		directory.cstr(),
 		tm->tm_year + 1900,
 		tm->tm_mon + 1,
@@ -128,10 +142,10 @@ Error CoreTracer::init(GenericMemoryPoolAllocator<U8> alloc, CString directory)
 		tm->tm_hour,
 		tm->tm_min);
 
-	ANKI_CHECK(m_traceJsonFile.open(StringAuto(alloc).sprintf("%strace.json", fname.cstr()), FileOpenFlag::WRITE));
-	ANKI_CHECK(m_traceJsonFile.writeText("[\n"));
+	ANKI_CHECK(m_traceFile.open(alloc, StringAuto(alloc).sprintf("%strace.ankitrace", m_filenamePrefix.cstr())));
 
-	ANKI_CHECK(m_countersCsvFile.open(StringAuto(alloc).sprintf("%scounters.csv", fname.cstr()), FileOpenFlag::WRITE));
+	ANKI_CHECK(m_countersCsvFile.open(
+		StringAuto(alloc).sprintf("%scounters.csv", m_filenamePrefix.cstr()), FileOpenFlag::WRITE));
 
 	return Error::NONE;
 }
@@ -189,32 +203,24 @@ Error CoreTracer::writeEvents(ThreadWorkItem& item)
 		return (a.m_start != b.m_start) ? a.m_start < b.m_start : a.m_duration > b.m_duration;
 	});
 
-	// Write events
-	for(const TracerEvent& event : item.m_events)
-	{
-		const I64 startMicroSec = I64(event.m_start * 1000000.0);
-		const I64 durMicroSec = I64(event.m_duration * 1000000.0);
-
-		// Do a hack
-		const ThreadId tid = (event.m_name == "GPU_TIME") ? 1 : item.m_tid;
-
-		ANKI_CHECK(m_traceJsonFile.writeText("{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", "
-											 "\"pid\": 1, \"tid\": %llu, \"ts\": %lld, \"dur\": %lld},\n",
-			event.m_name.cstr(),
-			tid,
-			startMicroSec,
-			durMicroSec));
-	}
+	// Do a hack and put the GPU events to their own thread
+	static const InternedString gpuTimeName("GPU_TIME");
+	TracerEvent* gpuEvents = std::stable_partition(item.m_events.getBegin(),
+		item.m_events.getEnd(),
+		[](const TracerEvent& event) { return event.m_name != gpuTimeName; });
+	const U32 cpuEventCount = U32(gpuEvents - item.m_events.getBegin());
 
-	// Store counters
-	// TODO
+	ANKI_CHECK(
+		m_traceFile.writeEvents(item.m_tid, ConstWeakArray<TracerEvent>(item.m_events.getBegin(), cpuEventCount)));
+	ANKI_CHECK(
+		m_traceFile.writeEvents(1, ConstWeakArray<TracerEvent>(gpuEvents, item.m_events.getSize() - cpuEventCount)));
 
 	return Error::NONE;
 }
 
 void CoreTracer::gatherCounters(ThreadWorkItem& item)
 {
-	// Sort
+	// Sort. The names are interned so sort them by ID
 	std::sort(item.m_counters.getBegin(), item.m_counters.getEnd(), [](const TracerCounter& a, const TracerCounter& b) {
 		return a.m_name < b.m_name;
 	});
@@ -231,7 +237,7 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 		else
 		{
 			// Merge
-			mergedCounters.getBack().m_value += item.m_counters[i].m_name;
+			mergedCounters.getBack().m_value += item.m_counters[i].m_value;
 		}
 	}
 	ANKI_ASSERT(mergedCounters.getSize() > 0 && mergedCounters.getSize() <= item.m_counters.getSize());
@@ -243,7 +249,7 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 		const TracerCounter& counter = mergedCounters[i];
 
 		Bool found = false;
-		for(const String& name : m_counterNames)
+		for(InternedString name : m_counterNames)
 		{
 			if(name == counter.m_name)
 			{
@@ -254,14 +260,16 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 
 		if(!found)
 		{
-			m_counterNames.emplaceBack(m_alloc, m_alloc, counter.m_name);
+			m_counterNames.emplaceBack(m_alloc, counter.m_name);
 			addedCounterName = true;
 		}
 	}
 
 	if(addedCounterName)
 	{
-		std::sort(m_counterNames.getBegin(), m_counterNames.getEnd());
+		std::sort(m_counterNames.getBegin(), m_counterNames.getEnd(), [](InternedString a, InternedString b) {
+			return a.toCString() < b.toCString();
+		});
 	}
 
 	// Get a per-frame structure
@@ -300,6 +308,39 @@ void CoreTracer::gatherCounters(ThreadWorkItem& item)
 }
 
 void CoreTracer::flushFrame(U64 frame)
+{
+	const Second now = HighRezTimer::getCurrentTime();
+	const Second frameTime = now - m_prevFlushTime;
+	const Bool firstFrame = m_prevFlushTime == 0.0;
+	m_prevFlushTime = now;
+
+	if(!m_rollingWindow)
+	{
+		flushTracer(frame);
+
+		const U64 lostRecordCount = TracerSingleton::get().getLostRecordCount();
+		if(lostRecordCount != m_lostRecordCount)
+		{
+			ANKI_CORE_LOGW("The tracer lost %" PRIu64 " events and counters. Flush it more often",
+				lostRecordCount - m_lostRecordCount);
+			m_lostRecordCount = lostRecordCount;
+		}
+	}
+	else if(!firstFrame && frameTime >= m_hitchFrameTime)
+	{
+		ANKI_CORE_LOGI(
+			"Frame %" PRIu64 " took %fms. Dumping the rolling window of the tracer", frame, frameTime * 1000.0);
+		flushTracer(frame);
+	}
+}
+
+void CoreTracer::dumpRollingWindow(U64 frame)
+{
+	ANKI_ASSERT(m_rollingWindow);
+	flushTracer(frame);
+}
+
+void CoreTracer::flushTracer(U64 frame)
 {
 	struct Ctx
 	{
@@ -397,4 +438,22 @@ Error CoreTracer::writeCountersForReal()
 	return Error::NONE;
 }
 
+Error CoreTracer::writeMemoryReport(ConstWeakArray<const MemoryTracker*> trackers)
+{
+	if(m_filenamePrefix.isEmpty())
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(StringAuto(m_alloc).sprintf("%smemory.txt", m_filenamePrefix.cstr()), FileOpenFlag::WRITE));
+
+	for(const MemoryTracker* tracker : trackers)
+	{
+		ANKI_CHECK(tracker->writeReport(file));
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -10,10 +10,15 @@
 #include <anki/util/Allocator.h>
 #include <anki/util/List.h>
 #include <anki/util/File.h>
+#include <anki/util/TracerFile.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
 
+// Forward
+class MemoryTracker;
+
 /// @addtogroup core
 /// @{
 
@@ -28,9 +33,15 @@ public:
 	/// @param directory The directory to store the trace and counters.
 	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString directory);
 
-	/// It will flush everything.
+	/// It will flush everything. In rolling window mode it will flush only if the frame was a hitch.
 	void flushFrame(U64 frame);
 
+	/// Write the rolling window of the tracer to the trace file. Only for the rolling window mode.
+	void dumpRollingWindow(U64 frame);
+
+	/// Write the stats and the leaks of some memory trackers to a file next to the trace. Call it at shutdown.
+	ANKI_USE_RESULT Error writeMemoryReport(ConstWeakArray<const MemoryTracker*> trackers);
+
 private:
 	class ThreadWorkItem;
 	class PerFrameCounters;
@@ -41,16 +52,26 @@ private:
 	ConditionVariable m_cvar;
 	Mutex m_mtx;
 
-	DynamicArray<String> m_counterNames;
+	String m_filenamePrefix; ///< The path and the date that prefixes all files.
+
+	DynamicArray<InternedString> m_counterNames; ///< Sorted by the characters.
 	IntrusiveList<PerFrameCounters> m_frameCounters;
 
 	IntrusiveList<ThreadWorkItem> m_workItems; ///< Items for the thread to process.
-	File m_traceJsonFile;
+	TracerFileWriter m_traceFile;
 	File m_countersCsvFile;
 	Bool m_quit = false;
 
+	/// In the rolling window mode the tracer is always enabled and it's flushed only after a hitch.
+	Bool m_rollingWindow = false;
+	Second m_hitchFrameTime = 0.0;
+	Second m_prevFlushTime = 0.0;
+	U64 m_lostRecordCount = 0;
+
 	Error threadWorker();
 
+	void flushTracer(U64 frame);
+
 	Error writeEvents(ThreadWorkItem& item);
 	void gatherCounters(ThreadWorkItem& item);
 	Error writeCountersForReal();
@@ -140,7 +140,7 @@ public:
 class RenderGraph::BakeContext
 {
 public:
-	StackAllocator<U8> m_alloc;
+	FrameAllocator<U8> m_alloc;
 	DynamicArray<Pass> m_passes;
 	BitSet<MAX_RENDER_GRAPH_PASSES, U64> m_passIsInBatch = {false};
 	DynamicArray<Batch> m_batches;
@@ -151,7 +151,7 @@ public:
 
 	Bool m_gatherStatistics = false;
 
-	BakeContext(const StackAllocator<U8>& alloc)
+	BakeContext(const FrameAllocator<U8>& alloc)
 		: m_alloc(alloc)
 	{
 	}
@@ -282,11 +282,8 @@ void RenderGraph::reset()
 		{
 			const U32 surfOrVolumeCount = getTextureSurfOrVolCount(rt.m_texture);
 
-			// Create a new hash because our hash map dislikes concurent keys.
 			const U64 uuid = rt.m_texture->getUuid();
-			const U64 hash = computeHash(&uuid, sizeof(uuid));
-
-			auto it = m_importedRenderTargets.find(hash);
+			auto it = m_importedRenderTargets.find(uuid);
 			if(it != m_importedRenderTargets.getEnd())
 			{
 				// Found
@@ -296,7 +293,7 @@ void RenderGraph::reset()
 			else
 			{
 				// Not found, create
-				it = m_importedRenderTargets.emplace(getAllocator(), hash);
+				it = m_importedRenderTargets.emplace(getAllocator(), uuid);
 				it->m_surfOrVolLastUsages.create(getAllocator(), surfOrVolumeCount);
 			}
 
@@ -328,7 +325,7 @@ void RenderGraph::reset()
 
 	m_ctx->m_graphicsCmdbs.destroy(m_ctx->m_alloc);
 
-	m_ctx->m_alloc = StackAllocator<U8>();
+	m_ctx->m_alloc = FrameAllocator<U8>();
 	m_ctx = nullptr;
 	++m_version;
 }
@@ -600,7 +597,7 @@ Bool RenderGraph::passHasUnmetDependencies(const BakeContext& ctx, U32 passIdx)
 	return depends;
 }
 
-RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc)
 {
 	// Allocate
 	BakeContext* ctx = alloc.newInstance<BakeContext>(alloc);
@@ -641,11 +638,8 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		{
 			// Get the usage from previous frames
 
-			// Create a new hash because our hash map dislikes concurent keys.
 			const U64 uuid = outRt.m_texture->getUuid();
-			const U64 hash = computeHash(&uuid, sizeof(uuid));
-
-			auto it = m_importedRenderTargets.find(hash);
+			auto it = m_importedRenderTargets.find(uuid);
 			ANKI_ASSERT(it != m_importedRenderTargets.getEnd() && "Can't find the imported RT");
 
 			ANKI_ASSERT(it->m_surfOrVolLastUsages.getSize() == surfOrVolumeCount);
@@ -681,7 +675,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -813,7 +807,7 @@ void RenderGraph::initBatches()
 	}
 }
 
-void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -956,7 +950,7 @@ void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& de
 void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 {
 	BakeContext& ctx = *m_ctx;
-	const StackAllocator<U8>& alloc = ctx.m_alloc;
+	const FrameAllocator<U8>& alloc = ctx.m_alloc;
 
 	// For all batches
 	for(Batch& batch : ctx.m_batches)
@@ -1051,7 +1045,7 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 	} // For all batches
 }
 
-void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc)
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_COMPILE);
 
@@ -1307,7 +1301,7 @@ void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
 }
 
 #if ANKI_DBG_RENDER_GRAPH
-StringAuto RenderGraph::textureUsageToStr(StackAllocator<U8>& alloc, TextureUsageBit usage)
+StringAuto RenderGraph::textureUsageToStr(FrameAllocator<U8>& alloc, TextureUsageBit usage)
 {
 	StringListAuto slist(alloc);
 
@@ -1345,7 +1339,7 @@ StringAuto RenderGraph::textureUsageToStr(StackAllocator<U8>& alloc, TextureUsag
 	return str;
 }
 
-StringAuto RenderGraph::bufferUsageToStr(StackAllocator<U8>& alloc, BufferUsageBit usage)
+StringAuto RenderGraph::bufferUsageToStr(FrameAllocator<U8>& alloc, BufferUsageBit usage)
 {
 	StringListAuto slist(alloc);
 
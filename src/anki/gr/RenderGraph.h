@@ -13,7 +13,7 @@
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/TimestampQuery.h>
 #include <anki/gr/CommandBuffer.h>
-#include <anki/util/HashMap.h>
+#include <anki/util/FlatHashMap.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/WeakArray.h>
 
@@ -321,7 +321,7 @@ protected:
 
 	Type m_type;
 
-	StackAllocator<U8> m_alloc;
+	FrameAllocator<U8> m_alloc;
 	RenderGraphDescription* m_descr;
 
 	RenderPassWorkCallback m_callback = nullptr;
@@ -337,7 +337,7 @@ protected:
 	BitSet<MAX_RENDER_GRAPH_BUFFERS, U64> m_writeBuffMask = {false};
 	Bool m_hasBufferDeps = false; ///< Opt.
 
-	String m_name;
+	SsoString m_name; ///< The names of the passes are short so they rarely allocate.
 
 	RenderPassDescriptionBase(Type t, RenderGraphDescription* descr)
 		: m_type(t)
@@ -457,7 +457,7 @@ class RenderGraphDescription
 	friend class RenderPassDescriptionBase;
 
 public:
-	RenderGraphDescription(const StackAllocator<U8>& alloc)
+	RenderGraphDescription(const FrameAllocator<U8>& alloc)
 		: m_alloc(alloc)
 	{
 	}
@@ -521,7 +521,7 @@ private:
 		BufferPtr m_importedBuff;
 	};
 
-	StackAllocator<U8> m_alloc;
+	FrameAllocator<U8> m_alloc;
 	DynamicArray<RenderPassDescriptionBase*> m_passes;
 	DynamicArray<RT> m_renderTargets;
 	DynamicArray<Buffer> m_buffers;
@@ -557,7 +557,7 @@ public:
 
 	/// @name 1st step methods
 	/// @{
-	void compileNewGraph(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void compileNewGraph(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc);
 	/// @}
 
 	/// @name 2nd step methods
@@ -619,9 +619,9 @@ private:
 		DynamicArray<TextureUsageBit> m_surfOrVolLastUsages; ///< Last TextureUsageBit of the imported RT.
 	};
 
-	HashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
-	HashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
-	HashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	FlatHashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
+	FlatHashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
+	FlatHashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets; ///< The key is the UUID of the texture.
 
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
@@ -641,10 +641,10 @@ private:
 
 	static ANKI_USE_RESULT RenderGraph* newInstance(GrManager* manager);
 
-	BakeContext* newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	BakeContext* newContext(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc);
+	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc);
 	void initBatches();
-	void initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initGraphicsPasses(const RenderGraphDescription& descr, FrameAllocator<U8>& alloc);
 	void setBatchBarriers(const RenderGraphDescription& descr);
 
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
@@ -676,8 +676,8 @@ private:
 	/// @{
 	ANKI_USE_RESULT Error dumpDependencyDotFile(
 		const RenderGraphDescription& descr, const BakeContext& ctx, CString path) const;
-	static StringAuto textureUsageToStr(StackAllocator<U8>& alloc, TextureUsageBit usage);
-	static StringAuto bufferUsageToStr(StackAllocator<U8>& alloc, BufferUsageBit usage);
+	static StringAuto textureUsageToStr(FrameAllocator<U8>& alloc, TextureUsageBit usage);
+	static StringAuto bufferUsageToStr(FrameAllocator<U8>& alloc, BufferUsageBit usage);
 	/// @}
 
 	TexturePtr getTexture(RenderTargetHandle handle) const;
@@ -141,6 +141,140 @@ void writeShaderBlockMemory(ShaderVariableDataType type,
 	}
 }
 
+template<typename T>
+static void getShaderBlockMemoryRangesSimple(
+	const ShaderVariableBlockInfo& varBlkInfo, U32 elementsCount, DynamicArrayAuto<ShaderBlockMemoryRange>& ranges)
+{
+	ANKI_ASSERT(varBlkInfo.m_offset >= 0);
+	ANKI_ASSERT(elementsCount > 0 && static_cast<I16>(elementsCount) <= varBlkInfo.m_arraySize);
+
+	U32 offset = U32(varBlkInfo.m_offset);
+	for(U32 i = 0; i < elementsCount; ++i)
+	{
+		ranges.emplaceBack(ShaderBlockMemoryRange{offset, sizeof(T)});
+		offset += U32(varBlkInfo.m_arrayStride);
+	}
+}
+
+template<typename T, typename Vec>
+static void getShaderBlockMemoryRangesMatrix(
+	const ShaderVariableBlockInfo& varBlkInfo, U32 elementsCount, DynamicArrayAuto<ShaderBlockMemoryRange>& ranges)
+{
+	ANKI_ASSERT(varBlkInfo.m_offset >= 0);
+	ANKI_ASSERT(elementsCount > 0 && static_cast<I16>(elementsCount) <= varBlkInfo.m_arraySize);
+	ANKI_ASSERT(varBlkInfo.m_matrixStride >= static_cast<I16>(sizeof(Vec)));
+
+	U32 offset = U32(varBlkInfo.m_offset);
+	for(U32 i = 0; i < elementsCount; ++i)
+	{
+		for(U32 j = 0; j < sizeof(T) / sizeof(Vec); ++j)
+		{
+			ranges.emplaceBack(ShaderBlockMemoryRange{offset + j * U32(varBlkInfo.m_matrixStride), sizeof(Vec)});
+		}
+		offset += U32(varBlkInfo.m_arrayStride);
+	}
+}
+
+void getShaderBlockMemoryRanges(ShaderVariableDataType type,
+	const ShaderVariableBlockInfo& varBlkInfo,
+	U32 elementsCount,
+	DynamicArrayAuto<ShaderBlockMemoryRange>& ranges)
+{
+	switch(type)
+	{
+	case ShaderVariableDataType::INT:
+		getShaderBlockMemoryRangesSimple<I32>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::UINT:
+		getShaderBlockMemoryRangesSimple<U32>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::FLOAT:
+		getShaderBlockMemoryRangesSimple<F32>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::IVEC2:
+		getShaderBlockMemoryRangesSimple<IVec2>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::UVEC2:
+		getShaderBlockMemoryRangesSimple<UVec2>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::VEC2:
+		getShaderBlockMemoryRangesSimple<Vec2>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::IVEC3:
+		getShaderBlockMemoryRangesSimple<IVec3>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::UVEC3:
+		getShaderBlockMemoryRangesSimple<UVec3>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::VEC3:
+		getShaderBlockMemoryRangesSimple<Vec3>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::IVEC4:
+		getShaderBlockMemoryRangesSimple<IVec4>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::UVEC4:
+		getShaderBlockMemoryRangesSimple<UVec4>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::VEC4:
+		getShaderBlockMemoryRangesSimple<Vec4>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::MAT3:
+		getShaderBlockMemoryRangesMatrix<Mat3, Vec3>(varBlkInfo, elementsCount, ranges);
+		break;
+	case ShaderVariableDataType::MAT4:
+		getShaderBlockMemoryRangesMatrix<Mat4, Vec4>(varBlkInfo, elementsCount, ranges);
+		break;
+	default:
+		ANKI_ASSERT(0);
+	}
+}
+
+void mergeShaderBlockMemoryRanges(
+	DynamicArrayAuto<ShaderBlockMemoryRange>& ranges, ConstWeakArray<ShaderBlockMemoryRange> excluded)
+{
+	if(ranges.getSize() == 0)
+	{
+		return;
+	}
+
+	std::sort(ranges.getBegin(), ranges.getEnd(), [](const ShaderBlockMemoryRange& a, const ShaderBlockMemoryRange& b) {
+		return a.m_offset < b.m_offset;
+	});
+
+	U32 outCount = 1;
+	for(U32 i = 1; i < ranges.getSize(); ++i)
+	{
+		ShaderBlockMemoryRange& prev = ranges[outCount - 1];
+		const U32 prevEnd = prev.m_offset + prev.m_size;
+		const ShaderBlockMemoryRange& crnt = ranges[i];
+
+		// Check if the gap between the 2 ranges is only padding
+		Bool merge = true;
+		if(crnt.m_offset > prevEnd)
+		{
+			for(const ShaderBlockMemoryRange& ex : excluded)
+			{
+				if(ex.m_offset < crnt.m_offset && ex.m_offset + ex.m_size > prevEnd)
+				{
+					merge = false;
+					break;
+				}
+			}
+		}
+
+		if(merge)
+		{
+			prev.m_size = max(prevEnd, crnt.m_offset + crnt.m_size) - prev.m_offset;
+		}
+		else
+		{
+			ranges[outCount++] = crnt;
+		}
+	}
+
+	ranges.resize(outCount);
+}
+
 const CString shaderVariableDataTypeToString(ShaderVariableDataType t)
 {
 #define ANKI_SVDT_MACRO(svdt, akType) \
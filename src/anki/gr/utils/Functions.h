@@ -7,6 +7,8 @@
 
 #include <anki/gr/Common.h>
 #include <anki/Math.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -56,6 +58,38 @@ void writeShaderBlockMemory(ShaderVariableDataType type,
 	void* buffBegin,
 	const void* buffEnd);
 
+/// A range of bytes inside a shader block.
+class ShaderBlockMemoryRange
+{
+public:
+	U32 m_offset;
+	U32 m_size;
+};
+
+/// Get the bytes that writeShaderBlockMemory will write for a variable. Appends one range per array element or one
+/// per matrix row.
+void getShaderBlockMemoryRanges(ShaderVariableDataType type,
+	const ShaderVariableBlockInfo& varBlkInfo,
+	U32 elementsCount,
+	DynamicArrayAuto<ShaderBlockMemoryRange>& ranges);
+
+/// Sort and merge ranges that touch. Ranges that are separated only by bytes that are not in @a excluded are merged
+/// as well. Those bytes are padding so copying them is harmless.
+void mergeShaderBlockMemoryRanges(
+	DynamicArrayAuto<ShaderBlockMemoryRange>& ranges, ConstWeakArray<ShaderBlockMemoryRange> excluded);
+
+/// Copy some ranges from one block to another. Both blocks have the same layout.
+inline void copyShaderBlockMemoryRanges(
+	ConstWeakArray<ShaderBlockMemoryRange> ranges, const void* src, void* buffBegin, const void* buffEnd)
+{
+	for(const ShaderBlockMemoryRange& range : ranges)
+	{
+		U8* out = static_cast<U8*>(buffBegin) + range.m_offset;
+		ANKI_ASSERT(out + range.m_size <= static_cast<const U8*>(buffEnd));
+		memcpy(out, static_cast<const U8*>(src) + range.m_offset, range.m_size);
+	}
+}
+
 /// Convert a ShaderVariableDataType to string.
 const CString shaderVariableDataTypeToString(ShaderVariableDataType t);
 
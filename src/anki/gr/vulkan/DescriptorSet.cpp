@@ -351,8 +351,8 @@ public:
 	Array<VkDescriptorPoolSize, U(DescriptorType::COUNT)> m_poolSizesCreateInf = {};
 	VkDescriptorPoolCreateInfo m_poolCreateInf = {};
 
-	DynamicArray<DSThreadAllocator*> m_threadAllocs;
-	RWMutex m_threadAllocsMtx;
+	ConcurrentHashMap<ThreadId, DSThreadAllocator*> m_threadAllocs;
+	Mutex m_threadAllocsMtx; ///< Only for creating allocators. The lookups don't lock
 
 	DSLayoutCacheEntry(DescriptorSetFactory* factory)
 		: m_factory(factory)
@@ -648,11 +648,7 @@ DSLayoutCacheEntry::~DSLayoutCacheEntry()
 {
 	auto alloc = m_factory->m_alloc;
 
-	for(DSThreadAllocator* a : m_threadAllocs)
-	{
-		alloc.deleteInstance(a);
-	}
-
+	m_threadAllocs.iterate([&](ThreadId, DSThreadAllocator* a) { alloc.deleteInstance(a); });
 	m_threadAllocs.destroy(alloc);
 
 	if(m_layoutHandle)
@@ -738,55 +734,37 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 
 Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc)
 {
-	alloc = nullptr;
-
-	class Comp
+	// Find it without locking
+	DSThreadAllocator* const* cached = m_threadAllocs.find(tid);
+	if(ANKI_LIKELY(cached != nullptr))
 	{
-	public:
-		Bool operator()(const DSThreadAllocator* a, ThreadId tid) const
-		{
-			return a->m_tid < tid;
-		}
+		alloc = *cached;
+		return Error::NONE;
+	}
 
-		Bool operator()(ThreadId tid, const DSThreadAllocator* a) const
-		{
-			return tid < a->m_tid;
-		}
-	};
+	// Need to create one
+	LockGuard<Mutex> lock(m_threadAllocsMtx);
 
-	// Find using binary search
+	// Search again
+	cached = m_threadAllocs.find(tid);
+	if(cached != nullptr)
 	{
-		RLockGuard<RWMutex> lock(m_threadAllocsMtx);
-		auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-		alloc = (it != m_threadAllocs.getEnd()) ? *it : nullptr;
+		alloc = *cached;
+		return Error::NONE;
 	}
 
-	if(alloc == nullptr)
+	// Create
+	alloc = m_factory->m_alloc.newInstance<DSThreadAllocator>(this, tid);
+	const Error err = alloc->init();
+	if(err)
 	{
-		// Need to create one
-
-		WLockGuard<RWMutex> lock(m_threadAllocsMtx);
-
-		// Search again
-		auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-		alloc = (it != m_threadAllocs.getEnd()) ? *it : nullptr;
-
-		// Create
-		if(alloc == nullptr)
-		{
-			alloc = m_factory->m_alloc.newInstance<DSThreadAllocator>(this, tid);
-			ANKI_CHECK(alloc->init());
-
-			m_threadAllocs.resize(m_factory->m_alloc, m_threadAllocs.getSize() + 1);
-			m_threadAllocs[m_threadAllocs.getSize() - 1] = alloc;
-
-			// Sort for fast find
-			std::sort(m_threadAllocs.getBegin(),
-				m_threadAllocs.getEnd(),
-				[](const DSThreadAllocator* a, const DSThreadAllocator* b) { return a->m_tid < b->m_tid; });
-		}
+		m_factory->m_alloc.deleteInstance(alloc);
+		alloc = nullptr;
+		return err;
 	}
 
+	m_threadAllocs.emplace(m_factory->m_alloc, tid, alloc);
+
 	ANKI_ASSERT(alloc);
 	return Error::NONE;
 }
@@ -933,11 +911,7 @@ Error DescriptorSetFactory::init(const GrAllocator<U8>& alloc, VkDevice dev, con
 
 void DescriptorSetFactory::destroy()
 {
-	for(DSLayoutCacheEntry* l : m_caches)
-	{
-		m_alloc.deleteInstance(l);
-	}
-
+	m_caches.iterate([&](U64, DSLayoutCacheEntry* l) { m_alloc.deleteInstance(l); });
 	m_caches.destroy(m_alloc);
 
 	if(m_bindless)
@@ -1001,27 +975,25 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 	}
 	else
 	{
-		LockGuard<SpinLock> lock(m_cachesMtx);
-
-		DSLayoutCacheEntry* cache = nullptr;
-		U count = 0;
-		for(DSLayoutCacheEntry* it : m_caches)
-		{
-			if(it->m_hash == hash)
-			{
-				cache = it;
-				break;
-			}
-			++count;
-		}
+		// Find it without locking
+		DSLayoutCacheEntry* const* cached = m_caches.find(hash);
+		DSLayoutCacheEntry* cache = (cached) ? *cached : nullptr;
 
 		if(cache == nullptr)
 		{
-			cache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
-			ANKI_CHECK(cache->init(bindings.getBegin(), bindingCount, hash));
+			// Lock to avoid creating the same layout twice
+			LockGuard<SpinLock> lock(m_cachesMtx);
 
-			m_caches.resize(m_alloc, m_caches.getSize() + 1);
-			m_caches[m_caches.getSize() - 1] = cache;
+			cached = m_caches.find(hash);
+			cache = (cached) ? *cached : nullptr;
+
+			if(cache == nullptr)
+			{
+				cache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
+				ANKI_CHECK(cache->init(bindings.getBegin(), bindingCount, hash));
+
+				m_caches.emplace(m_alloc, hash, cache);
+			}
 		}
 
 		// Set the layout
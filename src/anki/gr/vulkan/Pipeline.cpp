@@ -411,14 +411,14 @@ public:
 
 void PipelineFactory::destroy()
 {
-	for(auto it : m_pplines)
-	{
-		if(it.m_handle)
+	m_pplines.iterate([&](U64, PipelineInternal* pp) {
+		if(pp->m_handle)
 		{
-			vkDestroyPipeline(m_dev, it.m_handle, nullptr);
-			it.m_fb.reset(nullptr);
+			vkDestroyPipeline(m_dev, pp->m_handle, nullptr);
 		}
-	}
+
+		m_alloc.deleteInstance(pp);
+	});
 
 	m_pplines.destroy(m_alloc);
 }
@@ -434,34 +434,42 @@ void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline,
 		return;
 	}
 
+	// Find it without locking
+	PipelineInternal* const* cached = m_pplines.find(hash);
+	if(ANKI_LIKELY(cached != nullptr))
+	{
+		ppline.m_handle = (*cached)->m_handle;
+		return;
+	}
+
+	// Lock to avoid creating the same pipeline twice
 	LockGuard<SpinLock> lock(m_pplinesMtx);
 
-	auto it = m_pplines.find(hash);
-	if(it != m_pplines.getEnd())
+	cached = m_pplines.find(hash);
+	if(cached != nullptr)
 	{
-		ppline.m_handle = (*it).m_handle;
+		ppline.m_handle = (*cached)->m_handle;
+		return;
 	}
-	else
-	{
-		PipelineInternal pp;
-		const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
-		pp.m_fb = state.getFb();
 
-		{
-			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
-		}
+	PipelineInternal* pp = m_alloc.newInstance<PipelineInternal>();
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
+	pp->m_fb = state.getFb();
 
-		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp->m_handle));
+	}
 
-		m_pplines.emplace(m_alloc, hash, pp);
-		ppline.m_handle = pp.m_handle;
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
 
-		// Print shader info
-		const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
-		shaderImpl.getGrManagerImpl().printPipelineShaderInfo(
-			pp.m_handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
-	}
+	m_pplines.emplace(m_alloc, hash, pp);
+	ppline.m_handle = pp->m_handle;
+
+	// Print shader info
+	const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
+	shaderImpl.getGrManagerImpl().printPipelineShaderInfo(
+		pp->m_handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
 }
 
 } // end namespace anki
@@ -10,7 +10,7 @@
 #include <anki/gr/vulkan/ShaderProgramImpl.h>
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/vulkan/FramebufferImpl.h>
-#include <anki/util/HashMap.h>
+#include <anki/util/ConcurrentHashMap.h>
 
 namespace anki
 {
@@ -584,8 +584,8 @@ private:
 	VkDevice m_dev = VK_NULL_HANDLE;
 	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
 
-	HashMap<U64, PipelineInternal, Hasher> m_pplines;
-	SpinLock m_pplinesMtx;
+	ConcurrentHashMap<U64, PipelineInternal*, Hasher> m_pplines;
+	SpinLock m_pplinesMtx; ///< Only for creating pipelines. The lookups don't lock
 };
 /// @}
 
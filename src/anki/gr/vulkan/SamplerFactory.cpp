@@ -103,12 +103,10 @@ void SamplerFactory::destroy()
 	}
 
 	GrAllocator<U8> alloc = m_gr->getAllocator();
-	for(auto it : m_map)
-	{
-		MicroSampler* const sampler = it;
+	m_map.iterate([&](U64, MicroSampler* sampler) {
 		ANKI_ASSERT(sampler->getRefcount().load() == 0 && "Someone still holds a reference to a sampler");
 		alloc.deleteInstance(sampler);
-	}
+	});
 
 	m_map.destroy(alloc);
 
@@ -123,31 +121,40 @@ Error SamplerFactory::newInstance(const SamplerInitInfo& inf, MicroSamplerPtr& p
 	MicroSampler* out = nullptr;
 	const U64 hash = inf.computeHash();
 
-	LockGuard<Mutex> lock(m_mtx);
-
-	auto it = m_map.find(hash);
-
-	if(it != m_map.getEnd())
+	// Find it without locking
+	MicroSampler* const* cached = m_map.find(hash);
+	if(cached != nullptr)
 	{
-		out = *it;
+		out = *cached;
 	}
 	else
 	{
-		// Create a new one
-
-		GrAllocator<U8> alloc = m_gr->getAllocator();
-
-		out = alloc.newInstance<MicroSampler>(this);
-		err = out->init(inf);
+		// Lock to avoid creating the same sampler twice
+		LockGuard<Mutex> lock(m_mtx);
 
-		if(err)
+		cached = m_map.find(hash);
+		if(cached != nullptr)
 		{
-			alloc.deleteInstance(out);
-			out = nullptr;
+			out = *cached;
 		}
 		else
 		{
-			m_map.emplace(alloc, hash, out);
+			// Create a new one
+
+			GrAllocator<U8> alloc = m_gr->getAllocator();
+
+			out = alloc.newInstance<MicroSampler>(this);
+			err = out->init(inf);
+
+			if(err)
+			{
+				alloc.deleteInstance(out);
+				out = nullptr;
+			}
+			else
+			{
+				m_map.emplace(alloc, hash, out);
+			}
 		}
 	}
 
@@ -619,26 +619,24 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	// Chose the formats of the attributes
 	MeshBinaryFile::Header header = {};
 	{
-		// Positions
-		const Vec3 dist3d = aabbMin.abs().max(aabbMax.abs());
-		const F32 maxPositionDistance = max(max(dist3d.x(), dist3d.y()), dist3d.z());
+		// Positions are quantized relative to the AABB of their submesh
 		MeshBinaryFile::VertexAttribute& posa = header.m_vertexAttributes[VertexAttributeLocation::POSITION];
 		posa.m_bufferBinding = 0;
-		posa.m_format = (maxPositionDistance < 2.0) ? Format::R16G16B16A16_SFLOAT : Format::R32G32B32_SFLOAT;
+		posa.m_format = Format::R16G16B16A16_UNORM;
 		posa.m_relativeOffset = 0;
 		posa.m_scale = 1.0f;
 
-		// Normals
+		// Normals are octahedral encoded
 		MeshBinaryFile::VertexAttribute& na = header.m_vertexAttributes[VertexAttributeLocation::NORMAL];
 		na.m_bufferBinding = 1;
-		na.m_format = Format::A2B10G10R10_SNORM_PACK32;
+		na.m_format = Format::R16G16_SNORM;
 		na.m_relativeOffset = 0;
 		na.m_scale = 1.0f;
 
-		// Tangents
+		// Tangents are octahedral encoded plus the handedness
 		MeshBinaryFile::VertexAttribute& ta = header.m_vertexAttributes[VertexAttributeLocation::TANGENT];
 		ta.m_bufferBinding = 1;
-		ta.m_format = Format::A2B10G10R10_SNORM_PACK32;
+		ta.m_format = Format::R8G8B8A8_SNORM;
 		ta.m_relativeOffset = sizeof(U32);
 		ta.m_scale = 1.0;
 
@@ -676,23 +674,11 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	// Arange the attributes into vert buffers
 	{
 		// First buff has positions
-		const MeshBinaryFile::VertexAttribute& posa = header.m_vertexAttributes[VertexAttributeLocation::POSITION];
-		if(posa.m_format == Format::R32G32B32_SFLOAT)
-		{
-			header.m_vertexBuffers[0].m_vertexStride = sizeof(F32) * 3;
-		}
-		else if(posa.m_format == Format::R16G16B16A16_SFLOAT)
-		{
-			header.m_vertexBuffers[0].m_vertexStride = sizeof(U16) * 4;
-		}
-		else
-		{
-			ANKI_ASSERT(0);
-		}
+		header.m_vertexBuffers[0].m_vertexStride = sizeof(U16) * 4;
 		++header.m_vertexBufferCount;
 
 		// 2nd buff has normal + tangent + texcoords
-		header.m_vertexBuffers[1].m_vertexStride = sizeof(U32) * 2 + sizeof(U16) * 2;
+		header.m_vertexBuffers[1].m_vertexStride = sizeof(U32) * 3;
 		++header.m_vertexBufferCount;
 
 		// 3rd has bone weights
@@ -727,23 +713,30 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	ANKI_CHECK(file.write(&header, sizeof(header)));
 
 	// Write sub meshes
-	for(const SubMesh& in : submeshes)
 	{
-		MeshBinaryFile::SubMesh out;
-		out.m_firstIndex = in.m_firstIdx;
-		out.m_indexCount = in.m_idxCount;
-		out.m_aabbMin = in.m_aabbMin;
-		out.m_aabbMax = in.m_aabbMax;
+		U32 firstVertex = 0;
+		for(const SubMesh& in : submeshes)
+		{
+			MeshBinaryFile::SubMesh out;
+			out.m_firstIndex = in.m_firstIdx;
+			out.m_indexCount = in.m_idxCount;
+			out.m_firstVertex = firstVertex;
+			out.m_vertexCount = in.m_verts.getSize();
+			out.m_aabbMin = in.m_aabbMin;
+			out.m_aabbMax = in.m_aabbMax;
 
-		ANKI_CHECK(file.write(&out, sizeof(out)));
+			ANKI_CHECK(file.write(&out, sizeof(out)));
+
+			firstVertex += out.m_vertexCount;
+		}
 	}
 
 	// Write indices
+	U32 vertCount = 0;
 	for(const SubMesh& submesh : submeshes)
 	{
 		DynamicArrayAuto<U16> indices(m_alloc);
 		indices.create(submesh.m_indices.getSize());
-		U32 vertCount = 0;
 		for(U32 i = 0; i < indices.getSize(); ++i)
 		{
 			const U32 idx = submesh.m_indices[i] + vertCount;
@@ -763,36 +756,22 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	// Write first vert buffer
 	for(const SubMesh& submesh : submeshes)
 	{
-		const MeshBinaryFile::VertexAttribute& posa = header.m_vertexAttributes[VertexAttributeLocation::POSITION];
-		if(posa.m_format == Format::R32G32B32_SFLOAT)
-		{
-			DynamicArrayAuto<Vec3> positions(m_alloc);
-			positions.create(submesh.m_verts.getSize());
-			for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
-			{
-				positions[v] = submesh.m_verts[v].m_position;
-			}
-			ANKI_CHECK(file.write(&positions[0], positions.getSizeInBytes()));
-		}
-		else if(posa.m_format == Format::R16G16B16A16_SFLOAT)
+		DynamicArrayAuto<U16Vec4> positions(m_alloc);
+		positions.create(submesh.m_verts.getSize());
+
+		const Vec3 aabbSize = submesh.m_aabbMax - submesh.m_aabbMin;
+		for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
 		{
-			DynamicArrayAuto<HVec4> pos16(m_alloc);
-			pos16.create(submesh.m_verts.getSize());
+			const Vec3 normalized = (submesh.m_verts[v].m_position - submesh.m_aabbMin) / aabbSize;
 
-			for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
+			for(U32 c = 0; c < 3; ++c)
 			{
-				pos16[v] = HVec4(F16(submesh.m_verts[v].m_position.x()),
-					F16(submesh.m_verts[v].m_position.y()),
-					F16(submesh.m_verts[v].m_position.z()),
-					F16(0.0f));
+				positions[v][c] = U16(round(clamp(normalized[c], 0.0f, 1.0f) * F32(MAX_U16)));
 			}
-
-			ANKI_CHECK(file.write(&pos16[0], pos16.getSizeInBytes()));
-		}
-		else
-		{
-			ANKI_ASSERT(0);
+			positions[v].w() = 0;
 		}
+
+		ANKI_CHECK(file.write(&positions[0], positions.getSizeInBytes()));
 	}
 
 	// Write the 2nd vert buffer
@@ -800,10 +779,11 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	{
 		struct Vert
 		{
-			U32 m_n;
-			U32 m_t;
+			I16 m_n[2];
+			I8 m_t[4];
 			U16 m_uv[2];
 		};
+		static_assert(sizeof(Vert) == sizeof(U32) * 3, "See header.m_vertexBuffers[1]");
 
 		DynamicArrayAuto<Vert> verts(m_alloc);
 		verts.create(submesh.m_verts.getSize());
@@ -814,8 +794,19 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 			const Vec4& tangent = submesh.m_verts[i].m_tangent;
 			const Vec2& uv = submesh.m_verts[i].m_uv;
 
-			verts[i].m_n = packColorToR10G10B10A2SNorm(normal.x(), normal.y(), normal.z(), 0.0f);
-			verts[i].m_t = packColorToR10G10B10A2SNorm(tangent.x(), tangent.y(), tangent.z(), tangent.w());
+			const Vec2 normalOct = packUnitVectorToOctahedral(
+				(normal.getLengthSquared() > EPSILON) ? normal.getNormalized() : Vec3(0.0f, 0.0f, 1.0f));
+			verts[i].m_n[0] = I16(round(normalOct.x() * F32(MAX_I16)));
+			verts[i].m_n[1] = I16(round(normalOct.y() * F32(MAX_I16)));
+
+			// A zero tangent (eg when there are no UVs) would give NaNs
+			const Vec3 tangent3 = tangent.xyz();
+			const Vec2 tangentOct = packUnitVectorToOctahedral(
+				(tangent3.getLengthSquared() > EPSILON) ? tangent3.getNormalized() : Vec3(1.0f, 0.0f, 0.0f));
+			verts[i].m_t[0] = I8(round(tangentOct.x() * F32(MAX_I8)));
+			verts[i].m_t[1] = I8(round(tangentOct.y() * F32(MAX_I8)));
+			verts[i].m_t[2] = (tangent.w() >= 0.0f) ? MAX_I8 : -MAX_I8;
+			verts[i].m_t[3] = 0;
 
 			const Format uvfmt = header.m_vertexAttributes[VertexAttributeLocation::UV].m_format;
 			if(uvfmt == Format::R16G16_UNORM)
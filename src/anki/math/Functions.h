@@ -221,6 +221,47 @@ inline U32 packColorToR10G10B10A2SNorm(F32 r, F32 g, F32 b, F32 a)
 	return out.m_packed;
 }
 
+/// Map a unit vector to the [-1, 1] square using the octahedral mapping.
+template<typename TVec3>
+inline auto packUnitVectorToOctahedral(const TVec3& v) -> decltype(v.xy())
+{
+	using TVec2 = decltype(v.xy());
+	using T = typename TVec3::Scalar;
+
+	const T l1Norm = absolute(v.x()) + absolute(v.y()) + absolute(v.z());
+	TVec2 out = v.xy() / l1Norm;
+	if(v.z() < T(0))
+	{
+		// Fold the lower hemisphere
+		const T signX = (out.x() >= T(0)) ? T(1) : T(-1);
+		const T signY = (out.y() >= T(0)) ? T(1) : T(-1);
+		out = TVec2((T(1) - absolute(out.y())) * signX, (T(1) - absolute(out.x())) * signY);
+	}
+
+	return out;
+}
+
+/// The opposite of packUnitVectorToOctahedral. The output is normalized.
+template<typename TVec3, typename TVec2>
+inline TVec3 unpackOctahedralToUnitVector(const TVec2& oct)
+{
+	using T = typename TVec3::Scalar;
+
+	TVec3 out(oct.x(), oct.y(), T(1) - absolute(oct.x()) - absolute(oct.y()));
+	if(out.z() < T(0))
+	{
+		// Unfold the lower hemisphere
+		const T signX = (out.x() >= T(0)) ? T(1) : T(-1);
+		const T signY = (out.y() >= T(0)) ? T(1) : T(-1);
+		const T x = (T(1) - absolute(out.y())) * signX;
+		const T y = (T(1) - absolute(out.x())) * signY;
+		out.x() = x;
+		out.y() = y;
+	}
+
+	return out.getNormalized();
+}
+
 /// Compute the abs triangle area.
 template<typename TVec>
 inline F32 computeTriangleArea(const TVec& a, const TVec& b, const TVec& c)
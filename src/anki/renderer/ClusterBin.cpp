@@ -81,7 +81,7 @@ public:
 
 	U32 m_clusterCountZ = MAX_U32;
 
-	TileCtx(StackAllocator<U8>& alloc)
+	TileCtx(FrameAllocator<U8>& alloc)
 		: m_clusterEdgesWSpace(alloc)
 		, m_clusterBoxes(alloc)
 		, m_clusterSpheres(alloc)
@@ -23,7 +23,7 @@ class ClusterBinIn
 {
 public:
 	ThreadHive* m_threadHive ANKI_DEBUG_CODE(= nullptr);
-	StackAllocator<U8> m_tempAlloc;
+	FrameAllocator<U8> m_tempAlloc;
 
 	const RenderQueue* m_renderQueue ANKI_DEBUG_CODE(= nullptr);
 
@@ -27,6 +27,11 @@ MainRenderer::MainRenderer()
 MainRenderer::~MainRenderer()
 {
 	ANKI_R_LOGI("Destroying main renderer");
+
+	if(m_frameAlloc.isCreated())
+	{
+		m_frameAlloc.getMemoryPool().logHighWaterMarks("Renderer frame memory");
+	}
 }
 
 Error MainRenderer::init(ThreadHive* hive,
@@ -42,7 +47,7 @@ Error MainRenderer::init(ThreadHive* hive,
 	ANKI_R_LOGI("Initializing main renderer");
 
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbUserData);
-	m_frameAlloc = StackAllocator<U8>(allocCb, allocCbUserData, 1024 * 1024 * 10, 1.0f);
+	m_frameAlloc = FrameAllocator<U8>(allocCb, allocCbUserData, 2 * 1024 * 1024);
 
 	// Init renderer and manipulate the width/height
 	m_width = config.getNumberU32("width");
@@ -76,7 +76,7 @@ public:
 
 private:
 	HeapAllocator<U8> m_alloc;
-	StackAllocator<U8> m_frameAlloc;
+	FrameAllocator<U8> m_frameAlloc;
 
 	UniquePtr<Renderer> m_r;
 	Bool m_rDrawToDefaultFb = false;
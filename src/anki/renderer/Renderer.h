@@ -44,7 +44,7 @@ public:
 class RenderingContext
 {
 public:
-	StackAllocator<U8> m_tempAllocator;
+	FrameAllocator<U8> m_tempAllocator;
 	RenderQueue* m_renderQueue ANKI_DEBUG_CODE(= nullptr);
 
 	RenderGraphDescription m_renderGraphDescr;
@@ -64,7 +64,7 @@ public:
 
 	StagingGpuMemoryToken m_lightShadingUniformsToken;
 
-	RenderingContext(const StackAllocator<U8>& alloc)
+	RenderingContext(const FrameAllocator<U8>& alloc)
 		: m_tempAllocator(alloc)
 		, m_renderGraphDescr(alloc)
 	{
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/renderer/Common.h>
+#include <anki/util/FlatHashMap.h>
 
 namespace anki
 {
@@ -52,7 +53,7 @@ private:
 	DynamicArray<Tile> m_allTiles;
 	DynamicArray<U32> m_lodFirstTileIndex;
 
-	HashMap<HashMapKey, U32> m_lightInfoToTileIdx;
+	FlatHashMap<HashMapKey, U32> m_lightInfoToTileIdx;
 
 	U16 m_tileCountX = 0; ///< Tile count for LOD 0
 	U16 m_tileCountY = 0; ///< Tile count for LOD 0
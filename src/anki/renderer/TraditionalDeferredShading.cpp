@@ -55,7 +55,7 @@ Error TraditionalDeferredLightShading::init()
 }
 
 void TraditionalDeferredLightShading::bindVertexIndexBuffers(
-	MeshResourcePtr& mesh, CommandBufferPtr& cmdb, U32& indexCount)
+	MeshResourcePtr& mesh, CommandBufferPtr& cmdb, U32& indexCount, Mat4& dequantizationMat)
 {
 	// Attrib
 	U32 bufferBinding;
@@ -77,6 +77,18 @@ void TraditionalDeferredLightShading::bindVertexIndexBuffers(
 	mesh->getIndexBufferInfo(buff, offset, indexCount, idxType);
 
 	cmdb->bindIndexBuffer(buff, offset, idxType);
+
+	// Dequantization
+	Vec3 scale;
+	Vec3 translation;
+	mesh->getSubMeshPositionsDequantization(0, scale, translation);
+
+	dequantizationMat = Mat4::getIdentity();
+	for(U32 i = 0; i < 3; ++i)
+	{
+		dequantizationMat(i, i) = scale[i];
+		dequantizationMat(i, 3) = translation[i];
+	}
 }
 
 void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShadingDrawInfo& info)
@@ -128,7 +140,8 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 
 	// Do point lights
 	U32 indexCount;
-	bindVertexIndexBuffers(m_plightMesh, cmdb, indexCount);
+	Mat4 dequantizationMat;
+	bindVertexIndexBuffers(m_plightMesh, cmdb, indexCount, dequantizationMat);
 	cmdb->bindShaderProgram(m_plightGrProg[info.m_computeSpecular]);
 
 	for(const PointLightQueueElement& plightEl : info.m_pointLights)
@@ -139,7 +152,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 
 		Mat4 modelM(plightEl.m_worldPosition.xyz1(), Mat3::getIdentity(), plightEl.m_radius);
 
-		vert->m_mvp = info.m_viewProjectionMatrix * modelM;
+		vert->m_mvp = info.m_viewProjectionMatrix * modelM * dequantizationMat;
 
 		DeferredPointLightUniforms* light =
 			allocateAndBindUniforms<DeferredPointLightUniforms*>(sizeof(DeferredPointLightUniforms), cmdb, 0, 1);
@@ -159,7 +172,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 	}
 
 	// Do spot lights
-	bindVertexIndexBuffers(m_slightMesh, cmdb, indexCount);
+	bindVertexIndexBuffers(m_slightMesh, cmdb, indexCount, dequantizationMat);
 	cmdb->bindShaderProgram(m_slightGrProg[info.m_computeSpecular]);
 
 	for(const SpotLightQueueElement& splightEl : info.m_spotLights)
@@ -175,7 +188,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 		scaleM(1, 1) = scaleM(0, 0);
 		scaleM(2, 2) = splightEl.m_distance;
 
-		modelM = modelM * scaleM;
+		modelM = modelM * scaleM * dequantizationMat;
 
 		// Update vertex uniforms
 		DeferredVertexUniforms* vert =
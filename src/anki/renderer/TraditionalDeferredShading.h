@@ -60,7 +60,9 @@ private:
 	MeshResourcePtr m_slightMesh;
 	/// @}
 
-	static void bindVertexIndexBuffers(MeshResourcePtr& mesh, CommandBufferPtr& cmdb, U32& indexCount);
+	/// @param[out] dequantizationMat The positions of the mesh might be quantized. Multiply the model matrix with that.
+	static void bindVertexIndexBuffers(
+		MeshResourcePtr& mesh, CommandBufferPtr& cmdb, U32& indexCount, Mat4& dequantizationMat);
 };
 /// @}
 } // end namespace anki
@@ -4,7 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/AnimationResource.h>
-#include <anki/util/Xml.h>
+#include <anki/resource/ResourceBinary.h>
 
 namespace anki
 {
@@ -24,192 +24,103 @@ AnimationResource::~AnimationResource()
 	m_channels.destroy(getAllocator());
 }
 
-Error AnimationResource::load(const ResourceFilename& filename, Bool async)
+/// Copy the keys of a channel.
+/// @return True if all the keys are identity.
+template<typename TInKey, typename T, typename TFunc>
+static Bool loadKeys(const WeakArray<TInKey>& inKeys, ResourceAllocator<U8> alloc, Second& minTime, Second& maxTime,
+	DynamicArray<AnimationKeyframe<T>>& keys, TFunc convertKey)
 {
-	XmlElement el;
-	Second ftmp;
+	keys.create(alloc, inKeys.getSize());
+
+	Bool allIdentity = true;
+	for(U32 i = 0; i < inKeys.getSize(); ++i)
+	{
+		minTime = std::min(minTime, inKeys[i].m_time);
+		maxTime = std::max(maxTime, inKeys[i].m_time);
+
+		allIdentity = convertKey(inKeys[i], keys[i]) && allIdentity;
+	}
+
+	return allIdentity;
+}
 
+Error AnimationResource::load(const ResourceFilename& filename, Bool async)
+{
 	m_startTime = MAX_SECOND;
 	Second maxTime = MIN_SECOND;
 
-	// Document
-	XmlDocument doc;
-	ANKI_CHECK(openFileParseXml(filename, doc));
-	XmlElement rootel;
-	ANKI_CHECK(doc.getChildElement("animation", rootel));
-
-	// Count the number of identity keys. If all of the keys are identities drop a vector
-	U identPosCount = 0;
-	U identRotCount = 0;
-	U identScaleCount = 0;
+	StackAllocator<U8> binaryAlloc;
+	AnimationBinary* binary;
+	ANKI_CHECK(openFileLoadBinary(filename, binaryAlloc, binary));
 
 	// <channels>
-	XmlElement channelsEl;
-	ANKI_CHECK(rootel.getChildElement("channels", channelsEl));
-	XmlElement chEl;
-	ANKI_CHECK(channelsEl.getChildElement("channel", chEl));
-
-	U32 channelCount = 0;
-	ANKI_CHECK(chEl.getSiblingElementsCount(channelCount));
-	++channelCount;
-	if(channelCount == 0)
+	if(binary->m_channels.getSize() == 0)
 	{
 		ANKI_RESOURCE_LOGE("Didn't found any channels");
 		return Error::USER_DATA;
 	}
-	m_channels.create(getAllocator(), channelCount);
+	m_channels.create(getAllocator(), binary->m_channels.getSize());
 
 	// For all channels
-	channelCount = 0;
-	do
+	for(U32 i = 0; i < binary->m_channels.getSize(); ++i)
 	{
-		AnimationChannel& ch = m_channels[channelCount];
+		const AnimationBinaryChannel& inCh = binary->m_channels[i];
+		AnimationChannel& ch = m_channels[i];
 
 		// <name>
-		ANKI_CHECK(chEl.getChildElement("name", el));
-		CString strtmp;
-		ANKI_CHECK(el.getText(strtmp));
-		ch.m_name.create(getAllocator(), strtmp);
-
-		XmlElement keysEl, keyEl;
-
-		// <positionKeys>
-		ANKI_CHECK(chEl.getChildElementOptional("positionKeys", keysEl));
-		if(keysEl)
-		{
-			ANKI_CHECK(keysEl.getChildElement("key", keyEl));
-
-			U32 count = 0;
-			ANKI_CHECK(keyEl.getSiblingElementsCount(count));
-			++count;
-			ch.m_positions.create(getAllocator(), count);
-
-			count = 0;
-			do
-			{
-				AnimationKeyframe<Vec3>& key = ch.m_positions[count++];
-
-				// <time>
-				ANKI_CHECK(keyEl.getChildElement("time", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_time = ftmp;
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
-
-				// <value>
-				ANKI_CHECK(keyEl.getChildElement("value", el));
-				ANKI_CHECK(el.getNumbers(key.m_value));
-
-				// Check ident
-				if(key.m_value == Vec3(0.0))
-				{
-					++identPosCount;
-				}
-
-				// Move to next
-				ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
-			} while(keyEl);
-		}
-
-		// <rotationKeys>
-		ANKI_CHECK(chEl.getChildElement("rotationKeys", keysEl));
-		if(keysEl)
-		{
-			ANKI_CHECK(keysEl.getChildElement("key", keyEl));
-
-			U32 count = 0;
-			ANKI_CHECK(keyEl.getSiblingElementsCount(count));
-			++count;
-			ch.m_rotations.create(getAllocator(), count);
-
-			count = 0;
-			do
-			{
-				AnimationKeyframe<Quat>& key = ch.m_rotations[count++];
-
-				// <time>
-				ANKI_CHECK(keyEl.getChildElement("time", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_time = ftmp;
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
-
-				// <value>
-				Vec4 tmp2;
-				ANKI_CHECK(keyEl.getChildElement("value", el));
-				ANKI_CHECK(el.getNumbers(tmp2));
-				key.m_value = Quat(tmp2);
-
-				// Check ident
-				if(key.m_value == Quat::getIdentity())
-				{
-					++identRotCount;
-				}
-
-				// Move to next
-				ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
-			} while(keyEl);
-		}
-
-		// <scalingKeys>
-		ANKI_CHECK(chEl.getChildElementOptional("scalingKeys", keysEl));
-		if(keysEl)
-		{
-			ANKI_CHECK(keysEl.getChildElement("key", keyEl));
-
-			U32 count = 0;
-			ANKI_CHECK(keyEl.getSiblingElementsCount(count));
-			++count;
-			ch.m_scales.create(getAllocator(), count);
-
-			count = 0;
-			do
-			{
-				AnimationKeyframe<F32>& key = ch.m_scales[count++];
-
-				// <time>
-				ANKI_CHECK(keyEl.getChildElement("time", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_time = ftmp;
-				m_startTime = std::min(m_startTime, key.m_time);
-				maxTime = std::max(maxTime, key.m_time);
-
-				// <value>
-				ANKI_CHECK(keyEl.getChildElement("value", el));
-				ANKI_CHECK(el.getNumber(ftmp));
-				key.m_value = F32(ftmp);
-
-				// Check ident
-				if(isZero(key.m_value - 1.0))
-				{
-					++identScaleCount;
-				}
-
-				// Move to next
-				ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
-			} while(keyEl);
-		}
-
-		// Remove identity vectors
-		if(identPosCount == ch.m_positions.getSize())
+		ch.m_name.create(getAllocator(), &inCh.m_name[0]);
+
+		// <positionKeys>. If all of the keys of a channel are identities drop the vector
+		const Bool identPos = loadKeys(inCh.m_positionKeys,
+			getAllocator(),
+			m_startTime,
+			maxTime,
+			ch.m_positions,
+			[](const AnimationBinaryPositionKey& in, AnimationKeyframe<Vec3>& out) {
+				out.m_time = in.m_time;
+				out.m_value = Vec3(&in.m_value[0]);
+				return out.m_value == Vec3(0.0f);
+			});
+
+		if(identPos)
 		{
 			ch.m_positions.destroy(getAllocator());
 		}
 
-		if(identRotCount == ch.m_rotations.getSize())
+		// <rotationKeys>
+		const Bool identRot = loadKeys(inCh.m_rotationKeys,
+			getAllocator(),
+			m_startTime,
+			maxTime,
+			ch.m_rotations,
+			[](const AnimationBinaryRotationKey& in, AnimationKeyframe<Quat>& out) {
+				out.m_time = in.m_time;
+				out.m_value = Quat(&in.m_value[0]);
+				return out.m_value == Quat::getIdentity();
+			});
+
+		if(identRot)
 		{
 			ch.m_rotations.destroy(getAllocator());
 		}
 
-		if(identScaleCount == ch.m_scales.getSize())
+		// <scalingKeys>
+		const Bool identScale = loadKeys(inCh.m_scaleKeys,
+			getAllocator(),
+			m_startTime,
+			maxTime,
+			ch.m_scales,
+			[](const AnimationBinaryScaleKey& in, AnimationKeyframe<F32>& out) {
+				out.m_time = in.m_time;
+				out.m_value = in.m_value;
+				return isZero(out.m_value - 1.0f);
+			});
+
+		if(identScale)
 		{
 			ch.m_scales.destroy(getAllocator());
 		}
-
-		// Move to next channel
-		++channelCount;
-		ANKI_CHECK(chEl.getNextSiblingElement("channel", chEl));
-	} while(chEl);
+	}
 
 	m_duration = maxTime - m_startTime;
 
@@ -12,9 +12,6 @@
 namespace anki
 {
 
-// Forward
-class XmlElement;
-
 /// @addtogroup resource
 /// @{
 
@@ -7,3 +7,11 @@ ANKI_CONFIG_OPTION(rsrc_maxTextureSize, 1024u * 1024u, 4u, MAX_U32)
 ANKI_CONFIG_OPTION(rsrc_dumpShaderSources, 0, 0, 1)
 ANKI_CONFIG_OPTION(rsrc_dataPaths, ".", "The engine loads assets only in from these paths. Separate them with :")
 ANKI_CONFIG_OPTION(rsrc_transferScratchMemorySize, 256_MB, 1_MB, 4_GB)
+ANKI_CONFIG_OPTION(rsrc_packDecompressionThreadCount, 4u, 0u, 32u,
+	"Threads that decompress resource pack entries. 0 to decompress on the reading thread")
+ANKI_CONFIG_OPTION(rsrc_prefetchThreadCount, 4u, 1u, 32u, "Threads that read the files of a resource load plan")
+ANKI_CONFIG_OPTION(rsrc_prefetchMemoryBudget, 128_MB, 1_MB, 4_GB,
+	"The memory of the files of a resource load plan that are read but not opened yet")
+ANKI_CONFIG_OPTION(rsrc_useLoadPlans, 1, 0, 1, "Record and replay the files that a level loads")
+ANKI_CONFIG_OPTION(rsrc_compileShadersOnLoad, 1, 0, 1,
+	"Compile the shader programs the first time they load instead of compiling all of them at startup")
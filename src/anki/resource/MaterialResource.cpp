@@ -6,7 +6,7 @@
 #include <anki/resource/MaterialResource.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/TextureResource.h>
-#include <anki/util/Xml.h>
+#include <anki/resource/ResourceBinary.h>
 
 namespace anki
 {
@@ -80,6 +80,40 @@ static ANKI_USE_RESULT Error checkBuiltin(
 	return Error::NONE;
 }
 
+/// Get the value of a scalar variable.
+template<typename T, ANKI_ENABLE(std::is_arithmetic<T>::value)>
+static ANKI_USE_RESULT Error getInputValue(const MaterialBinaryInput& input, T& out)
+{
+	if(input.m_numberCount != 1)
+	{
+		ANKI_RESOURCE_LOGE("Expecting one number for input: %s", &input.m_name[0]);
+		return Error::USER_DATA;
+	}
+
+	out = T(input.m_numbers[0]);
+	return Error::NONE;
+}
+
+/// Get the value of a vector or matrix variable.
+template<typename TArray, ANKI_ENABLE(!std::is_arithmetic<TArray>::value)>
+static ANKI_USE_RESULT Error getInputValue(const MaterialBinaryInput& input, TArray& out)
+{
+	using T = typename std::remove_reference<decltype(out[0])>::type;
+
+	if(input.m_numberCount != out.getSize())
+	{
+		ANKI_RESOURCE_LOGE("Expecting %u numbers for input: %s", U32(out.getSize()), &input.m_name[0]);
+		return Error::USER_DATA;
+	}
+
+	for(U32 i = 0; i < input.m_numberCount; ++i)
+	{
+		out[i] = T(input.m_numbers[i]);
+	}
+
+	return Error::NONE;
+}
+
 MaterialVariable::MaterialVariable()
 {
 	m_mat4 = Mat4::getZero();
@@ -110,6 +144,8 @@ MaterialResource::~MaterialResource()
 						MaterialVariant& variant = m_variantMatrix[p][l][inst][skinned][vel];
 						variant.m_blockInfos.destroy(getAllocator());
 						variant.m_opaqueBindings.destroy(getAllocator());
+						variant.m_prebakedBlock.destroy(getAllocator());
+						variant.m_prebakedRanges.destroy(getAllocator());
 					}
 				}
 			}
@@ -127,74 +163,50 @@ MaterialResource::~MaterialResource()
 
 Error MaterialResource::load(const ResourceFilename& filename, Bool async)
 {
-	XmlDocument doc;
-	XmlElement el;
-	Bool present = false;
-	ANKI_CHECK(openFileParseXml(filename, doc));
-
-	// <material>
-	XmlElement rootEl;
-	ANKI_CHECK(doc.getChildElement("material", rootEl));
+	StackAllocator<U8> binaryAlloc;
+	MaterialBinary* binary;
+	ANKI_CHECK(openFileLoadBinary(filename, binaryAlloc, binary));
 
 	// shaderProgram
-	CString fname;
-	ANKI_CHECK(rootEl.getAttributeText("shaderProgram", fname));
-	ANKI_CHECK(getManager().loadResource(fname, m_prog, async));
+	ANKI_CHECK(getManager().loadResource(&binary->m_shaderProgram[0], m_prog, async));
 
 	// Good time to create the vars
 	ANKI_CHECK(createVars());
 
 	// shadow
-	ANKI_CHECK(rootEl.getAttributeNumberOptional("shadow", m_shadow, present));
-	m_shadow = m_shadow != 0;
+	m_shadow = binary->m_shadow;
 
 	// forwardShading
-	ANKI_CHECK(rootEl.getAttributeNumberOptional("forwardShading", m_forwardShading, present));
-	m_forwardShading = m_forwardShading != 0;
+	m_forwardShading = binary->m_forwardShading;
 
 	// <mutation>
-	XmlElement mutatorsEl;
-	ANKI_CHECK(rootEl.getChildElementOptional("mutation", mutatorsEl));
-	if(mutatorsEl)
+	if(binary->m_mutations.getSize())
 	{
-		ANKI_CHECK(parseMutators(mutatorsEl));
+		ANKI_CHECK(parseMutators(binary->m_mutations));
 	}
 
 	// The rest of the mutators
 	ANKI_CHECK(findBuiltinMutators());
 
 	// <inputs>
-	ANKI_CHECK(rootEl.getChildElementOptional("inputs", el));
-	if(el)
-	{
-		ANKI_CHECK(parseInputs(el, async));
-	}
+	ANKI_CHECK(parseInputs(binary->m_inputs, async));
 
 	return Error::NONE;
 }
 
-Error MaterialResource::parseMutators(XmlElement mutatorsEl)
+Error MaterialResource::parseMutators(ConstWeakArray<MaterialBinaryMutation> mutations)
 {
-	XmlElement mutatorEl;
-	ANKI_CHECK(mutatorsEl.getChildElement("mutator", mutatorEl));
-
 	//
 	// Process the non-builtin mutators
 	//
-	U32 mutatorCount = 0;
-	ANKI_CHECK(mutatorEl.getSiblingElementsCount(mutatorCount));
-	++mutatorCount;
-	ANKI_ASSERT(mutatorCount > 0);
-	m_nonBuiltinsMutation.create(getAllocator(), mutatorCount);
-	mutatorCount = 0;
-
-	do
+	m_nonBuiltinsMutation.create(getAllocator(), mutations.getSize());
+
+	for(U32 i = 0; i < mutations.getSize(); ++i)
 	{
-		SubMutation& smutation = m_nonBuiltinsMutation[mutatorCount];
+		SubMutation& smutation = m_nonBuiltinsMutation[i];
 
 		// name
-		CString mutatorName;
-		ANKI_CHECK(mutatorEl.getAttributeText("name", mutatorName));
+		const CString mutatorName = &mutations[i].m_name[0];
 		if(mutatorName.isEmpty())
 		{
 			ANKI_RESOURCE_LOGE("Mutator name is empty");
@@ -222,7 +234,7 @@ Error MaterialResource::parseMutators(XmlElement mutatorsEl)
 		}
 
 		// value
-		ANKI_CHECK(mutatorEl.getAttributeNumber("value", smutation.m_value));
+		smutation.m_value = mutations[i].m_value;
 
 		// Find mutator
 		smutation.m_mutator = m_prog->tryFindMutator(mutatorName);
@@ -238,13 +250,7 @@ Error MaterialResource::parseMutators(XmlElement mutatorsEl)
 			ANKI_RESOURCE_LOGE("Value %d is not part of the mutator %s", smutation.m_value, &mutatorName[0]);
 			return Error::USER_DATA;
 		}
-
-		// Advance
-		++mutatorCount;
-		ANKI_CHECK(mutatorEl.getNextSiblingElement("mutator", mutatorEl));
-	} while(mutatorEl);
-
-	ANKI_ASSERT(mutatorCount == m_nonBuiltinsMutation.getSize());
+	}
 
 	return Error::NONE;
 }
@@ -624,16 +630,13 @@ Error MaterialResource::createVars()
 	return Error::NONE;
 }
 
-Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
+Error MaterialResource::parseInputs(ConstWeakArray<MaterialBinaryInput> inputs, Bool async)
 {
 	// Connect the input variables
-	XmlElement inputEl;
-	ANKI_CHECK(inputsEl.getChildElementOptional("input", inputEl));
-	while(inputEl)
+	for(const MaterialBinaryInput& input : inputs)
 	{
 		// Get var name
-		CString varName;
-		ANKI_CHECK(inputEl.getAttributeText("shaderVar", varName));
+		const CString varName = &input.m_name[0];
 
 		// Try find var
 		MaterialVariable* foundVar = tryFindVariable(varName);
@@ -650,130 +653,73 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 			return Error::USER_DATA;
 		}
 
+		if(!foundVar->isConstant() && foundVar->isInstanced())
+		{
+			ANKI_RESOURCE_LOGE("Only some builtin variables can be instanced: %s", foundVar->getName().cstr());
+			return Error::USER_DATA;
+		}
+
 		// A value will be set
 		foundVar->m_mat4(3, 3) = 0.0f;
 
 		// Process var
-		if(foundVar->isConstant())
+		switch(foundVar->getDataType())
 		{
-			// Const
-
-			switch(foundVar->getDataType())
-			{
-			case ShaderVariableDataType::INT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_int));
-				break;
-			case ShaderVariableDataType::IVEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec2));
-				break;
-			case ShaderVariableDataType::IVEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec3));
-				break;
-			case ShaderVariableDataType::IVEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec4));
-				break;
-			case ShaderVariableDataType::UINT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_uint));
-				break;
-			case ShaderVariableDataType::UVEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec2));
-				break;
-			case ShaderVariableDataType::UVEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec3));
-				break;
-			case ShaderVariableDataType::UVEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec4));
-				break;
-			case ShaderVariableDataType::FLOAT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_float));
-				break;
-			case ShaderVariableDataType::VEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_vec2));
-				break;
-			case ShaderVariableDataType::VEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_vec3));
-				break;
-			case ShaderVariableDataType::VEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_vec4));
-				break;
-			default:
-				ANKI_ASSERT(0);
-				break;
-			}
-		}
-		else
-		{
-			// Not built-in
-
-			if(foundVar->isInstanced())
-			{
-				ANKI_RESOURCE_LOGE("Only some builtin variables can be instanced: %s", foundVar->getName().cstr());
-				return Error::USER_DATA;
-			}
-
-			switch(foundVar->getDataType())
-			{
-			case ShaderVariableDataType::INT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_int));
-				break;
-			case ShaderVariableDataType::IVEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec2));
-				break;
-			case ShaderVariableDataType::IVEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec3));
-				break;
-			case ShaderVariableDataType::IVEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec4));
-				break;
-			case ShaderVariableDataType::UINT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_uint));
-				break;
-			case ShaderVariableDataType::UVEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec2));
-				break;
-			case ShaderVariableDataType::UVEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec3));
-				break;
-			case ShaderVariableDataType::UVEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec4));
-				break;
-			case ShaderVariableDataType::FLOAT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_float));
-				break;
-			case ShaderVariableDataType::VEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_vec2));
-				break;
-			case ShaderVariableDataType::VEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_vec3));
-				break;
-			case ShaderVariableDataType::VEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_vec4));
-				break;
-			case ShaderVariableDataType::MAT3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_mat3));
-				break;
-			case ShaderVariableDataType::MAT4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_mat4));
-				break;
-			case ShaderVariableDataType::TEXTURE_2D:
-			case ShaderVariableDataType::TEXTURE_2D_ARRAY:
-			case ShaderVariableDataType::TEXTURE_3D:
-			case ShaderVariableDataType::TEXTURE_CUBE:
-			{
-				CString texfname;
-				ANKI_CHECK(inputEl.getAttributeText("value", texfname));
-				ANKI_CHECK(getManager().loadResource(texfname, foundVar->m_tex, async));
-				break;
-			}
-
-			default:
-				ANKI_ASSERT(0);
-				break;
-			}
+		case ShaderVariableDataType::INT:
+			ANKI_CHECK(getInputValue(input, foundVar->m_int));
+			break;
+		case ShaderVariableDataType::IVEC2:
+			ANKI_CHECK(getInputValue(input, foundVar->m_ivec2));
+			break;
+		case ShaderVariableDataType::IVEC3:
+			ANKI_CHECK(getInputValue(input, foundVar->m_ivec3));
+			break;
+		case ShaderVariableDataType::IVEC4:
+			ANKI_CHECK(getInputValue(input, foundVar->m_ivec4));
+			break;
+		case ShaderVariableDataType::UINT:
+			ANKI_CHECK(getInputValue(input, foundVar->m_uint));
+			break;
+		case ShaderVariableDataType::UVEC2:
+			ANKI_CHECK(getInputValue(input, foundVar->m_uvec2));
+			break;
+		case ShaderVariableDataType::UVEC3:
+			ANKI_CHECK(getInputValue(input, foundVar->m_uvec3));
+			break;
+		case ShaderVariableDataType::UVEC4:
+			ANKI_CHECK(getInputValue(input, foundVar->m_uvec4));
+			break;
+		case ShaderVariableDataType::FLOAT:
+			ANKI_CHECK(getInputValue(input, foundVar->m_float));
+			break;
+		case ShaderVariableDataType::VEC2:
+			ANKI_CHECK(getInputValue(input, foundVar->m_vec2));
+			break;
+		case ShaderVariableDataType::VEC3:
+			ANKI_CHECK(getInputValue(input, foundVar->m_vec3));
+			break;
+		case ShaderVariableDataType::VEC4:
+			ANKI_CHECK(getInputValue(input, foundVar->m_vec4));
+			break;
+		case ShaderVariableDataType::MAT3:
+			ANKI_ASSERT(!foundVar->isConstant());
+			ANKI_CHECK(getInputValue(input, foundVar->m_mat3));
+			break;
+		case ShaderVariableDataType::MAT4:
+			ANKI_ASSERT(!foundVar->isConstant());
+			ANKI_CHECK(getInputValue(input, foundVar->m_mat4));
+			break;
+		case ShaderVariableDataType::TEXTURE_2D:
+		case ShaderVariableDataType::TEXTURE_2D_ARRAY:
+		case ShaderVariableDataType::TEXTURE_3D:
+		case ShaderVariableDataType::TEXTURE_CUBE:
+			ANKI_ASSERT(!foundVar->isConstant());
+			ANKI_CHECK(getManager().loadResource(&input.m_text[0], foundVar->m_tex, async));
+			break;
+		default:
+			ANKI_ASSERT(0);
+			break;
 		}
-
-		// Advance
-		ANKI_CHECK(inputEl.getNextSiblingElement("input", inputEl));
 	}
 
 	return Error::NONE;
@@ -806,15 +752,34 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 		}
 	}
 
-	// Not initialized, init it
-	WLockGuard<RWMutex> lock(m_variantMatrixMtx);
+	// The default variant of the key is the one the variant falls back to while it compiles. It has the same pass,
+	// instancing and skinning so it's compatible with the draw
+	RenderingKey defaultKey = key;
+	defaultKey.setLod(0);
+	defaultKey.setVelocity(false);
 
-	// Check again
-	if(variant.m_prog.isCreated())
+	// Not initialized, init it
 	{
-		return variant;
+		WLockGuard<RWMutex> lock(m_variantMatrixMtx);
+
+		// Check again
+		if(variant.m_prog.isCreated())
+		{
+			return variant;
+		}
+
+		if(tryInitVariant(key, key == defaultKey, variant))
+		{
+			return variant;
+		}
 	}
 
+	// It compiles in the background. Use the default until it's done
+	return getOrCreateVariant(defaultKey);
+}
+
+Bool MaterialResource::tryInitVariant(const RenderingKey& key, Bool wait, MaterialVariant& variant) const
+{
 	ShaderProgramResourceVariantInitInfo initInfo(m_prog);
 
 	for(const SubMutation& m : m_nonBuiltinsMutation)
@@ -891,12 +856,19 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 	}
 
 	const ShaderProgramResourceVariant* progVariant;
-	m_prog->getOrCreateVariant(initInfo, progVariant);
+	if(wait)
+	{
+		m_prog->getOrCreateVariant(initInfo, progVariant);
+	}
+	else if(!m_prog->tryGetOrCreateVariant(initInfo, progVariant))
+	{
+		return false;
+	}
 
 	// Init the variant
 	initVariant(*progVariant, variant, key.getInstanceCount());
 
-	return variant;
+	return true;
 }
 
 void MaterialResource::initVariant(
@@ -998,6 +970,8 @@ void MaterialResource::initVariant(
 		ANKI_ASSERT(!(var.m_instanced && var.m_indexInBinary2ndElement == MAX_U32));
 	}
 
+	prebakeBlock(variant);
+
 // Debug print
 #if 0
 	ANKI_RESOURCE_LOGI("binary variant idx %u\n", U32(&binaryVariant - binary.m_variants.getBegin()));
@@ -1016,6 +990,65 @@ void MaterialResource::initVariant(
 #endif
 }
 
+void MaterialResource::prebakeBlock(MaterialVariant& variant) const
+{
+	variant.m_prebakedBlock.create(getAllocator(), variant.m_uniBlockSize, 0);
+	void* const blockBegin = variant.m_prebakedBlock.getBegin();
+	const void* const blockEnd = variant.m_prebakedBlock.getEnd();
+
+	DynamicArrayAuto<ShaderBlockMemoryRange> ranges(getTempAllocator());
+	DynamicArrayAuto<ShaderBlockMemoryRange> builtinRanges(getTempAllocator());
+	for(const MaterialVariable& var : m_vars)
+	{
+		if(!var.inBlock() || !variant.m_activeVars.get(var.m_index))
+		{
+			continue;
+		}
+
+		const ShaderVariableBlockInfo& blockInfo = variant.m_blockInfos[var.m_index];
+		if(var.m_builtin != BuiltinMaterialVariableId::NONE)
+		{
+			// The builtins are written every draw, don't overwrite them
+			getShaderBlockMemoryRanges(var.m_dataType, blockInfo, U32(blockInfo.m_arraySize), builtinRanges);
+			continue;
+		}
+
+		switch(var.m_dataType)
+		{
+		case ShaderVariableDataType::FLOAT:
+			variant.writeShaderBlockMemory(var, &var.getValue<F32>(), 1, blockBegin, blockEnd);
+			break;
+		case ShaderVariableDataType::VEC2:
+			variant.writeShaderBlockMemory(var, &var.getValue<Vec2>(), 1, blockBegin, blockEnd);
+			break;
+		case ShaderVariableDataType::VEC3:
+			variant.writeShaderBlockMemory(var, &var.getValue<Vec3>(), 1, blockBegin, blockEnd);
+			break;
+		case ShaderVariableDataType::VEC4:
+			variant.writeShaderBlockMemory(var, &var.getValue<Vec4>(), 1, blockBegin, blockEnd);
+			break;
+		case ShaderVariableDataType::MAT3:
+			variant.writeShaderBlockMemory(var, &var.getValue<Mat3>(), 1, blockBegin, blockEnd);
+			break;
+		case ShaderVariableDataType::MAT4:
+			variant.writeShaderBlockMemory(var, &var.getValue<Mat4>(), 1, blockBegin, blockEnd);
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+
+		getShaderBlockMemoryRanges(var.m_dataType, blockInfo, 1, ranges);
+	}
+
+	// Merge the ranges so the copy is a few big memcpys
+	mergeShaderBlockMemoryRanges(ranges, builtinRanges);
+	if(ranges.getSize())
+	{
+		variant.m_prebakedRanges.create(getAllocator(), ranges.getSize());
+		memcpy(variant.m_prebakedRanges.getBegin(), ranges.getBegin(), ranges.getSizeInBytes());
+	}
+}
+
 U32 MaterialResource::getInstanceGroupIdx(U32 instanceCount)
 {
 	ANKI_ASSERT(instanceCount > 0);
@@ -16,7 +16,8 @@ namespace anki
 {
 
 // Forward
-class XmlElement;
+class MaterialBinaryMutation;
+class MaterialBinaryInput;
 
 /// @addtogroup resource
 /// @{
@@ -262,12 +263,21 @@ public:
 		anki::writeShaderBlockMemory(var.getDataType(), blockInfo, elements, elementsCount, buffBegin, buffEnd);
 	}
 
+	/// Write the values of all the active variables that are in the block and are not builtins. Their values are
+	/// known when the variant is created so they are copied from a prebaked block with a few memcpys.
+	void writePrebakedShaderBlockMemory(void* buffBegin, const void* buffEnd) const
+	{
+		copyShaderBlockMemoryRanges(m_prebakedRanges, m_prebakedBlock.getBegin(), buffBegin, buffEnd);
+	}
+
 private:
 	ShaderProgramPtr m_prog;
 	DynamicArray<ShaderVariableBlockInfo> m_blockInfos;
 	DynamicArray<I16> m_opaqueBindings;
 	BitSet<128, U32> m_activeVars = {false};
 	U32 m_uniBlockSize = 0;
+	DynamicArray<U8> m_prebakedBlock; ///< A block with the values of the non-builtin variables.
+	DynamicArray<ShaderBlockMemoryRange> m_prebakedRanges; ///< The parts of m_prebakedBlock to copy.
 };
 
 /// Material resource.
@@ -289,6 +299,8 @@ private:
 /// </material>
 /// @endcode
 /// (1): Only for non-builtins.
+///
+/// If a MaterialBinary (.ankimtlbin) that is up to date exists next to the XML it will be loaded instead.
 class MaterialResource : public ResourceObject
 {
 public:
@@ -346,6 +358,9 @@ public:
 		return m_uboBinding;
 	}
 
+	/// Get the variant of a key. The first time a key is asked its shader program variant starts compiling in the
+	/// background. Until it's ready it returns the variant with the same key but LOD 0 and no velocity, that compiles
+	/// in the calling thread.
 	const MaterialVariant& getOrCreateVariant(const RenderingKey& key) const;
 
 private:
@@ -380,10 +395,10 @@ private:
 
 	static ANKI_USE_RESULT Error parseVariable(CString fullVarName, Bool& instanced, U32& idx, CString& name);
 
-	/// Parse whatever is inside the <inputs> tag.
-	ANKI_USE_RESULT Error parseInputs(XmlElement inputsEl, Bool async);
+	/// Process whatever was inside the <inputs> tag.
+	ANKI_USE_RESULT Error parseInputs(ConstWeakArray<MaterialBinaryInput> inputs, Bool async);
 
-	ANKI_USE_RESULT Error parseMutators(XmlElement mutatorsEl);
+	ANKI_USE_RESULT Error parseMutators(ConstWeakArray<MaterialBinaryMutation> mutations);
 	ANKI_USE_RESULT Error findBuiltinMutators();
 
 	static U32 getInstanceGroupIdx(U32 instanceCount);
@@ -391,6 +406,14 @@ private:
 	void initVariant(
 		const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant, U32 instanceCount) const;
 
+	/// Init a variant if its shader program variant is ready.
+	/// @param wait If true it waits for the shader program variant to compile.
+	/// @return True if the variant got initialized.
+	Bool tryInitVariant(const RenderingKey& key, Bool wait, MaterialVariant& variant) const;
+
+	/// Write the values of the non-builtin variables to the prebaked block of the variant.
+	void prebakeBlock(MaterialVariant& variant) const;
+
 	const MaterialVariable* tryFindVariableInternal(CString name) const
 	{
 		for(const MaterialVariable& v : m_vars)
@@ -20,50 +20,68 @@ MeshLoader::~MeshLoader()
 	m_subMeshes.destroy(m_alloc);
 }
 
-Error MeshLoader::load(const ResourceFilename& filename)
+static U32 getVertexAttributeFormatSize(Format fmt)
 {
-	auto& alloc = m_alloc;
+	switch(fmt)
+	{
+	case Format::R32G32B32_SFLOAT:
+		return 3 * sizeof(F32);
+	case Format::R16G16B16A16_SFLOAT:
+	case Format::R16G16B16A16_UNORM:
+	case Format::R16G16B16A16_UINT:
+		return 4 * sizeof(U16);
+	case Format::A2B10G10R10_SNORM_PACK32:
+	case Format::R16G16_UNORM:
+	case Format::R16G16_SNORM:
+	case Format::R16G16_SFLOAT:
+	case Format::R8G8B8A8_UNORM:
+	case Format::R8G8B8A8_SNORM:
+		return sizeof(U32);
+	default:
+		ANKI_ASSERT(0);
+		return 0;
+	}
+}
 
+/// Unpack the A2B10G10R10_SNORM_PACK32 format.
+static Vec4 unpackR10G10B10A2SNorm(U32 packed)
+{
+	// Sign extend the components with arithmetic shifts
+	const I32 x = I32(packed << 22u) >> 22;
+	const I32 y = I32(packed << 12u) >> 22;
+	const I32 z = I32(packed << 2u) >> 22;
+	const I32 w = I32(packed) >> 30;
+
+	return Vec4(max(F32(x) / 511.0f, -1.0f),
+		max(F32(y) / 511.0f, -1.0f),
+		max(F32(z) / 511.0f, -1.0f),
+		max(F32(w), -1.0f));
+}
+
+Error MeshLoader::load(const ResourceFilename& filename)
+{
 	// Load header
 	ANKI_CHECK(m_manager->getFilesystem().openFile(filename, m_file));
 	ANKI_CHECK(m_file->read(&m_header, sizeof(m_header)));
-	ANKI_CHECK(checkHeader());
 
-	// Read submesh info
+	if(memcmp(&m_header.m_magic[0], MeshBinaryFile::MAGIC, 8) == 0)
 	{
-		m_subMeshes.create(alloc, m_header.m_subMeshCount);
-		ANKI_CHECK(m_file->read(&m_subMeshes[0], m_subMeshes.getSizeInBytes()));
-
-		// Checks
-		const U32 indicesPerFace = !!(m_header.m_flags & MeshBinaryFile::Flag::QUAD) ? 4 : 3;
-		U idxSum = 0;
-		for(U i = 0; i < m_subMeshes.getSize(); i++)
-		{
-			const MeshBinaryFile::SubMesh& sm = m_subMeshes[0];
-			if(sm.m_firstIndex != idxSum || (sm.m_indexCount % indicesPerFace) != 0)
-			{
-				ANKI_RESOURCE_LOGE("Incorrect sub mesh info");
-				return Error::USER_DATA;
-			}
-
-			for(U d = 0; d < 3; ++d)
-			{
-				if(sm.m_aabbMin[i] >= sm.m_aabbMax[i])
-				{
-					ANKI_RESOURCE_LOGE("Wrong bounding box");
-					return Error::USER_DATA;
-				}
-			}
+		m_quantizedAttributes = true;
+	}
+	else if(memcmp(&m_header.m_magic[0], MeshBinaryFile::MAGIC_V4, 8) == 0)
+	{
+		m_quantizedAttributes = false;
+	}
+	else
+	{
+		ANKI_RESOURCE_LOGE("Wrong magic word");
+		return Error::USER_DATA;
+	}
 
-			idxSum += sm.m_indexCount;
-		}
+	ANKI_CHECK(checkHeader());
 
-		if(idxSum != m_header.m_totalIndexCount)
-		{
-			ANKI_RESOURCE_LOGE("Incorrect sub mesh info");
-			return Error::USER_DATA;
-		}
-	}
+	// Read submesh info
+	ANKI_CHECK(loadSubMeshes());
 
 	// Read vert buffer info
 	{
@@ -91,14 +109,26 @@ Error MeshLoader::load(const ResourceFilename& filename)
 			ANKI_RESOURCE_LOGE("Wrong vertex buffer count in the header");
 			return Error::USER_DATA;
 		}
+
+		for(const MeshBinaryFile::VertexAttribute& attrib : m_header.m_vertexAttributes)
+		{
+			if(attrib.m_format != Format::NONE
+				&& attrib.m_relativeOffset + getVertexAttributeFormatSize(attrib.m_format)
+					   > m_header.m_vertexBuffers[attrib.m_bufferBinding].m_vertexStride)
+			{
+				ANKI_RESOURCE_LOGE("Vertex attribute doesn't fit in its vertex buffer");
+				return Error::USER_DATA;
+			}
+		}
 	}
 
 	// Count and check the file size
 	{
-		U32 totalSize = sizeof(m_header);
+		PtrSize totalSize = sizeof(m_header);
 
-		totalSize += sizeof(MeshBinaryFile::SubMesh) * m_header.m_subMeshCount;
-		totalSize += U32(getIndexBufferSize());
+		totalSize += ((m_quantizedAttributes) ? sizeof(MeshBinaryFile::SubMesh) : sizeof(MeshBinaryFile::SubMeshV4))
+					 * m_header.m_subMeshCount;
+		totalSize += getIndexBufferSize();
 
 		for(U i = 0; i < m_header.m_vertexBufferCount; ++i)
 		{
@@ -112,9 +142,123 @@ Error MeshLoader::load(const ResourceFilename& filename)
 		}
 	}
 
+	// The shaders only decode the v5 normals and tangents
+	if(!m_quantizedAttributes)
+	{
+		m_header.m_vertexAttributes[VertexAttributeLocation::NORMAL].m_format = Format::R16G16_SNORM;
+		m_header.m_vertexAttributes[VertexAttributeLocation::TANGENT].m_format = Format::R8G8B8A8_SNORM;
+	}
+
 	return Error::NONE;
 }
 
+Error MeshLoader::loadSubMeshes()
+{
+	const MeshBinaryFile::Header& h = m_header;
+	m_subMeshes.create(m_alloc, h.m_subMeshCount);
+
+	if(m_quantizedAttributes)
+	{
+		ANKI_CHECK(m_file->read(&m_subMeshes[0], m_subMeshes.getSizeInBytes()));
+	}
+	else
+	{
+		for(MeshBinaryFile::SubMesh& out : m_subMeshes)
+		{
+			MeshBinaryFile::SubMeshV4 in;
+			ANKI_CHECK(m_file->read(&in, sizeof(in)));
+
+			out.m_firstIndex = in.m_firstIndex;
+			out.m_indexCount = in.m_indexCount;
+			out.m_firstVertex = 0;
+			out.m_vertexCount = h.m_totalVertexCount;
+			out.m_aabbMin = in.m_aabbMin;
+			out.m_aabbMax = in.m_aabbMax;
+		}
+	}
+
+	// Checks
+	const U32 indicesPerFace = !!(h.m_flags & MeshBinaryFile::Flag::QUAD) ? 4 : 3;
+	U32 idxSum = 0;
+	U32 vertSum = 0;
+	for(const MeshBinaryFile::SubMesh& sm : m_subMeshes)
+	{
+		if(sm.m_firstIndex != idxSum || (sm.m_indexCount % indicesPerFace) != 0)
+		{
+			ANKI_RESOURCE_LOGE("Incorrect sub mesh info");
+			return Error::USER_DATA;
+		}
+
+		if(m_quantizedAttributes && (sm.m_firstVertex != vertSum || sm.m_vertexCount == 0))
+		{
+			ANKI_RESOURCE_LOGE("Incorrect sub mesh info");
+			return Error::USER_DATA;
+		}
+
+		for(U d = 0; d < 3; ++d)
+		{
+			if(sm.m_aabbMin[d] >= sm.m_aabbMax[d])
+			{
+				ANKI_RESOURCE_LOGE("Wrong bounding box");
+				return Error::USER_DATA;
+			}
+		}
+
+		idxSum += sm.m_indexCount;
+		vertSum += sm.m_vertexCount;
+	}
+
+	if(idxSum != h.m_totalIndexCount || (m_quantizedAttributes && vertSum != h.m_totalVertexCount))
+	{
+		ANKI_RESOURCE_LOGE("Incorrect sub mesh info");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+void MeshLoader::encodeV4VertexBuffer(U32 bufferIdx, U8* data) const
+{
+	ANKI_ASSERT(!m_quantizedAttributes);
+	const U32 stride = m_header.m_vertexBuffers[bufferIdx].m_vertexStride;
+	const MeshBinaryFile::VertexAttribute& normalAttrib = m_header.m_vertexAttributes[VertexAttributeLocation::NORMAL];
+	const MeshBinaryFile::VertexAttribute& tangentAttrib =
+		m_header.m_vertexAttributes[VertexAttributeLocation::TANGENT];
+
+	for(U32 v = 0; v < m_header.m_totalVertexCount; ++v)
+	{
+		U8* vert = data + PtrSize(v) * stride;
+
+		if(normalAttrib.m_bufferBinding == bufferIdx)
+		{
+			U32 packed;
+			memcpy(&packed, vert + normalAttrib.m_relativeOffset, sizeof(packed));
+			const Vec3 normal = unpackR10G10B10A2SNorm(packed).xyz();
+
+			const Vec2 oct = packUnitVectorToOctahedral(
+				(normal.getLengthSquared() > EPSILON) ? normal.getNormalized() : Vec3(0.0f, 0.0f, 1.0f));
+			const Array<I16, 2> encoded = {{I16(round(oct.x() * F32(MAX_I16))), I16(round(oct.y() * F32(MAX_I16)))}};
+			memcpy(vert + normalAttrib.m_relativeOffset, &encoded[0], sizeof(encoded));
+		}
+
+		if(tangentAttrib.m_bufferBinding == bufferIdx)
+		{
+			U32 packed;
+			memcpy(&packed, vert + tangentAttrib.m_relativeOffset, sizeof(packed));
+			const Vec4 tangent = unpackR10G10B10A2SNorm(packed);
+			const Vec3 tangent3 = tangent.xyz();
+
+			const Vec2 oct = packUnitVectorToOctahedral(
+				(tangent3.getLengthSquared() > EPSILON) ? tangent3.getNormalized() : Vec3(1.0f, 0.0f, 0.0f));
+			const Array<I8, 4> encoded = {{I8(round(oct.x() * F32(MAX_I8))),
+				I8(round(oct.y() * F32(MAX_I8))),
+				(tangent.w() >= 0.0f) ? MAX_I8 : I8(-MAX_I8),
+				0}};
+			memcpy(vert + tangentAttrib.m_relativeOffset, &encoded[0], sizeof(encoded));
+		}
+	}
+}
+
 Error MeshLoader::checkFormat(VertexAttributeLocation type, ConstWeakArray<Format> supportedFormats) const
 {
 	const MeshBinaryFile::VertexAttribute& attrib = m_header.m_vertexAttributes[type];
@@ -158,13 +302,6 @@ Error MeshLoader::checkHeader() const
 {
 	const MeshBinaryFile::Header& h = m_header;
 
-	// Header
-	if(memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC, 8) != 0)
-	{
-		ANKI_RESOURCE_LOGE("Wrong magic word");
-		return Error::USER_DATA;
-	}
-
 	// Flags
 	if((h.m_flags & ~MeshBinaryFile::Flag::ALL) != MeshBinaryFile::Flag::NONE)
 	{
@@ -173,10 +310,21 @@ Error MeshLoader::checkHeader() const
 	}
 
 	// Attributes
-	ANKI_CHECK(checkFormat(
-		VertexAttributeLocation::POSITION, Array<Format, 2>{{Format::R16G16B16A16_SFLOAT, Format::R32G32B32_SFLOAT}}));
-	ANKI_CHECK(checkFormat(VertexAttributeLocation::NORMAL, Array<Format, 1>{{Format::A2B10G10R10_SNORM_PACK32}}));
-	ANKI_CHECK(checkFormat(VertexAttributeLocation::TANGENT, Array<Format, 1>{{Format::A2B10G10R10_SNORM_PACK32}}));
+	if(m_quantizedAttributes)
+	{
+		ANKI_CHECK(checkFormat(VertexAttributeLocation::POSITION, Array<Format, 1>{{Format::R16G16B16A16_UNORM}}));
+		ANKI_CHECK(checkFormat(VertexAttributeLocation::NORMAL, Array<Format, 1>{{Format::R16G16_SNORM}}));
+		ANKI_CHECK(checkFormat(VertexAttributeLocation::TANGENT, Array<Format, 1>{{Format::R8G8B8A8_SNORM}}));
+	}
+	else
+	{
+		ANKI_CHECK(checkFormat(VertexAttributeLocation::POSITION,
+			Array<Format, 2>{{Format::R16G16B16A16_SFLOAT, Format::R32G32B32_SFLOAT}}));
+		ANKI_CHECK(
+			checkFormat(VertexAttributeLocation::NORMAL, Array<Format, 1>{{Format::A2B10G10R10_SNORM_PACK32}}));
+		ANKI_CHECK(
+			checkFormat(VertexAttributeLocation::TANGENT, Array<Format, 1>{{Format::A2B10G10R10_SNORM_PACK32}}));
+	}
 	ANKI_CHECK(
 		checkFormat(VertexAttributeLocation::UV, Array<Format, 2>{{Format::R16G16_UNORM, Format::R16G16_SFLOAT}}));
 	ANKI_CHECK(checkFormat(
@@ -252,13 +400,28 @@ Error MeshLoader::storeVertexBuffer(U32 bufferIdx, void* ptr, PtrSize size)
 	ANKI_ASSERT(size == m_header.m_vertexBuffers[bufferIdx].m_vertexStride * m_header.m_totalVertexCount);
 	ANKI_ASSERT(m_loadedChunk == bufferIdx + 1);
 
-	if(ptr)
+	const Bool reencode =
+		!m_quantizedAttributes
+		&& (m_header.m_vertexAttributes[VertexAttributeLocation::NORMAL].m_bufferBinding == bufferIdx
+			   || m_header.m_vertexAttributes[VertexAttributeLocation::TANGENT].m_bufferBinding == bufferIdx);
+
+	if(!ptr)
+	{
+		ANKI_CHECK(m_file->seek(size, FileSeekOrigin::CURRENT));
+	}
+	else if(!reencode)
 	{
 		ANKI_CHECK(m_file->read(ptr, size));
 	}
 	else
 	{
-		ANKI_CHECK(m_file->seek(size, FileSeekOrigin::CURRENT));
+		// Re-encode in a staging copy because the ptr might point to GPU memory that is slow to read
+		DynamicArrayAuto<U8, PtrSize> staging(m_alloc);
+		staging.create(size);
+		ANKI_CHECK(m_file->read(&staging[0], size));
+
+		encodeV4VertexBuffer(bufferIdx, &staging[0]);
+		memcpy(ptr, &staging[0], size);
 	}
 
 	++m_loadedChunk;
@@ -309,27 +472,49 @@ Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, Dynami
 		ANKI_CHECK(storeVertexBuffer(attrib.m_bufferBinding, &staging[0], staging.getSizeInBytes()));
 
 		// Copy
-		for(U32 i = 0; i < m_header.m_totalVertexCount; ++i)
+		for(U32 subMeshIdx = 0; subMeshIdx < m_subMeshes.getSize(); ++subMeshIdx)
 		{
-			Vec3 vert(0.0f);
-			if(attrib.m_format == Format::R32G32B32_SFLOAT)
-			{
-				vert = *reinterpret_cast<Vec3*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
-			}
-			else if(attrib.m_format == Format::R16G16B16A16_SFLOAT)
+			const MeshBinaryFile::SubMesh& sm = m_subMeshes[subMeshIdx];
+			Vec3 scale;
+			Vec3 translation;
+			getSubMeshPositionsDequantization(subMeshIdx, scale, translation);
+
+			for(U32 i = sm.m_firstVertex; i < sm.m_firstVertex + sm.m_vertexCount; ++i)
 			{
-				F16* f16 = reinterpret_cast<F16*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+				Vec3 vert(0.0f);
+				if(attrib.m_format == Format::R32G32B32_SFLOAT)
+				{
+					vert = *reinterpret_cast<Vec3*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+				}
+				else if(attrib.m_format == Format::R16G16B16A16_SFLOAT)
+				{
+					F16* f16 =
+						reinterpret_cast<F16*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+
+					vert[0] = f16[0].toF32();
+					vert[1] = f16[1].toF32();
+					vert[2] = f16[2].toF32();
+				}
+				else if(attrib.m_format == Format::R16G16B16A16_UNORM)
+				{
+					U16* u16 =
+						reinterpret_cast<U16*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+
+					vert = Vec3(F32(u16[0]), F32(u16[1]), F32(u16[2])) / F32(MAX_U16);
+				}
+				else
+				{
+					ANKI_ASSERT(0);
+				}
 
-				vert[0] = f16[0].toF32();
-				vert[1] = f16[1].toF32();
-				vert[2] = f16[2].toF32();
+				positions[i] = vert * scale + translation;
 			}
-			else
+
+			if(!m_quantizedAttributes)
 			{
-				ANKI_ASSERT(0);
+				// All the sub-meshes of v4 files share the vertices
+				break;
 			}
-
-			positions[i] = vert;
 		}
 	}
 
@@ -17,11 +17,22 @@ namespace anki
 /// @addtogroup resource
 /// @{
 
-/// Information to decode mesh binary files.
+/// Information to decode mesh binary files. The layout of the file is:
+/// - MeshBinaryFile::Header
+/// - An array of MeshBinaryFile::SubMesh (MeshBinaryFile::SubMeshV4 for v4 files)
+/// - The index buffer
+/// - The vertex buffers
+///
+/// v5 files store the attributes in a compact form. The positions are quantized to 16bit relative to the bounding box
+/// of their sub-mesh, the normals are octahedral encoded and the tangents are octahedral encoded with 8bit components
+/// (the 3rd component holds the handedness). The vertex shaders decode them.
 class MeshBinaryFile
 {
 public:
-	static constexpr const char* MAGIC = "ANKIMES4";
+	static constexpr const char* MAGIC = "ANKIMES5";
+
+	/// The magic of the previous version of the format. Still supported by the MeshLoader.
+	static constexpr const char* MAGIC_V4 = "ANKIMES4";
 
 	enum class Flag : U32
 	{
@@ -46,7 +57,8 @@ public:
 		F32 m_scale;
 	};
 
-	struct SubMesh
+	/// The sub-mesh of v4 files.
+	struct SubMeshV4
 	{
 		U32 m_firstIndex;
 		U32 m_indexCount;
@@ -54,6 +66,16 @@ public:
 		Vec3 m_aabbMax; ///< Bounding box max.
 	};
 
+	struct SubMesh
+	{
+		U32 m_firstIndex;
+		U32 m_indexCount;
+		U32 m_firstVertex; ///< The vertices of a sub-mesh are contiguous. In v4 files it's always zero.
+		U32 m_vertexCount; ///< In v4 files it's the total vertex count.
+		Vec3 m_aabbMin; ///< Bounding box min. The quantized positions are relative to that.
+		Vec3 m_aabbMax; ///< Bounding box max.
+	};
+
 	struct Header
 	{
 		char m_magic[8]; ///< Magic word.
@@ -116,16 +138,30 @@ public:
 		return ConstWeakArray<MeshBinaryFile::SubMesh>(m_subMeshes);
 	}
 
+	/// Get the transform that the vertex shaders apply to the positions of a sub-mesh to bring them to the model space.
+	/// position = in_position * scale + translation.
+	void getSubMeshPositionsDequantization(U32 subMeshIdx, Vec3& scale, Vec3& translation) const
+	{
+		ANKI_ASSERT(isLoaded());
+		const MeshBinaryFile::SubMesh& sm = m_subMeshes[subMeshIdx];
+		scale = (m_quantizedAttributes) ? sm.m_aabbMax - sm.m_aabbMin : Vec3(1.0f);
+		translation = (m_quantizedAttributes) ? sm.m_aabbMin : Vec3(0.0f);
+	}
+
 private:
 	ResourceManager* m_manager;
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
 	ResourceFilePtr m_file;
 
+	/// The header that describes the buffers returned by the store methods. For v4 files the normals and tangents have
+	/// the formats of v5.
 	MeshBinaryFile::Header m_header;
 
 	DynamicArray<MeshBinaryFile::SubMesh> m_subMeshes;
 
+	Bool m_quantizedAttributes = false; ///< It's a v5 file.
+
 	U32 m_loadedChunk = 0; ///< Because the store methods need to be called in sequence.
 
 	Bool isLoaded() const
@@ -138,8 +174,13 @@ private:
 		return m_header.m_totalIndexCount * ((m_header.m_indexType == IndexType::U16) ? 2 : 4);
 	}
 
+	ANKI_USE_RESULT Error loadSubMeshes();
+
 	ANKI_USE_RESULT Error checkHeader() const;
 	ANKI_USE_RESULT Error checkFormat(VertexAttributeLocation type, ConstWeakArray<Format> supportedFormats) const;
+
+	/// Re-encode the normals and tangents of a v4 vertex buffer to the formats of v5. They have the same size.
+	void encodeV4VertexBuffer(U32 bufferIdx, U8* data) const;
 };
 /// @}
 
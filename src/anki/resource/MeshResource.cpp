@@ -92,6 +92,9 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		const Vec3 obbCenter = (loader.getSubMeshes()[i].m_aabbMax + loader.getSubMeshes()[i].m_aabbMin) / 2.0f;
 		const Vec3 obbExtend = loader.getSubMeshes()[i].m_aabbMax - obbCenter;
 		m_subMeshes[i].m_obb = Obb(obbCenter.xyz0(), Mat3x4::getIdentity(), obbExtend.xyz0());
+
+		loader.getSubMeshPositionsDequantization(
+			i, m_subMeshes[i].m_positionsScale, m_subMeshes[i].m_positionsTranslation);
 	}
 
 	// Index stuff
@@ -54,6 +54,15 @@ public:
 		return m_subMeshes.getSize();
 	}
 
+	/// Get the transform the vertex shaders need to apply to the positions of a sub-mesh. The positions might be
+	/// quantized relative to the bounding box of the sub-mesh. position = in_position * scale + translation.
+	void getSubMeshPositionsDequantization(U32 subMeshId, Vec3& scale, Vec3& translation) const
+	{
+		const SubMesh& sm = m_subMeshes[subMeshId];
+		scale = sm.m_positionsScale;
+		translation = sm.m_positionsTranslation;
+	}
+
 	/// Get all info around vertex indices.
 	void getIndexBufferInfo(BufferPtr& buff, PtrSize& buffOffset, U32& indexCount, IndexType& indexType) const
 	{
@@ -117,6 +126,8 @@ protected:
 		U32 m_firstIndex;
 		U32 m_indexCount;
 		Obb m_obb;
+		Vec3 m_positionsScale;
+		Vec3 m_positionsTranslation;
 	};
 	DynamicArray<SubMesh> m_subMeshes;
 
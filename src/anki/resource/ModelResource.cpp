@@ -7,7 +7,7 @@
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/MeshResource.h>
 #include <anki/resource/MeshLoader.h>
-#include <anki/util/Xml.h>
+#include <anki/resource/ResourceBinary.h>
 #include <anki/util/Logger.h>
 
 namespace anki
@@ -101,6 +101,7 @@ void ModelPatch::getRenderingDataSub(
 	inf.m_drawcallCount = 1;
 	inf.m_indicesOffsetArray[0] = 0;
 	inf.m_indicesCountArray[0] = indexCount;
+	mesh.getSubMeshPositionsDequantization(0, inf.m_positionsScale, inf.m_positionsTranslation);
 }
 
 U32 ModelPatch::getLodCount() const
@@ -156,90 +157,34 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 
 	// Load
 	//
-	XmlElement el;
-	XmlDocument doc;
-	ANKI_CHECK(openFileParseXml(filename, doc));
-
-	XmlElement rootEl;
-	ANKI_CHECK(doc.getChildElement("model", rootEl));
+	StackAllocator<U8> binaryAlloc;
+	ModelBinary* binary;
+	ANKI_CHECK(openFileLoadBinary(filename, binaryAlloc, binary));
 
 	// <modelPatches>
-	XmlElement modelPatchesEl;
-	ANKI_CHECK(rootEl.getChildElement("modelPatches", modelPatchesEl));
-
-	XmlElement modelPatchEl;
-	ANKI_CHECK(modelPatchesEl.getChildElement("modelPatch", modelPatchEl));
-
-	// Count
-	U32 count = 0;
-	do
-	{
-		++count;
-		// Move to next
-		ANKI_CHECK(modelPatchEl.getNextSiblingElement("modelPatch", modelPatchEl));
-	} while(modelPatchEl);
-
-	// Check number of model patches
-	if(count < 1)
-	{
-		ANKI_RESOURCE_LOGE("Zero number of model patches");
-		return Error::USER_DATA;
-	}
-
-	m_modelPatches.create(alloc, count);
+	m_modelPatches.create(alloc, binary->m_patches.getSize());
 
-	count = 0;
-	ANKI_CHECK(modelPatchesEl.getChildElement("modelPatch", modelPatchEl));
-	do
+	for(U32 i = 0; i < binary->m_patches.getSize(); ++i)
 	{
-		XmlElement materialEl;
-		ANKI_CHECK(modelPatchEl.getChildElement("material", materialEl));
-
-		Array<CString, 3> meshesFnames;
-		U32 meshesCount = 1;
-
-		// Get mesh
-		XmlElement meshEl;
-		ANKI_CHECK(modelPatchEl.getChildElement("mesh", meshEl));
+		const ModelBinaryPatch& patch = binary->m_patches[i];
 
-		XmlElement meshEl1;
-		ANKI_CHECK(modelPatchEl.getChildElementOptional("mesh1", meshEl1));
-
-		XmlElement meshEl2;
-		ANKI_CHECK(modelPatchEl.getChildElementOptional("mesh2", meshEl2));
-
-		ANKI_CHECK(meshEl.getText(meshesFnames[0]));
-
-		if(meshEl1)
+		Array<CString, MAX_LOD_COUNT> meshesFnames;
+		for(U32 lod = 0; lod < patch.m_meshCount; ++lod)
 		{
-			++meshesCount;
-			ANKI_CHECK(meshEl1.getText(meshesFnames[1]));
+			meshesFnames[lod] = &patch.m_meshes[lod][0];
 		}
 
-		if(meshEl2)
-		{
-			++meshesCount;
-			ANKI_CHECK(meshEl2.getText(meshesFnames[2]));
-		}
-
-		CString cstr;
-		ANKI_CHECK(materialEl.getText(cstr));
-
-		ANKI_CHECK(m_modelPatches[count].init(
-			this, ConstWeakArray<CString>(&meshesFnames[0], meshesCount), cstr, async, &getManager()));
-
-		// Move to next
-		ANKI_CHECK(modelPatchEl.getNextSiblingElement("modelPatch", modelPatchEl));
-	} while(modelPatchEl);
+		ANKI_CHECK(m_modelPatches[i].init(this,
+			ConstWeakArray<CString>(&meshesFnames[0], patch.m_meshCount),
+			&patch.m_material[0],
+			async,
+			&getManager()));
+	}
 
 	// <skeleton>
-	XmlElement skeletonEl;
-	ANKI_CHECK(rootEl.getChildElementOptional("skeleton", skeletonEl));
-	if(skeletonEl)
+	if(binary->m_skeleton.getSize())
 	{
-		CString fname;
-		ANKI_CHECK(skeletonEl.getText(fname));
-		ANKI_CHECK(getManager().loadResource(fname, m_skeleton));
+		ANKI_CHECK(getManager().loadResource(&binary->m_skeleton[0], m_skeleton));
 	}
 
 	// Calculate compound bounding volume
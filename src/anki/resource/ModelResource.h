@@ -79,6 +79,10 @@ public:
 	PtrSize m_indexBufferOffset;
 	IndexType m_indexType;
 
+	/// The vertex shaders transform the positions with that. See MeshResource::getSubMeshPositionsDequantization.
+	Vec3 m_positionsScale;
+	Vec3 m_positionsTranslation;
+
 	U32 m_boneTransformsBinding;
 };
 
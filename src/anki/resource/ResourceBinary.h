@@ -0,0 +1,385 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/shader_compiler/Common.h>
+#include <anki/util/Serializer.h>
+
+namespace anki
+{
+
+/// A mutator value that a material sets.
+class MaterialBinaryMutation
+{
+public:
+	WeakArray<char> m_name; ///< Null terminated.
+	MutatorValue m_value = 0;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(MaterialBinaryMutation, m_name), self.m_name);
+		s.doValue("m_value", offsetof(MaterialBinaryMutation, m_value), self.m_value);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialBinaryMutation&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialBinaryMutation&>(serializer, *this);
+	}
+};
+
+/// The value of a material variable.
+class MaterialBinaryInput
+{
+public:
+	WeakArray<char> m_name; ///< Null terminated.
+	WeakArray<char> m_text; ///< The value as it was written. Null terminated. Used by textures.
+	Array<F64, 16> m_numbers = {}; ///< The value as numbers. Used by everything other than textures.
+	U32 m_numberCount = 0; ///< Zero if the value is not a list of numbers.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(MaterialBinaryInput, m_name), self.m_name);
+		s.doValue("m_text", offsetof(MaterialBinaryInput, m_text), self.m_text);
+		s.doArray("m_numbers", offsetof(MaterialBinaryInput, m_numbers), &self.m_numbers[0], self.m_numbers.getSize());
+		s.doValue("m_numberCount", offsetof(MaterialBinaryInput, m_numberCount), self.m_numberCount);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialBinaryInput&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialBinaryInput&>(serializer, *this);
+	}
+};
+
+/// The binary version of a material.
+class MaterialBinary
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the text file it was created from.
+	U64 m_sourceSize = 0; ///< The size of the text file it was created from.
+	WeakArray<char> m_shaderProgram; ///< Null terminated.
+	WeakArray<MaterialBinaryMutation> m_mutations;
+	WeakArray<MaterialBinaryInput> m_inputs;
+	Bool m_shadow = true;
+	Bool m_forwardShading = false;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(MaterialBinary, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(MaterialBinary, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_sourceSize", offsetof(MaterialBinary, m_sourceSize), self.m_sourceSize);
+		s.doValue("m_shaderProgram", offsetof(MaterialBinary, m_shaderProgram), self.m_shaderProgram);
+		s.doValue("m_mutations", offsetof(MaterialBinary, m_mutations), self.m_mutations);
+		s.doValue("m_inputs", offsetof(MaterialBinary, m_inputs), self.m_inputs);
+		s.doValue("m_shadow", offsetof(MaterialBinary, m_shadow), self.m_shadow);
+		s.doValue("m_forwardShading", offsetof(MaterialBinary, m_forwardShading), self.m_forwardShading);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialBinary&>(serializer, *this);
+	}
+};
+
+/// A model patch.
+class ModelBinaryPatch
+{
+public:
+	Array<WeakArray<char>, MAX_LOD_COUNT> m_meshes = {}; ///< One mesh filename per LOD. Null terminated.
+	U32 m_meshCount = 0;
+	WeakArray<char> m_material; ///< Null terminated.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_meshes", offsetof(ModelBinaryPatch, m_meshes), &self.m_meshes[0], self.m_meshes.getSize());
+		s.doValue("m_meshCount", offsetof(ModelBinaryPatch, m_meshCount), self.m_meshCount);
+		s.doValue("m_material", offsetof(ModelBinaryPatch, m_material), self.m_material);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ModelBinaryPatch&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ModelBinaryPatch&>(serializer, *this);
+	}
+};
+
+/// The binary version of a model.
+class ModelBinary
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the text file it was created from.
+	U64 m_sourceSize = 0; ///< The size of the text file it was created from.
+	WeakArray<ModelBinaryPatch> m_patches;
+	WeakArray<char> m_skeleton; ///< Null terminated. Empty if there is no skeleton.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(ModelBinary, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(ModelBinary, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_sourceSize", offsetof(ModelBinary, m_sourceSize), self.m_sourceSize);
+		s.doValue("m_patches", offsetof(ModelBinary, m_patches), self.m_patches);
+		s.doValue("m_skeleton", offsetof(ModelBinary, m_skeleton), self.m_skeleton);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ModelBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ModelBinary&>(serializer, *this);
+	}
+};
+
+/// A skeleton bone.
+class SkeletonBinaryBone
+{
+public:
+	WeakArray<char> m_name; ///< Null terminated.
+	Array<F32, 16> m_transform = {};
+	Array<F32, 16> m_vertexTransform = {};
+	U32 m_parent = MAX_U32; ///< Index of the parent bone. MAX_U32 for the root bone.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(SkeletonBinaryBone, m_name), self.m_name);
+		s.doArray(
+			"m_transform", offsetof(SkeletonBinaryBone, m_transform), &self.m_transform[0], self.m_transform.getSize());
+		s.doArray("m_vertexTransform",
+			offsetof(SkeletonBinaryBone, m_vertexTransform),
+			&self.m_vertexTransform[0],
+			self.m_vertexTransform.getSize());
+		s.doValue("m_parent", offsetof(SkeletonBinaryBone, m_parent), self.m_parent);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SkeletonBinaryBone&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SkeletonBinaryBone&>(serializer, *this);
+	}
+};
+
+/// The binary version of a skeleton.
+class SkeletonBinary
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the text file it was created from.
+	U64 m_sourceSize = 0; ///< The size of the text file it was created from.
+	WeakArray<SkeletonBinaryBone> m_bones;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(SkeletonBinary, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(SkeletonBinary, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_sourceSize", offsetof(SkeletonBinary, m_sourceSize), self.m_sourceSize);
+		s.doValue("m_bones", offsetof(SkeletonBinary, m_bones), self.m_bones);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, SkeletonBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const SkeletonBinary&>(serializer, *this);
+	}
+};
+
+/// Position keyframe.
+class AnimationBinaryPositionKey
+{
+public:
+	Second m_time = 0.0;
+	Array<F32, 3> m_value = {};
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_time", offsetof(AnimationBinaryPositionKey, m_time), self.m_time);
+		s.doArray("m_value", offsetof(AnimationBinaryPositionKey, m_value), &self.m_value[0], self.m_value.getSize());
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryPositionKey&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryPositionKey&>(serializer, *this);
+	}
+};
+
+/// Rotation keyframe. The value is a quaternion.
+class AnimationBinaryRotationKey
+{
+public:
+	Second m_time = 0.0;
+	Array<F32, 4> m_value = {};
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_time", offsetof(AnimationBinaryRotationKey, m_time), self.m_time);
+		s.doArray("m_value", offsetof(AnimationBinaryRotationKey, m_value), &self.m_value[0], self.m_value.getSize());
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryRotationKey&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryRotationKey&>(serializer, *this);
+	}
+};
+
+/// Scale keyframe.
+class AnimationBinaryScaleKey
+{
+public:
+	Second m_time = 0.0;
+	F32 m_value = 1.0f;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_time", offsetof(AnimationBinaryScaleKey, m_time), self.m_time);
+		s.doValue("m_value", offsetof(AnimationBinaryScaleKey, m_value), self.m_value);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryScaleKey&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryScaleKey&>(serializer, *this);
+	}
+};
+
+/// Animation channel.
+class AnimationBinaryChannel
+{
+public:
+	WeakArray<char> m_name; ///< Null terminated.
+	WeakArray<AnimationBinaryPositionKey> m_positionKeys;
+	WeakArray<AnimationBinaryRotationKey> m_rotationKeys;
+	WeakArray<AnimationBinaryScaleKey> m_scaleKeys;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_name", offsetof(AnimationBinaryChannel, m_name), self.m_name);
+		s.doValue("m_positionKeys", offsetof(AnimationBinaryChannel, m_positionKeys), self.m_positionKeys);
+		s.doValue("m_rotationKeys", offsetof(AnimationBinaryChannel, m_rotationKeys), self.m_rotationKeys);
+		s.doValue("m_scaleKeys", offsetof(AnimationBinaryChannel, m_scaleKeys), self.m_scaleKeys);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryChannel&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryChannel&>(serializer, *this);
+	}
+};
+
+/// The binary version of an animation.
+class AnimationBinary
+{
+public:
+	Array<U8, 8> m_magic = {};
+	U64 m_sourceHash = 0; ///< The hash of the text file it was created from.
+	U64 m_sourceSize = 0; ///< The size of the text file it was created from.
+	WeakArray<AnimationBinaryChannel> m_channels;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(AnimationBinary, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_sourceHash", offsetof(AnimationBinary, m_sourceHash), self.m_sourceHash);
+		s.doValue("m_sourceSize", offsetof(AnimationBinary, m_sourceSize), self.m_sourceSize);
+		s.doValue("m_channels", offsetof(AnimationBinary, m_channels), self.m_channels);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinary&>(serializer, *this);
+	}
+};
+
+} // end namespace anki
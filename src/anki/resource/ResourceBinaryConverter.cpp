@@ -0,0 +1,543 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourceBinaryConverter.h>
+#include <anki/util/Xml.h>
+#include <anki/util/File.h>
+#include <anki/util/Hash.h>
+#include <anki/util/Logger.h>
+#include <cerrno>
+
+namespace anki
+{
+
+template<typename T>
+static WeakArray<T> newBinaryArray(GenericMemoryPoolAllocator<U8> alloc, U32 size)
+{
+	return WeakArray<T>((size) ? alloc.newArray<T>(size) : nullptr, size);
+}
+
+static WeakArray<char> newBinaryString(GenericMemoryPoolAllocator<U8> alloc, CString str)
+{
+	const U32 length = (str.isEmpty()) ? 0 : str.getLength();
+	WeakArray<char> out = newBinaryArray<char>(alloc, length + 1);
+	if(length)
+	{
+		memcpy(&out[0], str.cstr(), length);
+	}
+	out[length] = '\0';
+	return out;
+}
+
+template<typename TBinary>
+static TBinary* newBinary(GenericMemoryPoolAllocator<U8> alloc, U64 sourceHash)
+{
+	TBinary* binary = alloc.newInstance<TBinary>();
+	memcpy(&binary->m_magic[0], ResourceBinaryTraits<TBinary>::MAGIC, sizeof(binary->m_magic));
+	binary->m_sourceHash = sourceHash;
+	return binary;
+}
+
+/// Get the first child element with some name and the number of its siblings with the same name.
+static Error getChildElements(XmlElement parentEl, CString name, XmlElement& firstEl, U32& count)
+{
+	count = 0;
+	ANKI_CHECK(parentEl.getChildElementOptional(name, firstEl));
+	if(firstEl)
+	{
+		ANKI_CHECK(firstEl.getSiblingElementsCount(count));
+		++count;
+	}
+
+	return Error::NONE;
+}
+
+/// Parse a space separated list of numbers. Returns zero if the text is not a list of numbers.
+static U32 parseNumbersQuietly(CString txt, Array<F64, 16>& numbers)
+{
+	U32 count = 0;
+	const char* ptr = txt.cstr();
+	while(ptr)
+	{
+		while(*ptr == ' ')
+		{
+			++ptr;
+		}
+
+		if(*ptr == '\0')
+		{
+			break;
+		}
+
+		if(count == numbers.getSize())
+		{
+			return 0;
+		}
+
+		errno = 0;
+		char* end;
+		numbers[count++] = std::strtod(ptr, &end);
+		if(end == ptr || errno || (*end != ' ' && *end != '\0'))
+		{
+			errno = 0;
+			return 0;
+		}
+
+		ptr = end;
+	}
+
+	return count;
+}
+
+Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, MaterialBinary*& binary)
+{
+	binary = newBinary<MaterialBinary>(alloc, sourceHash);
+	Bool present;
+
+	// <material>
+	XmlElement rootEl;
+	ANKI_CHECK(xml.getChildElement("material", rootEl));
+
+	// shaderProgram
+	CString fname;
+	ANKI_CHECK(rootEl.getAttributeText("shaderProgram", fname));
+	binary->m_shaderProgram = newBinaryString(alloc, fname);
+
+	// shadow
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("shadow", binary->m_shadow, present));
+
+	// forwardShading
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("forwardShading", binary->m_forwardShading, present));
+
+	// <mutation>
+	XmlElement mutatorsEl;
+	ANKI_CHECK(rootEl.getChildElementOptional("mutation", mutatorsEl));
+	if(mutatorsEl)
+	{
+		XmlElement mutatorEl;
+		U32 count;
+		ANKI_CHECK(getChildElements(mutatorsEl, "mutator", mutatorEl, count));
+		if(count == 0)
+		{
+			ANKI_RESOURCE_LOGE("<mutation> should have at least one <mutator>");
+			return Error::USER_DATA;
+		}
+
+		binary->m_mutations = newBinaryArray<MaterialBinaryMutation>(alloc, count);
+		count = 0;
+		do
+		{
+			MaterialBinaryMutation& mutation = binary->m_mutations[count++];
+
+			CString name;
+			ANKI_CHECK(mutatorEl.getAttributeText("name", name));
+			if(name.isEmpty())
+			{
+				ANKI_RESOURCE_LOGE("Mutator name is empty");
+				return Error::USER_DATA;
+			}
+			mutation.m_name = newBinaryString(alloc, name);
+
+			ANKI_CHECK(mutatorEl.getAttributeNumber("value", mutation.m_value));
+
+			ANKI_CHECK(mutatorEl.getNextSiblingElement("mutator", mutatorEl));
+		} while(mutatorEl);
+	}
+
+	// <inputs>
+	XmlElement inputsEl;
+	ANKI_CHECK(rootEl.getChildElementOptional("inputs", inputsEl));
+	if(inputsEl)
+	{
+		XmlElement inputEl;
+		U32 count;
+		ANKI_CHECK(getChildElements(inputsEl, "input", inputEl, count));
+
+		binary->m_inputs = newBinaryArray<MaterialBinaryInput>(alloc, count);
+		count = 0;
+		while(inputEl)
+		{
+			MaterialBinaryInput& input = binary->m_inputs[count++];
+
+			CString name;
+			ANKI_CHECK(inputEl.getAttributeText("shaderVar", name));
+			input.m_name = newBinaryString(alloc, name);
+
+			// The type of the variable is not known without the program so store the value as text and as numbers
+			CString value;
+			ANKI_CHECK(inputEl.getAttributeText("value", value));
+			input.m_text = newBinaryString(alloc, value);
+			input.m_numberCount = (value.isEmpty()) ? 0 : parseNumbersQuietly(value, input.m_numbers);
+
+			ANKI_CHECK(inputEl.getNextSiblingElement("input", inputEl));
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, ModelBinary*& binary)
+{
+	binary = newBinary<ModelBinary>(alloc, sourceHash);
+
+	// <model>
+	XmlElement rootEl;
+	ANKI_CHECK(xml.getChildElement("model", rootEl));
+
+	// <modelPatches>
+	XmlElement modelPatchesEl;
+	ANKI_CHECK(rootEl.getChildElement("modelPatches", modelPatchesEl));
+
+	XmlElement modelPatchEl;
+	U32 count;
+	ANKI_CHECK(getChildElements(modelPatchesEl, "modelPatch", modelPatchEl, count));
+	if(count == 0)
+	{
+		ANKI_RESOURCE_LOGE("Zero number of model patches");
+		return Error::USER_DATA;
+	}
+
+	binary->m_patches = newBinaryArray<ModelBinaryPatch>(alloc, count);
+	count = 0;
+	do
+	{
+		ModelBinaryPatch& patch = binary->m_patches[count++];
+
+		// <material>
+		XmlElement materialEl;
+		ANKI_CHECK(modelPatchEl.getChildElement("material", materialEl));
+		CString fname;
+		ANKI_CHECK(materialEl.getText(fname));
+		patch.m_material = newBinaryString(alloc, fname);
+
+		// <mesh> <mesh1> <mesh2>
+		static const Array<CString, MAX_LOD_COUNT> meshElNames = {{"mesh", "mesh1", "mesh2"}};
+		for(U32 lod = 0; lod < MAX_LOD_COUNT; ++lod)
+		{
+			XmlElement meshEl;
+			if(lod == 0)
+			{
+				ANKI_CHECK(modelPatchEl.getChildElement(meshElNames[lod], meshEl));
+			}
+			else
+			{
+				ANKI_CHECK(modelPatchEl.getChildElementOptional(meshElNames[lod], meshEl));
+			}
+
+			if(meshEl)
+			{
+				ANKI_CHECK(meshEl.getText(fname));
+				patch.m_meshes[patch.m_meshCount++] = newBinaryString(alloc, fname);
+			}
+		}
+
+		ANKI_CHECK(modelPatchEl.getNextSiblingElement("modelPatch", modelPatchEl));
+	} while(modelPatchEl);
+
+	// <skeleton>
+	XmlElement skeletonEl;
+	ANKI_CHECK(rootEl.getChildElementOptional("skeleton", skeletonEl));
+	if(skeletonEl)
+	{
+		CString fname;
+		ANKI_CHECK(skeletonEl.getText(fname));
+		binary->m_skeleton = newBinaryString(alloc, fname);
+	}
+
+	return Error::NONE;
+}
+
+Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, SkeletonBinary*& binary)
+{
+	binary = newBinary<SkeletonBinary>(alloc, sourceHash);
+
+	// <skeleton>
+	XmlElement rootEl;
+	ANKI_CHECK(xml.getChildElement("skeleton", rootEl));
+
+	// <bones>
+	XmlElement bonesEl;
+	ANKI_CHECK(rootEl.getChildElement("bones", bonesEl));
+
+	XmlElement boneEl;
+	U32 boneCount;
+	ANKI_CHECK(getChildElements(bonesEl, "bone", boneEl, boneCount));
+	if(boneCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Skeleton doesn't have bones");
+		return Error::USER_DATA;
+	}
+
+	binary->m_bones = newBinaryArray<SkeletonBinaryBone>(alloc, boneCount);
+	WeakArray<CString> parentNames = newBinaryArray<CString>(alloc, boneCount);
+	U32 rootBoneCount = 0;
+
+	boneCount = 0;
+	do
+	{
+		SkeletonBinaryBone& bone = binary->m_bones[boneCount];
+
+		// <name>
+		XmlElement el;
+		ANKI_CHECK(boneEl.getChildElement("name", el));
+		CString name;
+		ANKI_CHECK(el.getText(name));
+		bone.m_name = newBinaryString(alloc, name);
+
+		// <transform>
+		ANKI_CHECK(boneEl.getChildElement("transform", el));
+		ANKI_CHECK(el.getNumbers(bone.m_transform));
+
+		// <boneTransform>
+		ANKI_CHECK(boneEl.getChildElement("boneTransform", el));
+		ANKI_CHECK(el.getNumbers(bone.m_vertexTransform));
+
+		// <parent>
+		ANKI_CHECK(boneEl.getChildElementOptional("parent", el));
+		if(el)
+		{
+			ANKI_CHECK(el.getText(parentNames[boneCount]));
+		}
+		else if(++rootBoneCount > 1)
+		{
+			ANKI_RESOURCE_LOGE("Skeleton cannot have more than one root nodes");
+			return Error::USER_DATA;
+		}
+
+		++boneCount;
+		ANKI_CHECK(boneEl.getNextSiblingElement("bone", boneEl));
+	} while(boneEl);
+
+	if(rootBoneCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Skeleton doesn't have a root node");
+		return Error::USER_DATA;
+	}
+
+	// Resolve the parents
+	for(U32 i = 0; i < boneCount; ++i)
+	{
+		if(parentNames[i].isEmpty())
+		{
+			continue;
+		}
+
+		SkeletonBinaryBone& bone = binary->m_bones[i];
+		for(U32 j = 0; j < boneCount; ++j)
+		{
+			if(CString(&binary->m_bones[j].m_name[0]) == parentNames[i])
+			{
+				bone.m_parent = j;
+				break;
+			}
+		}
+
+		if(bone.m_parent == MAX_U32)
+		{
+			ANKI_RESOURCE_LOGE(
+				"Bone \"%s\" is referencing an unknown parent \"%s\"", &bone.m_name[0], parentNames[i].cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+/// Parse <positionKeys>, <rotationKeys> or <scalingKeys>.
+template<typename TKey, typename TParseValueFunc>
+static Error convertAnimationKeys(XmlElement channelEl,
+	CString keysElName,
+	GenericMemoryPoolAllocator<U8> alloc,
+	TParseValueFunc parseValue,
+	WeakArray<TKey>& keys)
+{
+	XmlElement keysEl;
+	ANKI_CHECK(channelEl.getChildElementOptional(keysElName, keysEl));
+	if(!keysEl)
+	{
+		return Error::NONE;
+	}
+
+	XmlElement keyEl;
+	U32 count;
+	ANKI_CHECK(getChildElements(keysEl, "key", keyEl, count));
+	if(count == 0)
+	{
+		ANKI_RESOURCE_LOGE("<%s> should have at least one <key>", keysElName.cstr());
+		return Error::USER_DATA;
+	}
+
+	keys = newBinaryArray<TKey>(alloc, count);
+	count = 0;
+	do
+	{
+		TKey& key = keys[count++];
+
+		// <time>
+		XmlElement el;
+		ANKI_CHECK(keyEl.getChildElement("time", el));
+		ANKI_CHECK(el.getNumber(key.m_time));
+
+		// <value>
+		ANKI_CHECK(keyEl.getChildElement("value", el));
+		ANKI_CHECK(parseValue(el, key));
+
+		ANKI_CHECK(keyEl.getNextSiblingElement("key", keyEl));
+	} while(keyEl);
+
+	return Error::NONE;
+}
+
+Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, AnimationBinary*& binary)
+{
+	binary = newBinary<AnimationBinary>(alloc, sourceHash);
+
+	// <animation>
+	XmlElement rootEl;
+	ANKI_CHECK(xml.getChildElement("animation", rootEl));
+
+	// <channels>
+	XmlElement channelsEl;
+	ANKI_CHECK(rootEl.getChildElement("channels", channelsEl));
+
+	XmlElement channelEl;
+	U32 count;
+	ANKI_CHECK(getChildElements(channelsEl, "channel", channelEl, count));
+	if(count == 0)
+	{
+		ANKI_RESOURCE_LOGE("Didn't found any channels");
+		return Error::USER_DATA;
+	}
+
+	binary->m_channels = newBinaryArray<AnimationBinaryChannel>(alloc, count);
+	count = 0;
+	do
+	{
+		AnimationBinaryChannel& channel = binary->m_channels[count++];
+
+		// <name>
+		XmlElement el;
+		ANKI_CHECK(channelEl.getChildElement("name", el));
+		CString name;
+		ANKI_CHECK(el.getText(name));
+		channel.m_name = newBinaryString(alloc, name);
+
+		// <positionKeys>
+		ANKI_CHECK(convertAnimationKeys(channelEl,
+			"positionKeys",
+			alloc,
+			[](const XmlElement& valueEl, AnimationBinaryPositionKey& key) { return valueEl.getNumbers(key.m_value); },
+			channel.m_positionKeys));
+
+		// <rotationKeys>
+		ANKI_CHECK(convertAnimationKeys(channelEl,
+			"rotationKeys",
+			alloc,
+			[](const XmlElement& valueEl, AnimationBinaryRotationKey& key) { return valueEl.getNumbers(key.m_value); },
+			channel.m_rotationKeys));
+
+		// <scalingKeys>
+		ANKI_CHECK(convertAnimationKeys(channelEl,
+			"scalingKeys",
+			alloc,
+			[](const XmlElement& valueEl, AnimationBinaryScaleKey& key) { return valueEl.getNumber(key.m_value); },
+			channel.m_scaleKeys));
+
+		ANKI_CHECK(channelEl.getNextSiblingElement("channel", channelEl));
+	} while(channelEl);
+
+	return Error::NONE;
+}
+
+static CString getExtension(CString filename)
+{
+	const char* dot = strrchr(filename.cstr(), '.');
+	return (dot) ? dot + 1 : "";
+}
+
+Bool resourceFileHasBinary(CString filename)
+{
+	const CString ext = getExtension(filename);
+	return ext == ResourceBinaryTraits<MaterialBinary>::EXTENSION || ext == ResourceBinaryTraits<ModelBinary>::EXTENSION
+		   || ext == ResourceBinaryTraits<SkeletonBinary>::EXTENSION
+		   || ext == ResourceBinaryTraits<AnimationBinary>::EXTENSION;
+}
+
+template<typename TBinary>
+static Error convertResourceFileInternal(
+	const XmlDocument& xml, U64 sourceHash, U64 sourceSize, GenericMemoryPoolAllocator<U8> alloc, CString outFilename)
+{
+	TBinary* binary;
+	ANKI_CHECK(convertResourceXml(xml, sourceHash, alloc, binary));
+	binary->m_sourceSize = sourceSize;
+
+	File file;
+	ANKI_CHECK(file.open(outFilename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	BinarySerializer serializer;
+	ANKI_CHECK(serializer.serialize(*binary, alloc, file));
+
+	return Error::NONE;
+}
+
+Error convertResourceFile(CString inFilename, CString outFilename, GenericMemoryPoolAllocator<U8> alloc)
+{
+	if(!resourceFileHasBinary(inFilename))
+	{
+		ANKI_RESOURCE_LOGE("Resource type doesn't have a binary version: %s", inFilename.cstr());
+		return Error::USER_DATA;
+	}
+
+	// Parse the XML
+	StringAuto txt(alloc);
+	U64 sourceSize;
+	{
+		File file;
+		ANKI_CHECK(file.open(inFilename, FileOpenFlag::READ));
+		ANKI_CHECK(file.readAllText(txt));
+		sourceSize = file.getSize();
+	}
+
+	XmlDocument xml;
+	ANKI_CHECK(xml.parse(txt.toCString(), alloc));
+	const U64 sourceHash = computeStableHash(txt.cstr(), txt.getLength());
+
+	// The binary uses lots of small allocations so use a stack allocator to free them all at once
+	StackAllocator<U8> binaryAlloc(alloc.getMemoryPool().getAllocationCallback(),
+		alloc.getMemoryPool().getAllocationCallbackUserData(),
+		16_KB);
+
+	// Convert and write
+	const CString ext = getExtension(inFilename);
+	Error err = Error::NONE;
+	if(ext == ResourceBinaryTraits<MaterialBinary>::EXTENSION)
+	{
+		err = convertResourceFileInternal<MaterialBinary>(xml, sourceHash, sourceSize, binaryAlloc, outFilename);
+	}
+	else if(ext == ResourceBinaryTraits<ModelBinary>::EXTENSION)
+	{
+		err = convertResourceFileInternal<ModelBinary>(xml, sourceHash, sourceSize, binaryAlloc, outFilename);
+	}
+	else if(ext == ResourceBinaryTraits<SkeletonBinary>::EXTENSION)
+	{
+		err = convertResourceFileInternal<SkeletonBinary>(xml, sourceHash, sourceSize, binaryAlloc, outFilename);
+	}
+	else
+	{
+		err = convertResourceFileInternal<AnimationBinary>(xml, sourceHash, sourceSize, binaryAlloc, outFilename);
+	}
+
+	if(err)
+	{
+		ANKI_RESOURCE_LOGE("Failed to convert %s", inFilename.cstr());
+	}
+
+	return err;
+}
+
+} // end namespace anki
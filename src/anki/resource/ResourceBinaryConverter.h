@@ -0,0 +1,91 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/ResourceBinary.h>
+
+namespace anki
+{
+
+// Forward
+class XmlDocument;
+
+/// @addtogroup resource
+/// @{
+
+/// It's appended to the filename of a text resource to get the filename of its binary version. The binary of
+/// "foo.ankimtl" is "foo.ankimtlbin".
+constexpr const char* RESOURCE_BINARY_SUFFIX = "bin";
+
+/// Information about the binary version of resources.
+template<typename TBinary>
+class ResourceBinaryTraits;
+
+template<>
+class ResourceBinaryTraits<MaterialBinary>
+{
+public:
+	static constexpr const char* MAGIC = "ANKIMTL2";
+	static constexpr const char* EXTENSION = "ankimtl";
+};
+
+template<>
+class ResourceBinaryTraits<ModelBinary>
+{
+public:
+	static constexpr const char* MAGIC = "ANKIMDL2";
+	static constexpr const char* EXTENSION = "ankimdl";
+};
+
+template<>
+class ResourceBinaryTraits<SkeletonBinary>
+{
+public:
+	static constexpr const char* MAGIC = "ANKISKL2";
+	static constexpr const char* EXTENSION = "ankiskel";
+};
+
+template<>
+class ResourceBinaryTraits<AnimationBinary>
+{
+public:
+	static constexpr const char* MAGIC = "ANKIANM2";
+	static constexpr const char* EXTENSION = "ankianim";
+};
+
+/// @name Convert the XML of resources to their binary version
+/// The conversion doesn't need any other resource. The binary is allocated using many allocations that are never freed
+/// so the @a alloc should be a StackAllocator or something similar.
+/// @param xml The parsed XML.
+/// @param sourceHash The hash of the XML text. It's stored in the binary.
+/// @param alloc The allocator of the binary.
+/// @param[out] binary The new binary.
+/// @{
+ANKI_USE_RESULT Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, MaterialBinary*& binary);
+
+ANKI_USE_RESULT Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, ModelBinary*& binary);
+
+ANKI_USE_RESULT Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, SkeletonBinary*& binary);
+
+ANKI_USE_RESULT Error convertResourceXml(
+	const XmlDocument& xml, U64 sourceHash, GenericMemoryPoolAllocator<U8> alloc, AnimationBinary*& binary);
+/// @}
+
+/// Return true if the type of the resource file has a binary version. It checks the extension.
+Bool resourceFileHasBinary(CString filename);
+
+/// Convert a material, model, skeleton or animation file to binary. The type is deduced from the extension.
+/// @param inFilename The text file.
+/// @param outFilename The binary file to write.
+/// @param alloc Temp allocator.
+ANKI_USE_RESULT Error convertResourceFile(
+	CString inFilename, CString outFilename, GenericMemoryPoolAllocator<U8> alloc);
+/// @}
+
+} // end namespace anki
@@ -7,7 +7,10 @@
 #include <anki/util/Filesystem.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/ThreadPool.h>
+#include <anki/util/Hash.h>
 #include <contrib/minizip/unzip.h>
+#include <zlib.h>
 
 namespace anki
 {
@@ -58,12 +61,15 @@ public:
 	}
 };
 
-/// ZIP file
+/// ZIP file. It reads the archive through a pooled file handle and inflates the data itself so it can keep checkpoints
+/// of the inflate state. Seeking inside a deflated file restarts from the closest checkpoint and not from the start.
 class ZipResourceFile final : public ResourceFile
 {
 public:
-	unzFile m_archive = nullptr;
-	PtrSize m_size = 0;
+	ResourceFilesystem* m_fs = nullptr;
+	ResourceFilesystem::Path* m_archive = nullptr;
+	ResourceFilesystem::ArchiveEntry m_entry;
+	File* m_file = nullptr;
 
 	ZipResourceFile(GenericMemoryPoolAllocator<U8> alloc)
 		: ResourceFile(alloc)
@@ -72,57 +78,58 @@ public:
 
 	~ZipResourceFile()
 	{
-		if(m_archive)
-		{
-			// It's open
-			unzClose(m_archive);
-			m_archive = nullptr;
-			m_size = 0;
-		}
+		close();
 	}
 
-	ANKI_USE_RESULT Error open(const CString& archive, const CString& archivedFname)
+	ANKI_USE_RESULT Error open(ResourceFilesystem& fs, ResourceFilesystem::Path& archive, const CString& archivedFname)
 	{
-		// Open archive
-		m_archive = unzOpen(&archive[0]);
-		if(m_archive == nullptr)
-		{
-			ANKI_RESOURCE_LOGE("Failed to open archive");
-			return Error::FILE_ACCESS;
-		}
+		m_fs = &fs;
+		m_archive = &archive;
 
-		// Locate archived
-		const int caseSensitive = 1;
-		if(unzLocateFile(m_archive, &archivedFname[0], caseSensitive) != UNZ_OK)
+		Bool found;
+		ANKI_CHECK(fs.acquireArchiveFile(archive, archivedFname, m_entry, m_file, found));
+		if(!found)
 		{
 			ANKI_RESOURCE_LOGE("Failed to locate file in archive");
 			return Error::FILE_ACCESS;
 		}
 
-		// Open file
-		if(unzOpenCurrentFile(m_archive) != UNZ_OK)
+		ANKI_ASSERT(m_entry.m_size != 0);
+
+		if(m_entry.m_deflated)
 		{
-			ANKI_RESOURCE_LOGE("unzOpenCurrentFile() failed");
-			return Error::FILE_ACCESS;
+			zeroMemory(m_stream);
+			if(inflateInit2(&m_stream, -MAX_WBITS) != Z_OK)
+			{
+				ANKI_RESOURCE_LOGE("inflateInit2() failed");
+				return Error::FUNCTION_FAILED;
+			}
+			m_streamInitialized = true;
 		}
 
-		// Get size just in case
-		unz_file_info zinfo;
-		zinfo.uncompressed_size = 0;
-		unzGetCurrentFileInfo(m_archive, &zinfo, nullptr, 0, nullptr, 0, nullptr, 0);
-		m_size = zinfo.uncompressed_size;
-		ANKI_ASSERT(m_size != 0);
-
 		return Error::NONE;
 	}
 
 	void close()
 	{
-		if(m_archive)
+		for(Checkpoint* cp : m_checkpoints)
+		{
+			inflateEnd(&cp->m_stream);
+			getAllocator().deleteInstance(cp);
+		}
+		m_checkpoints.destroy(getAllocator());
+		m_inBuff.destroy(getAllocator());
+
+		if(m_streamInitialized)
+		{
+			inflateEnd(&m_stream);
+			m_streamInitialized = false;
+		}
+
+		if(m_file)
 		{
-			unzClose(m_archive);
-			m_archive = nullptr;
-			m_size = 0;
+			m_fs->releaseArchiveFile(*m_archive, m_file);
+			m_file = nullptr;
 		}
 	}
 
@@ -130,22 +137,28 @@ public:
 	{
 		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
 
-		I64 readSize = unzReadCurrentFile(m_archive, buff, U32(size));
-
-		if(I64(size) != readSize)
+		if(m_pos + size > m_entry.m_size)
 		{
 			ANKI_RESOURCE_LOGE("File read failed");
 			return Error::FILE_ACCESS;
 		}
 
-		return Error::NONE;
+		if(!m_entry.m_deflated)
+		{
+			ANKI_CHECK(m_file->seek(m_entry.m_dataOffset + m_pos, FileSeekOrigin::BEGINNING));
+			ANKI_CHECK(m_file->read(buff, size));
+			m_pos += size;
+			return Error::NONE;
+		}
+
+		return inflateData(static_cast<U8*>(buff), size);
 	}
 
 	ANKI_USE_RESULT Error readAllText(StringAuto& out) override
 	{
-		ANKI_ASSERT(m_size);
-		out.create('?', m_size);
-		return read(&out[0], m_size);
+		ANKI_ASSERT(m_entry.m_size);
+		out.create('?', m_entry.m_size);
+		return read(&out[0], m_entry.m_size);
 	}
 
 	ANKI_USE_RESULT Error readU32(U32& u) override
@@ -164,23 +177,66 @@ public:
 
 	ANKI_USE_RESULT Error seek(PtrSize offset, FileSeekOrigin origin) override
 	{
-		// Rewind if needed
-		if(origin == FileSeekOrigin::BEGINNING)
+		PtrSize newPos;
+		switch(origin)
+		{
+		case FileSeekOrigin::BEGINNING:
+			newPos = offset;
+			break;
+		case FileSeekOrigin::CURRENT:
+			newPos = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::END);
+			newPos = m_entry.m_size + offset;
+		}
+
+		if(newPos > m_entry.m_size)
+		{
+			ANKI_RESOURCE_LOGE("Seek out of bounds");
+			return Error::FUNCTION_FAILED;
+		}
+
+		if(!m_entry.m_deflated || newPos == m_pos)
 		{
-			if(unzCloseCurrentFile(m_archive) || unzOpenCurrentFile(m_archive))
+			m_pos = newPos;
+			return Error::NONE;
+		}
+
+		// Find the closest checkpoint that doesn't go past the new position
+		Checkpoint* closest = nullptr;
+		for(Checkpoint* cp : m_checkpoints)
+		{
+			if(cp->m_pos <= newPos && (newPos < m_pos || cp->m_pos > m_pos))
+			{
+				closest = cp;
+			}
+		}
+
+		if(closest)
+		{
+			ANKI_CHECK(restoreCheckpoint(*closest));
+		}
+		else if(newPos < m_pos)
+		{
+			// No checkpoint, start over
+			if(inflateReset(&m_stream) != Z_OK)
 			{
 				ANKI_RESOURCE_LOGE("Rewind failed");
 				return Error::FUNCTION_FAILED;
 			}
+
+			m_stream.next_in = nullptr;
+			m_stream.avail_in = 0;
+			m_compressedPos = 0;
+			m_pos = 0;
 		}
 
-		// Move forward by reading dummy data
-		Array<char, 128> buff;
-		while(offset != 0)
+		// Move forward by inflating dummy data
+		Array<U8, 1024> dummy;
+		while(m_pos < newPos)
 		{
-			PtrSize toRead = min<PtrSize>(offset, sizeof(buff));
-			ANKI_CHECK(read(&buff[0], toRead));
-			offset -= toRead;
+			ANKI_CHECK(inflateData(&dummy[0], min<PtrSize>(newPos - m_pos, dummy.getSize())));
 		}
 
 		return Error::NONE;
@@ -188,229 +244,1274 @@ public:
 
 	PtrSize getSize() const override
 	{
-		ANKI_ASSERT(m_size > 0);
-		return m_size;
-	}
-};
-
-ResourceFilesystem::~ResourceFilesystem()
-{
-	for(Path& p : m_paths)
-	{
-		p.m_files.destroy(m_alloc);
-		p.m_path.destroy(m_alloc);
-	}
-
-	m_paths.destroy(m_alloc);
-	m_cacheDir.destroy(m_alloc);
-}
-
-Error ResourceFilesystem::init(const ConfigSet& config, const CString& cacheDir)
-{
-	StringListAuto paths(m_alloc);
-	paths.splitString(config.getString("rsrc_dataPaths"), ':');
-
-	if(paths.getSize() < 1)
-	{
-		ANKI_RESOURCE_LOGE("Config option \"rsrc_dataPaths\" is empty");
-		return Error::USER_DATA;
+		ANKI_ASSERT(m_entry.m_size > 0);
+		return m_entry.m_size;
 	}
 
-	for(auto& path : paths)
+private:
+	/// A copy of the inflate state at some point of the file. The inflate state points back to its z_stream so it can't
+	/// be moved around.
+	class Checkpoint
 	{
-		ANKI_CHECK(addNewPath(path.toCString()));
-	}
-
-	addCachePath(cacheDir);
-
-	return Error::NONE;
-}
+	public:
+		z_stream m_stream;
+		PtrSize m_pos; ///< The uncompressed position.
+		PtrSize m_compressedPos; ///< The position of the next compressed byte the stream expects.
+	};
 
-void ResourceFilesystem::addCachePath(const CString& path)
-{
-	Path p;
-	p.m_path.create(m_alloc, path);
-	p.m_isCache = true;
+	/// The uncompressed distance between checkpoints. Every checkpoint costs the inflate window (32KB) plus some state.
+	static constexpr PtrSize CHECKPOINT_INTERVAL = 1_MB;
 
-	m_paths.emplaceBack(m_alloc, std::move(p));
-}
+	static constexpr U32 IN_BUFFER_SIZE = 16 * 1024;
 
-Error ResourceFilesystem::addNewPath(const CString& path)
-{
-	U32 fileCount = 0;
-	static const CString extension(".ankizip");
+	z_stream m_stream;
+	Bool m_streamInitialized = false;
+	DynamicArray<U8> m_inBuff;
+	PtrSize m_compressedPos = 0; ///< How much compressed data was fed to the stream.
+	PtrSize m_pos = 0; ///< The uncompressed position.
+	DynamicArray<Checkpoint*> m_checkpoints; ///< Sorted by position.
 
-	auto pos = path.find(extension);
-	if(pos != CString::NPOS && pos == path.getLength() - extension.getLength())
+	ANKI_USE_RESULT Error inflateData(U8* out, PtrSize size)
 	{
-		// It's an archive
+		ANKI_ASSERT(m_streamInitialized);
 
-		// Open
-		unzFile zfile = unzOpen(&path[0]);
-		if(!zfile)
+		if(m_inBuff.isEmpty())
 		{
-			ANKI_RESOURCE_LOGE("Failed to open archive");
-			return Error::FILE_ACCESS;
+			m_inBuff.create(getAllocator(), IN_BUFFER_SIZE);
 		}
 
-		// List files
-		if(unzGoToFirstFile(zfile) != UNZ_OK)
+		m_stream.next_out = out;
+		m_stream.avail_out = uInt(size);
+
+		while(m_stream.avail_out > 0)
 		{
-			unzClose(zfile);
-			ANKI_RESOURCE_LOGE("unzGoToFirstFile() failed. Empty archive?");
-			return Error::FILE_ACCESS;
-		}
+			// Feed more input
+			if(m_stream.avail_in == 0)
+			{
+				const PtrSize toRead = min<PtrSize>(m_entry.m_compressedSize - m_compressedPos, IN_BUFFER_SIZE);
+				if(toRead == 0)
+				{
+					ANKI_RESOURCE_LOGE("Unexpected end of compressed data");
+					return Error::FILE_ACCESS;
+				}
 
-		Path p;
-		p.m_isArchive = true;
-		p.m_path.sprintf(m_alloc, "%s", &path[0]);
+				ANKI_CHECK(m_file->seek(m_entry.m_dataOffset + m_compressedPos, FileSeekOrigin::BEGINNING));
+				ANKI_CHECK(m_file->read(&m_inBuff[0], toRead));
+				m_compressedPos += toRead;
+				m_stream.next_in = &m_inBuff[0];
+				m_stream.avail_in = uInt(toRead);
+			}
 
-		do
-		{
-			Array<char, 1024> filename;
+			const PtrSize outBefore = m_stream.avail_out;
+			const I32 ret = ::inflate(&m_stream, Z_NO_FLUSH);
+			if(ret != Z_OK && ret != Z_STREAM_END)
+			{
+				ANKI_RESOURCE_LOGE("inflate() failed");
+				return Error::FUNCTION_FAILED;
+			}
 
-			unz_file_info info;
-			if(unzGetCurrentFileInfo(zfile, &info, &filename[0], filename.getSize(), nullptr, 0, nullptr, 0) != UNZ_OK)
+			m_pos += outBefore - m_stream.avail_out;
+
+			if(ret == Z_STREAM_END && m_stream.avail_out > 0)
 			{
-				unzClose(zfile);
-				ANKI_RESOURCE_LOGE("unzGetCurrentFileInfo() failed");
+				ANKI_RESOURCE_LOGE("File read failed");
 				return Error::FILE_ACCESS;
 			}
 
-			// If compressed size is zero then it's a dir
-			if(info.uncompressed_size > 0)
+			// Keep a checkpoint every now and then
+			const PtrSize lastCheckpointPos = (m_checkpoints.getSize()) ? m_checkpoints.getBack()->m_pos : 0;
+			if(m_pos >= lastCheckpointPos + CHECKPOINT_INTERVAL && ret != Z_STREAM_END)
 			{
-				p.m_files.pushBackSprintf(m_alloc, "%s", &filename[0]);
-				++fileCount;
+				Checkpoint* cp = getAllocator().newInstance<Checkpoint>();
+				if(inflateCopy(&cp->m_stream, &m_stream) == Z_OK)
+				{
+					cp->m_pos = m_pos;
+					cp->m_compressedPos = m_compressedPos - m_stream.avail_in;
+					m_checkpoints.emplaceBack(getAllocator(), cp);
+				}
+				else
+				{
+					getAllocator().deleteInstance(cp);
+				}
 			}
-		} while(unzGoToNextFile(zfile) == UNZ_OK);
+		}
 
-		m_paths.emplaceFront(m_alloc, std::move(p));
-		unzClose(zfile);
+		return Error::NONE;
 	}
-	else
-	{
-		// It's simple directory
 
-		m_paths.emplaceFront(m_alloc, Path());
-		Path& p = m_paths.getFront();
-		p.m_path.sprintf(m_alloc, "%s", &path[0]);
-		p.m_isArchive = false;
-
-		struct UserData
+	ANKI_USE_RESULT Error restoreCheckpoint(Checkpoint& cp)
+	{
+		inflateEnd(&m_stream);
+		if(inflateCopy(&m_stream, &cp.m_stream) != Z_OK)
 		{
-			ResourceFilesystem* m_sys;
-			U32* m_fileCount;
-		} ud{this, &fileCount};
+			m_streamInitialized = false;
+			ANKI_RESOURCE_LOGE("inflateCopy() failed");
+			return Error::FUNCTION_FAILED;
+		}
 
-		ANKI_CHECK(walkDirectoryTree(path, &ud, [](const CString& fname, void* ud, Bool isDir) -> Error {
-			if(isDir)
-			{
-				return Error::NONE;
-			}
+		m_stream.next_in = nullptr;
+		m_stream.avail_in = 0;
+		m_compressedPos = cp.m_compressedPos;
+		m_pos = cp.m_pos;
+		return Error::NONE;
+	}
+};
 
-			UserData* udd = static_cast<UserData*>(ud);
-			ResourceFilesystem* self = udd->m_sys;
+/// A file inside an AnKi resource pack. Compressed entries are decoded block by block so seeking is cheap.
+class PackResourceFile final : public ResourceFile
+{
+public:
+	File m_file;
+	const ResourcePackBinary::Entry* m_entry = nullptr;
+	ThreadPool* m_threadPool = nullptr;
+	Mutex* m_threadPoolMtx = nullptr;
 
-			Path& p = self->m_paths.getFront();
-			p.m_files.pushBackSprintf(self->m_alloc, "%s", fname.cstr());
+	/// The offsets of the compressed blocks from the beginning of the pack. It has one more element than the blocks.
+	DynamicArray<U64> m_blockOffsets;
 
-			++(*udd->m_fileCount);
-			return Error::NONE;
-		}));
+	DynamicArray<U8> m_cachedBlock; ///< The last decoded block that was partially read.
+	U32 m_cachedBlockIdx = MAX_U32;
 
-		if(p.m_files.getSize() < 1)
-		{
-			ANKI_RESOURCE_LOGE("Directory is empty: %s", &path[0]);
-			return Error::USER_DATA;
-		}
-	}
+	PtrSize m_pos = 0;
 
-	ANKI_RESOURCE_LOGI("Added new data path \"%s\" that contains %u files", &path[0], fileCount);
-	return Error::NONE;
-}
+	PackResourceFile(GenericMemoryPoolAllocator<U8> alloc)
+		: ResourceFile(alloc)
+	{
+	}
 
-Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFilePtr& filePtr)
-{
-	ResourceFile* rfile = nullptr;
-	Error err = Error::NONE;
+	~PackResourceFile()
+	{
+		m_blockOffsets.destroy(getAllocator());
+		m_cachedBlock.destroy(getAllocator());
+	}
 
-	// Search for the fname in reverse order
-	for(const Path& p : m_paths)
+	ANKI_USE_RESULT Error open(const CString& packFname, const ResourcePackBinary::Entry& entry)
 	{
-		// Check if it's cache
-		if(p.m_isCache)
+		m_entry = &entry;
+		ANKI_CHECK(m_file.open(packFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+		ANKI_CHECK(m_file.seek(m_entry->m_offset, FileSeekOrigin::BEGINNING));
+
+		if(m_entry->m_codec == ResourcePackCodec::DEFLATE)
 		{
-			StringAuto newFname(m_alloc);
-			newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
+			// Read the block table
+			const U32 blockCount = ResourcePackBinary::computeBlockCount(m_entry->m_size);
+			DynamicArrayAuto<U32> blockSizes(getAllocator(), blockCount);
+			ANKI_CHECK(m_file.read(&blockSizes[0], blockSizes.getSizeInBytes()));
+
+			m_blockOffsets.create(getAllocator(), blockCount + 1);
+			m_blockOffsets[0] = m_entry->m_offset + blockSizes.getSizeInBytes();
+			for(U32 i = 0; i < blockCount; ++i)
+			{
+				m_blockOffsets[i + 1] = m_blockOffsets[i] + blockSizes[i];
+			}
 
-			if(fileExists(newFname.toCString()))
+			if(m_blockOffsets.getBack() != m_entry->m_offset + m_entry->m_compressedSize)
 			{
-				// In cache
+				ANKI_RESOURCE_LOGE("Corrupted resource pack entry");
+				return Error::USER_DATA;
+			}
+		}
+		else if(m_entry->m_codec != ResourcePackCodec::STORED)
+		{
+			ANKI_RESOURCE_LOGE("Unknown resource pack codec");
+			return Error::USER_DATA;
+		}
 
-				CResourceFile* file = m_alloc.newInstance<CResourceFile>(m_alloc);
-				rfile = file;
+		return Error::NONE;
+	}
 
-				err = file->m_file.open(&newFname[0], FileOpenFlag::READ);
-			}
+	ANKI_USE_RESULT Error read(void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+
+		if(m_pos + size > m_entry->m_size)
+		{
+			ANKI_RESOURCE_LOGE("File read failed");
+			return Error::FILE_ACCESS;
 		}
-		else
+
+		if(m_entry->m_codec == ResourcePackCodec::STORED)
 		{
-			// In data path or archive
+			ANKI_CHECK(m_file.read(buff, size));
+			m_pos += size;
+			return Error::NONE;
+		}
 
-			for(const String& pfname : p.m_files)
+		U8* out = static_cast<U8*>(buff);
+		while(size > 0)
+		{
+			const U32 block = U32(m_pos / ResourcePackBinary::BLOCK_SIZE);
+			const PtrSize offsetInBlock = m_pos % ResourcePackBinary::BLOCK_SIZE;
+
+			if(offsetInBlock == 0 && size >= getBlockSize(block))
 			{
-				if(pfname != filename)
+				// Decode whole blocks directly to the output
+				U32 blockCount = 0;
+				PtrSize blocksSize = 0;
+				while(block + blockCount < m_blockOffsets.getSize() - 1
+					  && blocksSize + getBlockSize(block + blockCount) <= size)
 				{
-					continue;
+					blocksSize += getBlockSize(block + blockCount);
+					++blockCount;
 				}
 
-				// Found
-				if(p.m_isArchive)
+				ANKI_CHECK(decodeBlocks(block, blockCount, out));
+				out += blocksSize;
+				size -= blocksSize;
+				m_pos += blocksSize;
+			}
+			else
+			{
+				// Partial read, go through the cache
+				if(m_cachedBlockIdx != block)
 				{
-					ZipResourceFile* file = m_alloc.newInstance<ZipResourceFile>(m_alloc);
-					rfile = file;
-
-					err = file->open(p.m_path.toCString(), filename);
+					if(m_cachedBlock.isEmpty())
+					{
+						m_cachedBlock.create(getAllocator(), U32(ResourcePackBinary::BLOCK_SIZE));
+					}
+
+					m_cachedBlockIdx = MAX_U32;
+					ANKI_CHECK(decodeBlocks(block, 1, &m_cachedBlock[0]));
+					m_cachedBlockIdx = block;
 				}
-				else
-				{
-					StringAuto newFname(m_alloc);
-					newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
-
-					CResourceFile* file = m_alloc.newInstance<CResourceFile>(m_alloc);
-					rfile = file;
 
-					err = file->m_file.open(&newFname[0], FileOpenFlag::READ);
-
-#if 0
-					printf("Opening asset %s\n", &newFname[0]);
-#endif
-				}
+				const PtrSize toCopy = min(size, getBlockSize(block) - offsetInBlock);
+				memcpy(out, &m_cachedBlock[U32(offsetInBlock)], toCopy);
+				out += toCopy;
+				size -= toCopy;
+				m_pos += toCopy;
 			}
-		} // end if cache
+		}
+
+		return Error::NONE;
+	}
 
-		if(rfile)
+	ANKI_USE_RESULT Error readAllText(StringAuto& out) override
+	{
+		const PtrSize size = m_entry->m_size - m_pos;
+		if(size == 0)
 		{
-			break;
+			ANKI_RESOURCE_LOGE("Nothing to read");
+			return Error::FILE_ACCESS;
 		}
-	} // end for all paths
 
-	if(err)
+		out.create('?', size);
+		return read(&out[0], size);
+	}
+
+	ANKI_USE_RESULT Error readU32(U32& u) override
 	{
-		m_alloc.deleteInstance(rfile);
-		return err;
+		// Assume machine and file have same endianness
+		ANKI_CHECK(read(&u, sizeof(u)));
+		return Error::NONE;
 	}
 
-	if(!rfile)
+	ANKI_USE_RESULT Error readF32(F32& u) override
 	{
-		ANKI_RESOURCE_LOGE("File not found: %s", &filename[0]);
-		return Error::USER_DATA;
+		// Assume machine and file have same endianness
+		ANKI_CHECK(read(&u, sizeof(u)));
+		return Error::NONE;
 	}
 
-	// Done
-	filePtr.reset(rfile);
-	return Error::NONE;
+	ANKI_USE_RESULT Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize newPos;
+		switch(origin)
+		{
+		case FileSeekOrigin::BEGINNING:
+			newPos = offset;
+			break;
+		case FileSeekOrigin::CURRENT:
+			newPos = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::END);
+			newPos = m_entry->m_size + offset;
+		}
+
+		if(newPos > m_entry->m_size)
+		{
+			ANKI_RESOURCE_LOGE("Seek out of bounds");
+			return Error::FUNCTION_FAILED;
+		}
+
+		m_pos = newPos;
+		if(m_entry->m_codec == ResourcePackCodec::STORED)
+		{
+			ANKI_CHECK(m_file.seek(m_entry->m_offset + m_pos, FileSeekOrigin::BEGINNING));
+		}
+
+		return Error::NONE;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_entry->m_size;
+	}
+
+private:
+	/// Decompresses a range of blocks.
+	class DecodeTask : public ThreadPoolTask
+	{
+	public:
+		const PackResourceFile* m_file = nullptr;
+		const U8* m_compressed = nullptr;
+		U8* m_out = nullptr;
+		U32 m_firstBlock = 0;
+		U32 m_blockCount = 0;
+
+		Error operator()(U32 taskId, PtrSize threadCount) override
+		{
+			for(U32 i = taskId; i < m_blockCount; i += U32(threadCount))
+			{
+				ANKI_CHECK(m_file->decodeBlock(m_firstBlock, m_firstBlock + i, m_compressed, m_out));
+			}
+
+			return Error::NONE;
+		}
+	};
+
+	/// Blocks smaller than that are decoded serially.
+	static constexpr U32 MIN_PARALLEL_BLOCK_COUNT = 4;
+
+	PtrSize getBlockSize(U32 block) const
+	{
+		return min(ResourcePackBinary::BLOCK_SIZE, m_entry->m_size - block * ResourcePackBinary::BLOCK_SIZE);
+	}
+
+	/// Decode a single block. The output and compressed data correspond to firstBlock.
+	ANKI_USE_RESULT Error decodeBlock(U32 firstBlock, U32 block, const U8* compressed, U8* out) const
+	{
+		const PtrSize inOffset = m_blockOffsets[block] - m_blockOffsets[firstBlock];
+		const PtrSize inSize = m_blockOffsets[block + 1] - m_blockOffsets[block];
+		const PtrSize outOffset = (block - firstBlock) * ResourcePackBinary::BLOCK_SIZE;
+		const PtrSize outSize = getBlockSize(block);
+
+		uLongf decodedSize = uLongf(outSize);
+		if(uncompress(out + outOffset, &decodedSize, compressed + inOffset, uLong(inSize)) != Z_OK
+			|| decodedSize != outSize)
+		{
+			ANKI_RESOURCE_LOGE("Failed to decompress resource pack block");
+			return Error::FUNCTION_FAILED;
+		}
+
+		return Error::NONE;
+	}
+
+	/// Read a range of compressed blocks with one read and decode them, in parallel if possible.
+	ANKI_USE_RESULT Error decodeBlocks(U32 firstBlock, U32 blockCount, U8* out)
+	{
+		ANKI_ASSERT(blockCount > 0);
+		DynamicArrayAuto<U8> compressed(
+			getAllocator(), U32(m_blockOffsets[firstBlock + blockCount] - m_blockOffsets[firstBlock]));
+		ANKI_CHECK(m_file.seek(m_blockOffsets[firstBlock], FileSeekOrigin::BEGINNING));
+		ANKI_CHECK(m_file.read(&compressed[0], compressed.getSize()));
+
+		DecodeTask task;
+		task.m_file = this;
+		task.m_compressed = &compressed[0];
+		task.m_out = out;
+		task.m_firstBlock = firstBlock;
+		task.m_blockCount = blockCount;
+
+		// The pool is shared by all files. If someone else is using it do the work serially
+		if(m_threadPool && blockCount >= MIN_PARALLEL_BLOCK_COUNT && m_threadPoolMtx->tryLock())
+		{
+			for(U32 i = 0; i < m_threadPool->getThreadCount(); ++i)
+			{
+				m_threadPool->assignNewTask(i, &task);
+			}
+
+			const Error err = m_threadPool->waitForAllThreadsToFinish();
+			m_threadPoolMtx->unlock();
+			return err;
+		}
+
+		return task(0, 1);
+	}
+};
+
+/// A file that ResourceFilesystem::prefetchFiles() already read to memory.
+class MemoryResourceFile final : public ResourceFile
+{
+public:
+	DynamicArray<U8> m_data;
+	PtrSize m_pos = 0;
+
+	MemoryResourceFile(GenericMemoryPoolAllocator<U8> alloc)
+		: ResourceFile(alloc)
+	{
+	}
+
+	~MemoryResourceFile()
+	{
+		m_data.destroy(getAllocator());
+	}
+
+	ANKI_USE_RESULT Error read(void* buff, PtrSize size) override
+	{
+		if(m_pos + size > m_data.getSize())
+		{
+			ANKI_RESOURCE_LOGE("Read out of bounds");
+			return Error::FILE_ACCESS;
+		}
+
+		if(size == 0)
+		{
+			return Error::NONE;
+		}
+
+		memcpy(buff, &m_data[U32(m_pos)], size);
+		m_pos += size;
+		return Error::NONE;
+	}
+
+	ANKI_USE_RESULT Error readAllText(StringAuto& out) override
+	{
+		const PtrSize size = m_data.getSize() - m_pos;
+		if(size == 0)
+		{
+			ANKI_RESOURCE_LOGE("Nothing to read");
+			return Error::FILE_ACCESS;
+		}
+
+		out.create('?', size);
+		return read(&out[0], size);
+	}
+
+	ANKI_USE_RESULT Error readU32(U32& u) override
+	{
+		// Assume machine and file have same endianness
+		return read(&u, sizeof(u));
+	}
+
+	ANKI_USE_RESULT Error readF32(F32& u) override
+	{
+		// Assume machine and file have same endianness
+		return read(&u, sizeof(u));
+	}
+
+	ANKI_USE_RESULT Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize newPos;
+		switch(origin)
+		{
+		case FileSeekOrigin::BEGINNING:
+			newPos = offset;
+			break;
+		case FileSeekOrigin::CURRENT:
+			newPos = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::END);
+			newPos = m_data.getSize() + offset;
+		}
+
+		if(newPos > m_data.getSize())
+		{
+			ANKI_RESOURCE_LOGE("Seek out of bounds");
+			return Error::FILE_ACCESS;
+		}
+
+		m_pos = newPos;
+		return Error::NONE;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_data.getSize();
+	}
+};
+
+ResourceFilesystem::~ResourceFilesystem()
+{
+	dropPrefetchedFiles();
+
+	for(Path& p : m_paths)
+	{
+		p.m_files.destroy(m_alloc);
+		p.m_path.destroy(m_alloc);
+		p.m_packIndex.destroy(m_alloc);
+		p.m_packStringTable.destroy(m_alloc);
+		p.m_archiveEntries.destroy(m_alloc);
+
+		for(File* file : p.m_freeArchiveFiles)
+		{
+			m_alloc.deleteInstance(file);
+		}
+		p.m_freeArchiveFiles.destroy(m_alloc);
+	}
+
+	m_paths.destroy(m_alloc);
+	m_cacheDir.destroy(m_alloc);
+	m_alloc.deleteInstance(m_packThreadPool);
+}
+
+Error ResourceFilesystem::init(const ConfigSet& config, const CString& cacheDir)
+{
+	StringListAuto paths(m_alloc);
+	paths.splitString(config.getString("rsrc_dataPaths"), ':');
+
+	if(paths.getSize() < 1)
+	{
+		ANKI_RESOURCE_LOGE("Config option \"rsrc_dataPaths\" is empty");
+		return Error::USER_DATA;
+	}
+
+	for(auto& path : paths)
+	{
+		ANKI_CHECK(addNewPath(path.toCString()));
+	}
+
+	addCachePath(cacheDir);
+
+	m_prefetchThreadCount = config.getNumberU32("rsrc_prefetchThreadCount");
+	m_prefetchMemoryBudget = config.getNumberU64("rsrc_prefetchMemoryBudget");
+
+	// Create the decompression threads if there are packs
+	const U32 packThreadCount = config.getNumberU32("rsrc_packDecompressionThreadCount");
+	for(const Path& p : m_paths)
+	{
+		if(p.m_isPack && packThreadCount > 0)
+		{
+			m_packThreadPool = m_alloc.newInstance<ThreadPool>(packThreadCount);
+			break;
+		}
+	}
+
+	return Error::NONE;
+}
+
+void ResourceFilesystem::addCachePath(const CString& path)
+{
+	Path p;
+	p.m_path.create(m_alloc, path);
+	p.m_isCache = true;
+
+	m_paths.emplaceBack(m_alloc, std::move(p));
+}
+
+Error ResourceFilesystem::addNewPath(const CString& path)
+{
+	U32 fileCount = 0;
+	static const CString extension(".ankizip");
+	static const CString packExtension(ResourcePackBinary::EXTENSION);
+
+	auto pos = path.find(extension);
+	auto packPos = path.find(packExtension);
+	if(packPos != CString::NPOS && packPos == path.getLength() - packExtension.getLength())
+	{
+		ANKI_CHECK(addNewPack(path));
+		fileCount = m_paths.getFront().m_packIndex.getSize();
+	}
+	else if(pos != CString::NPOS && pos == path.getLength() - extension.getLength())
+	{
+		// It's an archive
+
+		// Open
+		unzFile zfile = unzOpen(&path[0]);
+		if(!zfile)
+		{
+			ANKI_RESOURCE_LOGE("Failed to open archive");
+			return Error::FILE_ACCESS;
+		}
+
+		// List files
+		if(unzGoToFirstFile(zfile) != UNZ_OK)
+		{
+			unzClose(zfile);
+			ANKI_RESOURCE_LOGE("unzGoToFirstFile() failed. Empty archive?");
+			return Error::FILE_ACCESS;
+		}
+
+		Path p;
+		p.m_isArchive = true;
+		p.m_path.sprintf(m_alloc, "%s", &path[0]);
+
+		do
+		{
+			Array<char, 1024> filename;
+
+			unz_file_info info;
+			if(unzGetCurrentFileInfo(zfile, &info, &filename[0], filename.getSize(), nullptr, 0, nullptr, 0) != UNZ_OK)
+			{
+				unzClose(zfile);
+				ANKI_RESOURCE_LOGE("unzGetCurrentFileInfo() failed");
+				return Error::FILE_ACCESS;
+			}
+
+			// If compressed size is zero then it's a dir
+			if(info.uncompressed_size > 0)
+			{
+				const U64 hash = computeHash(&filename[0], strlen(&filename[0]));
+				if(p.m_archiveEntries.find(hash) != p.m_archiveEntries.getEnd())
+				{
+					unzClose(zfile);
+					ANKI_RESOURCE_LOGE("Duplicate or colliding filename in archive: %s", &filename[0]);
+					return Error::USER_DATA;
+				}
+
+				// Only stored and deflated files can be read
+				if(info.compression_method != 0 && info.compression_method != Z_DEFLATED)
+				{
+					unzClose(zfile);
+					ANKI_RESOURCE_LOGE(
+						"Unsupported compression method %lu in archive: %s", info.compression_method, &filename[0]);
+					return Error::USER_DATA;
+				}
+
+				// Don't touch the local header here, it costs a seek per file. It's parsed on the first open
+				ArchiveEntry entry;
+				entry.m_centralDirOffset = unzGetOffset64(zfile);
+
+				p.m_files.pushBackSprintf(m_alloc, "%s", &filename[0]);
+
+				entry.m_filename = p.m_files.getBack().cstr();
+				entry.m_compressedSize = info.compressed_size;
+				entry.m_size = info.uncompressed_size;
+				entry.m_deflated = info.compression_method == Z_DEFLATED;
+				p.m_archiveEntries.emplace(m_alloc, hash, entry);
+
+				++fileCount;
+			}
+		} while(unzGoToNextFile(zfile) == UNZ_OK);
+
+		unzClose(zfile);
+		m_paths.emplaceFront(m_alloc, std::move(p));
+	}
+	else
+	{
+		// It's simple directory
+
+		m_paths.emplaceFront(m_alloc, Path());
+		Path& p = m_paths.getFront();
+		p.m_path.sprintf(m_alloc, "%s", &path[0]);
+		p.m_isArchive = false;
+
+		struct UserData
+		{
+			ResourceFilesystem* m_sys;
+			U32* m_fileCount;
+		} ud{this, &fileCount};
+
+		ANKI_CHECK(walkDirectoryTree(path, &ud, [](const CString& fname, void* ud, Bool isDir) -> Error {
+			if(isDir)
+			{
+				return Error::NONE;
+			}
+
+			UserData* udd = static_cast<UserData*>(ud);
+			ResourceFilesystem* self = udd->m_sys;
+
+			Path& p = self->m_paths.getFront();
+			p.m_files.pushBackSprintf(self->m_alloc, "%s", fname.cstr());
+
+			++(*udd->m_fileCount);
+			return Error::NONE;
+		}));
+
+		if(p.m_files.getSize() < 1)
+		{
+			ANKI_RESOURCE_LOGE("Directory is empty: %s", &path[0]);
+			return Error::USER_DATA;
+		}
+	}
+
+	ANKI_RESOURCE_LOGI("Added new data path \"%s\" that contains %u files", &path[0], fileCount);
+	return Error::NONE;
+}
+
+Error ResourceFilesystem::addNewPack(const CString& path)
+{
+	File file;
+	ANKI_CHECK(file.open(path, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	ResourcePackBinary::Header header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], ResourcePackBinary::MAGIC, sizeof(header.m_magic)) != 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong magic of resource pack: %s", path.cstr());
+		return Error::USER_DATA;
+	}
+
+	if(header.m_entryCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Resource pack is empty: %s", path.cstr());
+		return Error::USER_DATA;
+	}
+
+	m_paths.emplaceFront(m_alloc, Path());
+	Path& p = m_paths.getFront();
+	p.m_isPack = true;
+	p.m_path.create(m_alloc, path);
+
+	// Read the index and the string table at once
+	ANKI_CHECK(file.seek(header.m_indexOffset, FileSeekOrigin::BEGINNING));
+	p.m_packIndex.create(m_alloc, header.m_entryCount);
+	ANKI_CHECK(file.read(&p.m_packIndex[0], p.m_packIndex.getSizeInBytes()));
+	p.m_packStringTable.create(m_alloc, header.m_stringTableSize);
+	ANKI_CHECK(file.read(&p.m_packStringTable[0], p.m_packStringTable.getSizeInBytes()));
+
+	for(const ResourcePackBinary::Entry& entry : p.m_packIndex)
+	{
+		if(entry.m_filenameOffset + entry.m_filenameLength > header.m_stringTableSize)
+		{
+			ANKI_RESOURCE_LOGE("Corrupted resource pack: %s", path.cstr());
+			return Error::USER_DATA;
+		}
+
+		// Keep the filenames for iterateAllFilenames()
+		p.m_files.pushBackSprintf(
+			m_alloc, "%.*s", I32(entry.m_filenameLength), &p.m_packStringTable[entry.m_filenameOffset]);
+	}
+
+	return Error::NONE;
+}
+
+Error ResourceFilesystem::acquireArchiveFile(
+	Path& archive, const CString& filename, ArchiveEntry& entry, File*& file, Bool& found)
+{
+	ANKI_ASSERT(archive.m_isArchive);
+	file = nullptr;
+	found = false;
+
+	const ArchiveEntry* it = archive.findArchiveEntry(filename);
+	if(it == nullptr)
+	{
+		return Error::NONE;
+	}
+
+	found = true;
+
+	LockGuard<Mutex> lock(m_archiveMtx);
+
+	// Get an open file of the archive
+	if(archive.m_freeArchiveFiles.getSize())
+	{
+		file = archive.m_freeArchiveFiles.getBack();
+		archive.m_freeArchiveFiles.popBack(m_alloc);
+	}
+	else
+	{
+		File* newFile = m_alloc.newInstance<File>();
+		const Error err = newFile->open(archive.m_path.toCString(), FileOpenFlag::READ | FileOpenFlag::BINARY);
+		if(err)
+		{
+			m_alloc.deleteInstance(newFile);
+			return err;
+		}
+
+		file = newFile;
+	}
+
+	// First open of the file, find where its data start
+	if(it->m_dataOffset == MAX_U64)
+	{
+		const Error err = readArchiveDataOffset(*file, *it);
+		if(err)
+		{
+			archive.m_freeArchiveFiles.emplaceBack(m_alloc, file);
+			file = nullptr;
+			return err;
+		}
+	}
+
+	entry = *it;
+	return Error::NONE;
+}
+
+Error ResourceFilesystem::readArchiveDataOffset(File& file, const ArchiveEntry& entry)
+{
+	auto readU16 = [](const U8* p) -> U32 { return U32(p[0]) | (U32(p[1]) << 8u); };
+	auto readU32 = [](const U8* p) -> U64 {
+		return U64(p[0]) | (U64(p[1]) << 8u) | (U64(p[2]) << 16u) | (U64(p[3]) << 24u);
+	};
+	auto readU64 = [&](const U8* p) -> U64 { return readU32(p) | (readU32(p + 4) << 32u); };
+
+	// Read the record of the central directory
+	constexpr U32 CENTRAL_RECORD_SIZE = 46;
+	Array<U8, CENTRAL_RECORD_SIZE> central;
+	ANKI_CHECK(file.seek(entry.m_centralDirOffset, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(file.read(&central[0], central.getSize()));
+	if(readU32(&central[0]) != 0x02014b50)
+	{
+		ANKI_RESOURCE_LOGE("Wrong central directory signature: %s", entry.m_filename);
+		return Error::USER_DATA;
+	}
+
+	U64 localHeaderOffset = readU32(&central[42]);
+	if(localHeaderOffset == MAX_U32)
+	{
+		// ZIP64, the offset is in the extra field after the 64bit sizes that overflowed
+		const U32 filenameLen = readU16(&central[28]);
+		const U32 extraLen = readU16(&central[30]);
+		DynamicArrayAuto<U8> extra(m_alloc, extraLen);
+		if(extraLen)
+		{
+			ANKI_CHECK(file.seek(entry.m_centralDirOffset + CENTRAL_RECORD_SIZE + filenameLen,
+				FileSeekOrigin::BEGINNING));
+			ANKI_CHECK(file.read(&extra[0], extraLen));
+		}
+
+		Bool found = false;
+		U32 pos = 0;
+		while(!found && pos + 4 <= extraLen)
+		{
+			const U32 headerId = readU16(&extra[pos]);
+			const U32 dataSize = readU16(&extra[pos + 2]);
+			pos += 4;
+			if(headerId == 0x0001)
+			{
+				U32 fieldPos = pos;
+				fieldPos += (readU32(&central[24]) == MAX_U32) ? 8 : 0; // Uncompressed size
+				fieldPos += (readU32(&central[20]) == MAX_U32) ? 8 : 0; // Compressed size
+				if(fieldPos + 8 <= pos + dataSize && fieldPos + 8 <= extraLen)
+				{
+					localHeaderOffset = readU64(&extra[fieldPos]);
+					found = true;
+				}
+			}
+
+			pos += dataSize;
+		}
+
+		if(!found)
+		{
+			ANKI_RESOURCE_LOGE("Missing ZIP64 local header offset: %s", entry.m_filename);
+			return Error::USER_DATA;
+		}
+	}
+
+	// Read the local header. The data are after it and its variable sized fields
+	constexpr U32 LOCAL_HEADER_SIZE = 30;
+	Array<U8, LOCAL_HEADER_SIZE> local;
+	ANKI_CHECK(file.seek(localHeaderOffset, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(file.read(&local[0], local.getSize()));
+	if(readU32(&local[0]) != 0x04034b50)
+	{
+		ANKI_RESOURCE_LOGE("Wrong local header signature: %s", entry.m_filename);
+		return Error::USER_DATA;
+	}
+
+	entry.m_dataOffset = localHeaderOffset + LOCAL_HEADER_SIZE + readU16(&local[26]) + readU16(&local[28]);
+	return Error::NONE;
+}
+
+void ResourceFilesystem::releaseArchiveFile(Path& archive, File* file)
+{
+	ANKI_ASSERT(file);
+	LockGuard<Mutex> lock(m_archiveMtx);
+	archive.m_freeArchiveFiles.emplaceBack(m_alloc, file);
+}
+
+const ResourcePackBinary::Entry* ResourceFilesystem::Path::findPackEntry(const CString& filename) const
+{
+	ANKI_ASSERT(m_isPack);
+	const U64 hash = ResourcePackBinary::computeFilenameHash(filename);
+	const PtrSize filenameLen = filename.getLength();
+
+	auto it = std::lower_bound(m_packIndex.getBegin(),
+		m_packIndex.getEnd(),
+		hash,
+		[](const ResourcePackBinary::Entry& entry, U64 hash) { return entry.m_filenameHash < hash; });
+
+	for(; it != m_packIndex.getEnd() && it->m_filenameHash == hash; ++it)
+	{
+		if(it->m_filenameLength == filenameLen
+			&& memcmp(&m_packStringTable[it->m_filenameOffset], filename.cstr(), filenameLen) == 0)
+		{
+			return it;
+		}
+	}
+
+	return nullptr;
+}
+
+const ResourceFilesystem::ArchiveEntry* ResourceFilesystem::Path::findArchiveEntry(const CString& filename) const
+{
+	ANKI_ASSERT(m_isArchive);
+	auto it = m_archiveEntries.find(computeHash(filename.cstr(), filename.getLength()));
+
+	// The hashes of the archive's files are unique but a file that is not in the archive can have the same hash
+	return (it != m_archiveEntries.getEnd() && filename == it->m_filename) ? &(*it) : nullptr;
+}
+
+ResourceFilesystem::Path* ResourceFilesystem::findPath(const CString& filename)
+{
+	// Search for the fname in reverse order
+	for(Path& p : m_paths)
+	{
+		if(p.m_isCache)
+		{
+			StringAuto newFname(m_alloc);
+			newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
+
+			if(fileExists(newFname.toCString()))
+			{
+				return &p;
+			}
+		}
+		else if(p.m_isPack)
+		{
+			// In resource pack, use the index
+			if(p.findPackEntry(filename))
+			{
+				return &p;
+			}
+		}
+		else if(p.m_isArchive)
+		{
+			// In archive, use the cached central directory
+			if(p.findArchiveEntry(filename))
+			{
+				return &p;
+			}
+		}
+		else
+		{
+			// In data path
+			for(const String& pfname : p.m_files)
+			{
+				if(pfname == filename)
+				{
+					return &p;
+				}
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFilePtr& filePtr)
+{
+	{
+		LockGuard<Mutex> lock(m_openFileCallbackMtx);
+		if(m_openFileCallback)
+		{
+			m_openFileCallback(filename, m_openFileCallbackUserData);
+		}
+	}
+
+	// Check if it's already in memory
+	PrefetchedFile* prefetched = takePrefetchedFile(filename);
+	if(prefetched)
+	{
+		MemoryResourceFile* file = m_alloc.newInstance<MemoryResourceFile>(m_alloc);
+		file->m_data = std::move(prefetched->m_data);
+		prefetched->m_filename.destroy(m_alloc);
+		m_alloc.deleteInstance(prefetched);
+
+		filePtr.reset(file);
+		return Error::NONE;
+	}
+
+	return openFileInternal(filename, filePtr);
+}
+
+Error ResourceFilesystem::openFileInternal(const CString& filename, ResourceFilePtr& filePtr)
+{
+	Path* p = findPath(filename);
+	if(!p)
+	{
+		ANKI_RESOURCE_LOGE("File not found: %s", &filename[0]);
+		return Error::USER_DATA;
+	}
+
+	ResourceFile* rfile = nullptr;
+	Error err = Error::NONE;
+	if(p->m_isPack)
+	{
+		PackResourceFile* file = m_alloc.newInstance<PackResourceFile>(m_alloc);
+		rfile = file;
+
+		file->m_threadPool = m_packThreadPool;
+		file->m_threadPoolMtx = &m_packThreadPoolMtx;
+		err = file->open(p->m_path.toCString(), *p->findPackEntry(filename));
+	}
+	else if(p->m_isArchive)
+	{
+		ZipResourceFile* file = m_alloc.newInstance<ZipResourceFile>(m_alloc);
+		rfile = file;
+
+		err = file->open(*this, *p, filename);
+	}
+	else
+	{
+		// In data path or in cache
+		StringAuto newFname(m_alloc);
+		newFname.sprintf("%s/%s", &p->m_path[0], &filename[0]);
+
+		CResourceFile* file = m_alloc.newInstance<CResourceFile>(m_alloc);
+		rfile = file;
+
+		err = file->m_file.open(&newFname[0], FileOpenFlag::READ);
+	}
+
+	if(err)
+	{
+		m_alloc.deleteInstance(rfile);
+		return err;
+	}
+
+	// Done
+	filePtr.reset(rfile);
+	return Error::NONE;
+}
+
+Error ResourceFilesystem::getFileTimestamp(const ResourceFilename& filename, U64& timestamp)
+{
+	const Path* p = findPath(filename);
+	if(!p)
+	{
+		ANKI_RESOURCE_LOGE("File not found: %s", &filename[0]);
+		return Error::USER_DATA;
+	}
+
+	StringAuto fullFname(m_alloc);
+	if(p->m_isPack || p->m_isArchive)
+	{
+		fullFname.create(p->m_path.toCString());
+	}
+	else
+	{
+		fullFname.sprintf("%s/%s", &p->m_path[0], &filename[0]);
+	}
+
+	ANKI_CHECK(getFileModificationTime(fullFname.toCString(), timestamp));
+	return Error::NONE;
+}
+
+void ResourceFilesystem::setOpenFileCallback(ResourceFilesystemOpenFileCallback callback, void* userData)
+{
+	LockGuard<Mutex> lock(m_openFileCallbackMtx);
+	m_openFileCallback = callback;
+	m_openFileCallbackUserData = userData;
+}
+
+class ResourceFilesystem::PrefetchTask : public ThreadPoolTask
+{
+public:
+	ResourceFilesystem* m_fs = nullptr;
+
+	Error operator()(U32 taskId, PtrSize threadsCount) override
+	{
+		m_fs->prefetchQueuedFiles();
+		return Error::NONE;
+	}
+};
+
+ResourceFilesystem::PrefetchedFile* ResourceFilesystem::takePrefetchedFile(const CString& filename)
+{
+	const U64 hash = computeHash(filename.cstr(), filename.getLength());
+
+	LockGuard<Mutex> lock(m_prefetchMtx);
+
+	while(true)
+	{
+		auto it = m_prefetchedFiles.find(hash);
+		if(it == m_prefetchedFiles.getEnd() || (*it)->m_filename != filename)
+		{
+			return nullptr;
+		}
+
+		PrefetchedFile* file = *it;
+		if(file->m_state == PrefetchedFile::State::READING)
+		{
+			// It will be ready soon, wait for it instead of reading it twice
+			m_prefetchCondVar.wait(m_prefetchMtx);
+			continue;
+		}
+
+		m_prefetchedFiles.erase(m_alloc, it);
+
+		if(file->m_state == PrefetchedFile::State::QUEUED)
+		{
+			// The threads didn't get to it yet. Read it from the disk and don't let the threads read it
+			file->m_filename.destroy(m_alloc);
+			m_alloc.deleteInstance(file);
+			return nullptr;
+		}
+
+		// Make room for more files
+		ANKI_ASSERT(m_prefetchedBytes >= file->m_data.getSize());
+		m_prefetchedBytes -= file->m_data.getSize();
+		m_prefetchCondVar.notifyAll();
+		return file;
+	}
+}
+
+void ResourceFilesystem::prefetchQueuedFiles()
+{
+	ANKI_TRACE_SCOPED_EVENT(RSRC_FILE_READ);
+
+	while(true)
+	{
+		// Get the next file that no one opened yet. Copy the name since openFile() can delete QUEUED files
+		StringAuto filename(m_alloc);
+		U64 hash = 0;
+		{
+			LockGuard<Mutex> lock(m_prefetchMtx);
+
+			while(!m_stopPrefetching && m_prefetchQueuePos < m_prefetchQueue.getSize())
+			{
+				hash = m_prefetchQueue[m_prefetchQueuePos++];
+				auto it = m_prefetchedFiles.find(hash);
+				if(it != m_prefetchedFiles.getEnd() && (*it)->m_state == PrefetchedFile::State::QUEUED)
+				{
+					filename.create((*it)->m_filename.toCString());
+					break;
+				}
+			}
+
+			if(filename.isEmpty())
+			{
+				return;
+			}
+		}
+
+		ResourceFilePtr file;
+		const Error openErr = openFileInternal(filename.toCString(), file);
+
+		// Wait until there is room. Always let one file in or a file larger than the budget would block forever
+		PrefetchedFile* prefetched = nullptr;
+		const PtrSize size = (openErr) ? 0 : file->getSize();
+		{
+			LockGuard<Mutex> lock(m_prefetchMtx);
+
+			while(!m_stopPrefetching && m_prefetchedBytes > 0 && m_prefetchedBytes + size > m_prefetchMemoryBudget)
+			{
+				m_prefetchCondVar.wait(m_prefetchMtx);
+			}
+
+			auto it = m_prefetchedFiles.find(hash);
+			if(m_stopPrefetching || it == m_prefetchedFiles.getEnd()
+			   || (*it)->m_state != PrefetchedFile::State::QUEUED)
+			{
+				// Stopped or someone opened it while waiting
+				continue;
+			}
+
+			prefetched = *it;
+
+			if(openErr)
+			{
+				// Let openFile() read it and report the error
+				m_prefetchedFiles.erase(m_alloc, it);
+				prefetched->m_filename.destroy(m_alloc);
+				m_alloc.deleteInstance(prefetched);
+				m_prefetchCondVar.notifyAll();
+				continue;
+			}
+
+			prefetched->m_state = PrefetchedFile::State::READING;
+			m_prefetchedBytes += size;
+		}
+
+		// Read it outside the lock. No one touches the file while it's READING
+		Error err = Error::NONE;
+		if(size > 0)
+		{
+			prefetched->m_data.create(m_alloc, U32(size));
+			err = file->read(&prefetched->m_data[0], size);
+		}
+
+		LockGuard<Mutex> lock(m_prefetchMtx);
+		auto it = m_prefetchedFiles.find(hash);
+		ANKI_ASSERT(it != m_prefetchedFiles.getEnd() && *it == prefetched);
+		if(err)
+		{
+			m_prefetchedFiles.erase(m_alloc, it);
+			m_prefetchedBytes -= size;
+			prefetched->m_filename.destroy(m_alloc);
+			prefetched->m_data.destroy(m_alloc);
+			m_alloc.deleteInstance(prefetched);
+		}
+		else
+		{
+			prefetched->m_state = PrefetchedFile::State::READY;
+		}
+
+		m_prefetchCondVar.notifyAll();
+	}
+}
+
+void ResourceFilesystem::prefetchFiles(ConstWeakArray<CString> filenames)
+{
+	dropPrefetchedFiles();
+
+	if(filenames.getSize() == 0)
+	{
+		return;
+	}
+
+	{
+		LockGuard<Mutex> lock(m_prefetchMtx);
+
+		m_prefetchQueue.create(m_alloc, filenames.getSize());
+		U32 count = 0;
+		for(CString filename : filenames)
+		{
+			const U64 hash = computeHash(filename.cstr(), filename.getLength());
+			if(m_prefetchedFiles.find(hash) != m_prefetchedFiles.getEnd())
+			{
+				// Already there or a hash collision, skip
+				continue;
+			}
+
+			PrefetchedFile* file = m_alloc.newInstance<PrefetchedFile>();
+			file->m_filename.create(m_alloc, filename);
+			m_prefetchedFiles.emplace(m_alloc, hash, file);
+			m_prefetchQueue[count++] = hash;
+		}
+
+		m_prefetchQueue.resize(m_alloc, count);
+	}
+
+	m_prefetchTask = m_alloc.newInstance<PrefetchTask>();
+	m_prefetchTask->m_fs = this;
+
+	m_prefetchThreadPool = m_alloc.newInstance<ThreadPool>(max(1u, min(m_prefetchThreadCount, filenames.getSize())));
+	for(U32 i = 0; i < m_prefetchThreadPool->getThreadCount(); ++i)
+	{
+		m_prefetchThreadPool->assignNewTask(i, m_prefetchTask);
+	}
+}
+
+void ResourceFilesystem::dropPrefetchedFiles()
+{
+	if(m_prefetchThreadPool)
+	{
+		{
+			LockGuard<Mutex> lock(m_prefetchMtx);
+			m_stopPrefetching = true;
+			m_prefetchCondVar.notifyAll();
+		}
+
+		// The task never fails
+		const Error err = m_prefetchThreadPool->waitForAllThreadsToFinish();
+		(void)err;
+
+		m_alloc.deleteInstance(m_prefetchThreadPool);
+		m_prefetchThreadPool = nullptr;
+		m_alloc.deleteInstance(m_prefetchTask);
+		m_prefetchTask = nullptr;
+	}
+
+	LockGuard<Mutex> lock(m_prefetchMtx);
+
+	for(PrefetchedFile* file : m_prefetchedFiles)
+	{
+		file->m_filename.destroy(m_alloc);
+		file->m_data.destroy(m_alloc);
+		m_alloc.deleteInstance(file);
+	}
+
+	m_prefetchedFiles.destroy(m_alloc);
+	m_prefetchQueue.destroy(m_alloc);
+	m_prefetchQueuePos = 0;
+	m_prefetchedBytes = 0;
+	m_stopPrefetching = false;
 }
 
 } // end namespace anki
@@ -6,16 +6,21 @@
 #pragma once
 
 #include <anki/resource/Common.h>
+#include <anki/resource/ResourcePack.h>
 #include <anki/util/String.h>
 #include <anki/util/StringList.h>
 #include <anki/util/File.h>
 #include <anki/util/Ptr.h>
+#include <anki/util/Thread.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
 
 // Forward
 class ConfigSet;
+class ThreadPool;
 
 /// @addtogroup resource
 /// @{
@@ -71,6 +76,9 @@ private:
 /// Resource file smart pointer.
 using ResourceFilePtr = IntrusivePtr<ResourceFile>;
 
+/// The function that ResourceFilesystem::openFile() calls for every file it opens.
+using ResourceFilesystemOpenFileCallback = void (*)(CString filename, void* userData);
+
 /// Resource filesystem.
 class ResourceFilesystem : public NonCopyable
 {
@@ -87,6 +95,29 @@ public:
 	/// Search the path list to find the file. Then open the file for reading. It's thread-safe.
 	ANKI_USE_RESULT Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
+	/// Check if a file exists in any of the paths. It's thread-safe.
+	Bool hasFile(const ResourceFilename& filename)
+	{
+		return findPath(filename) != nullptr;
+	}
+
+	/// Get the time a file was last modified, in nanoseconds. For files inside archives or packs it's the time of the
+	/// archive. It's thread-safe.
+	ANKI_USE_RESULT Error getFileTimestamp(const ResourceFilename& filename, U64& timestamp);
+
+	/// Set a function that openFile() will call for every file it opens. It's called in the thread that opens the file.
+	/// Pass nullptr to remove it. It's thread-safe.
+	void setOpenFileCallback(ResourceFilesystemOpenFileCallback callback, void* userData);
+
+	/// Start reading a number of files to memory in background threads, in the order they are given. The first
+	/// openFile() of any of them will not touch the disk. The files that are read but not opened yet can't take more
+	/// than the rsrc_prefetchMemoryBudget. The reads continue as openFile() takes them. It replaces the files of the
+	/// previous call.
+	void prefetchFiles(ConstWeakArray<CString> filenames);
+
+	/// Stop the background reads and free the prefetched files that no one opened.
+	void dropPrefetchedFiles();
+
 	/// Iterate all the filenames from all paths provided.
 	template<typename TFunc>
 	ANKI_USE_RESULT Error iterateAllFilenames(TFunc func) const
@@ -104,12 +135,31 @@ public:
 #if !ANKI_TESTS
 private:
 #endif
+	/// Cached central directory information of a file inside a zip archive. Only m_dataOffset changes after the archive
+	/// is added and it's accessed under m_archiveMtx. The rest can be read without locking.
+	class ArchiveEntry
+	{
+	public:
+		const char* m_filename = nullptr; ///< Points to a string of Path::m_files.
+		U64 m_centralDirOffset = 0; ///< The offset of the file's record in the central directory.
+		/// The offset of the file data in the archive. It's resolved on the first open of the file.
+		mutable U64 m_dataOffset = MAX_U64;
+		U64 m_compressedSize = 0;
+		U64 m_size = 0;
+		Bool m_deflated = false;
+	};
+
 	class Path : public NonCopyable
 	{
 	public:
 		StringList m_files; ///< Files inside the directory.
 		String m_path; ///< A directory or an archive.
+		HashMap<U64, ArchiveEntry> m_archiveEntries; ///< The central directory of an archive. Key is the filename hash.
+		DynamicArray<File*> m_freeArchiveFiles; ///< Open files of an archive that are not in use.
+		DynamicArray<ResourcePackBinary::Entry> m_packIndex; ///< The index of a resource pack.
+		DynamicArray<char> m_packStringTable; ///< The filenames of a resource pack.
 		Bool m_isArchive = false;
+		Bool m_isPack = false;
 		Bool m_isCache = false;
 
 		Path() = default;
@@ -117,7 +167,12 @@ private:
 		Path(Path&& b)
 			: m_files(std::move(b.m_files))
 			, m_path(std::move(b.m_path))
+			, m_archiveEntries(std::move(b.m_archiveEntries))
+			, m_freeArchiveFiles(std::move(b.m_freeArchiveFiles))
+			, m_packIndex(std::move(b.m_packIndex))
+			, m_packStringTable(std::move(b.m_packStringTable))
 			, m_isArchive(std::move(b.m_isArchive))
+			, m_isPack(std::move(b.m_isPack))
 			, m_isCache(std::move(b.m_isCache))
 		{
 		}
@@ -126,20 +181,100 @@ private:
 		{
 			m_files = std::move(b.m_files);
 			m_path = std::move(b.m_path);
+			m_archiveEntries = std::move(b.m_archiveEntries);
+			m_freeArchiveFiles = std::move(b.m_freeArchiveFiles);
+			m_packIndex = std::move(b.m_packIndex);
+			m_packStringTable = std::move(b.m_packStringTable);
 			m_isArchive = std::move(b.m_isArchive);
+			m_isPack = std::move(b.m_isPack);
 			m_isCache = std::move(b.m_isCache);
 			return *this;
 		}
+
+		/// Find a file in the index of a resource pack.
+		const ResourcePackBinary::Entry* findPackEntry(const CString& filename) const;
+
+		/// Find a file in the central directory of an archive.
+		const ArchiveEntry* findArchiveEntry(const CString& filename) const;
 	};
 
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	List<Path> m_paths;
 	String m_cacheDir;
 
+	Mutex m_archiveMtx; ///< Protects the open files of the archives.
+
+	ThreadPool* m_packThreadPool = nullptr; ///< Used to decompress the blocks of resource pack entries.
+	Mutex m_packThreadPoolMtx;
+
+	/// A file of prefetchFiles().
+	class PrefetchedFile
+	{
+	public:
+		enum class State : U8
+		{
+			QUEUED,
+			READING,
+			READY
+		};
+
+		String m_filename;
+		DynamicArray<U8> m_data;
+		State m_state = State::QUEUED;
+	};
+
+	class PrefetchTask;
+
+	/// @name Prefetching. Protected by m_prefetchMtx
+	/// @{
+	HashMap<U64, PrefetchedFile*> m_prefetchedFiles; ///< Key is the filename hash.
+	DynamicArray<U64> m_prefetchQueue; ///< The filename hashes in the order they are read.
+	U32 m_prefetchQueuePos = 0;
+	PtrSize m_prefetchedBytes = 0; ///< The bytes of the files that are read or being read but no one took.
+	Bool m_stopPrefetching = false;
+	Mutex m_prefetchMtx;
+	ConditionVariable m_prefetchCondVar;
+	/// @}
+
+	ThreadPool* m_prefetchThreadPool = nullptr;
+	PrefetchTask* m_prefetchTask = nullptr;
+	U32 m_prefetchThreadCount = 0;
+	PtrSize m_prefetchMemoryBudget = 0;
+
+	ResourceFilesystemOpenFileCallback m_openFileCallback = nullptr;
+	void* m_openFileCallbackUserData = nullptr;
+	Mutex m_openFileCallbackMtx;
+
 	/// Add a filesystem path or an archive. The path is read-only.
 	ANKI_USE_RESULT Error addNewPath(const CString& path);
 
+	/// Add an AnKi resource pack. Loads its index.
+	ANKI_USE_RESULT Error addNewPack(const CString& path);
+
+	/// Get the entry of an archived file and an open handle of the archive. Release the file with releaseArchiveFile.
+	ANKI_USE_RESULT Error acquireArchiveFile(
+		Path& archive, const CString& filename, ArchiveEntry& entry, File*& file, Bool& found);
+
+	/// Parse the central directory record and the local header of an archived file to find where its data start.
+	ANKI_USE_RESULT Error readArchiveDataOffset(File& file, const ArchiveEntry& entry);
+
+	/// Return an archive file to the pool.
+	void releaseArchiveFile(Path& archive, File* file);
+
 	void addCachePath(const CString& path);
+
+	/// Get a prefetched file and remove it from the prefetched files. Returns nullptr if it wasn't prefetched. If it's
+	/// being read it waits for it.
+	PrefetchedFile* takePrefetchedFile(const CString& filename);
+
+	/// The work of the prefetch threads. Reads the queued files until the queue is empty or dropPrefetchedFiles().
+	void prefetchQueuedFiles();
+
+	/// openFile() without the callback and the prefetched files.
+	ANKI_USE_RESULT Error openFileInternal(const CString& filename, ResourceFilePtr& file);
+
+	/// Find the path that contains a file.
+	Path* findPath(const CString& filename);
 };
 /// @}
 
@@ -0,0 +1,204 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourceLoadPlan.h>
+#include <anki/util/File.h>
+#include <anki/util/Logger.h>
+#include <anki/util/Hash.h>
+#include <algorithm>
+
+namespace anki
+{
+
+U32 ResourceLoadPlan::addString(CString str)
+{
+	const U32 offset = m_stringTable.getSize();
+	const U32 length = str.getLength();
+	m_stringTable.resize(offset + length + 1);
+	memcpy(&m_stringTable[offset], str.cstr(), length + 1);
+	return offset;
+}
+
+U32 ResourceLoadPlan::addResource(CString filename, U32 parent)
+{
+	ANKI_ASSERT(parent == MAX_U32 || parent < m_resources.getSize());
+
+	ResourceLoadPlanBinary::Resource& rsrc = *m_resources.emplaceBack();
+	rsrc.m_parent = parent;
+	rsrc.m_filenameOffset = addString(filename);
+	return m_resources.getSize() - 1;
+}
+
+void ResourceLoadPlan::addFile(CString filename, U32 resource)
+{
+	ANKI_ASSERT(resource == MAX_U32 || resource < m_resources.getSize());
+
+	const U64 hash = computeHash(filename.cstr(), filename.getLength());
+	if(m_fileIndices.find(hash) != m_fileIndices.getEnd())
+	{
+		return;
+	}
+
+	m_fileIndices.emplace(hash, m_files.getSize());
+
+	ResourceLoadPlanBinary::File& file = *m_files.emplaceBack();
+	file.m_timestamp = 0;
+	file.m_filenameOffset = addString(filename);
+	file.m_resource = resource;
+}
+
+void ResourceLoadPlan::sortFiles()
+{
+	std::sort(m_files.getBegin(),
+		m_files.getEnd(),
+		[this](const ResourceLoadPlanBinary::File& a, const ResourceLoadPlanBinary::File& b) -> Bool {
+			if(a.m_resource != b.m_resource)
+			{
+				return a.m_resource < b.m_resource;
+			}
+
+			return strcmp(&m_stringTable[a.m_filenameOffset], &m_stringTable[b.m_filenameOffset]) < 0;
+		});
+
+	// The indices changed
+	m_fileIndices.destroy();
+	for(U32 i = 0; i < m_files.getSize(); ++i)
+	{
+		const CString filename = getFileFilename(i);
+		m_fileIndices.emplace(computeHash(filename.cstr(), filename.getLength()), i);
+	}
+}
+
+Error ResourceLoadPlan::load(CString filename)
+{
+	ANKI_ASSERT(m_resources.getSize() == 0 && m_files.getSize() == 0 && "Already loaded");
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	ResourceLoadPlanBinary::Header header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+
+	if(memcmp(&header.m_magic[0], ResourceLoadPlanBinary::MAGIC, sizeof(header.m_magic)) != 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong magic word: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	const PtrSize expectedSize = sizeof(header) + header.m_resourceCount * sizeof(ResourceLoadPlanBinary::Resource)
+								 + header.m_fileCount * sizeof(ResourceLoadPlanBinary::File)
+								 + header.m_stringTableSize;
+	if(file.getSize() != expectedSize)
+	{
+		ANKI_RESOURCE_LOGE("Unexpected file size: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	if(header.m_resourceCount)
+	{
+		m_resources.create(header.m_resourceCount);
+		ANKI_CHECK(file.read(&m_resources[0], m_resources.getSizeInBytes()));
+	}
+
+	if(header.m_fileCount)
+	{
+		m_files.create(header.m_fileCount);
+		ANKI_CHECK(file.read(&m_files[0], m_files.getSizeInBytes()));
+	}
+
+	if(header.m_stringTableSize)
+	{
+		m_stringTable.create(header.m_stringTableSize);
+		ANKI_CHECK(file.read(&m_stringTable[0], m_stringTable.getSizeInBytes()));
+	}
+
+	// Checks. A level that loads nothing has an empty plan
+	if(m_stringTable.getSize() > 0 && m_stringTable.getBack() != '\0')
+	{
+		ANKI_RESOURCE_LOGE("Wrong string table: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	for(U32 i = 0; i < m_resources.getSize(); ++i)
+	{
+		const ResourceLoadPlanBinary::Resource& rsrc = m_resources[i];
+		if((rsrc.m_parent != MAX_U32 && rsrc.m_parent >= i) || rsrc.m_filenameOffset >= m_stringTable.getSize())
+		{
+			ANKI_RESOURCE_LOGE("Wrong resource info: %s", filename.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	for(const ResourceLoadPlanBinary::File& f : m_files)
+	{
+		if(f.m_filenameOffset >= m_stringTable.getSize()
+		   || (f.m_resource != MAX_U32 && f.m_resource >= m_resources.getSize()))
+		{
+			ANKI_RESOURCE_LOGE("Wrong file info: %s", filename.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error ResourceLoadPlan::save(CString filename) const
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	ResourceLoadPlanBinary::Header header = {};
+	memcpy(&header.m_magic[0], ResourceLoadPlanBinary::MAGIC, sizeof(header.m_magic));
+	header.m_resourceCount = m_resources.getSize();
+	header.m_fileCount = m_files.getSize();
+	header.m_stringTableSize = m_stringTable.getSize();
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	if(m_resources.getSize())
+	{
+		ANKI_CHECK(file.write(&m_resources[0], m_resources.getSizeInBytes()));
+	}
+
+	if(m_files.getSize())
+	{
+		ANKI_CHECK(file.write(&m_files[0], m_files.getSizeInBytes()));
+	}
+
+	if(m_stringTable.getSize())
+	{
+		ANKI_CHECK(file.write(&m_stringTable[0], m_stringTable.getSizeInBytes()));
+	}
+
+	return Error::NONE;
+}
+
+Bool ResourceLoadPlan::operator==(const ResourceLoadPlan& b) const
+{
+	if(getResourceCount() != b.getResourceCount() || getFileCount() != b.getFileCount())
+	{
+		return false;
+	}
+
+	for(U32 i = 0; i < getResourceCount(); ++i)
+	{
+		if(getResourceParent(i) != b.getResourceParent(i) || getResourceFilename(i) != b.getResourceFilename(i))
+		{
+			return false;
+		}
+	}
+
+	for(U32 i = 0; i < getFileCount(); ++i)
+	{
+		if(getFileTimestamp(i) != b.getFileTimestamp(i) || getFileResource(i) != b.getFileResource(i)
+		   || getFileFilename(i) != b.getFileFilename(i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // end namespace anki
@@ -0,0 +1,140 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/String.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// Information to decode the load plan files (.ankiloadplan). The layout of the file is:
+/// - ResourceLoadPlanBinary::Header
+/// - An array of ResourceLoadPlanBinary::Resource in the order they were loaded.
+/// - An array of ResourceLoadPlanBinary::File sorted by resource.
+/// - String table. All the filenames, null terminated.
+class ResourceLoadPlanBinary
+{
+public:
+	static constexpr const char* MAGIC = "ANKILDP2";
+	static constexpr const char* EXTENSION = ".ankiloadplan";
+
+	struct Header
+	{
+		char m_magic[8]; ///< Magic word.
+		U32 m_resourceCount;
+		U32 m_fileCount;
+		U32 m_stringTableSize;
+		U32 _padding;
+	};
+
+	/// A node of the dependency graph.
+	struct Resource
+	{
+		U32 m_parent; ///< The resource that loaded this one. MAX_U32 if it was loaded directly.
+		U32 m_filenameOffset; ///< Offset in the string table.
+	};
+
+	/// A file that the resources read.
+	struct File
+	{
+		U64 m_timestamp; ///< The modification time of the file when the plan was recorded.
+		U32 m_filenameOffset; ///< Offset in the string table.
+		U32 m_resource; ///< The resource that opened the file first. MAX_U32 if it was opened outside a resource load.
+	};
+};
+
+/// The resources a level loads, the dependencies between them and the files they read. The ResourceManager records it
+/// the first time a level loads and uses it the next times to read all the files in parallel before they are needed.
+class ResourceLoadPlan
+{
+public:
+	ResourceLoadPlan(GenericMemoryPoolAllocator<U8> alloc)
+		: m_resources(alloc)
+		, m_files(alloc)
+		, m_stringTable(alloc)
+		, m_fileIndices(alloc)
+	{
+	}
+
+	/// Add a node to the dependency graph.
+	/// @param filename The filename of the resource.
+	/// @param parent The index of the resource that loads this one or MAX_U32.
+	/// @return The index of the new resource.
+	U32 addResource(CString filename, U32 parent);
+
+	/// Add a file the resources read. Files that are already in the plan are skipped.
+	/// @param filename The filename of the file.
+	/// @param resource The index of the resource that reads it or MAX_U32.
+	void addFile(CString filename, U32 resource);
+
+	void setFileTimestamp(U32 idx, U64 timestamp)
+	{
+		m_files[idx].m_timestamp = timestamp;
+	}
+
+	/// Sort the files by the resource that read them and then by name. The order the files are opened might differ
+	/// between runs.
+	void sortFiles();
+
+	ANKI_USE_RESULT Error load(CString filename);
+
+	ANKI_USE_RESULT Error save(CString filename) const;
+
+	U32 getResourceCount() const
+	{
+		return m_resources.getSize();
+	}
+
+	CString getResourceFilename(U32 idx) const
+	{
+		return &m_stringTable[m_resources[idx].m_filenameOffset];
+	}
+
+	U32 getResourceParent(U32 idx) const
+	{
+		return m_resources[idx].m_parent;
+	}
+
+	U32 getFileCount() const
+	{
+		return m_files.getSize();
+	}
+
+	CString getFileFilename(U32 idx) const
+	{
+		return &m_stringTable[m_files[idx].m_filenameOffset];
+	}
+
+	U64 getFileTimestamp(U32 idx) const
+	{
+		return m_files[idx].m_timestamp;
+	}
+
+	U32 getFileResource(U32 idx) const
+	{
+		return m_files[idx].m_resource;
+	}
+
+	/// Check if two plans have the same resources and read the same files.
+	Bool operator==(const ResourceLoadPlan& b) const;
+
+private:
+	DynamicArrayAuto<ResourceLoadPlanBinary::Resource> m_resources;
+	DynamicArrayAuto<ResourceLoadPlanBinary::File> m_files;
+	DynamicArrayAuto<char> m_stringTable;
+	HashMapAuto<U64, U32> m_fileIndices; ///< The filename hashes of the files added with addFile(). Not serialized.
+
+	U32 addString(CString str);
+};
+/// @}
+
+} // end namespace anki
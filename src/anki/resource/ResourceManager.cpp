@@ -6,7 +6,10 @@
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/AsyncLoader.h>
 #include <anki/resource/AnimationResource.h>
+#include <anki/resource/ResourceLoadPlan.h>
+#include <anki/resource/ShaderProgramResourceSystem.h>
 #include <anki/util/Logger.h>
+#include <anki/util/Filesystem.h>
 #include <anki/core/ConfigSet.h>
 
 #include <anki/resource/MaterialResource.h>
@@ -24,15 +27,21 @@
 namespace anki
 {
 
+/// The load plan index of the resource that the thread is loading. The resources it loads while loading it become its
+/// children. Every thread has its own since resources load in parallel.
+static thread_local U32 g_loadPlanParent = MAX_U32;
+
 ResourceManager::ResourceManager()
 {
 }
 
 ResourceManager::~ResourceManager()
 {
+	destroyLoadPlans();
 	m_cacheDir.destroy(m_alloc);
 	m_alloc.deleteInstance(m_asyncLoader);
 	m_alloc.deleteInstance(m_transferGpuAlloc);
+	m_alloc.deleteInstance(m_shaderProgramSystem);
 }
 
 Error ResourceManager::init(ResourceManagerInitInfo& init)
@@ -49,6 +58,7 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	// Init some constants
 	m_maxTextureSize = init.m_config->getNumberU32("rsrc_maxTextureSize");
 	m_dumpShaderSource = init.m_config->getBool("rsrc_dumpShaderSources");
+	m_useLoadPlans = init.m_config->getBool("rsrc_useLoadPlans");
 
 	// Init type resource managers
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) TypeResourceManager<rsrc_>::init(m_alloc);
@@ -64,6 +74,10 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	m_transferGpuAlloc = m_alloc.newInstance<TransferGpuAllocator>();
 	ANKI_CHECK(m_transferGpuAlloc->init(init.m_config->getNumberU32("rsrc_transferScratchMemorySize"), m_gr, m_alloc));
 
+	m_shaderProgramSystem =
+		m_alloc.newInstance<ShaderProgramResourceSystem>(m_cacheDir.toCString(), m_gr, m_fs, m_alloc);
+	ANKI_CHECK(m_shaderProgramSystem->init(*init.m_config));
+
 	return Error::NONE;
 }
 
@@ -93,6 +107,19 @@ Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out
 		T* ptr = m_alloc.newInstance<T>(this);
 		ANKI_ASSERT(ptr->getRefcount().load() == 0);
 
+		// Add it to the load plan. Resources that this one loads will be its children
+		const U32 prevLoadPlanParent = g_loadPlanParent;
+		{
+			LockGuard<Mutex> lock(m_loadPlanMtx);
+			if(m_recordedPlan)
+			{
+				// The parent might belong to a previous plan if the load started before the plan
+				const U32 parent =
+					(prevLoadPlanParent < m_recordedPlan->getResourceCount()) ? prevLoadPlanParent : MAX_U32;
+				g_loadPlanParent = m_recordedPlan->addResource(filename, parent);
+			}
+		}
+
 		// Populate the ptr. Use a block to cleanup temp_pool allocations
 		auto& pool = m_tmpAlloc.getMemoryPool();
 
@@ -101,6 +128,9 @@ Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out
 			(void)allocsCountBefore;
 
 			err = ptr->load(filename, async);
+
+			g_loadPlanParent = prevLoadPlanParent;
+
 			if(err)
 			{
 				ANKI_RESOURCE_LOGE("Failed to load resource: %s", &filename[0]);
@@ -129,6 +159,194 @@ Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out
 	return err;
 }
 
+Error ResourceManager::beginLoadPlan(CString name)
+{
+	ANKI_ASSERT(!m_recordedPlan && "Forgot to call endLoadPlan()");
+
+	if(!m_useLoadPlans)
+	{
+		return Error::NONE;
+	}
+
+	m_loadPlanFilename.sprintf(m_alloc, "%s/%s%s", m_cacheDir.cstr(), name.cstr(), ResourceLoadPlanBinary::EXTENSION);
+
+	// Use the plan of the previous run
+	if(fileExists(m_loadPlanFilename.toCString()))
+	{
+		ResourceLoadPlan* replayedPlan = m_alloc.newInstance<ResourceLoadPlan>(m_alloc);
+
+		if(replayedPlan->load(m_loadPlanFilename.toCString()))
+		{
+			ANKI_RESOURCE_LOGI("Load plan is corrupted and will be recorded again: %s", m_loadPlanFilename.cstr());
+			m_alloc.deleteInstance(replayedPlan);
+		}
+		else
+		{
+			prefetchLoadPlanFiles(*replayedPlan);
+
+			LockGuard<Mutex> lock(m_loadPlanMtx);
+			m_replayedPlan = replayedPlan;
+		}
+	}
+
+	// Start recording
+	{
+		LockGuard<Mutex> lock(m_loadPlanMtx);
+		m_recordedPlan = m_alloc.newInstance<ResourceLoadPlan>(m_alloc);
+	}
+
+	m_fs->setOpenFileCallback(
+		[](CString filename, void* userData) { static_cast<ResourceManager*>(userData)->recordOpenedFile(filename); },
+		this);
+
+	return Error::NONE;
+}
+
+void ResourceManager::prefetchLoadPlanFiles(const ResourceLoadPlan& plan)
+{
+	// A resource is stale if any of its files changed. The resources it loads are stale as well since they might not
+	// be the same anymore. The parents come before their children so one pass is enough
+	DynamicArrayAuto<Bool> staleResources(m_alloc);
+	staleResources.create(plan.getResourceCount(), false);
+	DynamicArrayAuto<Bool> changedFiles(m_alloc);
+	changedFiles.create(plan.getFileCount(), false);
+
+	for(U32 i = 0; i < plan.getFileCount(); ++i)
+	{
+		U64 timestamp;
+		if(m_fs->getFileTimestamp(plan.getFileFilename(i), timestamp) || timestamp != plan.getFileTimestamp(i))
+		{
+			changedFiles[i] = true;
+
+			const U32 rsrc = plan.getFileResource(i);
+			if(rsrc != MAX_U32)
+			{
+				staleResources[rsrc] = true;
+			}
+		}
+	}
+
+	U32 staleResourceCount = 0;
+	for(U32 i = 0; i < plan.getResourceCount(); ++i)
+	{
+		const U32 parent = plan.getResourceParent(i);
+		if(parent != MAX_U32 && staleResources[parent])
+		{
+			staleResources[i] = true;
+		}
+
+		staleResourceCount += staleResources[i];
+	}
+
+	// Prefetch the rest in the order the resources loaded
+	DynamicArrayAuto<CString> filenames(m_alloc);
+	filenames.create(plan.getFileCount());
+	U32 count = 0;
+	for(U32 i = 0; i < plan.getFileCount(); ++i)
+	{
+		const U32 rsrc = plan.getFileResource(i);
+		if(!changedFiles[i] && (rsrc == MAX_U32 || !staleResources[rsrc]))
+		{
+			filenames[count++] = plan.getFileFilename(i);
+		}
+	}
+
+	m_fs->prefetchFiles(ConstWeakArray<CString>((count) ? &filenames[0] : nullptr, count));
+
+	ANKI_RESOURCE_LOGI("Using load plan %s. Prefetching %u of %u files. %u of %u resources changed",
+		m_loadPlanFilename.cstr(),
+		count,
+		plan.getFileCount(),
+		staleResourceCount,
+		plan.getResourceCount());
+}
+
+void ResourceManager::recordOpenedFile(CString filename)
+{
+	LockGuard<Mutex> lock(m_loadPlanMtx);
+	if(m_recordedPlan)
+	{
+		// The files that are opened outside of a resource load (eg in the async loader) have no resource
+		const U32 rsrc = (g_loadPlanParent < m_recordedPlan->getResourceCount()) ? g_loadPlanParent : MAX_U32;
+		m_recordedPlan->addFile(filename, rsrc);
+	}
+}
+
+Error ResourceManager::endLoadPlan()
+{
+	if(!m_useLoadPlans)
+	{
+		return Error::NONE;
+	}
+
+	ANKI_ASSERT(g_loadPlanParent == MAX_U32);
+
+	// Stop recording. Loads that are still in flight in other threads will not touch the plans after this
+	m_fs->setOpenFileCallback(nullptr, nullptr);
+
+	ResourceLoadPlan* recordedPlan;
+	ResourceLoadPlan* replayedPlan;
+	{
+		LockGuard<Mutex> lock(m_loadPlanMtx);
+		recordedPlan = m_recordedPlan;
+		m_recordedPlan = nullptr;
+		replayedPlan = m_replayedPlan;
+		m_replayedPlan = nullptr;
+	}
+
+	m_fs->dropPrefetchedFiles();
+
+	Error err = Error::NONE;
+	if(recordedPlan)
+	{
+		recordedPlan->sortFiles();
+
+		for(U32 i = 0; i < recordedPlan->getFileCount(); ++i)
+		{
+			U64 timestamp;
+			err = m_fs->getFileTimestamp(recordedPlan->getFileFilename(i), timestamp);
+			if(err)
+			{
+				break;
+			}
+
+			recordedPlan->setFileTimestamp(i, timestamp);
+		}
+
+		if(!err && (!replayedPlan || !(*replayedPlan == *recordedPlan)))
+		{
+			err = recordedPlan->save(m_loadPlanFilename.toCString());
+			if(!err)
+			{
+				ANKI_RESOURCE_LOGI("Saved load plan %s. It has %u files of %u resources",
+					m_loadPlanFilename.cstr(),
+					recordedPlan->getFileCount(),
+					recordedPlan->getResourceCount());
+			}
+		}
+	}
+
+	m_alloc.deleteInstance(recordedPlan);
+	m_alloc.deleteInstance(replayedPlan);
+	m_loadPlanFilename.destroy(m_alloc);
+	return err;
+}
+
+void ResourceManager::destroyLoadPlans()
+{
+	if(m_fs)
+	{
+		m_fs->setOpenFileCallback(nullptr, nullptr);
+	}
+
+	LockGuard<Mutex> lock(m_loadPlanMtx);
+	m_alloc.deleteInstance(m_recordedPlan);
+	m_recordedPlan = nullptr;
+	m_alloc.deleteInstance(m_replayedPlan);
+	m_replayedPlan = nullptr;
+	m_loadPlanFilename.destroy(m_alloc);
+}
+
 // Instansiate the ResourceManager::loadResource()
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) \
 	template Error ResourceManager::loadResource<rsrc_>(const CString& filename, ResourcePtr<rsrc_>& out, Bool async);
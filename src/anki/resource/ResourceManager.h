@@ -6,9 +6,11 @@
 #pragma once
 
 #include <anki/resource/TransferGpuAllocator.h>
-#include <anki/util/List.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/InternedString.h>
 #include <anki/util/Functions.h>
 #include <anki/util/String.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -21,6 +23,8 @@ class ResourceManager;
 class AsyncLoader;
 class ResourceManagerModel;
 class ShaderCompilerCache;
+class ResourceLoadPlan;
+class ShaderProgramResourceSystem;
 
 /// @addtogroup resource
 /// @{
@@ -42,21 +46,28 @@ protected:
 
 	Type* findLoadedResource(const CString& filename)
 	{
-		auto it = find(filename);
-		return (it != m_ptrs.end()) ? *it : nullptr;
+		// The filenames of the resources are interned so if the filename isn't interned there is no such resource
+		InternedString internedFilename;
+		if(!InternedString::tryFind(filename, internedFilename))
+		{
+			return nullptr;
+		}
+
+		auto it = m_ptrs.find(internedFilename);
+		return (it != m_ptrs.getEnd()) ? *it : nullptr;
 	}
 
 	void registerResource(Type* ptr)
 	{
 		ANKI_ASSERT(ptr->getRefcount().load() == 0);
-		ANKI_ASSERT(find(ptr->getFilename()) == m_ptrs.getEnd());
-		m_ptrs.pushBack(m_alloc, ptr);
+		ANKI_ASSERT(m_ptrs.find(ptr->getInternedFilename()) == m_ptrs.getEnd());
+		m_ptrs.emplace(m_alloc, ptr->getInternedFilename(), ptr);
 	}
 
 	void unregisterResource(Type* ptr)
 	{
-		auto it = find(ptr->getFilename());
-		ANKI_ASSERT(it != m_ptrs.end());
+		auto it = m_ptrs.find(ptr->getInternedFilename());
+		ANKI_ASSERT(it != m_ptrs.getEnd());
 		m_ptrs.erase(m_alloc, it);
 	}
 
@@ -66,25 +77,8 @@ protected:
 	}
 
 private:
-	using Container = List<Type*>;
-
 	ResourceAllocator<U8> m_alloc;
-	Container m_ptrs;
-
-	typename Container::Iterator find(const CString& filename)
-	{
-		typename Container::Iterator it;
-
-		for(it = m_ptrs.getBegin(); it != m_ptrs.getEnd(); ++it)
-		{
-			if((*it)->getFilename() == filename)
-			{
-				break;
-			}
-		}
-
-		return it;
-	}
+	HashMap<InternedString, Type*> m_ptrs;
 };
 
 class ResourceManagerInitInfo
@@ -127,6 +121,15 @@ public:
 	template<typename T>
 	ANKI_USE_RESULT Error loadResource(const CString& filename, ResourcePtr<T>& out, Bool async = true);
 
+	/// Call it before loading a level. If a previous run recorded a load plan with the same name it will start reading
+	/// its files in the background. The files of the resources that changed since then are skipped. It also starts
+	/// recording a new plan.
+	/// @param name A name that identifies the level.
+	ANKI_USE_RESULT Error beginLoadPlan(CString name);
+
+	/// Call it after loading a level. It stores the new plan in the cache directory if it's different than the old.
+	ANKI_USE_RESULT Error endLoadPlan();
+
 	// Internals:
 
 	ANKI_INTERNAL U32 getMaxTextureSize() const
@@ -200,6 +203,11 @@ public:
 		return *m_asyncLoader;
 	}
 
+	ANKI_INTERNAL ShaderProgramResourceSystem& getShaderProgramResourceSystem()
+	{
+		return *m_shaderProgramSystem;
+	}
+
 	/// Get the number of times loadResource() was called.
 	ANKI_INTERNAL U64 getLoadingRequestCount() const
 	{
@@ -221,7 +229,25 @@ private:
 	U64 m_uuid = 0;
 	U64 m_loadRequestCount = 0;
 	TransferGpuAllocator* m_transferGpuAlloc = nullptr;
+	ShaderProgramResourceSystem* m_shaderProgramSystem = nullptr;
 	Bool m_dumpShaderSource = false;
+	Bool m_useLoadPlans = false;
+
+	/// @name Load plan recording. The plans are protected by m_loadPlanMtx
+	/// @{
+	ResourceLoadPlan* m_recordedPlan = nullptr;
+	ResourceLoadPlan* m_replayedPlan = nullptr;
+	String m_loadPlanFilename;
+	Mutex m_loadPlanMtx;
+	/// @}
+
+	/// Prefetch the files of the previous plan that didn't change and belong to resources that didn't change.
+	void prefetchLoadPlanFiles(const ResourceLoadPlan& plan);
+
+	/// Add a file to the recorded plan. The ResourceFilesystem calls it in the thread that opens the file.
+	void recordOpenedFile(CString filename);
+
+	void destroyLoadPlans();
 };
 /// @}
 
@@ -5,7 +5,9 @@
 
 #include <anki/resource/ResourceObject.h>
 #include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceBinaryConverter.h>
 #include <anki/util/Xml.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -18,7 +20,6 @@ ResourceObject::ResourceObject(ResourceManager* manager)
 
 ResourceObject::~ResourceObject()
 {
-	m_fname.destroy(getAllocator());
 }
 
 ResourceAllocator<U8> ResourceObject::getAllocator() const
@@ -59,4 +60,102 @@ Error ResourceObject::openFileParseXml(const CString& filename, XmlDocument& xml
 	return Error::NONE;
 }
 
+template<typename TBinary>
+Error ResourceObject::openFileLoadBinary(const CString& filename, StackAllocator<U8>& alloc, TBinary*& binary)
+{
+	binary = nullptr;
+	ResourceFilesystem& fs = m_manager->getFilesystem();
+	alloc = StackAllocator<U8>(getAllocator().getMemoryPool().getAllocationCallback(),
+		getAllocator().getMemoryPool().getAllocationCallbackUserData(),
+		4_KB);
+
+	StringAuto binaryFilename(getTempAllocator());
+	binaryFilename.sprintf("%s%s", filename.cstr(), RESOURCE_BINARY_SUFFIX);
+	const Bool hasBinary = fs.hasFile(binaryFilename.toCString());
+	const Bool hasText = !hasBinary || fs.hasFile(filename);
+
+	// Try the binary
+	StringAuto txt(getTempAllocator());
+	U64 sourceHash = 0;
+	if(hasBinary)
+	{
+		ResourceFilePtr file;
+		ANKI_CHECK(openFile(binaryFilename.toCString(), file));
+		const Error err = BinaryDeserializer::deserialize(binary, alloc, *file);
+
+		Bool upToDate = false;
+		if(err)
+		{
+			ANKI_RESOURCE_LOGW("Failed to load binary: %s", binaryFilename.cstr());
+		}
+		else if(memcmp(&binary->m_magic[0], ResourceBinaryTraits<TBinary>::MAGIC, sizeof(binary->m_magic)) != 0)
+		{
+			ANKI_RESOURCE_LOGW("Wrong magic word or version: %s", binaryFilename.cstr());
+		}
+		else if(!hasText)
+		{
+			upToDate = true;
+		}
+		else
+		{
+			ResourceFilePtr txtFile;
+			ANKI_CHECK(openFile(filename, txtFile));
+
+			// If the text is older than the binary and has the same size skip reading and hashing it
+			U64 txtTimestamp, binaryTimestamp;
+			ANKI_CHECK(fs.getFileTimestamp(filename, txtTimestamp));
+			ANKI_CHECK(fs.getFileTimestamp(binaryFilename.toCString(), binaryTimestamp));
+			upToDate = txtFile->getSize() == binary->m_sourceSize && txtTimestamp < binaryTimestamp;
+
+			if(!upToDate)
+			{
+				ANKI_CHECK(txtFile->readAllText(txt));
+				sourceHash = computeStableHash(txt.cstr(), txt.getLength());
+				upToDate = binary->m_sourceHash == sourceHash;
+			}
+
+			if(!upToDate)
+			{
+				ANKI_RESOURCE_LOGW("Binary is out of date: %s", binaryFilename.cstr());
+			}
+		}
+
+		if(upToDate)
+		{
+			return Error::NONE;
+		}
+
+		if(!hasText)
+		{
+			ANKI_RESOURCE_LOGE("Can't use the binary and the text file is missing: %s", filename.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	// Convert the text
+	if(txt.isEmpty())
+	{
+		ANKI_CHECK(openFileReadAllText(filename, txt));
+		sourceHash = computeStableHash(txt.cstr(), txt.getLength());
+	}
+
+	XmlDocument xml;
+	ANKI_CHECK(xml.parse(txt.toCString(), getTempAllocator()));
+	ANKI_CHECK(convertResourceXml(xml, sourceHash, alloc, binary));
+	binary->m_sourceSize = txt.getLength();
+
+	return Error::NONE;
+}
+
+#define ANKI_INSTANTIATE_OPEN_FILE_LOAD_BINARY(binary_) \
+	template Error ResourceObject::openFileLoadBinary<binary_>( \
+		const CString& filename, StackAllocator<U8>& alloc, binary_*& binary);
+
+ANKI_INSTANTIATE_OPEN_FILE_LOAD_BINARY(MaterialBinary)
+ANKI_INSTANTIATE_OPEN_FILE_LOAD_BINARY(ModelBinary)
+ANKI_INSTANTIATE_OPEN_FILE_LOAD_BINARY(SkeletonBinary)
+ANKI_INSTANTIATE_OPEN_FILE_LOAD_BINARY(AnimationBinary)
+
+#undef ANKI_INSTANTIATE_OPEN_FILE_LOAD_BINARY
+
 } // end namespace anki
@@ -8,7 +8,7 @@
 #include <anki/resource/Common.h>
 #include <anki/resource/ResourceFilesystem.h>
 #include <anki/util/Atomic.h>
-#include <anki/util/String.h>
+#include <anki/util/InternedString.h>
 
 namespace anki
 {
@@ -54,12 +54,18 @@ public:
 		return m_fname.toCString();
 	}
 
+	InternedString getInternedFilename() const
+	{
+		ANKI_ASSERT(!m_fname.isEmpty());
+		return m_fname;
+	}
+
 	// Internals:
 
 	ANKI_INTERNAL void setFilename(const CString& fname)
 	{
 		ANKI_ASSERT(m_fname.isEmpty());
-		m_fname.create(getAllocator(), fname);
+		m_fname = InternedString(fname);
 	}
 
 	ANKI_INTERNAL void setUuid(U64 uuid)
@@ -81,10 +87,18 @@ public:
 
 	ANKI_INTERNAL ANKI_USE_RESULT Error openFileParseXml(const ResourceFilename& filename, XmlDocument& xml);
 
+	/// Load the binary version of a text resource if it's up to date. If it's not convert the text on the fly.
+	/// @param filename The filename of the text resource.
+	/// @param[out] alloc The allocator that holds the memory of @a binary. It frees it when it's destroyed.
+	/// @param[out] binary The binary.
+	template<typename TBinary>
+	ANKI_INTERNAL ANKI_USE_RESULT Error openFileLoadBinary(
+		const ResourceFilename& filename, StackAllocator<U8>& alloc, TBinary*& binary);
+
 private:
 	ResourceManager* m_manager;
 	Atomic<I32> m_refcount;
-	String m_fname; ///< Unique resource name.
+	InternedString m_fname; ///< Unique resource name.
 	U64 m_uuid = 0;
 };
 /// @}
@@ -0,0 +1,209 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourcePack.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/StringList.h>
+#include <anki/util/Hash.h>
+#include <anki/util/Logger.h>
+#include <anki/util/WeakArray.h>
+#include <zlib.h>
+#include <algorithm>
+
+namespace anki
+{
+
+U64 ResourcePackBinary::computeFilenameHash(CString filename)
+{
+	ANKI_ASSERT(!filename.isEmpty());
+	return computeStableHash(filename.cstr(), filename.getLength());
+}
+
+static Error writePadding(File& file, PtrSize alignment)
+{
+	static const Array<U8, 1024> zeros = {};
+
+	PtrSize offset = file.tell();
+	PtrSize alignedOffset = offset;
+	alignRoundUp(alignment, alignedOffset);
+
+	while(offset < alignedOffset)
+	{
+		const PtrSize size = min<PtrSize>(alignedOffset - offset, zeros.getSize());
+		ANKI_CHECK(file.write(&zeros[0], size));
+		offset += size;
+	}
+
+	return Error::NONE;
+}
+
+/// Compress a file block by block. Returns false if the compression didn't save enough space.
+static Bool compressEntry(ConstWeakArray<U8> in, DynamicArrayAuto<U8>& out)
+{
+	const U32 blockCount = ResourcePackBinary::computeBlockCount(in.getSizeInBytes());
+	const PtrSize blockTableSize = blockCount * sizeof(U32);
+
+	const uLong maxCompressedBlockSize = compressBound(uLong(ResourcePackBinary::BLOCK_SIZE));
+	out.create(U32(blockTableSize + blockCount * maxCompressedBlockSize));
+
+	PtrSize outOffset = blockTableSize;
+	for(U32 block = 0; block < blockCount; ++block)
+	{
+		const PtrSize inOffset = block * ResourcePackBinary::BLOCK_SIZE;
+		const PtrSize inSize = min(ResourcePackBinary::BLOCK_SIZE, in.getSizeInBytes() - inOffset);
+
+		uLongf compressedSize = maxCompressedBlockSize;
+		if(compress2(&out[U32(outOffset)], &compressedSize, &in[U32(inOffset)], uLong(inSize), Z_BEST_COMPRESSION)
+			!= Z_OK)
+		{
+			return false;
+		}
+
+		const U32 compressedSizeU32 = U32(compressedSize);
+		memcpy(&out[block * sizeof(U32)], &compressedSizeU32, sizeof(U32));
+		outOffset += compressedSize;
+	}
+
+	out.resize(U32(outOffset));
+
+	// Worth it only if it saves more than 10%
+	return outOffset * 10 < in.getSizeInBytes() * 9;
+}
+
+Error createResourcePack(CString dataDir, CString packFilename, Bool compress, GenericMemoryPoolAllocator<U8> alloc)
+{
+	// Gather the files
+	class WalkContext
+	{
+	public:
+		StringListAuto m_filenames;
+
+		WalkContext(GenericMemoryPoolAllocator<U8> alloc)
+			: m_filenames(alloc)
+		{
+		}
+	} ctx(alloc);
+
+	ANKI_CHECK(walkDirectoryTree(dataDir, &ctx, [](const CString& fname, void* ud, Bool isDir) -> Error {
+		if(!isDir)
+		{
+			static_cast<WalkContext*>(ud)->m_filenames.pushBackSprintf("%s", fname.cstr());
+		}
+		return Error::NONE;
+	}));
+
+	if(ctx.m_filenames.isEmpty())
+	{
+		ANKI_RESOURCE_LOGE("Directory is empty: %s", dataDir.cstr());
+		return Error::USER_DATA;
+	}
+
+	File packFile;
+	ANKI_CHECK(packFile.open(packFilename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	// Write a dummy header. The real one will be written at the end
+	ResourcePackBinary::Header header = {};
+	ANKI_CHECK(packFile.write(&header, sizeof(header)));
+
+	// Write the entries
+	DynamicArrayAuto<ResourcePackBinary::Entry> entries(alloc);
+	StringAuto stringTable(alloc);
+	PtrSize totalSize = 0;
+	PtrSize totalCompressedSize = 0;
+
+	for(const String& fname : ctx.m_filenames)
+	{
+		// Read the file
+		StringAuto fullFname(alloc);
+		fullFname.sprintf("%s/%s", dataDir.cstr(), fname.cstr());
+
+		// Empty files can't be opened. Skip them like the zip archives do. Any other failure is an error
+		PtrSize fileSize;
+		ANKI_CHECK(getFileSize(fullFname.toCString(), fileSize));
+		if(fileSize == 0)
+		{
+			ANKI_RESOURCE_LOGW("Skipping empty file: %s", fullFname.cstr());
+			continue;
+		}
+
+		File file;
+		ANKI_CHECK(file.open(fullFname.toCString(), FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+		DynamicArrayAuto<U8> data(alloc);
+		data.create(U32(file.getSize()));
+		ANKI_CHECK(file.read(&data[0], data.getSize()));
+
+		// Compress
+		DynamicArrayAuto<U8> compressedData(alloc);
+		const Bool compressed = compress && compressEntry(data, compressedData);
+		const DynamicArrayAuto<U8>& finalData = (compressed) ? compressedData : data;
+
+		// Write
+		ANKI_CHECK(writePadding(packFile, ResourcePackBinary::ENTRY_ALIGNMENT));
+
+		ResourcePackBinary::Entry& entry = *entries.emplaceBack();
+		zeroMemory(entry);
+		entry.m_filenameHash = ResourcePackBinary::computeFilenameHash(fname.toCString());
+		entry.m_offset = packFile.tell();
+		entry.m_size = data.getSize();
+		entry.m_compressedSize = finalData.getSize();
+		entry.m_filenameOffset = U32(stringTable.getLength());
+		entry.m_filenameLength = U32(fname.getLength());
+		entry.m_codec = (compressed) ? ResourcePackCodec::DEFLATE : ResourcePackCodec::STORED;
+
+		ANKI_CHECK(packFile.write(&finalData[0], finalData.getSize()));
+
+		stringTable.append(fname.toCString());
+		totalSize += entry.m_size;
+		totalCompressedSize += entry.m_compressedSize;
+	}
+
+	if(entries.getSize() == 0)
+	{
+		ANKI_RESOURCE_LOGE("No files to pack in: %s", dataDir.cstr());
+		return Error::USER_DATA;
+	}
+
+	// Sort the index
+	std::sort(entries.getBegin(),
+		entries.getEnd(),
+		[&](const ResourcePackBinary::Entry& a, const ResourcePackBinary::Entry& b) {
+			if(a.m_filenameHash != b.m_filenameHash)
+			{
+				return a.m_filenameHash < b.m_filenameHash;
+			}
+
+			// Collision, sort by name to keep the pack deterministic
+			const I32 cmp = strncmp(&stringTable[a.m_filenameOffset],
+				&stringTable[b.m_filenameOffset],
+				min(a.m_filenameLength, b.m_filenameLength));
+			return (cmp != 0) ? cmp < 0 : a.m_filenameLength < b.m_filenameLength;
+		});
+
+	// Write the index and the string table
+	ANKI_CHECK(writePadding(packFile, alignof(ResourcePackBinary::Entry)));
+	header.m_indexOffset = packFile.tell();
+	ANKI_CHECK(packFile.write(&entries[0], entries.getSizeInBytes()));
+	ANKI_CHECK(packFile.write(&stringTable[0], stringTable.getLength()));
+
+	// Write the header
+	memcpy(&header.m_magic[0], ResourcePackBinary::MAGIC, sizeof(header.m_magic));
+	header.m_entryCount = entries.getSize();
+	header.m_stringTableSize = U32(stringTable.getLength());
+	ANKI_CHECK(packFile.seek(0, FileSeekOrigin::BEGINNING));
+	ANKI_CHECK(packFile.write(&header, sizeof(header)));
+
+	ANKI_RESOURCE_LOGI("Packed %u files of %s to %s. Uncompressed size %zuKB, compressed size %zuKB",
+		entries.getSize(),
+		dataDir.cstr(),
+		packFilename.cstr(),
+		PtrSize(totalSize / 1_KB),
+		PtrSize(totalCompressedSize / 1_KB));
+
+	return Error::NONE;
+}
+
+} // end namespace anki
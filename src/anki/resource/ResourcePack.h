@@ -0,0 +1,81 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/Array.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// The compression of a single entry of a resource pack.
+enum class ResourcePackCodec : U32
+{
+	STORED, ///< Not compressed.
+	DEFLATE, ///< Every block is compressed independently with zlib.
+
+	COUNT
+};
+
+/// Information to decode the AnKi resource pack files (.ankipak). The layout of the file is:
+/// - ResourcePackBinary::Header
+/// - Entry data. Every entry starts at an offset aligned to ENTRY_ALIGNMENT. A compressed entry starts with an array of
+///   U32 (one per block) that holds the compressed size of each block followed by the compressed blocks.
+/// - Index. An array of ResourcePackBinary::Entry sorted by the hash of the filename.
+/// - String table. All the filenames, not null terminated.
+class ResourcePackBinary
+{
+public:
+	static constexpr const char* MAGIC = "ANKIPAK1";
+	static constexpr const char* EXTENSION = ".ankipak";
+
+	static constexpr PtrSize ENTRY_ALIGNMENT = 64_KB;
+
+	/// The uncompressed size of a compression block. Blocks are independent so they can be decoded in any order.
+	static constexpr PtrSize BLOCK_SIZE = 64_KB;
+
+	struct Header
+	{
+		char m_magic[8]; ///< Magic word.
+		U32 m_entryCount;
+		U32 m_stringTableSize;
+		U64 m_indexOffset; ///< The offset of the index from the beginning of the file.
+	};
+
+	struct Entry
+	{
+		U64 m_filenameHash; ///< The key of the index.
+		U64 m_offset; ///< The offset of the data from the beginning of the file.
+		U64 m_size; ///< The uncompressed size.
+		U64 m_compressedSize; ///< The size of the data in the file, including the block size array.
+		U32 m_filenameOffset; ///< Offset in the string table.
+		U32 m_filenameLength;
+		ResourcePackCodec m_codec;
+		U32 _padding;
+	};
+
+	static U32 computeBlockCount(PtrSize size)
+	{
+		return U32((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+	}
+
+	static U64 computeFilenameHash(CString filename);
+};
+
+/// Create a resource pack that contains all the files of a directory.
+/// @param dataDir The directory to pack.
+/// @param packFilename The output file.
+/// @param compress If false all the entries will be stored. If true the entries will be compressed if that saves some
+///                 space.
+/// @param alloc Temporary allocator.
+ANKI_USE_RESULT Error createResourcePack(
+	CString dataDir, CString packFilename, Bool compress, GenericMemoryPoolAllocator<U8> alloc);
+/// @}
+
+} // end namespace anki
@@ -5,6 +5,8 @@
 
 #include <anki/resource/ShaderProgramResource.h>
 #include <anki/resource/ResourceManager.h>
+#include <anki/resource/ShaderProgramResourceSystem.h>
+#include <anki/resource/AsyncLoader.h>
 #include <anki/gr/ShaderProgram.h>
 #include <anki/gr/GrManager.h>
 #include <anki/util/Filesystem.h>
@@ -21,6 +23,40 @@ ShaderProgramResourceVariant::~ShaderProgramResourceVariant()
 {
 }
 
+/// Compiles a variant in the AsyncLoader.
+class ShaderProgramResource::CompileVariantTask : public AsyncLoaderTask
+{
+public:
+	const ShaderProgramResource* m_resource = nullptr;
+	ShaderProgramResourceVariant* m_variant = nullptr;
+
+	~CompileVariantTask()
+	{
+		// The loader deletes the tasks that didn't run when it stops so count them here
+		LockGuard<Mutex> lock(m_resource->m_mtx);
+		ANKI_ASSERT(m_resource->m_asyncCompilationCount > 0);
+		--m_resource->m_asyncCompilationCount;
+		m_resource->m_variantCompiledCondVar.notifyAll();
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		{
+			LockGuard<Mutex> lock(m_resource->m_mtx);
+			if(m_variant->m_state.load() != U32(ShaderProgramResourceVariant::State::QUEUED))
+			{
+				// getOrCreateVariant() needed it and compiled it
+				return Error::NONE;
+			}
+
+			m_variant->m_state.store(U32(ShaderProgramResourceVariant::State::COMPILING));
+		}
+
+		m_resource->compileVariant(*m_variant);
+		return Error::NONE;
+	}
+};
+
 ShaderProgramResource::ShaderProgramResource(ResourceManager* manager)
 	: ResourceObject(manager)
 	, m_binary(getAllocator())
@@ -29,6 +65,15 @@ ShaderProgramResource::ShaderProgramResource(ResourceManager* manager)
 
 ShaderProgramResource::~ShaderProgramResource()
 {
+	// Wait for the variants in the AsyncLoader since they point to this
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		while(m_asyncCompilationCount > 0)
+		{
+			m_variantCompiledCondVar.wait(m_mtx);
+		}
+	}
+
 	m_mutators.destroy(getAllocator());
 
 	for(ShaderProgramResourceConstant& c : m_consts)
@@ -38,21 +83,25 @@ ShaderProgramResource::~ShaderProgramResource()
 	m_consts.destroy(getAllocator());
 	m_constBinaryMapping.destroy(getAllocator());
 
-	for(auto it : m_variants)
-	{
-		ShaderProgramResourceVariant* variant = &(*it);
+	m_variants.iterate([&](U64, ShaderProgramResourceVariant* variant) {
+		variant->m_constValues.destroy(getAllocator());
 		getAllocator().deleteInstance(variant);
-	}
+	});
 	m_variants.destroy(getAllocator());
 }
 
 Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 {
-	// Load the binary from the cache. It should have been compiled there
-	StringAuto baseFilename(getTempAllocator());
-	getFilepathFilename(filename, baseFilename);
+	// Compile it now if it wasn't compiled at startup
+	ShaderProgramResourceSystem& system = getManager().getShaderProgramResourceSystem();
+	if(system.getCompileOnLoad())
+	{
+		ANKI_CHECK(system.compileProgram(filename));
+	}
+
+	// Load the binary from the cache
 	StringAuto binaryFilename(getTempAllocator());
-	binaryFilename.sprintf("%s/%sbin", getManager().getCacheDirectory().cstr(), baseFilename.cstr());
+	system.getBinaryFilename(filename, binaryFilename);
 	ANKI_CHECK(m_binary.deserializeFromFile(binaryFilename));
 	const ShaderProgramBinary& binary = m_binary.getBinary();
 
@@ -193,14 +242,12 @@ Error ShaderProgramResource::parseConst(CString constName, U32& componentIdx, U3
 	return Error::NONE;
 }
 
-void ShaderProgramResource::getOrCreateVariant(
-	const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+U64 ShaderProgramResource::computeVariantHash(const ShaderProgramResourceVariantInitInfo& info) const
 {
 	// Sanity checks
 	ANKI_ASSERT(info.m_setMutators.getEnabledBitCount() == m_mutators.getSize());
 	ANKI_ASSERT(info.m_setConstants.getEnabledBitCount() == m_consts.getSize());
 
-	// Compute variant hash
 	U64 hash = 0;
 	if(m_mutators.getSize())
 	{
@@ -213,37 +260,110 @@ void ShaderProgramResource::getOrCreateVariant(
 			appendHash(info.m_constantValues.getBegin(), m_consts.getSize() * sizeof(info.m_constantValues[0]), hash);
 	}
 
-	// Check if the variant is in the cache
+	return hash;
+}
+
+void ShaderProgramResource::getOrCreateVariant(
+	const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+{
+	const U64 hash = computeVariantHash(info);
+
+	// Check if the variant is in the cache. It doesn't lock
+	ShaderProgramResourceVariant* const* cached = m_variants.find(hash);
+	if(cached != nullptr && (*cached)->m_state.load() == U32(ShaderProgramResourceVariant::State::READY))
 	{
-		RLockGuard<RWMutex> lock(m_mtx);
+		variant = *cached;
+		return;
+	}
 
-		auto it = m_variants.find(hash);
-		variant = (it != m_variants.getEnd()) ? *it : nullptr;
+	ShaderProgramResourceVariant* v;
+	Bool compile = false;
+	{
+		LockGuard<Mutex> lock(m_mtx);
 
-		if(variant != nullptr)
+		// Check again
+		cached = m_variants.find(hash);
+		if(cached == nullptr)
 		{
-			// Done
-			return;
+			v = getAllocator().newInstance<ShaderProgramResourceVariant>();
+			initVariant(info, *v);
+			v->m_state.store(U32(ShaderProgramResourceVariant::State::COMPILING));
+			m_variants.emplace(getAllocator(), hash, v);
+			compile = true;
 		}
+		else
+		{
+			v = *cached;
+			if(v->m_state.load() == U32(ShaderProgramResourceVariant::State::QUEUED))
+			{
+				// Don't wait for the AsyncLoader to get to it
+				v->m_state.store(U32(ShaderProgramResourceVariant::State::COMPILING));
+				compile = true;
+			}
+			else
+			{
+				while(v->m_state.load() != U32(ShaderProgramResourceVariant::State::READY))
+				{
+					m_variantCompiledCondVar.wait(m_mtx);
+				}
+			}
+		}
+	}
+
+	// Compile outside the lock so different variants compile in parallel
+	if(compile)
+	{
+		compileVariant(*v);
+	}
+
+	variant = v;
+}
+
+Bool ShaderProgramResource::tryGetOrCreateVariant(
+	const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+{
+	const U64 hash = computeVariantHash(info);
+	variant = nullptr;
+
+	// Check if the variant is in the cache. It doesn't lock
+	ShaderProgramResourceVariant* const* cached = m_variants.find(hash);
+	if(cached != nullptr && (*cached)->m_state.load() == U32(ShaderProgramResourceVariant::State::READY))
+	{
+		variant = *cached;
+		return true;
 	}
 
-	// Create the variant
-	WLockGuard<RWMutex> lock(m_mtx);
+	if(cached != nullptr)
+	{
+		// In the AsyncLoader
+		return false;
+	}
+
+	LockGuard<Mutex> lock(m_mtx);
 
 	// Check again
-	auto it = m_variants.find(hash);
-	variant = (it != m_variants.getEnd()) ? *it : nullptr;
-	if(variant != nullptr)
+	cached = m_variants.find(hash);
+	if(cached != nullptr)
 	{
-		// Done
-		return;
+		const Bool ready = (*cached)->m_state.load() == U32(ShaderProgramResourceVariant::State::READY);
+		variant = (ready) ? *cached : nullptr;
+		return ready;
 	}
 
-	// Create
+	// Queue it
 	ShaderProgramResourceVariant* v = getAllocator().newInstance<ShaderProgramResourceVariant>();
 	initVariant(info, *v);
+	v->m_state.store(U32(ShaderProgramResourceVariant::State::QUEUED));
 	m_variants.emplace(getAllocator(), hash, v);
-	variant = v;
+
+	AsyncLoader& loader = getManager().getAsyncLoader();
+	CompileVariantTask* task = loader.newTask<CompileVariantTask>();
+	task->m_resource = this;
+	task->m_variant = v;
+	++m_asyncCompilationCount;
+	loader.submitTask(task);
+
+	return false;
 }
 
 void ShaderProgramResource::initVariant(
@@ -256,7 +376,8 @@ void ShaderProgramResource::initVariant(
 	if(m_mutators.getSize())
 	{
 		// Create the mutation hash
-		const U64 hash = computeHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+		const U64 hash =
+			computeStableHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
 
 		// Search for the mutation in the binary
 		// TODO optimize the search
@@ -278,7 +399,11 @@ void ShaderProgramResource::initVariant(
 	variant.m_binaryVariant = binaryVariant;
 
 	// Set the constannt values
-	Array<ShaderSpecializationConstValue, 64> constValues;
+	if(binaryVariant->m_constants.getSize())
+	{
+		variant.m_constValues.create(getAllocator(), binaryVariant->m_constants.getSize());
+	}
+
 	U32 constValueCount = 0;
 	for(const ShaderProgramBinaryConstantInstance& instance : binaryVariant->m_constants)
 	{
@@ -298,10 +423,10 @@ void ShaderProgramResource::initVariant(
 		}
 		ANKI_ASSERT(value && "Forgot to set the value of a constant");
 
-		constValues[constValueCount].m_constantId = c.m_constantId;
-		constValues[constValueCount].m_dataType = c.m_type;
-		constValues[constValueCount].m_int = value->m_ivec4[component];
-		++constValueCount;
+		ShaderSpecializationConstValue& constValue = variant.m_constValues[constValueCount++];
+		constValue.m_constantId = c.m_constantId;
+		constValue.m_dataType = c.m_type;
+		constValue.m_int = value->m_ivec4[component];
 	}
 
 	// Get the workgroup sizes
@@ -346,6 +471,12 @@ void ShaderProgramResource::initVariant(
 			ANKI_ASSERT(variant.m_workgroupSizes[i] != MAX_U32);
 		}
 	}
+}
+
+void ShaderProgramResource::compileVariant(ShaderProgramResourceVariant& variant) const
+{
+	ANKI_ASSERT(variant.m_state.load() == U32(ShaderProgramResourceVariant::State::COMPILING));
+	const ShaderProgramBinary& binary = m_binary.getBinary();
 
 	// Create the program name
 	StringAuto progName(getTempAllocator());
@@ -367,14 +498,19 @@ void ShaderProgramResource::initVariant(
 
 		ShaderInitInfo inf(cprogName);
 		inf.m_shaderType = shaderType;
-		inf.m_binary = binary.m_codeBlocks[binaryVariant->m_codeBlockIndices[shaderType]].m_binary;
-		inf.m_constValues.setArray((constValueCount) ? constValues.getBegin() : nullptr, constValueCount);
+		inf.m_binary = binary.m_codeBlocks[variant.m_binaryVariant->m_codeBlockIndices[shaderType]].m_binary;
+		inf.m_constValues = variant.m_constValues;
 
 		progInf.m_shaders[shaderType] = getManager().getGrManager().newShader(inf);
 	}
 
-	// Create the program
+	// Create the program. No one reads it before the variant is READY
 	variant.m_prog = getManager().getGrManager().newShaderProgram(progInf);
+
+	LockGuard<Mutex> lock(m_mtx);
+	variant.m_constValues.destroy(getAllocator());
+	variant.m_state.store(U32(ShaderProgramResourceVariant::State::READY));
+	m_variantCompiledCondVar.notifyAll();
 }
 
 } // end namespace anki
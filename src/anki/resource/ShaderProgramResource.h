@@ -11,7 +11,7 @@
 #include <anki/gr/ShaderProgram.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/String.h>
-#include <anki/util/HashMap.h>
+#include <anki/util/ConcurrentHashMap.h>
 #include <anki/util/WeakArray.h>
 #include <anki/Math.h>
 
@@ -59,6 +59,14 @@ class ShaderProgramResourceVariant
 {
 	friend class ShaderProgramResource;
 
+	/// The state of the GPU objects of the variant.
+	enum class State : U32
+	{
+		QUEUED, ///< Waiting in the background thread.
+		COMPILING,
+		READY
+	};
+
 public:
 	ShaderProgramResourceVariant();
 
@@ -94,6 +102,9 @@ private:
 	const ShaderProgramBinaryVariant* m_binaryVariant = nullptr;
 	BitSet<128, U64> m_activeConsts = {false};
 	Array<U32, 3> m_workgroupSizes;
+
+	Atomic<U32> m_state = {U32(State::READY)};
+	DynamicArray<ShaderSpecializationConstValue> m_constValues; ///< Needed until the variant compiles.
 };
 
 /// The value of a constant.
@@ -224,11 +235,19 @@ public:
 		return m_binary.getBinary();
 	}
 
-	/// Get or create a graphics shader program variant.
+	/// Get or create a graphics shader program variant. If the variant is not compiled it compiles it in the calling
+	/// thread.
 	/// @note It's thread-safe.
 	void getOrCreateVariant(
 		const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const;
 
+	/// Same as getOrCreateVariant() but it doesn't wait for the compilation. The first time a variant is asked its
+	/// compilation goes to the AsyncLoader. Until it's done the caller should use a default variant of its own.
+	/// @return True if the variant is ready. If it's false the variant is nullptr.
+	/// @note It's thread-safe.
+	Bool tryGetOrCreateVariant(
+		const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const;
+
 	/// @copydoc getOrCreateVariant
 	void getOrCreateVariant(const ShaderProgramResourceVariant*& variant) const
 	{
@@ -253,13 +272,23 @@ private:
 
 	DynamicArray<ConstMapping> m_constBinaryMapping;
 
-	mutable HashMap<U64, ShaderProgramResourceVariant*> m_variants;
-	mutable RWMutex m_mtx;
+	mutable ConcurrentHashMap<U64, ShaderProgramResourceVariant*> m_variants;
+	mutable Mutex m_mtx; ///< Only for creating variants and changing their state. The lookups don't lock
+	mutable ConditionVariable m_variantCompiledCondVar; ///< Used with m_mtx.
+	mutable U32 m_asyncCompilationCount = 0; ///< The variants in the AsyncLoader. Protected by m_mtx.
 
 	ShaderTypeBit m_shaderStages = ShaderTypeBit::NONE;
 
+	class CompileVariantTask;
+
+	U64 computeVariantHash(const ShaderProgramResourceVariantInitInfo& info) const;
+
+	/// Find the binary variant and the values of the constants. It doesn't create the GPU objects.
 	void initVariant(const ShaderProgramResourceVariantInitInfo& info, ShaderProgramResourceVariant& variant) const;
 
+	/// Create the GPU objects of a variant that is in the COMPILING state and make it READY.
+	void compileVariant(ShaderProgramResourceVariant& variant) const;
+
 	static ANKI_USE_RESULT Error parseConst(CString constName, U32& componentIdx, U32& componentCount, CString& name);
 };
 
@@ -0,0 +1,647 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ShaderProgramResourceSystem.h>
+#include <anki/resource/ResourceFilesystem.h>
+#include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/shader_compiler/ShaderProgramParser.h>
+#include <anki/gr/GrManager.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/ThreadPool.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+/// Read the shader sources from the ResourceFilesystem.
+class ShaderProgramResourceSystemFilesystem : public ShaderProgramFilesystemInterface
+{
+public:
+	ResourceFilesystem* m_fsystem = nullptr;
+
+	Error readAllText(CString filename, StringAuto& txt) final
+	{
+		ResourceFilePtr file;
+		ANKI_CHECK(m_fsystem->openFile(filename, file));
+		ANKI_CHECK(file->readAllText(txt));
+		return Error::NONE;
+	}
+
+	Error getFileTimestamp(CString filename, U64& timestamp) final
+	{
+		return m_fsystem->getFileTimestamp(filename, timestamp);
+	}
+};
+
+/// Skip the programs whose source hash matches the meta file.
+class ShaderProgramResourceSystemSkip : public ShaderProgramPostParseInterface
+{
+public:
+	const ShaderProgramResourceSystem* m_system = nullptr;
+	U64 m_metafileHash = 0;
+	U64 m_newHash = 0;
+	CString m_fname;
+	DynamicArrayAuto<U8> m_metafile; ///< The new contents of the meta file.
+
+	ShaderProgramResourceSystemSkip(GenericMemoryPoolAllocator<U8> alloc)
+		: m_metafile(alloc)
+	{
+	}
+
+	Bool skipCompilation(const ShaderProgramParser& parser) final
+	{
+		const U64 finalHash = m_system->computeProgramHash(parser.getHash());
+
+		m_newHash = finalHash;
+		const Bool skip = finalHash == m_metafileHash;
+
+		if(!skip)
+		{
+			ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
+		}
+
+		// Only the parser knows the dependencies. The meta file will be written after the binary
+		m_system->serializeMetafile(finalHash, parser, m_metafile);
+
+		return skip;
+	};
+};
+
+/// Compile the variants of a single program in a ThreadHive that many programs share. It waits only for the tasks of
+/// its program.
+class ShaderProgramResourceSystemTaskManager : public ShaderProgramAsyncTaskInterface
+{
+public:
+	ThreadHive* m_hive = nullptr;
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	Mutex m_mtx;
+	ConditionVariable m_cvar;
+	U32 m_pendingTasks = 0;
+
+	void enqueueTask(void (*callback)(void* userData), void* userData) final
+	{
+		struct Ctx
+		{
+			void (*m_callback)(void* userData);
+			void* m_userData;
+			ShaderProgramResourceSystemTaskManager* m_self;
+		};
+		Ctx* ctx = m_alloc.newInstance<Ctx>();
+		ctx->m_callback = callback;
+		ctx->m_userData = userData;
+		ctx->m_self = this;
+
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			++m_pendingTasks;
+		}
+
+		m_hive->submitTask(
+			[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+				Ctx* ctx = static_cast<Ctx*>(userData);
+				ctx->m_callback(ctx->m_userData);
+
+				ShaderProgramResourceSystemTaskManager& self = *ctx->m_self;
+				self.m_alloc.deleteInstance(ctx);
+
+				LockGuard<Mutex> lock(self.m_mtx);
+				ANKI_ASSERT(self.m_pendingTasks > 0);
+				--self.m_pendingTasks;
+				if(self.m_pendingTasks == 0)
+				{
+					self.m_cvar.notifyAll();
+				}
+			},
+			ctx);
+	}
+
+	Error joinTasks() final
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		while(m_pendingTasks > 0)
+		{
+			m_cvar.wait(m_mtx);
+		}
+
+		return Error::NONE;
+	}
+};
+
+ShaderProgramResourceSystem::ShaderProgramResourceSystem(
+	CString cacheDir, GrManager* gr, ResourceFilesystem* fs, const GenericMemoryPoolAllocator<U8>& alloc)
+	: m_alloc(alloc)
+	, m_gr(gr)
+	, m_fs(fs)
+	, m_spirvCache(alloc)
+	, m_includeCache(alloc)
+{
+	m_cacheDir.create(alloc, cacheDir);
+}
+
+ShaderProgramResourceSystem::~ShaderProgramResourceSystem()
+{
+	ANKI_ASSERT(m_programsInFlight.getSize() == 0);
+	m_programsInFlight.destroy(m_alloc);
+	m_cacheDir.destroy(m_alloc);
+}
+
+Error ShaderProgramResourceSystem::init(const ConfigSet& config)
+{
+	m_compileOnLoad = config.getBool("rsrc_compileShadersOnLoad");
+
+	StringAuto spirvCacheDir(m_alloc);
+	spirvCacheDir.sprintf("%s/spirv", m_cacheDir.cstr());
+	ANKI_CHECK(m_spirvCache.init(spirvCacheDir));
+
+	return Error::NONE;
+}
+
+void ShaderProgramResourceSystem::getBinaryFilename(CString programFilename, StringAuto& binaryFilename) const
+{
+	StringAuto baseFilename(m_alloc);
+	getFilepathFilename(programFilename, baseFilename);
+	binaryFilename.sprintf("%s/%sbin", m_cacheDir.cstr(), baseFilename.cstr());
+}
+
+Error ShaderProgramResourceSystem::compileAllPrograms(ThreadHive& hive)
+{
+	if(m_compileOnLoad)
+	{
+		ANKI_RESOURCE_LOGI("Shader programs will compile when they load");
+		return Error::NONE;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
+	ANKI_RESOURCE_LOGI("Compiling shader programs");
+	m_spirvCache.resetStatistics();
+
+	class Program
+	{
+	public:
+		String m_filename;
+		ShaderProgramParser* m_parser = nullptr; ///< Only the stale programs have one.
+		U64 m_metafileHash = 0;
+		U32 m_variantCount = 0; ///< An estimation of the work.
+		Bool m_compiled = false;
+		Second m_compileTime = 0.0;
+		PtrSize m_spirvBytesSaved = 0;
+	};
+
+	// Gather the programs
+	DynamicArrayAuto<Program> programs(m_alloc);
+	ANKI_CHECK(m_fs->iterateAllFilenames([&](CString fname) -> Error {
+		StringAuto extension(m_alloc);
+		getFilepathExtension(fname, extension);
+		if(extension.getLength() == 8 && extension == "ankiprog")
+		{
+			programs.emplaceBack()->m_filename.create(m_alloc, fname);
+		}
+
+		return Error::NONE;
+	}));
+
+	// Parse all programs in the hive to find the stale ones and how much work each has. The compilation will reuse the
+	// parsers
+	class ParseCtx
+	{
+	public:
+		ShaderProgramResourceSystem* m_system = nullptr;
+		WeakArray<Program> m_programs;
+		Atomic<U32> m_nextProgram = {0};
+		Atomic<U32> m_err = {0};
+	};
+
+	ParseCtx parseCtx;
+	parseCtx.m_system = this;
+	parseCtx.m_programs = WeakArray<Program>(programs);
+
+	const U32 parseTaskCount = min(hive.getThreadCount(), programs.getSize());
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> parseTasks;
+	for(U32 i = 0; i < parseTaskCount; ++i)
+	{
+		parseTasks[i] = ANKI_THREAD_HIVE_TASK(
+			{
+				U32 idx;
+				while((idx = self->m_nextProgram.fetchAdd(1)) < self->m_programs.getSize())
+				{
+					Program& program = self->m_programs[idx];
+					if(self->m_system->parseStaleProgram(
+						   program.m_filename.toCString(), program.m_parser, program.m_metafileHash))
+					{
+						self->m_err.store(1);
+					}
+				}
+			},
+			&parseCtx,
+			nullptr,
+			nullptr);
+	}
+
+	if(parseTaskCount > 0)
+	{
+		hive.submitTasks(&parseTasks[0], parseTaskCount);
+		hive.waitAllTasks();
+	}
+
+	Error err = (parseCtx.m_err.load()) ? Error::FUNCTION_FAILED : Error::NONE;
+
+	// Compile the stale ones, longest first. Each thread drives the compilation of a program: It feeds its variants to
+	// the hive, which all programs share, and while the hive compiles them it does the serialization and the rest
+	DynamicArrayAuto<U32> order(m_alloc);
+	for(U32 i = 0; i < programs.getSize(); ++i)
+	{
+		Program& program = programs[i];
+		if(program.m_parser)
+		{
+			program.m_variantCount = 1;
+			for(const ShaderProgramParserMutator& mutator : program.m_parser->getMutators())
+			{
+				program.m_variantCount *= mutator.getValues().getSize();
+			}
+
+			order.emplaceBack(i);
+		}
+	}
+
+	std::sort(order.getBegin(), order.getEnd(), [&](U32 a, U32 b) {
+		return programs[a].m_variantCount > programs[b].m_variantCount;
+	});
+
+	class DriverTask : public ThreadPoolTask
+	{
+	public:
+		ShaderProgramResourceSystem* m_system = nullptr;
+		ThreadHive* m_hive = nullptr;
+		WeakArray<Program> m_programs;
+		WeakArray<U32> m_order; ///< The order to compile the programs.
+		Atomic<U32> m_nextProgram = {0};
+
+		Error operator()(U32 taskId, PtrSize threadsCount) override
+		{
+			ShaderProgramResourceSystemTaskManager taskManager;
+			taskManager.m_hive = m_hive;
+			taskManager.m_alloc = m_system->m_alloc;
+
+			U32 idx;
+			while((idx = m_nextProgram.fetchAdd(1)) < m_order.getSize())
+			{
+				Program& program = m_programs[m_order[idx]];
+
+				const Second startTime = HighRezTimer::getCurrentTime();
+				m_system->beginProgramCompilation(program.m_filename.toCString());
+				const Error err = m_system->compileParsedProgram(program.m_filename.toCString(),
+					*program.m_parser,
+					program.m_metafileHash,
+					&taskManager,
+					program.m_compiled,
+					program.m_spirvBytesSaved);
+				m_system->endProgramCompilation(program.m_filename.toCString());
+				ANKI_CHECK(err);
+				program.m_compileTime = HighRezTimer::getCurrentTime() - startTime;
+			}
+
+			return Error::NONE;
+		}
+	};
+
+	if(!err && order.getSize() > 0)
+	{
+		DriverTask task;
+		task.m_system = this;
+		task.m_hive = &hive;
+		task.m_programs = WeakArray<Program>(programs);
+		task.m_order = WeakArray<U32>(order);
+
+		// The drivers spend most of their time waiting for the hive. A few are enough to keep it busy
+		ThreadPool threadPool(min(MAX_COMPILATION_DRIVER_THREADS, order.getSize()));
+		for(U32 i = 0; i < threadPool.getThreadCount(); ++i)
+		{
+			threadPool.assignNewTask(i, &task);
+		}
+		err = threadPool.waitForAllThreadsToFinish();
+	}
+
+	// Release the scratch memory of the hive
+	hive.waitAllTasks();
+
+	// Report
+	if(!err)
+	{
+		std::sort(order.getBegin(), order.getEnd(), [&](U32 a, U32 b) {
+			return programs[a].m_compileTime > programs[b].m_compileTime;
+		});
+
+		U32 compiledCount = 0;
+		PtrSize spirvBytesSaved = 0;
+		for(U32 i : order)
+		{
+			const Program& program = programs[i];
+			if(program.m_compiled)
+			{
+				++compiledCount;
+				spirvBytesSaved += program.m_spirvBytesSaved;
+				ANKI_RESOURCE_LOGI("\t%.3fs %u variants %uB stripped %s",
+					program.m_compileTime,
+					program.m_variantCount,
+					U32(program.m_spirvBytesSaved),
+					program.m_filename.cstr());
+			}
+		}
+
+		ANKI_RESOURCE_LOGI("Compiled %u shader programs. Stripped %uB of SPIR-V. SPIR-V cache hits %u misses %u. "
+						   "Parsed file cache hits %u misses %u",
+			compiledCount,
+			U32(spirvBytesSaved),
+			m_spirvCache.getHitCount(),
+			m_spirvCache.getMissCount(),
+			m_includeCache.getHitCount(),
+			m_includeCache.getMissCount());
+	}
+
+	for(Program& program : programs)
+	{
+		program.m_filename.destroy(m_alloc);
+		m_alloc.deleteInstance(program.m_parser);
+	}
+
+	return err;
+}
+
+Error ShaderProgramResourceSystem::parseStaleProgram(CString filename, ShaderProgramParser*& parser, U64& metafileHash)
+{
+	parser = nullptr;
+
+	Bool upToDate;
+	ANKI_CHECK(readMetafile(filename, metafileHash, upToDate));
+	if(upToDate)
+	{
+		return Error::NONE;
+	}
+
+	// Some files changed, parse to see if the program changed. The parser reads files only in parse()
+	ShaderProgramResourceSystemFilesystem fsystem;
+	fsystem.m_fsystem = m_fs;
+
+	parser = m_alloc.newInstance<ShaderProgramParser>(
+		filename, &fsystem, m_alloc, m_gr->getDeviceCapabilities(), m_gr->getBindlessLimits(), &m_includeCache);
+	const Error err = parser->parse();
+	if(err)
+	{
+		m_alloc.deleteInstance(parser);
+		parser = nullptr;
+	}
+
+	return err;
+}
+
+U64 ShaderProgramResourceSystem::computeGpuHash() const
+{
+	const GpuDeviceCapabilities caps = m_gr->getDeviceCapabilities();
+	const BindlessLimits limits = m_gr->getBindlessLimits();
+	U64 gpuHash = computeStableHash(&caps, sizeof(caps));
+	gpuHash = appendStableHash(&limits, sizeof(limits), gpuHash);
+	gpuHash = appendStableHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
+	return gpuHash;
+}
+
+U64 ShaderProgramResourceSystem::computeProgramHash(U64 sourceHash) const
+{
+	ANKI_ASSERT(sourceHash != 0);
+	const Array<U64, 2> hashes = {{sourceHash, computeGpuHash()}};
+	return computeStableHash(hashes.getBegin(), hashes.getSizeInBytes());
+}
+
+void ShaderProgramResourceSystem::getMetafileFilename(CString programFilename, StringAuto& metaFilename) const
+{
+	StringAuto baseFname(m_alloc);
+	getFilepathFilename(programFilename, baseFname);
+	metaFilename.sprintf("%s/%smeta", m_cacheDir.cstr(), baseFname.cstr());
+}
+
+Error ShaderProgramResourceSystem::readMetafile(CString filename, U64& hash, Bool& dependenciesUpToDate) const
+{
+	hash = 0;
+	dependenciesUpToDate = false;
+
+	StringAuto metaFname(m_alloc);
+	getMetafileFilename(filename, metaFname);
+	if(!fileExists(metaFname))
+	{
+		return Error::NONE;
+	}
+
+	// The layout of the file is:
+	// U64 program hash
+	// U64 GPU hash
+	// U32 dependency count
+	// For each dependency: U64 timestamp, U32 filename length, filename
+	File metaFile;
+	ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	ANKI_CHECK(metaFile.read(&hash, sizeof(hash)));
+
+	U64 gpuHash;
+	U32 dependencyCount;
+	if(metaFile.getSize() < sizeof(hash) + sizeof(gpuHash) + sizeof(dependencyCount))
+	{
+		// Old meta file without dependencies
+		return Error::NONE;
+	}
+
+	ANKI_CHECK(metaFile.read(&gpuHash, sizeof(gpuHash)));
+	ANKI_CHECK(metaFile.read(&dependencyCount, sizeof(dependencyCount)));
+	if(gpuHash != computeGpuHash() || dependencyCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	StringAuto depFilename(m_alloc);
+	for(U32 i = 0; i < dependencyCount; ++i)
+	{
+		U64 timestamp;
+		U32 length;
+		ANKI_CHECK(metaFile.read(&timestamp, sizeof(timestamp)));
+		ANKI_CHECK(metaFile.read(&length, sizeof(length)));
+		if(length == 0 || length > 1024)
+		{
+			ANKI_RESOURCE_LOGW("Corrupted meta file: %s", metaFname.cstr());
+			return Error::NONE;
+		}
+
+		depFilename.destroy();
+		depFilename.create('\0', length);
+		ANKI_CHECK(metaFile.read(&depFilename[0], length));
+
+		// Compare the timestamp. If the file is gone the program is stale. The parsing will decide if it still needs it
+		if(timestamp == 0 || !m_fs->hasFile(depFilename))
+		{
+			return Error::NONE;
+		}
+
+		U64 newTimestamp;
+		ANKI_CHECK(m_fs->getFileTimestamp(depFilename, newTimestamp));
+		if(newTimestamp != timestamp)
+		{
+			return Error::NONE;
+		}
+	}
+
+	// Even if nothing changed the binary might be missing
+	StringAuto binFname(m_alloc);
+	getBinaryFilename(filename, binFname);
+	dependenciesUpToDate = fileExists(binFname);
+
+	return Error::NONE;
+}
+
+void ShaderProgramResourceSystem::serializeMetafile(
+	U64 hash, const ShaderProgramParser& parser, DynamicArrayAuto<U8>& data) const
+{
+	auto append = [&](const void* ptr, PtrSize size) {
+		const U32 offset = data.getSize();
+		data.resize(U32(offset + size));
+		memcpy(&data[offset], ptr, size);
+	};
+
+	append(&hash, sizeof(hash));
+
+	const U64 gpuHash = computeGpuHash();
+	append(&gpuHash, sizeof(gpuHash));
+
+	const U32 dependencyCount = parser.getDependencyCount();
+	append(&dependencyCount, sizeof(dependencyCount));
+
+	for(U32 i = 0; i < dependencyCount; ++i)
+	{
+		const U64 timestamp = parser.getDependencyTimestamp(i);
+		const CString depFilename = parser.getDependencyFilename(i);
+		const U32 length = depFilename.getLength();
+		append(&timestamp, sizeof(timestamp));
+		append(&length, sizeof(length));
+		append(depFilename.cstr(), length);
+	}
+}
+
+Error ShaderProgramResourceSystem::compileProgram(CString filename)
+{
+	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
+
+	// Compile in the calling thread. Other threads might be using the hives. Programs that load in parallel compile in
+	// parallel, only the threads that load the same program wait for each other
+	beginProgramCompilation(filename);
+	ShaderProgramParser* parser;
+	U64 metafileHash;
+	Error err = parseStaleProgram(filename, parser, metafileHash);
+	if(!err && parser)
+	{
+		Bool compiled;
+		PtrSize spirvBytesSaved;
+		err = compileParsedProgram(filename, *parser, metafileHash, nullptr, compiled, spirvBytesSaved);
+		m_alloc.deleteInstance(parser);
+	}
+	endProgramCompilation(filename);
+
+	return err;
+}
+
+void ShaderProgramResourceSystem::beginProgramCompilation(CString filename)
+{
+	// Use the binary's filename since programs in different directories share the binary if they have the same name
+	StringAuto binaryFilename(m_alloc);
+	getBinaryFilename(filename, binaryFilename);
+	const U64 hash = binaryFilename.computeHash();
+
+	LockGuard<Mutex> lock(m_programsInFlightMtx);
+	while(true)
+	{
+		Bool inFlight = false;
+		for(U64 h : m_programsInFlight)
+		{
+			inFlight = inFlight || h == hash;
+		}
+
+		if(!inFlight)
+		{
+			break;
+		}
+
+		m_programsInFlightCvar.wait(m_programsInFlightMtx);
+	}
+
+	m_programsInFlight.emplaceBack(m_alloc, hash);
+}
+
+void ShaderProgramResourceSystem::endProgramCompilation(CString filename)
+{
+	StringAuto binaryFilename(m_alloc);
+	getBinaryFilename(filename, binaryFilename);
+	const U64 hash = binaryFilename.computeHash();
+
+	LockGuard<Mutex> lock(m_programsInFlightMtx);
+	for(U32 i = 0; i < m_programsInFlight.getSize(); ++i)
+	{
+		if(m_programsInFlight[i] == hash)
+		{
+			m_programsInFlight[i] = m_programsInFlight.getBack();
+			m_programsInFlight.popBack(m_alloc);
+			break;
+		}
+	}
+
+	m_programsInFlightCvar.notifyAll();
+}
+
+Error ShaderProgramResourceSystem::compileParsedProgram(CString fname,
+	const ShaderProgramParser& parser,
+	U64 metafileHash,
+	ShaderProgramAsyncTaskInterface* taskManager,
+	Bool& compiled,
+	PtrSize& spirvBytesSaved)
+{
+	compiled = false;
+	spirvBytesSaved = 0;
+
+	ShaderProgramResourceSystemSkip skip(m_alloc);
+	skip.m_system = this;
+	skip.m_metafileHash = metafileHash;
+	skip.m_fname = fname;
+
+	// Compile
+	ShaderProgramBinaryWrapper binary(m_alloc);
+	ANKI_CHECK(compileShaderProgram(parser,
+		&skip,
+		taskManager,
+		&m_spirvCache,
+		ShaderProgramCompilerOptions(),
+		m_alloc,
+		m_gr->getDeviceCapabilities(),
+		m_gr->getBindlessLimits(),
+		binary));
+
+	const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
+	if(!cachedBinIsUpToDate)
+	{
+		compiled = true;
+		spirvBytesSaved = binary.getOriginalSpirvSize() - binary.getSpirvSize();
+
+		// Save the binary to the cache
+		StringAuto storeFname(m_alloc);
+		getBinaryFilename(fname, storeFname);
+		ANKI_CHECK(binary.serializeToFile(storeFname));
+	}
+
+	// Update the meta file. Even if the program didn't change its files might have newer timestamps
+	StringAuto metaFname(m_alloc);
+	getMetafileFilename(fname, metaFname);
+	File metaFile;
+	ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_CHECK(metaFile.write(&skip.m_metafile[0], skip.m_metafile.getSizeInBytes()));
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,114 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
+#include <anki/shader_compiler/ShaderProgramParser.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+// Forward
+class ThreadHive;
+class ConfigSet;
+
+/// @addtogroup resource
+/// @{
+
+/// Compiles the shader programs (.ankiprog) to binaries that live in the cache directory. A program is compiled only
+/// if its binary is missing or stale and only the shader stages that are not in the SPIR-V cache go through the
+/// compiler.
+///
+/// Next to every binary there is a meta file with the hash of the program and the files the program read, with their
+/// modification times. If none of the files changed the program is not even parsed. The parsed files are cached and
+/// all the programs share the cache.
+class ShaderProgramResourceSystem
+{
+public:
+	ShaderProgramResourceSystem(
+		CString cacheDir, GrManager* gr, ResourceFilesystem* fs, const GenericMemoryPoolAllocator<U8>& alloc);
+
+	~ShaderProgramResourceSystem();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& config);
+
+	/// Compile all the programs of the filesystem. If the system compiles the programs when they load it does nothing.
+	/// The programs are parsed in parallel and then the variants of all the stale programs go to the hive, the
+	/// programs with the most variants first. It logs how much time each program took.
+	/// @param hive The hive that will compile the variants.
+	ANKI_USE_RESULT Error compileAllPrograms(ThreadHive& hive);
+
+	/// Compile a single program if its binary is out of date. Used when the programs compile when they load. It's
+	/// thread-safe.
+	ANKI_USE_RESULT Error compileProgram(CString filename);
+
+	/// If true the programs compile the first time they are loaded instead of at startup.
+	Bool getCompileOnLoad() const
+	{
+		return m_compileOnLoad;
+	}
+
+	/// Get the filename of the binary of a program.
+	void getBinaryFilename(CString programFilename, StringAuto& binaryFilename) const;
+
+	/// Combine the hash of the source of a program with the hash of the GPU capabilities.
+	ANKI_INTERNAL U64 computeProgramHash(U64 sourceHash) const;
+
+	/// Create the contents of the meta file of a program.
+	ANKI_INTERNAL void serializeMetafile(U64 hash, const ShaderProgramParser& parser, DynamicArrayAuto<U8>& data) const;
+
+private:
+	/// The threads that feed the variants of the programs to the hive in compileAllPrograms().
+	static constexpr U32 MAX_COMPILATION_DRIVER_THREADS = 4;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	String m_cacheDir;
+	GrManager* m_gr;
+	ResourceFilesystem* m_fs;
+	ShaderProgramSpirvCache m_spirvCache;
+	ShaderProgramParserIncludeCache m_includeCache;
+	Bool m_compileOnLoad = false;
+
+	/// @name Programs that are being compiled
+	/// @{
+	DynamicArray<U64> m_programsInFlight; ///< The hashes of their filenames.
+	Mutex m_programsInFlightMtx;
+	ConditionVariable m_programsInFlightCvar;
+	/// @}
+
+	/// Wait until no other thread compiles the program and mark it as being compiled.
+	void beginProgramCompilation(CString filename);
+
+	void endProgramCompilation(CString filename);
+
+	/// Compile a program that parseStaleProgram() returned.
+	/// @param[out] spirvBytesSaved How much smaller the SPIR-V became after stripping its debug info.
+	ANKI_USE_RESULT Error compileParsedProgram(CString filename,
+		const ShaderProgramParser& parser,
+		U64 metafileHash,
+		ShaderProgramAsyncTaskInterface* taskManager,
+		Bool& compiled,
+		PtrSize& spirvBytesSaved);
+
+	/// Parse a program if some of its files changed since the last compilation.
+	/// @param[out] parser The parser of the program or nullptr if the program is up to date. Delete it with m_alloc.
+	/// @param[out] metafileHash The hash of the program the last time it was compiled.
+	ANKI_USE_RESULT Error parseStaleProgram(CString filename, ShaderProgramParser*& parser, U64& metafileHash);
+
+	U64 computeGpuHash() const;
+
+	void getMetafileFilename(CString programFilename, StringAuto& metaFilename) const;
+
+	/// Read the meta file of a program.
+	/// @param[out] hash The hash of the program the last time it was compiled. Zero if there is no meta file.
+	/// @param[out] dependenciesUpToDate True if none of the files that the program reads changed.
+	ANKI_USE_RESULT Error readMetafile(CString filename, U64& hash, Bool& dependenciesUpToDate) const;
+};
+/// @}
+
+} // end namespace anki
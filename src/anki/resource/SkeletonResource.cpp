@@ -4,8 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/SkeletonResource.h>
-#include <anki/util/Xml.h>
-#include <anki/util/StringList.h>
+#include <anki/resource/ResourceBinary.h>
 
 namespace anki
 {
@@ -22,112 +21,84 @@ SkeletonResource::~SkeletonResource()
 
 Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
 {
-	XmlDocument doc;
-	ANKI_CHECK(openFileParseXml(filename, doc));
-
-	XmlElement rootEl;
-	ANKI_CHECK(doc.getChildElement("skeleton", rootEl));
-	XmlElement bonesEl;
-	ANKI_CHECK(rootEl.getChildElement("bones", bonesEl));
-
-	// count the bones count
-	XmlElement boneEl;
-	U32 boneCount = 0;
-
-	ANKI_CHECK(bonesEl.getChildElement("bone", boneEl));
-	ANKI_CHECK(boneEl.getSiblingElementsCount(boneCount));
-	++boneCount;
+	StackAllocator<U8> binaryAlloc;
+	SkeletonBinary* binary;
+	ANKI_CHECK(openFileLoadBinary(filename, binaryAlloc, binary));
 
+	const U32 boneCount = binary->m_bones.getSize();
 	m_bones.create(getAllocator(), boneCount);
 
-	StringListAuto boneParents(getAllocator());
-
 	// Load every bone
-	boneCount = 0;
-	do
+	for(U32 i = 0; i < boneCount; ++i)
 	{
-		Bone& bone = m_bones[boneCount];
-		bone.m_idx = boneCount;
-
-		// <name>
-		XmlElement nameEl;
-		ANKI_CHECK(boneEl.getChildElement("name", nameEl));
-		CString tmp;
-		ANKI_CHECK(nameEl.getText(tmp));
-		bone.m_name.create(getAllocator(), tmp);
-
-		// <transform>
-		XmlElement trfEl;
-		ANKI_CHECK(boneEl.getChildElement("transform", trfEl));
-		ANKI_CHECK(trfEl.getNumbers(bone.m_transform));
-
-		// <boneTransform>
-		XmlElement btrfEl;
-		ANKI_CHECK(boneEl.getChildElement("boneTransform", btrfEl));
-		ANKI_CHECK(btrfEl.getNumbers(bone.m_vertTrf));
-
-		// <parent>
-		XmlElement parentEl;
-		ANKI_CHECK(boneEl.getChildElementOptional("parent", parentEl));
-		if(parentEl)
-		{
-			CString parentName;
-			ANKI_CHECK(parentEl.getText(parentName));
-			boneParents.pushBack(parentName);
-		}
-		else
-		{
-			boneParents.pushBack("");
+		const SkeletonBinaryBone& inBone = binary->m_bones[i];
+		Bone& bone = m_bones[i];
+		bone.m_idx = i;
+		bone.m_name.create(getAllocator(), &inBone.m_name[0]);
+		bone.m_transform = Mat4(&inBone.m_transform[0]);
+		bone.m_vertTrf = Mat4(&inBone.m_vertexTransform[0]);
 
+		if(inBone.m_parent == MAX_U32)
+		{
 			if(m_rootBoneIdx != MAX_U32)
 			{
 				ANKI_RESOURCE_LOGE("Skeleton cannot have more than one root nodes");
 				return Error::USER_DATA;
 			}
 
-			m_rootBoneIdx = boneCount;
+			m_rootBoneIdx = i;
+		}
+		else if(inBone.m_parent >= boneCount || inBone.m_parent == i)
+		{
+			ANKI_RESOURCE_LOGE("Bone \"%s\" is referencing a wrong parent", &bone.m_name[0]);
+			return Error::USER_DATA;
 		}
+	}
 
-		// Advance
-		ANKI_CHECK(boneEl.getNextSiblingElement("bone", boneEl));
-		++boneCount;
-	} while(boneEl);
+	if(m_rootBoneIdx == MAX_U32)
+	{
+		ANKI_RESOURCE_LOGE("Skeleton doesn't have a root node");
+		return Error::USER_DATA;
+	}
 
-	// Resolve the parents
-	auto it = boneParents.getBegin();
-	for(U32 i = 0; i < m_bones.getSize(); ++i)
+	// Connect the parents and the children
+	for(U32 i = 0; i < boneCount; ++i)
 	{
+		const U32 parentIdx = binary->m_bones[i].m_parent;
+		if(parentIdx == MAX_U32)
+		{
+			continue;
+		}
+
 		Bone& bone = m_bones[i];
+		bone.m_parent = &m_bones[parentIdx];
 
-		if(!it->isEmpty())
+		if(bone.m_parent->m_childrenCount >= MAX_CHILDREN_PER_BONE)
 		{
-			for(U32 j = 0; j < m_bones.getSize(); ++j)
-			{
-				if(m_bones[j].m_name == *it)
-				{
-					bone.m_parent = &m_bones[j];
-					break;
-				}
-			}
-
-			if(bone.m_parent == nullptr)
-			{
-				ANKI_RESOURCE_LOGE(
-					"Bone \"%s\" is referencing an unknown parent \"%s\"", &bone.m_name[0], &it->toCString()[0]);
-				return Error::USER_DATA;
-			}
+			ANKI_RESOURCE_LOGE(
+				"Bone \"%s\" cannot have more that %u children", &bone.m_parent->m_name[0], MAX_CHILDREN_PER_BONE);
+			return Error::USER_DATA;
+		}
 
-			if(bone.m_parent->m_childrenCount >= MAX_CHILDREN_PER_BONE)
-			{
-				ANKI_RESOURCE_LOGE(
-					"Bone \"%s\" cannot have more that %u children", &bone.m_parent->m_name[0], MAX_CHILDREN_PER_BONE);
-				return Error::USER_DATA;
-			}
+		bone.m_parent->m_children[bone.m_parent->m_childrenCount++] = &bone;
+	}
 
-			bone.m_parent->m_children[bone.m_parent->m_childrenCount++] = &bone;
+	// A binary can have bones that form a loop. Those bones are not under the root so the skeleton has more than one
+	// root in practice
+	DynamicArrayAuto<const Bone*> reachableBones(getTempAllocator());
+	reachableBones.emplaceBack(&m_bones[m_rootBoneIdx]);
+	for(U32 i = 0; i < reachableBones.getSize(); ++i)
+	{
+		for(const Bone* child : reachableBones[i]->getChildren())
+		{
+			reachableBones.emplaceBack(child);
 		}
+	}
 
-		++it;
+	if(reachableBones.getSize() != boneCount)
+	{
+		ANKI_RESOURCE_LOGE("Skeleton cannot have more than one root nodes");
+		return Error::USER_DATA;
 	}
 
 	return Error::NONE;
@@ -30,11 +30,11 @@ class Event;
 
 /// The type of the scene's allocator
 template<typename T>
-using SceneAllocator = HeapAllocator<T>;
+using SceneAllocator = SlabAllocator<T>;
 
 /// The type of the scene's frame allocator
 template<typename T>
-using SceneFrameAllocator = StackAllocator<T>;
+using SceneFrameAllocator = FrameAllocator<T>;
 /// @}
 
 } // end namespace anki
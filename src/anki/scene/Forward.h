@@ -29,5 +29,6 @@ class CameraNode;
 
 // Other
 class SceneGraph;
+class SceneComponentPool;
 
 } // end namespace anki
@@ -170,6 +170,11 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		// Program
 		cmdb->bindShaderProgram(modelInf.m_program);
 
+		// The positions might be quantized
+		const Array<Vec4, 2> positionsDequantization = {
+			{modelInf.m_positionsScale.xyz0(), modelInf.m_positionsTranslation.xyz0()}};
+		cmdb->setPushConstants(&positionsDequantization[0], sizeof(positionsDequantization));
+
 		// Uniforms
 		static_cast<const MaterialRenderComponent&>(getComponent<RenderComponent>())
 			.allocateAndSetupUniforms(ctx,
@@ -0,0 +1,174 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/SceneComponentPool.h>
+
+namespace anki
+{
+
+/// The order that the components get updated. A node should create its components in the same order because a
+/// component can read the components that were created before it in the same node.
+static const Array<SceneComponentType, U32(SceneComponentType::COUNT) - 1> COMPONENT_UPDATE_ORDER = {
+	{SceneComponentType::SCRIPT,
+		SceneComponentType::PLAYER_CONTROLLER,
+		SceneComponentType::JOINT,
+		SceneComponentType::BODY,
+		SceneComponentType::SKIN,
+		SceneComponentType::MOVE,
+		SceneComponentType::OCCLUDER,
+		SceneComponentType::DECAL,
+		SceneComponentType::FOG_DENSITY,
+		SceneComponentType::TRIGGER,
+		SceneComponentType::LIGHT,
+		SceneComponentType::GLOBAL_ILLUMINATION_PROBE,
+		SceneComponentType::FRUSTUM,
+		SceneComponentType::SPATIAL,
+		SceneComponentType::REFLECTION_PROBE,
+		SceneComponentType::LENS_FLARE,
+		SceneComponentType::GENERIC_GPU_COMPUTE_JOB_COMPONENT,
+		SceneComponentType::RENDER}};
+
+static Atomic<U32> g_sceneComponentClassIdCounter = {0};
+
+U32 getSceneComponentUpdateStage(SceneComponentType type)
+{
+	ANKI_ASSERT(type != SceneComponentType::NONE && type < SceneComponentType::COUNT);
+
+	U32 order = 0;
+	while(COMPONENT_UPDATE_ORDER[order] != type)
+	{
+		++order;
+		ANKI_ASSERT(order < COMPONENT_UPDATE_ORDER.getSize());
+	}
+
+	// Stage 0 is for the feedback components that are first in their node and the odd stages are for the types
+	return 1 + order * 2;
+}
+
+U32 computeSceneComponentUpdateStage(SceneComponentType type, U32 prevComponentStage)
+{
+	if(type != SceneComponentType::NONE)
+	{
+		return getSceneComponentUpdateStage(type);
+	}
+
+	if(prevComponentStage == MAX_U32)
+	{
+		return 0;
+	}
+
+	// Two feedback components in a row would be updated in parallel
+	ANKI_ASSERT((prevComponentStage & 1) == 1 && "Feedback components should follow a component with a type");
+	return prevComponentStage + 1;
+}
+
+U32 SceneComponentClassInfo::newClassId()
+{
+	return g_sceneComponentClassIdCounter.fetchAdd(1);
+}
+
+SceneComponentPool::SceneComponentPool(const SceneComponentClassInfo& classInfo)
+	: m_classInfo(&classInfo)
+{
+	// Fit the chunks in the slabs. Components that are bigger than a slab block get a chunk each
+	m_componentsPerChunk = U32(SlabMemoryPool::MAX_SLAB_ALLOCATION_SIZE / classInfo.m_componentSize);
+	m_componentsPerChunk = clamp(m_componentsPerChunk, 1u, MAX_COMPONENTS_PER_CHUNK);
+	m_fullChunkMask = (m_componentsPerChunk == MAX_COMPONENTS_PER_CHUNK) ? MAX_U64
+																		 : (U64(1) << U64(m_componentsPerChunk)) - 1;
+}
+
+void SceneComponentPool::destroy(SceneAllocator<U8> alloc)
+{
+	ANKI_ASSERT(m_componentCount == 0 && "Components are still alive");
+
+	for(Chunk& chunk : m_chunks)
+	{
+		ANKI_ASSERT(chunk.m_memory == nullptr);
+	}
+
+	m_chunks.destroy(alloc);
+}
+
+void* SceneComponentPool::allocate(SceneAllocator<U8> alloc, U32& poolIndex)
+{
+	LockGuard<SpinLock> lock(m_mtx);
+
+	// Find a chunk with a free slot
+	U32 chunkIdx = m_firstChunkWithSpace;
+	while(chunkIdx < m_chunks.getSize() && m_chunks[chunkIdx].m_usedMask == m_fullChunkMask)
+	{
+		++chunkIdx;
+	}
+
+	if(chunkIdx == m_chunks.getSize())
+	{
+		Chunk& chunk = *m_chunks.emplaceBack(alloc);
+		chunk.m_memory = nullptr;
+		chunk.m_usedMask = 0;
+	}
+
+	m_firstChunkWithSpace = chunkIdx;
+
+	Chunk& chunk = m_chunks[chunkIdx];
+	if(chunk.m_memory == nullptr)
+	{
+		chunk.m_memory = alloc.allocate(getChunkSize(), m_classInfo->m_componentAlignment);
+	}
+
+	const U32 slot = U32(__builtin_ctzll(~chunk.m_usedMask));
+	ANKI_ASSERT(slot < m_componentsPerChunk);
+	chunk.m_usedMask |= U64(1) << U64(slot);
+	++m_componentCount;
+
+	poolIndex = chunkIdx * m_componentsPerChunk + slot;
+	return chunk.m_memory + slot * m_classInfo->m_componentSize;
+}
+
+void SceneComponentPool::initComponent(SceneComponent& comp, SceneNode& node, U32 poolIndex)
+{
+	ANKI_ASSERT(comp.m_pool == nullptr);
+	ANKI_ASSERT(reinterpret_cast<U8*>(&comp)
+				== m_chunks[poolIndex / m_componentsPerChunk].m_memory
+					   + (poolIndex % m_componentsPerChunk) * m_classInfo->m_componentSize);
+
+	comp.m_node = &node;
+	comp.m_pool = this;
+	comp.m_poolIndex = poolIndex;
+}
+
+void SceneComponentPool::deleteComponent(SceneAllocator<U8> alloc, SceneComponent& comp)
+{
+	ANKI_ASSERT(comp.m_pool == this);
+	const U32 poolIndex = comp.m_poolIndex;
+	comp.~SceneComponent();
+
+	LockGuard<SpinLock> lock(m_mtx);
+
+	const U32 chunkIdx = poolIndex / m_componentsPerChunk;
+	const U64 bit = U64(1) << U64(poolIndex % m_componentsPerChunk);
+	Chunk& chunk = m_chunks[chunkIdx];
+	ANKI_ASSERT(chunk.m_usedMask & bit);
+	chunk.m_usedMask &= ~bit;
+	ANKI_ASSERT(m_componentCount > 0);
+	--m_componentCount;
+
+	m_firstChunkWithSpace = min(m_firstChunkWithSpace, chunkIdx);
+
+	// Release the memory of the empty chunk. Only the empty chunks at the end can go away, the rest keep their index
+	if(chunk.m_usedMask == 0)
+	{
+		alloc.deallocate(chunk.m_memory, getChunkSize());
+		chunk.m_memory = nullptr;
+
+		while(m_chunks.getSize() > 0 && m_chunks.getBack().m_memory == nullptr)
+		{
+			m_chunks.popBack(alloc);
+		}
+
+		m_firstChunkWithSpace = min(m_firstChunkWithSpace, m_chunks.getSize());
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,209 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/components/SceneComponent.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup scene
+/// @{
+
+/// The number of stages that the SceneGraph updates the components in. Every component type has its own stage and the
+/// feedback components (the ones with SceneComponentType::NONE) are updated in a stage right after the stage of the
+/// component that precedes them in their node.
+constexpr U32 SCENE_COMPONENT_UPDATE_STAGE_COUNT = 1 + 2 * (U32(SceneComponentType::COUNT) - 1);
+
+/// Get the update stage of a component type.
+U32 getSceneComponentUpdateStage(SceneComponentType type);
+
+/// Compute the update stage of a component.
+/// @param type The type of the component.
+/// @param prevComponentStage The stage of the component that was created before it in the same node or MAX_U32 if
+///        it's the first component.
+U32 computeSceneComponentUpdateStage(SceneComponentType type, U32 prevComponentStage);
+
+/// The info of a C++ class of components. @memberof SceneComponentPool
+class SceneComponentClassInfo
+{
+public:
+	using UpdateCallback = Error (*)(
+		SceneComponent& comp, SceneNode& node, Second prevTime, Second crntTime, Bool& updated);
+
+	U32 m_classId;
+	U32 m_componentSize;
+	U32 m_componentAlignment;
+	UpdateCallback m_updateCallback;
+
+	/// Get the info of a component class.
+	template<typename TComponent>
+	static const SceneComponentClassInfo& get()
+	{
+		static const SceneComponentClassInfo info = {
+			newClassId(), sizeof(TComponent), alignof(TComponent), updateComponent<TComponent>};
+		return info;
+	}
+
+private:
+	static U32 newClassId();
+
+	/// Call the update of the class without going through the vtable.
+	template<typename TComponent>
+	static Error updateComponent(SceneComponent& comp, SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
+	{
+		return static_cast<TComponent&>(comp).TComponent::update(node, prevTime, crntTime, updated);
+	}
+};
+
+/// Stores all the components of a C++ class next to each other. The components are placed in chunks of memory that
+/// never move so a pointer to a component stays valid until the component gets deleted. A chunk is small enough to
+/// come from the slabs of the SlabMemoryPool and its memory is freed when its last component gets deleted.
+class SceneComponentPool : public NonCopyable
+{
+public:
+	static constexpr U32 MAX_COMPONENTS_PER_CHUNK = 64;
+
+	SceneComponentPool(const SceneComponentClassInfo& classInfo);
+
+	~SceneComponentPool()
+	{
+		ANKI_ASSERT(m_chunks.isEmpty() && "Forgot to call destroy");
+	}
+
+	void destroy(SceneAllocator<U8> alloc);
+
+	/// Allocate memory for a new component. Call initComponent() after constructing the component.
+	/// @note It's thread-safe.
+	void* allocate(SceneAllocator<U8> alloc, U32& poolIndex);
+
+	/// Set the pool related members of a component that was constructed in the memory of allocate().
+	void initComponent(SceneComponent& comp, SceneNode& node, U32 poolIndex);
+
+	/// Call the destructor of a component and free its memory.
+	/// @note It's thread-safe.
+	void deleteComponent(SceneAllocator<U8> alloc, SceneComponent& comp);
+
+	const SceneComponentClassInfo& getClassInfo() const
+	{
+		return *m_classInfo;
+	}
+
+	/// The type of the components. It's known after the first component gets created.
+	SceneComponentType getComponentType() const
+	{
+		ANKI_ASSERT(m_updateStage != MAX_U32);
+		return m_componentType;
+	}
+
+	/// The stage that the SceneGraph updates the components of the pool. It's known after the first component gets
+	/// created.
+	U32 getUpdateStage() const
+	{
+		return m_updateStage;
+	}
+
+	/// Set the type and the update stage. It's called once by the SceneGraph when it creates the first component.
+	void setComponentTypeAndUpdateStage(SceneComponentType type, U32 stage)
+	{
+		ANKI_ASSERT(m_updateStage == MAX_U32 && stage < SCENE_COMPONENT_UPDATE_STAGE_COUNT);
+		m_componentType = type;
+		m_updateStage = stage;
+	}
+
+	/// The chunks, including the ones that are empty and have no memory.
+	U32 getChunkCount() const
+	{
+		LockGuard<SpinLock> lock(m_mtx);
+		return m_chunks.getSize();
+	}
+
+	U32 getComponentsPerChunk() const
+	{
+		return m_componentsPerChunk;
+	}
+
+	U32 getComponentCount() const
+	{
+		return m_componentCount;
+	}
+
+	/// Iterate the components of a chunk in the order they are in memory. The components that get created while
+	/// iterating are not visited.
+	template<typename TFunc>
+	ANKI_USE_RESULT Error iterateChunk(U32 chunkIdx, TFunc func) const
+	{
+		// Copy the chunk because the updates might create components and grow the chunk array
+		Chunk chunk;
+		{
+			LockGuard<SpinLock> lock(m_mtx);
+			if(chunkIdx >= m_chunks.getSize())
+			{
+				// The chunk got released
+				return Error::NONE;
+			}
+
+			chunk = m_chunks[chunkIdx];
+		}
+
+		U64 mask = chunk.m_usedMask;
+		Error err = Error::NONE;
+		while(mask != 0 && !err)
+		{
+			const U32 slot = U32(__builtin_ctzll(mask));
+			mask &= mask - 1;
+			err = func(*reinterpret_cast<SceneComponent*>(chunk.m_memory + slot * m_classInfo->m_componentSize));
+		}
+
+		return err;
+	}
+
+	/// Iterate all components.
+	template<typename TFunc>
+	ANKI_USE_RESULT Error iterateComponents(TFunc func) const
+	{
+		Error err = Error::NONE;
+		for(U32 i = 0; i < getChunkCount() && !err; ++i)
+		{
+			err = iterateChunk(i, func);
+		}
+
+		return err;
+	}
+
+private:
+	/// Memory for m_componentsPerChunk components. The chunk keeps its index when it gets empty and its memory gets
+	/// freed because the index is part of the SceneComponent::m_poolIndex of the components.
+	class Chunk
+	{
+	public:
+		U8* m_memory;
+		U64 m_usedMask;
+	};
+
+	static_assert(MAX_COMPONENTS_PER_CHUNK == sizeof(Chunk::m_usedMask) * 8, "Wrong assumption");
+
+	const SceneComponentClassInfo* m_classInfo;
+	U32 m_componentsPerChunk;
+	U64 m_fullChunkMask;
+	DynamicArray<Chunk> m_chunks;
+	U32 m_firstChunkWithSpace = 0; ///< Opt. There is no free slot before that chunk.
+	U32 m_componentCount = 0;
+	mutable SpinLock m_mtx;
+
+	SceneComponentType m_componentType = SceneComponentType::NONE;
+	U32 m_updateStage = MAX_U32;
+
+	PtrSize getChunkSize() const
+	{
+		return m_classInfo->m_componentSize * m_componentsPerChunk;
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -9,6 +9,7 @@
 #include <anki/scene/ModelNode.h>
 #include <anki/scene/Octree.h>
 #include <anki/scene/components/FrustumComponent.h>
+#include <anki/scene/TransformHierarchy.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/renderer/MainRenderer.h>
@@ -33,6 +34,31 @@ public:
 	Second m_crntTime;
 };
 
+class SceneGraph::UpdateComponentsCtx
+{
+public:
+	const SceneGraph* m_scene = nullptr;
+
+	/// @name The pools and their chunk counts before the update
+	/// The updates might create components and pools so the tasks shouldn't look at the live ones.
+	/// @{
+	DynamicArrayAuto<const SceneComponentPool*> m_pools;
+	DynamicArrayAuto<U32> m_poolChunkCounts;
+	/// @}
+
+	U32 m_chunkCount = 0; ///< The chunks of all pools.
+	Atomic<U32> m_crntChunk = {0};
+
+	Second m_prevUpdateTime;
+	Second m_crntTime;
+
+	UpdateComponentsCtx(SceneFrameAllocator<U8> alloc)
+		: m_pools(alloc)
+		, m_poolChunkCounts(alloc)
+	{
+	}
+};
+
 SceneGraph::SceneGraph()
 {
 }
@@ -47,10 +73,35 @@ SceneGraph::~SceneGraph()
 
 	deleteNodesMarkedForDeletion();
 
+	for(SceneComponentPool* pool : m_componentPools)
+	{
+		if(pool)
+		{
+			pool->destroy(m_alloc);
+			m_alloc.deleteInstance(pool);
+		}
+	}
+	m_componentPools.destroy(m_alloc);
+
+	for(DynamicArray<SceneComponentPool*>& pools : m_componentPoolsPerStage)
+	{
+		pools.destroy(m_alloc);
+	}
+
 	if(m_octree)
 	{
 		m_alloc.deleteInstance(m_octree);
 	}
+
+	if(m_transformHierarchy)
+	{
+		m_alloc.deleteInstance(m_transformHierarchy);
+	}
+
+	if(m_frameAlloc.isCreated())
+	{
+		m_frameAlloc.getMemoryPool().logHighWaterMarks("Scene frame memory");
+	}
 }
 
 Error SceneGraph::init(AllocAlignedCallback allocCb,
@@ -71,7 +122,7 @@ Error SceneGraph::init(AllocAlignedCallback allocCb,
 	m_scriptManager = scriptManager;
 
 	m_alloc = SceneAllocator<U8>(allocCb, allocCbData);
-	m_frameAlloc = SceneFrameAllocator<U8>(allocCb, allocCbData, 1 * 1024 * 1024);
+	m_frameAlloc = SceneFrameAllocator<U8>(allocCb, allocCbData, 256 * 1024);
 
 	// Limits
 	m_limits.m_earlyZDistance = config.getNumberF32("scene_earlyZDistance");
@@ -84,6 +135,8 @@ Error SceneGraph::init(AllocAlignedCallback allocCb,
 	m_octree = m_alloc.newInstance<Octree>(m_alloc);
 	m_octree->init(m_sceneMin, m_sceneMax, 5); // TODO
 
+	m_transformHierarchy = m_alloc.newInstance<TransformHierarchy>(m_alloc);
+
 	// Init the default main camera
 	ANKI_CHECK(newSceneNode<PerspectiveCameraNode>("mainCamera", m_defaultMainCam));
 	m_defaultMainCam->getComponent<FrustumComponent>().setPerspective(
@@ -214,7 +267,20 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		ANKI_TRACE_SCOPED_EVENT(SCENE_NODES_UPDATE);
 		ANKI_CHECK(m_events.updateAllEvents(prevUpdateTime, crntTime));
 
-		// Then the rest
+		// Update the components one stage at a time
+		const U32 moveStage = getSceneComponentUpdateStage(SceneComponentType::MOVE);
+		for(U32 stage = 0; stage < SCENE_COMPONENT_UPDATE_STAGE_COUNT; ++stage)
+		{
+			if(stage == moveStage)
+			{
+				// Compute the world transforms before the MoveComponents pick them up
+				ANKI_CHECK(m_transformHierarchy->update(*m_threadHive));
+			}
+
+			ANKI_CHECK(updateComponentStage(stage, prevUpdateTime, crntTime));
+		}
+
+		// Then the nodes
 		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
 		UpdateSceneNodesCtx updateCtx;
 		updateCtx.m_scene = this;
@@ -255,37 +321,20 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 {
 	ANKI_TRACE_INC_COUNTER(SCENE_NODES_UPDATED, 1);
 
-	Error err = Error::NONE;
-
-	// Components update
-	Timestamp componentTimestamp = 0;
-	err = node.iterateComponents([&](SceneComponent& comp) -> Error {
-		Bool updated = false;
-		Error e = comp.update(node, prevTime, crntTime, updated);
-
-		if(updated)
-		{
-			comp.setTimestamp(node.getSceneGraph().m_timestamp);
-			componentTimestamp = max(componentTimestamp, node.getSceneGraph().m_timestamp);
-			ANKI_ASSERT(componentTimestamp > 0);
-		}
-
-		return e;
+	// The components are already updated. Find if any of them changed in this frame
+	const Timestamp timestamp = node.getSceneGraph().m_timestamp;
+	Bool componentUpdated = false;
+	Error err = node.iterateComponents([&](SceneComponent& comp) -> Error {
+		componentUpdated = componentUpdated || comp.getTimestamp() == timestamp;
+		return Error::NONE;
 	});
 
-	// Update children
-	if(!err)
-	{
-		err = node.visitChildrenMaxDepth(
-			0, [&](SceneNode& child) -> Error { return updateNode(prevTime, crntTime, child); });
-	}
-
 	// Frame update
 	if(!err)
 	{
-		if(componentTimestamp != 0)
+		if(componentUpdated)
 		{
-			node.setComponentMaxTimestamp(componentTimestamp);
+			node.setComponentMaxTimestamp(timestamp);
 		}
 		else
 		{
@@ -308,7 +357,8 @@ Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx) const
 	Error err = Error::NONE;
 	while(!quit && !err)
 	{
-		// Fetch a batch of scene nodes that don't have parent
+		// Fetch a batch of scene nodes. The components of the children don't depend on their parents any more so all
+		// nodes are independent
 		Array<SceneNode*, NODE_UPDATE_BATCH> batch;
 		U batchSize = 0;
 
@@ -328,12 +378,7 @@ Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx) const
 					break;
 				}
 
-				SceneNode& node = *ctx.m_crntNode;
-				if(node.getParent() == nullptr)
-				{
-					batch[batchSize++] = &node;
-				}
-
+				batch[batchSize++] = &(*ctx.m_crntNode);
 				++ctx.m_crntNode;
 			}
 		}
@@ -348,4 +393,129 @@ Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx) const
 	return err;
 }
 
+SceneComponentPool& SceneGraph::getComponentPool(const SceneComponentClassInfo& classInfo)
+{
+	LockGuard<Mutex> lock(m_componentPoolsMtx);
+
+	if(classInfo.m_classId >= m_componentPools.getSize())
+	{
+		m_componentPools.resize(m_alloc, classInfo.m_classId + 1, nullptr);
+	}
+
+	SceneComponentPool*& pool = m_componentPools[classInfo.m_classId];
+	if(pool == nullptr)
+	{
+		pool = m_alloc.newInstance<SceneComponentPool>(classInfo);
+	}
+
+	return *pool;
+}
+
+void SceneGraph::registerComponentPool(SceneComponentPool& pool, SceneComponentType type, U32 prevComponentStage)
+{
+	const U32 stage = computeSceneComponentUpdateStage(type, prevComponentStage);
+
+	LockGuard<Mutex> lock(m_componentPoolsMtx);
+
+	if(pool.getUpdateStage() == MAX_U32)
+	{
+		pool.setComponentTypeAndUpdateStage(type, stage);
+		m_componentPoolsPerStage[stage].emplaceBack(m_alloc, &pool);
+	}
+
+	ANKI_ASSERT(pool.getComponentType() == type);
+	ANKI_ASSERT(pool.getUpdateStage() == stage && "The components of a class should be in the same place in the nodes");
+}
+
+Error SceneGraph::updateComponentStage(U32 stage, Second prevUpdateTime, Second crntTime)
+{
+	UpdateComponentsCtx ctx(m_frameAlloc);
+	ctx.m_scene = this;
+	ctx.m_prevUpdateTime = prevUpdateTime;
+	ctx.m_crntTime = crntTime;
+
+	for(const SceneComponentPool* pool : m_componentPoolsPerStage[stage])
+	{
+		const U32 chunkCount = pool->getChunkCount();
+		ctx.m_pools.emplaceBack(pool);
+		ctx.m_poolChunkCounts.emplaceBack(chunkCount);
+		ctx.m_chunkCount += chunkCount;
+	}
+
+	const U32 taskCount = min(m_threadHive->getThreadCount(), ctx.m_chunkCount);
+	if(taskCount == 0)
+	{
+		return Error::NONE;
+	}
+	else if(taskCount == 1)
+	{
+		// Not worth waking up the threads
+		return updateComponents(ctx);
+	}
+
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+	for(U32 i = 0; i < taskCount; i++)
+	{
+		tasks[i] = ANKI_THREAD_HIVE_TASK(
+			{
+				if(self->m_scene->updateComponents(*self))
+				{
+					ANKI_SCENE_LOGF("Will not recover");
+				}
+			},
+			&ctx,
+			nullptr,
+			nullptr);
+	}
+
+	m_threadHive->submitTasks(&tasks[0], taskCount);
+	m_threadHive->waitAllTasks();
+
+	return Error::NONE;
+}
+
+Error SceneGraph::updateComponents(UpdateComponentsCtx& ctx) const
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_COMPONENTS_UPDATE);
+
+	Error err = Error::NONE;
+	while(!err)
+	{
+		U32 chunkIdx = ctx.m_crntChunk.fetchAdd(1);
+		if(chunkIdx >= ctx.m_chunkCount)
+		{
+			break;
+		}
+
+		// Find the pool of the chunk
+		U32 poolIdx = 0;
+		while(chunkIdx >= ctx.m_poolChunkCounts[poolIdx])
+		{
+			chunkIdx -= ctx.m_poolChunkCounts[poolIdx];
+			++poolIdx;
+		}
+
+		const SceneComponentPool& pool = *ctx.m_pools[poolIdx];
+		err = pool.iterateChunk(chunkIdx, [&](SceneComponent& comp) -> Error {
+			return updateComponent(pool.getClassInfo(), comp, ctx.m_prevUpdateTime, ctx.m_crntTime);
+		});
+	}
+
+	return err;
+}
+
+Error SceneGraph::updateComponent(
+	const SceneComponentClassInfo& classInfo, SceneComponent& comp, Second prevTime, Second crntTime) const
+{
+	Bool updated = false;
+	ANKI_CHECK(classInfo.m_updateCallback(comp, comp.getSceneNode(), prevTime, crntTime, updated));
+
+	if(updated)
+	{
+		comp.setTimestamp(m_timestamp);
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
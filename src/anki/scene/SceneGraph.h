@@ -26,6 +26,7 @@ class ConfigSet;
 class PerspectiveCameraNode;
 class UpdateSceneNodesCtx;
 class Octree;
+class TransformHierarchy;
 
 /// @addtogroup scene
 /// @{
@@ -150,6 +151,11 @@ public:
 	template<typename Func>
 	ANKI_USE_RESULT Error iterateSceneNodes(PtrSize begin, PtrSize end, Func func);
 
+	/// Iterate all the components of a type in the order they are stored in their pools.
+	/// @note It's not thread-safe with the creation of components.
+	template<typename TComponent, typename TFunc>
+	ANKI_USE_RESULT Error iterateComponentsOfType(TFunc func) const;
+
 	/// Create a new SceneNode
 	template<typename Node, typename... Args>
 	ANKI_USE_RESULT Error newSceneNode(const CString& name, Node*& node, Args&&... args);
@@ -228,8 +234,15 @@ public:
 		return *m_octree;
 	}
 
+	const TransformHierarchy& getTransformHierarchy() const
+	{
+		ANKI_ASSERT(m_transformHierarchy);
+		return *m_transformHierarchy;
+	}
+
 private:
 	class UpdateSceneNodesCtx;
+	class UpdateComponentsCtx;
 
 	const Timestamp* m_globalTimestamp = nullptr;
 	Timestamp m_timestamp = 0; ///< Cached timestamp
@@ -249,6 +262,13 @@ private:
 	U32 m_nodesCount = 0;
 	HashMap<CString, SceneNode*> m_nodesDict;
 
+	/// @name Component pools
+	/// @{
+	DynamicArray<SceneComponentPool*> m_componentPools; ///< Indexed by SceneComponentClassInfo::m_classId.
+	Array<DynamicArray<SceneComponentPool*>, SCENE_COMPONENT_UPDATE_STAGE_COUNT> m_componentPoolsPerStage;
+	Mutex m_componentPoolsMtx;
+	/// @}
+
 	SceneNode* m_mainCam = nullptr;
 	Timestamp m_activeCameraChangeTimestamp = 0;
 	PerspectiveCameraNode* m_defaultMainCam = nullptr;
@@ -256,6 +276,7 @@ private:
 	EventManager m_events;
 
 	Octree* m_octree = nullptr;
+	TransformHierarchy* m_transformHierarchy = nullptr;
 
 	Vec3 m_sceneMin = {-1000.0f, -200.0f, -1000.0f};
 	Vec3 m_sceneMax = {1000.0f, 200.0f, 1000.0f};
@@ -277,6 +298,20 @@ private:
 	ANKI_USE_RESULT Error updateNodes(UpdateSceneNodesCtx& ctx) const;
 	ANKI_USE_RESULT static Error updateNode(Second prevTime, Second crntTime, SceneNode& node);
 
+	/// Get or create the pool of a component class.
+	/// @note It's thread-safe.
+	SceneComponentPool& getComponentPool(const SceneComponentClassInfo& classInfo);
+
+	/// Set the update stage of a pool when its first component gets created.
+	/// @note It's thread-safe.
+	void registerComponentPool(SceneComponentPool& pool, SceneComponentType type, U32 prevComponentStage);
+
+	/// Update the components of all the pools of a stage.
+	ANKI_USE_RESULT Error updateComponentStage(U32 stage, Second prevUpdateTime, Second crntTime);
+	ANKI_USE_RESULT Error updateComponents(UpdateComponentsCtx& ctx) const;
+	ANKI_USE_RESULT Error updateComponent(
+		const SceneComponentClassInfo& classInfo, SceneComponent& comp, Second prevTime, Second crntTime) const;
+
 	/// Do visibility tests.
 	static void doVisibilityTests(SceneNode& frustumable, SceneGraph& scene, RenderQueue& rqueue);
 };
@@ -316,6 +351,23 @@ inline Error SceneGraph::newSceneNode(const CString& name, Node*& node, Args&&..
 	return err;
 }
 
+template<typename TComponent, typename TFunc>
+Error SceneGraph::iterateComponentsOfType(TFunc func) const
+{
+	for(const SceneComponentPool* pool : m_componentPools)
+	{
+		if(pool == nullptr || pool->getUpdateStage() == MAX_U32 || pool->getComponentType() != TComponent::CLASS_TYPE)
+		{
+			continue;
+		}
+
+		ANKI_CHECK(pool->iterateComponents(
+			[&](SceneComponent& comp) -> Error { return func(static_cast<TComponent&>(comp)); }));
+	}
+
+	return Error::NONE;
+}
+
 template<typename Func>
 Error SceneGraph::iterateSceneNodes(PtrSize begin, PtrSize end, Func func)
 {
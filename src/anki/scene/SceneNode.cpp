@@ -5,6 +5,8 @@
 
 #include <anki/scene/SceneNode.h>
 #include <anki/scene/SceneGraph.h>
+#include <anki/scene/TransformHierarchy.h>
+#include <anki/scene/components/MoveComponent.h>
 
 namespace anki
 {
@@ -23,12 +25,14 @@ SceneNode::~SceneNode()
 {
 	auto alloc = getAllocator();
 
-	auto it = m_components.getBegin();
-	auto end = m_components.getEnd();
-	for(; it != end; ++it)
+	for(SceneComponent* comp : m_components)
 	{
-		SceneComponent* comp = *it;
-		alloc.deleteInstance(comp);
+		if(comp->getType() == SceneComponentType::MOVE)
+		{
+			m_scene->m_transformHierarchy->removeComponent(static_cast<MoveComponent&>(*comp));
+		}
+
+		comp->m_pool->deleteComponent(alloc, *comp);
 	}
 
 	Base::destroy(alloc);
@@ -75,4 +79,53 @@ ResourceManager& SceneNode::getResourceManager()
 	return m_scene->getResourceManager();
 }
 
+void SceneNode::addChild(SceneNode* obj)
+{
+	Base::addChild(getAllocator(), obj);
+
+	// The MoveComponents of the child are now relative to this node
+	MoveComponent* parentComp = tryGetComponent<MoveComponent>();
+	Error err = obj->iterateComponentsOfType<MoveComponent>([&](MoveComponent& comp) -> Error {
+		m_scene->m_transformHierarchy->setParent(comp, parentComp);
+		return Error::NONE;
+	});
+
+	(void)err;
+}
+
+SceneComponentPool& SceneNode::getComponentPool(const SceneComponentClassInfo& classInfo)
+{
+	return m_scene->getComponentPool(classInfo);
+}
+
+void SceneNode::registerComponent(SceneComponent& comp, SceneComponentPool& pool, U32 poolIndex)
+{
+	pool.initComponent(comp, *this, poolIndex);
+
+	const U32 prevStage = (m_components.getSize() > 0) ? m_components.getBack()->m_pool->getUpdateStage() : MAX_U32;
+	m_scene->registerComponentPool(pool, comp.getType(), prevStage);
+
+	m_components.emplaceBack(getAllocator(), &comp);
+
+	if(comp.getType() == SceneComponentType::MOVE)
+	{
+		TransformHierarchy& hierarchy = *m_scene->m_transformHierarchy;
+		MoveComponent& moveComp = static_cast<MoveComponent&>(comp);
+
+		SceneNode* parent = getParent();
+		hierarchy.addComponent(moveComp, (parent) ? parent->tryGetComponent<MoveComponent>() : nullptr);
+
+		// The children attach to the last MoveComponent of the node
+		ANKI_ASSERT(tryGetComponent<MoveComponent>() == &moveComp);
+		Error err = visitChildrenMaxDepth(0, [&](SceneNode& child) -> Error {
+			return child.iterateComponentsOfType<MoveComponent>([&](MoveComponent& childComp) -> Error {
+				hierarchy.setParent(childComp, &moveComp);
+				return Error::NONE;
+			});
+		});
+
+		(void)err;
+	}
+}
+
 } // end namespace anki
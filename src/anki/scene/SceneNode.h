@@ -11,7 +11,7 @@
 #include <anki/util/BitSet.h>
 #include <anki/util/List.h>
 #include <anki/util/Enum.h>
-#include <anki/scene/components/SceneComponent.h>
+#include <anki/scene/SceneComponentPool.h>
 
 namespace anki
 {
@@ -81,10 +81,7 @@ public:
 
 	SceneFrameAllocator<U8> getFrameAllocator() const;
 
-	void addChild(SceneNode* obj)
-	{
-		Base::addChild(getAllocator(), obj);
-	}
+	void addChild(SceneNode* obj);
 
 	/// This is called by the scene every frame after logic and before rendering. By default it does nothing.
 	/// @param prevUpdateTime Timestamp of the previous update
@@ -202,21 +199,29 @@ public:
 	}
 
 protected:
-	/// Create and append a component to the components container. The SceneNode has the ownership.
+	/// Create and append a component to the components container. The SceneNode has the ownership. The component is
+	/// placed in the SceneComponentPool of its class.
 	template<typename TComponent, typename... TArgs>
 	TComponent* newComponent(TArgs&&... args)
 	{
-		TComponent* comp = getAllocator().newInstance<TComponent>(std::forward<TArgs>(args)...);
-		m_components.emplaceBack(getAllocator(), comp);
+		SceneComponentPool& pool = getComponentPool(SceneComponentClassInfo::get<TComponent>());
+		U32 poolIndex;
+		void* mem = pool.allocate(getAllocator(), poolIndex);
+		TComponent* comp = ::new(mem) TComponent(std::forward<TArgs>(args)...);
+		registerComponent(*comp, pool, poolIndex);
 		return comp;
 	}
 
 	ResourceManager& getResourceManager();
 
 private:
+	SceneComponentPool& getComponentPool(const SceneComponentClassInfo& classInfo);
+
+	void registerComponent(SceneComponent& comp, SceneComponentPool& pool, U32 poolIndex);
+
 	SceneGraph* m_scene = nullptr;
 	U64 m_uuid;
-	String m_name; ///< A unique name
+	SsoString m_name; ///< A unique name. Most fit inline.
 
 	DynamicArray<SceneComponent*> m_components;
 
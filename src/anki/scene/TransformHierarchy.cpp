@@ -0,0 +1,337 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/TransformHierarchy.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+class TransformHierarchy::UpdateLevelCtx
+{
+public:
+	TransformHierarchy* m_hierarchy = nullptr;
+	U32 m_level = 0;
+	Atomic<U32> m_crntComponent = {0};
+	U32 m_end = 0;
+};
+
+TransformHierarchy::~TransformHierarchy()
+{
+	ANKI_ASSERT(m_componentCount == 0 && "Components are still in the hierarchy");
+
+	for(Level& level : m_levels)
+	{
+		level.m_components.destroy(m_alloc);
+		level.m_parents.destroy(m_alloc);
+		level.m_worldTrfs.destroy(m_alloc);
+		level.m_dirty.destroy(m_alloc);
+	}
+
+	m_levels.destroy(m_alloc);
+}
+
+void TransformHierarchy::addComponent(MoveComponent& comp, MoveComponent* parent)
+{
+	ANKI_ASSERT(comp.m_hierarchyIndex == MAX_U32 && "Already added");
+	ANKI_ASSERT(parent == nullptr || parent->m_hierarchyIndex != MAX_U32);
+
+	LockGuard<Mutex> lock(m_mtx);
+	linkToParent(comp, parent);
+	insertEntry(comp, (parent) ? parent->m_hierarchyLevel + 1 : 0);
+}
+
+void TransformHierarchy::removeComponent(MoveComponent& comp)
+{
+	ANKI_ASSERT(comp.m_hierarchyIndex != MAX_U32 && "Not added");
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	// The children become roots
+	while(comp.m_hierarchyFirstChild)
+	{
+		MoveComponent& child = *comp.m_hierarchyFirstChild;
+		unlinkFromParent(child);
+		relevelSubtree(child);
+	}
+
+	unlinkFromParent(comp);
+	removeEntry(comp);
+}
+
+void TransformHierarchy::setParent(MoveComponent& comp, MoveComponent* parent)
+{
+	ANKI_ASSERT(comp.m_hierarchyIndex != MAX_U32 && "Not added");
+	ANKI_ASSERT(parent == nullptr || parent->m_hierarchyIndex != MAX_U32);
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	if(comp.m_hierarchyParent == parent)
+	{
+		return;
+	}
+
+#if ANKI_ENABLE_ASSERTS
+	for(const MoveComponent* it = parent; it; it = it->m_hierarchyParent)
+	{
+		ANKI_ASSERT(it != &comp && "Cyclic hierarchy");
+	}
+#endif
+
+	unlinkFromParent(comp);
+	linkToParent(comp, parent);
+	relevelSubtree(comp);
+}
+
+void TransformHierarchy::linkToParent(MoveComponent& comp, MoveComponent* parent)
+{
+	ANKI_ASSERT(comp.m_hierarchyParent == nullptr && comp.m_hierarchyNextSibling == nullptr);
+
+	if(parent)
+	{
+		comp.m_hierarchyParent = parent;
+		comp.m_hierarchyNextSibling = parent->m_hierarchyFirstChild;
+		parent->m_hierarchyFirstChild = &comp;
+	}
+}
+
+void TransformHierarchy::unlinkFromParent(MoveComponent& comp)
+{
+	if(comp.m_hierarchyParent)
+	{
+		MoveComponent** it = &comp.m_hierarchyParent->m_hierarchyFirstChild;
+		while(*it != &comp)
+		{
+			ANKI_ASSERT(*it);
+			it = &(*it)->m_hierarchyNextSibling;
+		}
+
+		*it = comp.m_hierarchyNextSibling;
+	}
+
+	comp.m_hierarchyParent = nullptr;
+	comp.m_hierarchyNextSibling = nullptr;
+}
+
+void TransformHierarchy::insertEntry(MoveComponent& comp, U32 level)
+{
+	ANKI_ASSERT(comp.m_hierarchyIndex == MAX_U32);
+	ANKI_ASSERT((comp.m_hierarchyParent == nullptr && level == 0)
+				|| (comp.m_hierarchyParent && comp.m_hierarchyParent->m_hierarchyLevel + 1 == level));
+
+	while(m_levels.getSize() <= level)
+	{
+		m_levels.emplaceBack(m_alloc);
+	}
+
+	Level& l = m_levels[level];
+	comp.m_hierarchyLevel = level;
+	comp.m_hierarchyIndex = l.m_components.getSize();
+
+	l.m_components.emplaceBack(m_alloc, &comp);
+	l.m_parents.emplaceBack(m_alloc, (comp.m_hierarchyParent) ? comp.m_hierarchyParent->m_hierarchyIndex : MAX_U32);
+	l.m_worldTrfs.emplaceBack(m_alloc, comp.getWorldTransform());
+	l.m_dirty.emplaceBack(m_alloc, false);
+
+	++m_componentCount;
+}
+
+void TransformHierarchy::removeEntry(MoveComponent& comp)
+{
+	const U32 level = comp.m_hierarchyLevel;
+	const U32 idx = comp.m_hierarchyIndex;
+	Level& l = m_levels[level];
+	ANKI_ASSERT(l.m_components[idx] == &comp);
+
+	// Move the last component of the level in the hole
+	const U32 last = l.m_components.getSize() - 1;
+	if(idx != last)
+	{
+		MoveComponent& moved = *l.m_components[last];
+		l.m_components[idx] = &moved;
+		l.m_parents[idx] = l.m_parents[last];
+		l.m_worldTrfs[idx] = l.m_worldTrfs[last];
+		l.m_dirty[idx] = l.m_dirty[last];
+		moved.m_hierarchyIndex = idx;
+
+		// Its children point to it. Skip the children that are not in a level at the moment
+		for(MoveComponent* child = moved.m_hierarchyFirstChild; child; child = child->m_hierarchyNextSibling)
+		{
+			if(child->m_hierarchyIndex != MAX_U32)
+			{
+				ANKI_ASSERT(child->m_hierarchyLevel == level + 1);
+				m_levels[level + 1].m_parents[child->m_hierarchyIndex] = idx;
+			}
+		}
+	}
+
+	l.m_components.popBack(m_alloc);
+	l.m_parents.popBack(m_alloc);
+	l.m_worldTrfs.popBack(m_alloc);
+	l.m_dirty.popBack(m_alloc);
+
+	comp.m_hierarchyLevel = MAX_U32;
+	comp.m_hierarchyIndex = MAX_U32;
+	ANKI_ASSERT(m_componentCount > 0);
+	--m_componentCount;
+
+	// Drop the empty levels at the end
+	while(m_levels.getSize() > 0 && m_levels.getBack().m_components.getSize() == 0)
+	{
+		Level& back = m_levels.getBack();
+		back.m_components.destroy(m_alloc);
+		back.m_parents.destroy(m_alloc);
+		back.m_worldTrfs.destroy(m_alloc);
+		back.m_dirty.destroy(m_alloc);
+		m_levels.popBack(m_alloc);
+	}
+}
+
+void TransformHierarchy::relevelSubtree(MoveComponent& comp)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_TRANSFORM_HIERARCHY_RELEVEL);
+
+	// The world transforms of the subtree need to be recomputed
+	comp.markForUpdate();
+
+	const U32 newLevel = (comp.m_hierarchyParent) ? comp.m_hierarchyParent->m_hierarchyLevel + 1 : 0;
+	if(newLevel == comp.m_hierarchyLevel)
+	{
+		// Same level, only the parent index changes
+		m_levels[newLevel].m_parents[comp.m_hierarchyIndex] =
+			(comp.m_hierarchyParent) ? comp.m_hierarchyParent->m_hierarchyIndex : MAX_U32;
+		return;
+	}
+
+	// Gather the subtree, parents first
+	DynamicArrayAuto<MoveComponent*> subtree(m_alloc);
+	subtree.emplaceBack(&comp);
+	for(U32 i = 0; i < subtree.getSize(); ++i)
+	{
+		for(MoveComponent* child = subtree[i]->m_hierarchyFirstChild; child; child = child->m_hierarchyNextSibling)
+		{
+			subtree.emplaceBack(child);
+		}
+	}
+
+	// Remove them parents first so the components that are still in the levels always have their children in the
+	// next level. Then insert them parents first so the children find the new indices of their parents
+	for(MoveComponent* c : subtree)
+	{
+		removeEntry(*c);
+	}
+
+	for(MoveComponent* c : subtree)
+	{
+		insertEntry(*c, (c->m_hierarchyParent) ? c->m_hierarchyParent->m_hierarchyLevel + 1 : 0);
+	}
+}
+
+Error TransformHierarchy::update(ThreadHive& hive)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_TRANSFORM_HIERARCHY_UPDATE);
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	// The parents are always in the previous level so the components of a level don't depend on each other
+	for(U32 level = 0; level < m_levels.getSize(); ++level)
+	{
+		const U32 end = m_levels[level].m_components.getSize();
+		const U32 batchCount = (end + COMPONENTS_PER_TASK_BATCH - 1) / COMPONENTS_PER_TASK_BATCH;
+		const U32 taskCount = min(hive.getThreadCount(), batchCount);
+
+		if(taskCount <= 1)
+		{
+			updateRange(level, 0, end);
+			continue;
+		}
+
+		UpdateLevelCtx ctx;
+		ctx.m_hierarchy = this;
+		ctx.m_level = level;
+		ctx.m_end = end;
+
+		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+		for(U32 i = 0; i < taskCount; ++i)
+		{
+			tasks[i] = ANKI_THREAD_HIVE_TASK(
+				{
+					while(true)
+					{
+						const U32 batchBegin = self->m_crntComponent.fetchAdd(COMPONENTS_PER_TASK_BATCH);
+						if(batchBegin >= self->m_end)
+						{
+							break;
+						}
+
+						const U32 batchEnd = batchBegin + COMPONENTS_PER_TASK_BATCH;
+						self->m_hierarchy->updateRange(self->m_level, batchBegin, min(batchEnd, self->m_end));
+					}
+				},
+				&ctx,
+				nullptr,
+				nullptr);
+		}
+
+		hive.submitTasks(&tasks[0], taskCount);
+		hive.waitAllTasks();
+	}
+
+	return Error::NONE;
+}
+
+void TransformHierarchy::updateRange(U32 level, U32 begin, U32 end)
+{
+	Level& l = m_levels[level];
+	const Level* parentLevel = (level > 0) ? &m_levels[level - 1] : nullptr;
+
+	for(U32 i = begin; i < end; ++i)
+	{
+		MoveComponent& comp = *l.m_components[i];
+		const U32 parent = l.m_parents[i];
+		ANKI_ASSERT((parent == MAX_U32) == (parentLevel == nullptr));
+
+		// A dirty parent makes the whole subtree dirty
+		const Bool parentDirty = parent != MAX_U32 && parentLevel->m_dirty[parent];
+		const Bool dirty = parentDirty || comp.m_flags.get(MoveComponentFlag::MARKED_FOR_UPDATE);
+		l.m_dirty[i] = dirty;
+
+		if(!dirty)
+		{
+			continue;
+		}
+
+		comp.m_flags.unset(MoveComponentFlag::MARKED_FOR_UPDATE);
+
+		if(parent == MAX_U32 || comp.m_flags.get(MoveComponentFlag::IGNORE_PARENT_TRANSFORM))
+		{
+			l.m_worldTrfs[i] = comp.getLocalTransform();
+		}
+		else if(comp.m_flags.get(MoveComponentFlag::IGNORE_LOCAL_TRANSFORM))
+		{
+			l.m_worldTrfs[i] = parentLevel->m_worldTrfs[parent];
+		}
+		else
+		{
+			l.m_worldTrfs[i] = parentLevel->m_worldTrfs[parent].combineTransformations(comp.getLocalTransform());
+		}
+	}
+}
+
+const Transform& TransformHierarchy::getWorldTransform(const MoveComponent& comp) const
+{
+	ANKI_ASSERT(comp.m_hierarchyIndex != MAX_U32);
+	return m_levels[comp.m_hierarchyLevel].m_worldTrfs[comp.m_hierarchyIndex];
+}
+
+Bool TransformHierarchy::isDirty(const MoveComponent& comp) const
+{
+	ANKI_ASSERT(comp.m_hierarchyIndex != MAX_U32);
+	return m_levels[comp.m_hierarchyLevel].m_dirty[comp.m_hierarchyIndex];
+}
+
+} // end namespace anki
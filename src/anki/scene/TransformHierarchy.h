@@ -0,0 +1,108 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/Common.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+#include <anki/Math.h>
+
+namespace anki
+{
+
+// Forward
+class MoveComponent;
+class ThreadHive;
+
+/// @addtogroup scene
+/// @{
+
+/// The MoveComponents of the scene flattened into arrays, one array per depth in the node hierarchy. The world
+/// transforms are computed one depth level at a time and every level is spread across the threads so a big hierarchy
+/// doesn't end up in a single thread. MoveComponent::update() gets its world transform from here.
+///
+/// The arrays are patched when components get added, removed or change parents. Only the components that move to
+/// another level are touched.
+class TransformHierarchy : public NonCopyable
+{
+public:
+	TransformHierarchy(SceneAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~TransformHierarchy();
+
+	/// Add a component.
+	/// @param parent The component that the world transform of @a comp is relative to. It can be nullptr.
+	/// @note It's thread-safe.
+	void addComponent(MoveComponent& comp, MoveComponent* parent);
+
+	/// Remove a component. Its children become roots.
+	/// @note It's thread-safe.
+	void removeComponent(MoveComponent& comp);
+
+	/// Change the parent of a component. The component and its children move to their new levels.
+	/// @note It's thread-safe.
+	void setParent(MoveComponent& comp, MoveComponent* parent);
+
+	/// Compute the world transforms of the components that are marked for update and the world transforms of their
+	/// children. It clears the MoveComponentFlag::MARKED_FOR_UPDATE of the components.
+	ANKI_USE_RESULT Error update(ThreadHive& hive);
+
+	const Transform& getWorldTransform(const MoveComponent& comp) const;
+
+	/// Return true if the world transform changed in the last update().
+	Bool isDirty(const MoveComponent& comp) const;
+
+	U32 getComponentCount() const
+	{
+		return m_componentCount;
+	}
+
+	U32 getLevelCount() const
+	{
+		return m_levels.getSize();
+	}
+
+private:
+	/// Less than that and a level is updated in the calling thread.
+	static constexpr U32 COMPONENTS_PER_TASK_BATCH = 64;
+
+	/// The components of a depth level.
+	class Level
+	{
+	public:
+		DynamicArray<MoveComponent*> m_components;
+		DynamicArray<U32> m_parents; ///< The index of the parent's component in the previous level or MAX_U32.
+		DynamicArray<Transform> m_worldTrfs;
+		DynamicArray<Bool> m_dirty;
+	};
+
+	class UpdateLevelCtx;
+
+	SceneAllocator<U8> m_alloc;
+	DynamicArray<Level> m_levels;
+	U32 m_componentCount = 0;
+	Mutex m_mtx;
+
+	/// Append a component to a level.
+	void insertEntry(MoveComponent& comp, U32 level);
+
+	/// Remove a component from its level. The last component of the level takes its place.
+	void removeEntry(MoveComponent& comp);
+
+	/// Move a component and all its children to the levels that match its parent.
+	void relevelSubtree(MoveComponent& comp);
+
+	void linkToParent(MoveComponent& comp, MoveComponent* parent);
+	void unlinkFromParent(MoveComponent& comp);
+
+	void updateRange(U32 level, U32 begin, U32 end);
+};
+/// @}
+
+} // end namespace anki
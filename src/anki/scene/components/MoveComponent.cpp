@@ -4,7 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/scene/components/MoveComponent.h>
-#include <anki/scene/SceneNode.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/TransformHierarchy.h>
 
 namespace anki
 {
@@ -21,72 +22,19 @@ MoveComponent::~MoveComponent()
 }
 
 Error MoveComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
-{
-	updated = updateWorldTransform(node);
-	return Error::NONE;
-}
-
-Bool MoveComponent::updateWorldTransform(SceneNode& node)
 {
 	m_prevWTrf = m_wtrf;
-	const Bool dirty = m_flags.get(MoveComponentFlag::MARKED_FOR_UPDATE);
-
-	// If dirty then update world transform
-	if(dirty)
-	{
-		const SceneNode* parent = node.getParent();
-
-		if(parent)
-		{
-			const MoveComponent* parentMove = parent->tryGetComponent<MoveComponent>();
 
-			if(parentMove == nullptr)
-			{
-				// Parent not movable
-				m_wtrf = m_ltrf;
-			}
-			else if(m_flags.get(MoveComponentFlag::IGNORE_PARENT_TRANSFORM))
-			{
-				m_wtrf = m_ltrf;
-			}
-			else if(m_flags.get(MoveComponentFlag::IGNORE_LOCAL_TRANSFORM))
-			{
-				m_wtrf = parentMove->getWorldTransform();
-			}
-			else
-			{
-				m_wtrf = parentMove->getWorldTransform().combineTransformations(m_ltrf);
-			}
-		}
-		else
-		{
-			// No parent
+	// The TransformHierarchy has already computed the world transform and consumed the MARKED_FOR_UPDATE flag
+	const TransformHierarchy& hierarchy = node.getSceneGraph().getTransformHierarchy();
+	updated = hierarchy.isDirty(*this);
 
-			m_wtrf = m_ltrf;
-		}
-
-		// Now it's a good time to cleanse parent
-		m_flags.unset(MoveComponentFlag::MARKED_FOR_UPDATE);
-	}
-
-	// If this is dirty then make children dirty as well. Don't walk the whole tree because you will re-walk it later
-	if(dirty)
+	if(updated)
 	{
-		Error err = node.visitChildrenMaxDepth(1, [](SceneNode& childNode) -> Error {
-			Error e = childNode.iterateComponentsOfType<MoveComponent>([](MoveComponent& mov) -> Error {
-				mov.markForUpdate();
-				return Error::NONE;
-			});
-
-			(void)e;
-
-			return Error::NONE;
-		});
-
-		(void)err;
+		m_wtrf = hierarchy.getWorldTransform(*this);
 	}
 
-	return dirty;
+	return Error::NONE;
 }
 
 } // end namespace anki
@@ -35,6 +35,8 @@ ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MoveComponentFlag, inline)
 /// Interface for movable scene nodes
 class MoveComponent : public SceneComponent
 {
+	friend class TransformHierarchy;
+
 public:
 	static const SceneComponentType CLASS_TYPE = SceneComponentType::MOVE;
 
@@ -159,7 +161,8 @@ private:
 	/// The transformation in local space
 	Transform m_ltrf = Transform::getIdentity();
 
-	/// The transformation in world space (local combined with parent's transformation)
+	/// The transformation in world space (local combined with parent's transformation). A copy of the one in the
+	/// TransformHierarchy.
 	Transform m_wtrf = Transform::getIdentity();
 
 	/// Keep the previous transformation for checking if it moved
@@ -167,13 +170,19 @@ private:
 
 	BitMask<MoveComponentFlag> m_flags;
 
+	/// @name TransformHierarchy data
+	/// @{
+	MoveComponent* m_hierarchyParent = nullptr;
+	MoveComponent* m_hierarchyFirstChild = nullptr;
+	MoveComponent* m_hierarchyNextSibling = nullptr;
+	U32 m_hierarchyLevel = MAX_U32;
+	U32 m_hierarchyIndex = MAX_U32; ///< The place of the component in its level.
+	/// @}
+
 	void markForUpdate()
 	{
 		m_flags.set(MoveComponentFlag::MARKED_FOR_UPDATE);
 	}
-
-	/// Called every frame. It updates the @a m_wtrf if @a shouldUpdateWTrf is true. Then it moves to the children.
-	Bool updateWorldTransform(SceneNode& node);
 };
 /// @}
 
@@ -56,41 +56,26 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 	ctx.m_commandBuffer->bindUniformBuffer(
 		set, m_mtl->getUniformsBinding(), token.m_buffer, token.m_offset, token.m_range);
 
+	// The values that the material sets are the same every draw
+	variant.writePrebakedShaderBlockMemory(uniformsBegin, uniformsEnd);
+
 	// Iterate variables
 	for(auto it = m_vars.getBegin(); it != m_vars.getEnd(); ++it)
 	{
 		const MaterialRenderComponentVariable& var = *it;
 		const MaterialVariable& mvar = var.getMaterialVariable();
 
-		if(!variant.isVariableActive(mvar))
+		if(!variant.isVariableActive(mvar) || (mvar.inBlock() && !mvar.isBuildin()))
 		{
 			continue;
 		}
 
 		switch(mvar.getDataType())
 		{
-		case ShaderVariableDataType::FLOAT:
-		{
-			const F32 val = mvar.getValue<F32>();
-			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-			break;
-		}
-		case ShaderVariableDataType::VEC2:
-		{
-			const Vec2 val = mvar.getValue<Vec2>();
-			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-			break;
-		}
 		case ShaderVariableDataType::VEC3:
 		{
 			switch(mvar.getBuiltin())
 			{
-			case BuiltinMaterialVariableId::NONE:
-			{
-				const Vec3 val = mvar.getValue<Vec3>();
-				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-				break;
-			}
 			case BuiltinMaterialVariableId::CAMERA_POSITION:
 			{
 				const Vec3 val = ctx.m_cameraTransform.getTranslationPart().xyz();
@@ -103,22 +88,10 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 
 			break;
 		}
-		case ShaderVariableDataType::VEC4:
-		{
-			const Vec4 val = mvar.getValue<Vec4>();
-			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-			break;
-		}
 		case ShaderVariableDataType::MAT3:
 		{
 			switch(mvar.getBuiltin())
 			{
-			case BuiltinMaterialVariableId::NONE:
-			{
-				const Mat3 val = mvar.getValue<Mat3>();
-				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-				break;
-			}
 			case BuiltinMaterialVariableId::NORMAL_MATRIX:
 			{
 				ANKI_ASSERT(transforms.getSize() > 0);
@@ -163,12 +136,6 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 		{
 			switch(mvar.getBuiltin())
 			{
-			case BuiltinMaterialVariableId::NONE:
-			{
-				const Mat4 val = mvar.getValue<Mat4>();
-				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
-				break;
-			}
 			case BuiltinMaterialVariableId::MODEL_VIEW_PROJECTION_MATRIX:
 			{
 				ANKI_ASSERT(transforms.getSize() > 0);
@@ -42,9 +42,13 @@ enum class SceneComponentType : U16
 	LAST_COMPONENT_ID = PLAYER_CONTROLLER
 };
 
-/// Scene node component
+/// Scene node component. The components live in the SceneComponentPool of their class and the pointers to them are
+/// stable until their node deletes them.
 class SceneComponent
 {
+	friend class SceneNode;
+	friend class SceneComponentPool;
+
 public:
 	/// Construct the scene component.
 	SceneComponent(SceneComponentType type)
@@ -61,6 +65,13 @@ public:
 		return m_type;
 	}
 
+	/// Get the node that owns this component.
+	SceneNode& getSceneNode() const
+	{
+		ANKI_ASSERT(m_node);
+		return *m_node;
+	}
+
 	Timestamp getTimestamp() const
 	{
 		return m_timestamp;
@@ -89,6 +100,9 @@ public:
 	}
 
 private:
+	SceneNode* m_node = nullptr;
+	SceneComponentPool* m_pool = nullptr;
+	U32 m_poolIndex = MAX_U32; ///< The slot of the component inside the pool.
 	Timestamp m_timestamp = 1; ///< Indicates when an update happened
 	SceneComponentType m_type;
 };
@@ -8,10 +8,16 @@
 #include <anki/util/Logger.h>
 #include <anki/util/String.h>
 #include <anki/util/BitSet.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
 
+// Forward
+class ShaderProgramParser;
+class ShaderProgramParserIncludeCache;
+
 /// @addtogroup shader_compiler
 /// @{
 
@@ -29,13 +35,21 @@ class ShaderProgramFilesystemInterface
 {
 public:
 	virtual ANKI_USE_RESULT Error readAllText(CString filename, StringAuto& txt) = 0;
+
+	/// Get the modification time of a file. If it's zero the ShaderProgramParserIncludeCache won't cache the file.
+	virtual ANKI_USE_RESULT Error getFileTimestamp(CString filename, U64& timestamp)
+	{
+		timestamp = 0;
+		return Error::NONE;
+	}
 };
 
 /// This controls if the compilation will continue after the parsing stage.
 class ShaderProgramPostParseInterface
 {
 public:
-	virtual Bool skipCompilation(U64 programHash) = 0;
+	/// @param parser The parser of the program. It knows the hash of the program and the files it read.
+	virtual Bool skipCompilation(const ShaderProgramParser& parser) = 0;
 };
 
 /// An interface for asynchronous shader compilation.
@@ -46,6 +60,21 @@ public:
 
 	virtual ANKI_USE_RESULT Error joinTasks() = 0;
 };
+
+/// A cache of compiled SPIR-V. The compiler uses it to skip the variants whose preprocessed source didn't change. It
+/// will be accessed by many threads.
+class ShaderProgramSpirvCacheInterface
+{
+public:
+	/// Find the SPIR-V of a shader stage.
+	/// @param sourceHash The hash of the preprocessed source, the shader type and the GPU capabilities.
+	/// @param[out] spirv The SPIR-V if it was found.
+	/// @return True if it was found.
+	virtual Bool find(U64 sourceHash, DynamicArrayAuto<U8>& spirv) = 0;
+
+	/// Store the SPIR-V of a shader stage.
+	virtual void store(U64 sourceHash, ConstWeakArray<U8> spirv) = 0;
+};
 /// @}
 
 } // end namespace anki
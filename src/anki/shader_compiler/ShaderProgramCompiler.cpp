@@ -7,48 +7,57 @@
 #include <anki/shader_compiler/ShaderProgramParser.h>
 #include <anki/shader_compiler/Glslang.h>
 #include <anki/shader_compiler/ShaderProgramReflection.h>
+#include <anki/shader_compiler/SpirvStrip.h>
 #include <anki/util/Serializer.h>
+#include <anki/util/Filesystem.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
 
 static const char* SHADER_BINARY_MAGIC = "ANKISDR1";
-const U32 SHADER_BINARY_VERSION = 1;
+const U32 SHADER_BINARY_VERSION = 2;
 
 Error ShaderProgramBinaryWrapper::serializeToFile(CString fname) const
 {
 	ANKI_ASSERT(m_binary);
 
-	File file;
-	ANKI_CHECK(file.open(fname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-
-	BinarySerializer serializer;
 	HeapAllocator<U8> tmpAlloc(
 		m_alloc.getMemoryPool().getAllocationCallback(), m_alloc.getMemoryPool().getAllocationCallbackUserData());
-	ANKI_CHECK(serializer.serialize(*m_binary, tmpAlloc, file));
 
-	return Error::NONE;
+	// Other processes might have the file mapped so don't truncate it. Write a new file and replace the old one
+	StringAuto tmpFname(tmpAlloc);
+	tmpFname.sprintf("%s.%016" PRIx64 ".tmp", fname.cstr(), getRandom());
+	{
+		File file;
+		ANKI_CHECK(file.open(tmpFname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+		BinarySerializer serializer;
+		ANKI_CHECK(serializer.serialize(*m_binary, tmpAlloc, file));
+	}
+
+	return renameFile(tmpFname.toCString(), fname);
 }
 
 Error ShaderProgramBinaryWrapper::deserializeFromFile(CString fname)
 {
 	cleanup();
 
-	File file;
-	ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
-
-	BinaryDeserializer deserializer;
-	ANKI_CHECK(deserializer.deserialize(m_binary, m_alloc, file));
-
-	m_singleAllocation = true;
+	// Map the file and use it in place. The code blocks are never written so their pages are shared with the other
+	// processes that load the same binary. Only the pages that have pointers get a private copy
+	ANKI_CHECK(m_mappedFile.open(fname));
 
-	if(memcmp(SHADER_BINARY_MAGIC, &m_binary->m_magic[0], 0) != 0)
+	ShaderProgramBinary* binary;
+	const Error err = BinaryDeserializer::deserializeInPlace(binary, m_mappedFile.getData(), m_mappedFile.getSize());
+	if(err || memcmp(SHADER_BINARY_MAGIC, &binary->m_magic[0], 8) != 0)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Corrupted or wrong version of shader binary: %s", fname.cstr());
+		m_mappedFile.close();
 		return Error::USER_DATA;
 	}
 
+	m_binary = binary;
 	return Error::NONE;
 }
 
@@ -59,76 +68,80 @@ void ShaderProgramBinaryWrapper::cleanup()
 		return;
 	}
 
-	if(!m_singleAllocation)
+	if(m_mappedFile.isOpen())
 	{
-		for(ShaderProgramBinaryMutator& mutator : m_binary->m_mutators)
-		{
-			m_alloc.getMemoryPool().free(mutator.m_values.getBegin());
-		}
-		m_alloc.getMemoryPool().free(m_binary->m_mutators.getBegin());
+		// The binary is inside the mapped file
+		m_mappedFile.close();
+		m_binary = nullptr;
+		return;
+	}
 
-		for(ShaderProgramBinaryCodeBlock& code : m_binary->m_codeBlocks)
-		{
-			m_alloc.getMemoryPool().free(code.m_binary.getBegin());
-		}
-		m_alloc.getMemoryPool().free(m_binary->m_codeBlocks.getBegin());
+	for(ShaderProgramBinaryMutator& mutator : m_binary->m_mutators)
+	{
+		m_alloc.getMemoryPool().free(mutator.m_values.getBegin());
+	}
+	m_alloc.getMemoryPool().free(m_binary->m_mutators.getBegin());
 
-		for(ShaderProgramBinaryMutation& m : m_binary->m_mutations)
-		{
-			m_alloc.getMemoryPool().free(m.m_values.getBegin());
-		}
-		m_alloc.getMemoryPool().free(m_binary->m_mutations.getBegin());
+	for(ShaderProgramBinaryCodeBlock& code : m_binary->m_codeBlocks)
+	{
+		m_alloc.getMemoryPool().free(code.m_binary.getBegin());
+	}
+	m_alloc.getMemoryPool().free(m_binary->m_codeBlocks.getBegin());
+
+	for(ShaderProgramBinaryMutation& m : m_binary->m_mutations)
+	{
+		m_alloc.getMemoryPool().free(m.m_values.getBegin());
+	}
+	m_alloc.getMemoryPool().free(m_binary->m_mutations.getBegin());
 
-		for(ShaderProgramBinaryBlock& block : m_binary->m_uniformBlocks)
+	for(ShaderProgramBinaryBlock& block : m_binary->m_uniformBlocks)
+	{
+		m_alloc.getMemoryPool().free(block.m_variables.getBegin());
+	}
+	m_alloc.getMemoryPool().free(m_binary->m_uniformBlocks.getBegin());
+
+	for(ShaderProgramBinaryBlock& block : m_binary->m_storageBlocks)
+	{
+		m_alloc.getMemoryPool().free(block.m_variables.getBegin());
+	}
+	m_alloc.getMemoryPool().free(m_binary->m_storageBlocks.getBegin());
+
+	if(m_binary->m_pushConstantBlock)
+	{
+		m_alloc.getMemoryPool().free(m_binary->m_pushConstantBlock->m_variables.getBegin());
+		m_alloc.getMemoryPool().free(m_binary->m_pushConstantBlock);
+	}
+
+	m_alloc.getMemoryPool().free(m_binary->m_opaques.getBegin());
+	m_alloc.getMemoryPool().free(m_binary->m_constants.getBegin());
+
+	for(ShaderProgramBinaryVariant& variant : m_binary->m_variants)
+	{
+		for(ShaderProgramBinaryBlockInstance& block : variant.m_uniformBlocks)
 		{
 			m_alloc.getMemoryPool().free(block.m_variables.getBegin());
 		}
-		m_alloc.getMemoryPool().free(m_binary->m_uniformBlocks.getBegin());
 
-		for(ShaderProgramBinaryBlock& block : m_binary->m_storageBlocks)
+		for(ShaderProgramBinaryBlockInstance& block : variant.m_storageBlocks)
 		{
 			m_alloc.getMemoryPool().free(block.m_variables.getBegin());
 		}
-		m_alloc.getMemoryPool().free(m_binary->m_storageBlocks.getBegin());
 
-		if(m_binary->m_pushConstantBlock)
+		if(variant.m_pushConstantBlock)
 		{
-			m_alloc.getMemoryPool().free(m_binary->m_pushConstantBlock->m_variables.getBegin());
-			m_alloc.getMemoryPool().free(m_binary->m_pushConstantBlock);
+			m_alloc.getMemoryPool().free(variant.m_pushConstantBlock->m_variables.getBegin());
 		}
 
-		m_alloc.getMemoryPool().free(m_binary->m_opaques.getBegin());
-		m_alloc.getMemoryPool().free(m_binary->m_constants.getBegin());
-
-		for(ShaderProgramBinaryVariant& variant : m_binary->m_variants)
-		{
-			for(ShaderProgramBinaryBlockInstance& block : variant.m_uniformBlocks)
-			{
-				m_alloc.getMemoryPool().free(block.m_variables.getBegin());
-			}
-
-			for(ShaderProgramBinaryBlockInstance& block : variant.m_storageBlocks)
-			{
-				m_alloc.getMemoryPool().free(block.m_variables.getBegin());
-			}
-
-			if(variant.m_pushConstantBlock)
-			{
-				m_alloc.getMemoryPool().free(variant.m_pushConstantBlock->m_variables.getBegin());
-			}
-
-			m_alloc.getMemoryPool().free(variant.m_uniformBlocks.getBegin());
-			m_alloc.getMemoryPool().free(variant.m_storageBlocks.getBegin());
-			m_alloc.getMemoryPool().free(variant.m_pushConstantBlock);
-			m_alloc.getMemoryPool().free(variant.m_constants.getBegin());
-			m_alloc.getMemoryPool().free(variant.m_opaques.getBegin());
-		}
-		m_alloc.getMemoryPool().free(m_binary->m_variants.getBegin());
+		m_alloc.getMemoryPool().free(variant.m_uniformBlocks.getBegin());
+		m_alloc.getMemoryPool().free(variant.m_storageBlocks.getBegin());
+		m_alloc.getMemoryPool().free(variant.m_pushConstantBlock);
+		m_alloc.getMemoryPool().free(variant.m_constants.getBegin());
+		m_alloc.getMemoryPool().free(variant.m_opaques.getBegin());
 	}
+	m_alloc.getMemoryPool().free(m_binary->m_variants.getBegin());
 
 	m_alloc.getMemoryPool().free(m_binary);
 	m_binary = nullptr;
-	m_singleAllocation = false;
 }
 
 /// Spin the dials. Used to compute all mutator combinations.
@@ -169,12 +182,20 @@ static Bool spinDials(DynamicArrayAuto<U32>& dials, ConstWeakArray<ShaderProgram
 
 static Error compileSpirv(ConstWeakArray<MutatorValue> mutation,
 	const ShaderProgramParser& parser,
+	U64 capabilitiesHash,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	GenericMemoryPoolAllocator<U8>& tmpAlloc,
-	Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)>& spirv)
+	Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)>& spirv,
+	Second& preprocessTime,
+	Second& glslangTime)
 {
+	glslangTime = 0.0;
+
 	// Generate the source and the rest for the variant
+	Second startTime = HighRezTimer::getCurrentTime();
 	ShaderProgramParserVariant parserVariant;
 	ANKI_CHECK(parser.generateVariant(mutation, parserVariant));
+	preprocessTime = HighRezTimer::getCurrentTime() - startTime;
 
 	// Compile stages
 	for(ShaderType shaderType : EnumIterable<ShaderType>())
@@ -184,9 +205,31 @@ static Error compileSpirv(ConstWeakArray<MutatorValue> mutation,
 			continue;
 		}
 
+		// Check the cache. The key is the final source plus everything else that affects the compilation
+		const CString source = parserVariant.getSource(shaderType);
+		U64 sourceHash = 0;
+		if(spirvCache)
+		{
+			sourceHash = computeStableHash(source.cstr(), source.getLength());
+			sourceHash = appendStableHash(&shaderType, sizeof(shaderType), sourceHash);
+			sourceHash = appendStableHash(&capabilitiesHash, sizeof(capabilitiesHash), sourceHash);
+
+			if(spirvCache->find(sourceHash, spirv[shaderType]))
+			{
+				continue;
+			}
+		}
+
 		// Compile
-		ANKI_CHECK(compilerGlslToSpirv(parserVariant.getSource(shaderType), shaderType, tmpAlloc, spirv[shaderType]));
+		startTime = HighRezTimer::getCurrentTime();
+		ANKI_CHECK(compilerGlslToSpirv(source, shaderType, tmpAlloc, spirv[shaderType]));
 		ANKI_ASSERT(spirv[shaderType].getSize() > 0);
+		glslangTime += HighRezTimer::getCurrentTime() - startTime;
+
+		if(spirvCache)
+		{
+			spirvCache->store(sourceHash, spirv[shaderType]);
+		}
 	}
 
 	return Error::NONE;
@@ -194,6 +237,8 @@ static Error compileSpirv(ConstWeakArray<MutatorValue> mutation,
 
 static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 	const ShaderProgramParser& parser,
+	U64 capabilitiesHash,
+	ShaderProgramSpirvCacheInterface* spirvCache,
 	ShaderProgramBinaryVariant& variant,
 	DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks,
 	DynamicArrayAuto<U64>& codeBlockHashes,
@@ -201,7 +246,8 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 	GenericMemoryPoolAllocator<U8>& binaryAlloc,
 	ShaderProgramAsyncTaskInterface& taskManager,
 	Mutex& mtx,
-	Atomic<I32>& error)
+	Atomic<I32>& error,
+	ShaderProgramCompilerStats& stats)
 {
 	variant = {};
 
@@ -212,11 +258,14 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 		GenericMemoryPoolAllocator<U8> m_binaryAlloc;
 		DynamicArrayAuto<MutatorValue> m_mutation{m_tmpAlloc};
 		const ShaderProgramParser* m_parser;
+		U64 m_capabilitiesHash;
+		ShaderProgramSpirvCacheInterface* m_spirvCache;
 		ShaderProgramBinaryVariant* m_variant;
 		DynamicArrayAuto<ShaderProgramBinaryCodeBlock>* m_codeBlocks;
 		DynamicArrayAuto<U64>* m_codeBlockHashes;
 		Mutex* m_mtx;
 		Atomic<I32>* m_err;
+		ShaderProgramCompilerStats* m_stats; ///< Protected by m_mtx.
 
 		Ctx(GenericMemoryPoolAllocator<U8> tmpAlloc)
 			: m_tmpAlloc(tmpAlloc)
@@ -229,11 +278,14 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 	ctx->m_mutation.create(mutation.getSize());
 	memcpy(ctx->m_mutation.getBegin(), mutation.getBegin(), mutation.getSizeInBytes());
 	ctx->m_parser = &parser;
+	ctx->m_capabilitiesHash = capabilitiesHash;
+	ctx->m_spirvCache = spirvCache;
 	ctx->m_variant = &variant;
 	ctx->m_codeBlocks = &codeBlocks;
 	ctx->m_codeBlockHashes = &codeBlockHashes;
 	ctx->m_mtx = &mtx;
 	ctx->m_err = &error;
+	ctx->m_stats = &stats;
 
 	auto callback = [](void* userData) {
 		Ctx& ctx = *static_cast<Ctx*>(userData);
@@ -249,7 +301,15 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 		// All good, compile the variant
 		Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)> spirvs = {
 			{{tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}}};
-		const Error err = compileSpirv(ctx.m_mutation, *ctx.m_parser, tmpAlloc, spirvs);
+		Second preprocessTime, glslangTime;
+		const Error err = compileSpirv(ctx.m_mutation,
+			*ctx.m_parser,
+			ctx.m_capabilitiesHash,
+			ctx.m_spirvCache,
+			tmpAlloc,
+			spirvs,
+			preprocessTime,
+			glslangTime);
 
 		if(!err)
 		{
@@ -257,6 +317,12 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 
 			LockGuard<Mutex> lock(*ctx.m_mtx);
 
+			ShaderProgramCompilerStats& stats = *ctx.m_stats;
+			stats.m_preprocessTime += preprocessTime;
+			stats.m_glslangTime += glslangTime;
+			stats.m_maxVariantTime = max(stats.m_maxVariantTime, preprocessTime + glslangTime);
+			++stats.m_variantCount;
+
 			for(ShaderType shaderType : EnumIterable<ShaderType>())
 			{
 				DynamicArrayAuto<U8>& spirv = spirvs[shaderType];
@@ -268,7 +334,7 @@ static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
 				}
 
 				// Check if the spirv is already generated
-				const U64 newHash = computeHash(&spirv[0], spirv.getSize());
+				const U64 newHash = computeStableHash(&spirv[0], spirv.getSize());
 				Bool found = false;
 				for(U32 i = 0; i < ctx.m_codeBlockHashes->getSize(); ++i)
 				{
@@ -767,10 +833,86 @@ static Error doReflection(
 	return Error::NONE;
 }
 
-Error compileShaderProgramInternal(CString fname,
-	ShaderProgramFilesystemInterface& fsystem,
+static PtrSize computeSpirvSize(const ShaderProgramBinary& binary)
+{
+	PtrSize size = 0;
+	for(const ShaderProgramBinaryCodeBlock& block : binary.m_codeBlocks)
+	{
+		size += block.m_binary.getSizeInBytes();
+	}
+	return size;
+}
+
+/// Strip the debug info of the code blocks and merge the blocks that became identical.
+static Error stripCodeBlocks(
+	ShaderProgramBinary& binary, GenericMemoryPoolAllocator<U8> tmpAlloc, GenericMemoryPoolAllocator<U8> binaryAlloc)
+{
+	const U32 oldBlockCount = binary.m_codeBlocks.getSize();
+	DynamicArrayAuto<U64> newBlockHashes(tmpAlloc);
+	DynamicArrayAuto<U32> oldToNewBlock(tmpAlloc, oldBlockCount, MAX_U32);
+	U32 newBlockCount = 0;
+
+	for(U32 oldIdx = 0; oldIdx < oldBlockCount; ++oldIdx)
+	{
+		ShaderProgramBinaryCodeBlock& block = binary.m_codeBlocks[oldIdx];
+
+		DynamicArrayAuto<U8> stripped(tmpAlloc);
+		ANKI_CHECK(stripSpirvDebugInfo(block.m_binary, stripped));
+
+		binaryAlloc.getMemoryPool().free(block.m_binary.getBegin());
+		block.m_binary = {};
+
+		// Merge with a previous block if it's the same. The hash is only a quick reject
+		const U64 hash = computeStableHash(&stripped[0], stripped.getSizeInBytes());
+		for(U32 newIdx = 0; newIdx < newBlockCount; ++newIdx)
+		{
+			const ConstWeakArray<U8> newBlock = binary.m_codeBlocks[newIdx].m_binary;
+			if(newBlockHashes[newIdx] == hash && newBlock.getSizeInBytes() == stripped.getSizeInBytes()
+				&& memcmp(newBlock.getBegin(), &stripped[0], stripped.getSizeInBytes()) == 0)
+			{
+				oldToNewBlock[oldIdx] = newIdx;
+				break;
+			}
+		}
+
+		if(oldToNewBlock[oldIdx] != MAX_U32)
+		{
+			continue;
+		}
+
+		U8* code = binaryAlloc.allocate(stripped.getSizeInBytes());
+		memcpy(code, &stripped[0], stripped.getSizeInBytes());
+
+		// The new index is never larger than the old so compact in place
+		binary.m_codeBlocks[newBlockCount].m_binary.setArray(code, stripped.getSize());
+		newBlockHashes.emplaceBack(hash);
+		oldToNewBlock[oldIdx] = newBlockCount++;
+	}
+
+	// Remap the variants
+	for(ShaderProgramBinaryVariant& variant : binary.m_variants)
+	{
+		for(U32& idx : variant.m_codeBlockIndices)
+		{
+			if(idx != MAX_U32)
+			{
+				idx = oldToNewBlock[idx];
+			}
+		}
+	}
+
+	// Keep the same array, it's just shorter
+	binary.m_codeBlocks.setArray(binary.m_codeBlocks.getBegin(), newBlockCount);
+
+	return Error::NONE;
+}
+
+Error compileShaderProgramInternal(const ShaderProgramParser& parser,
+	Second parseTime,
 	ShaderProgramPostParseInterface* postParseCallback,
 	ShaderProgramAsyncTaskInterface* taskManager_,
+	ShaderProgramSpirvCacheInterface* spirvCache,
+	const ShaderProgramCompilerOptions& options,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
@@ -778,22 +920,29 @@ Error compileShaderProgramInternal(CString fname,
 {
 	// Initialize the binary
 	binaryW.cleanup();
-	binaryW.m_singleAllocation = false;
 	GenericMemoryPoolAllocator<U8> binaryAllocator = binaryW.m_alloc;
 	binaryW.m_binary = binaryAllocator.newInstance<ShaderProgramBinary>();
 	ShaderProgramBinary& binary = *binaryW.m_binary;
 	binary = {};
 	memcpy(&binary.m_magic[0], SHADER_BINARY_MAGIC, 8);
 
-	// Parse source
-	ShaderProgramParser parser(fname, &fsystem, tempAllocator, gpuCapabilities, bindlessLimits);
-	ANKI_CHECK(parser.parse());
+	ShaderProgramCompilerStats& stats = binaryW.m_stats;
+	stats = {};
+	binaryW.m_originalSpirvSize = 0;
+	binaryW.m_spirvSize = 0;
+	const Second startTime = HighRezTimer::getCurrentTime() - parseTime;
+	stats.m_parseTime = parseTime;
 
-	if(postParseCallback && postParseCallback->skipCompilation(parser.getHash()))
+	if(postParseCallback && postParseCallback->skipCompilation(parser))
 	{
 		return Error::NONE;
 	}
 
+	// Compute the hash of whatever else affects the SPIR-V
+	U64 capabilitiesHash = computeStableHash(&gpuCapabilities, sizeof(gpuCapabilities));
+	capabilitiesHash = appendStableHash(&bindlessLimits, sizeof(bindlessLimits), capabilitiesHash);
+	capabilitiesHash = appendStableHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), capabilitiesHash);
+
 	// Get mutators
 	U32 mutationCount = 0;
 	if(parser.getMutators().getSize() > 0)
@@ -877,7 +1026,8 @@ Error compileShaderProgramInternal(CString fname,
 				originalMutationValues.getBegin(),
 				originalMutationValues.getSizeInBytes());
 
-			mutation.m_hash = computeHash(originalMutationValues.getBegin(), originalMutationValues.getSizeInBytes());
+			mutation.m_hash =
+				computeStableHash(originalMutationValues.getBegin(), originalMutationValues.getSizeInBytes());
 			ANKI_ASSERT(mutation.m_hash > 0);
 
 			const Bool rewritten = parser.rewriteMutation(
@@ -893,6 +1043,8 @@ Error compileShaderProgramInternal(CString fname,
 
 				compileVariantAsync(originalMutationValues,
 					parser,
+					capabilitiesHash,
+					spirvCache,
 					variant,
 					codeBlocks,
 					codeBlockHashes,
@@ -900,7 +1052,8 @@ Error compileShaderProgramInternal(CString fname,
 					binaryAllocator,
 					taskManager,
 					mtx,
-					errorAtomic);
+					errorAtomic,
+					stats);
 
 				mutation.m_variantIndex = variants.getSize() - 1;
 
@@ -911,7 +1064,7 @@ Error compileShaderProgramInternal(CString fname,
 			{
 				// Check if the rewritten mutation exists
 				const U64 otherMutationHash =
-					computeHash(rewrittenMutationValues.getBegin(), rewrittenMutationValues.getSizeInBytes());
+					computeStableHash(rewrittenMutationValues.getBegin(), rewrittenMutationValues.getSizeInBytes());
 				auto it = mutationHashToIdx.find(otherMutationHash);
 
 				ShaderProgramBinaryVariant* variant = nullptr;
@@ -924,6 +1077,8 @@ Error compileShaderProgramInternal(CString fname,
 
 					compileVariantAsync(originalMutationValues,
 						parser,
+						capabilitiesHash,
+						spirvCache,
 						*variant,
 						codeBlocks,
 						codeBlockHashes,
@@ -931,7 +1086,8 @@ Error compileShaderProgramInternal(CString fname,
 						binaryAllocator,
 						taskManager,
 						mtx,
-						errorAtomic);
+						errorAtomic,
+						stats);
 
 					ShaderProgramBinaryMutation& otherMutation = mutations[mutationCount++];
 					otherMutation.m_values.setArray(
@@ -985,6 +1141,8 @@ Error compileShaderProgramInternal(CString fname,
 
 		compileVariantAsync(mutation,
 			parser,
+			capabilitiesHash,
+			spirvCache,
 			binary.m_variants[0],
 			codeBlocks,
 			codeBlockHashes,
@@ -992,7 +1150,8 @@ Error compileShaderProgramInternal(CString fname,
 			binaryAllocator,
 			taskManager,
 			mtx,
-			errorAtomic);
+			errorAtomic,
+			stats);
 
 		ANKI_CHECK(taskManager.joinTasks());
 		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
@@ -1018,7 +1177,19 @@ Error compileShaderProgramInternal(CString fname,
 	binary.m_presentShaderTypes = parser.getShaderTypes();
 
 	// Reflection
+	const Second reflectionStartTime = HighRezTimer::getCurrentTime();
 	ANKI_CHECK(doReflection(binary, tempAllocator, binaryAllocator));
+	stats.m_reflectionTime = HighRezTimer::getCurrentTime() - reflectionStartTime;
+
+	// Strip after the reflection because the reflection needs the names
+	binaryW.m_originalSpirvSize = computeSpirvSize(binary);
+	if(options.m_stripDebugInfo)
+	{
+		ANKI_CHECK(stripCodeBlocks(binary, tempAllocator, binaryAllocator));
+	}
+	binaryW.m_spirvSize = computeSpirvSize(binary);
+
+	stats.m_totalTime = HighRezTimer::getCurrentTime() - startTime;
 
 	return Error::NONE;
 }
@@ -1027,13 +1198,31 @@ Error compileShaderProgram(CString fname,
 	ShaderProgramFilesystemInterface& fsystem,
 	ShaderProgramPostParseInterface* postParseCallback,
 	ShaderProgramAsyncTaskInterface* taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
+	ShaderProgramParserIncludeCache* includeCache,
+	const ShaderProgramCompilerOptions& options,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
 	ShaderProgramBinaryWrapper& binaryW)
 {
-	const Error err = compileShaderProgramInternal(
-		fname, fsystem, postParseCallback, taskManager, tempAllocator, gpuCapabilities, bindlessLimits, binaryW);
+	const Second startTime = HighRezTimer::getCurrentTime();
+	ShaderProgramParser parser(fname, &fsystem, tempAllocator, gpuCapabilities, bindlessLimits, includeCache);
+	Error err = parser.parse();
+	if(!err)
+	{
+		err = compileShaderProgramInternal(parser,
+			HighRezTimer::getCurrentTime() - startTime,
+			postParseCallback,
+			taskManager,
+			spirvCache,
+			options,
+			tempAllocator,
+			gpuCapabilities,
+			bindlessLimits,
+			binaryW);
+	}
+
 	if(err)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", fname.cstr());
@@ -1042,4 +1231,32 @@ Error compileShaderProgram(CString fname,
 	return err;
 }
 
+Error compileShaderProgram(const ShaderProgramParser& parser,
+	ShaderProgramPostParseInterface* postParseCallback,
+	ShaderProgramAsyncTaskInterface* taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
+	const ShaderProgramCompilerOptions& options,
+	GenericMemoryPoolAllocator<U8> tempAllocator,
+	const GpuDeviceCapabilities& gpuCapabilities,
+	const BindlessLimits& bindlessLimits,
+	ShaderProgramBinaryWrapper& binaryW)
+{
+	const Error err = compileShaderProgramInternal(parser,
+		0.0,
+		postParseCallback,
+		taskManager,
+		spirvCache,
+		options,
+		tempAllocator,
+		gpuCapabilities,
+		bindlessLimits,
+		binaryW);
+	if(err)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", parser.getFilename().cstr());
+	}
+
+	return err;
+}
+
 } // end namespace anki
@@ -7,6 +7,7 @@
 
 #include <anki/shader_compiler/ShaderProgramDump.h>
 #include <anki/util/String.h>
+#include <anki/util/MemoryMappedFile.h>
 #include <anki/gr/Common.h>
 
 namespace anki
@@ -17,14 +18,41 @@ namespace anki
 
 extern const U32 SHADER_BINARY_VERSION;
 
+/// Options of the compilation.
+/// @memberof ShaderProgramCompiler
+class ShaderProgramCompilerOptions
+{
+public:
+	/// Remove the debug info (names, source and line info) from the SPIR-V after the reflection. Some code blocks
+	/// become identical after stripping and they are merged.
+	Bool m_stripDebugInfo = true;
+};
+
+/// Timings of the compilation. The times of the variants are summed over all the variants so with many threads they
+/// might be larger than the wall time.
+/// @memberof ShaderProgramCompiler
+class ShaderProgramCompilerStats
+{
+public:
+	Second m_totalTime = 0.0; ///< Wall time of the whole compilation.
+	Second m_parseTime = 0.0;
+	Second m_preprocessTime = 0.0; ///< Generating the source of the variants.
+	Second m_glslangTime = 0.0; ///< Compiling the source of the variants to SPIR-V.
+	Second m_reflectionTime = 0.0;
+	Second m_maxVariantTime = 0.0; ///< The preprocessing and the compilation of the slowest variant.
+	U32 m_variantCount = 0;
+};
+
 /// A wrapper over the POD ShaderProgramBinary class.
 /// @memberof ShaderProgramCompiler
 class ShaderProgramBinaryWrapper : public NonCopyable
 {
-	friend Error compileShaderProgramInternal(CString fname,
-		ShaderProgramFilesystemInterface& fsystem,
+	friend Error compileShaderProgramInternal(const ShaderProgramParser& parser,
+		Second parseTime,
 		ShaderProgramPostParseInterface* postParseCallback,
 		ShaderProgramAsyncTaskInterface* taskManager,
+		ShaderProgramSpirvCacheInterface* spirvCache,
+		const ShaderProgramCompilerOptions& options,
 		GenericMemoryPoolAllocator<U8> tempAllocator,
 		const GpuDeviceCapabilities& gpuCapabilities,
 		const BindlessLimits& bindlessLimits,
@@ -43,6 +71,7 @@ public:
 
 	ANKI_USE_RESULT Error serializeToFile(CString fname) const;
 
+	/// Load a binary. The file is memory mapped and used in place so the code blocks point inside the mapping.
 	ANKI_USE_RESULT Error deserializeFromFile(CString fname);
 
 	const ShaderProgramBinary& getBinary() const
@@ -51,19 +80,56 @@ public:
 		return *m_binary;
 	}
 
+	/// The size of all the code blocks before the stripping and the merging. Valid after compilation.
+	PtrSize getOriginalSpirvSize() const
+	{
+		return m_originalSpirvSize;
+	}
+
+	/// The size of all the code blocks. Valid after compilation.
+	PtrSize getSpirvSize() const
+	{
+		return m_spirvSize;
+	}
+
+	/// Valid after compilation.
+	const ShaderProgramCompilerStats& getStats() const
+	{
+		return m_stats;
+	}
+
 private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	ShaderProgramBinary* m_binary = nullptr;
-	Bool m_singleAllocation = false;
+	MemoryMappedFile m_mappedFile; ///< If it's open the m_binary points inside it.
+	PtrSize m_originalSpirvSize = 0;
+	PtrSize m_spirvSize = 0;
+	ShaderProgramCompilerStats m_stats;
 
 	void cleanup();
 };
 
 /// Takes an AnKi special shader program and spits a binary.
+/// @param spirvCache Optional. If it's present only the shader stages that are not in the cache will be compiled.
+/// @param includeCache Optional. A cache of the parsed files that many compilations can share.
 ANKI_USE_RESULT Error compileShaderProgram(CString fname,
 	ShaderProgramFilesystemInterface& fsystem,
 	ShaderProgramPostParseInterface* postParseCallback,
 	ShaderProgramAsyncTaskInterface* taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
+	ShaderProgramParserIncludeCache* includeCache,
+	const ShaderProgramCompilerOptions& options,
+	GenericMemoryPoolAllocator<U8> tempAllocator,
+	const GpuDeviceCapabilities& gpuCapabilities,
+	const BindlessLimits& bindlessLimits,
+	ShaderProgramBinaryWrapper& binary);
+
+/// Same as above but for a program that is already parsed. The parser should outlive the call.
+ANKI_USE_RESULT Error compileShaderProgram(const ShaderProgramParser& parser,
+	ShaderProgramPostParseInterface* postParseCallback,
+	ShaderProgramAsyncTaskInterface* taskManager,
+	ShaderProgramSpirvCacheInterface* spirvCache,
+	const ShaderProgramCompilerOptions& options,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
@@ -128,16 +128,129 @@ static const char* SHADER_HEADER = R"(#version 450 core
 #define ANKI_SPECIALIZATION_CONSTANT_VEC4(n, id, defltVal) _ANKI_SCONST_X4(Vec4, F32, n, id, defltVal,)
 )";
 
-static const U64 SHADER_HEADER_HASH = computeHash(SHADER_HEADER, sizeof(SHADER_HEADER));
+static const U64 SHADER_HEADER_HASH = computeStableHash(SHADER_HEADER, sizeof(SHADER_HEADER));
+
+ShaderProgramParserIncludeCache::~ShaderProgramParserIncludeCache()
+{
+	for(File* file : m_files)
+	{
+		ANKI_ASSERT(file->m_refcount == 0 && "Some parser still reads the file");
+		destroyFile(m_alloc, file);
+	}
+	m_files.destroy(m_alloc);
+}
+
+void ShaderProgramParserIncludeCache::destroyFile(GenericMemoryPoolAllocator<U8> alloc, File* file)
+{
+	for(Line& line : file->m_lines)
+	{
+		line.m_line.destroy(alloc);
+
+		for(String& token : line.m_tokens)
+		{
+			token.destroy(alloc);
+		}
+		line.m_tokens.destroy(alloc);
+	}
+
+	file->m_lines.destroy(alloc);
+	file->m_filename.destroy(alloc);
+	alloc.deleteInstance(file);
+}
+
+ShaderProgramParserIncludeCache::File* ShaderProgramParserIncludeCache::find(CString filename, U64 timestamp)
+{
+	ANKI_ASSERT(timestamp != 0);
+
+	File* out = nullptr;
+	{
+		LockGuard<Mutex> lock(m_mtx);
+
+		auto it = m_files.find(filename.computeHash());
+		if(it != m_files.getEnd() && (*it)->m_timestamp == timestamp && (*it)->m_filename == filename)
+		{
+			out = *it;
+			++out->m_refcount;
+		}
+	}
+
+	if(out)
+	{
+		m_hits.fetchAdd(1);
+	}
+	else
+	{
+		m_misses.fetchAdd(1);
+	}
+
+	return out;
+}
+
+ShaderProgramParserIncludeCache::File* ShaderProgramParserIncludeCache::insert(File* file)
+{
+	ANKI_ASSERT(file && file->m_timestamp != 0 && file->m_refcount == 0);
+	const U64 hash = file->m_filename.toCString().computeHash();
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	auto it = m_files.find(hash);
+	if(it == m_files.getEnd())
+	{
+		m_files.emplace(m_alloc, hash, file);
+	}
+	else if((*it)->m_filename != file->m_filename)
+	{
+		// Hash collision, keep the old file and don't cache the new one
+		file->m_stale = true;
+	}
+	else if((*it)->m_timestamp == file->m_timestamp)
+	{
+		// Another parser loaded it at the same time
+		destroyFile(m_alloc, file);
+		file = *it;
+	}
+	else
+	{
+		// The file changed. Some parser might still read the old one
+		File* oldFile = *it;
+		if(oldFile->m_refcount == 0)
+		{
+			destroyFile(m_alloc, oldFile);
+		}
+		else
+		{
+			oldFile->m_stale = true;
+		}
+
+		*it = file;
+	}
+
+	++file->m_refcount;
+	return file;
+}
+
+void ShaderProgramParserIncludeCache::release(File* file)
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	ANKI_ASSERT(file->m_refcount > 0);
+	--file->m_refcount;
+	if(file->m_refcount == 0 && file->m_stale)
+	{
+		destroyFile(m_alloc, file);
+	}
+}
 
 ShaderProgramParser::ShaderProgramParser(CString fname,
 	ShaderProgramFilesystemInterface* fsystem,
 	GenericMemoryPoolAllocator<U8> alloc,
 	const GpuDeviceCapabilities& gpuCapabilities,
-	const BindlessLimits& bindlessLimits)
+	const BindlessLimits& bindlessLimits,
+	ShaderProgramParserIncludeCache* includeCache)
 	: m_alloc(alloc)
 	, m_fname(alloc, fname)
 	, m_fsystem(fsystem)
+	, m_includeCache(includeCache)
 	, m_gpuCapabilities(gpuCapabilities)
 	, m_bindlessLimits(bindlessLimits)
 {
@@ -147,11 +260,11 @@ ShaderProgramParser::~ShaderProgramParser()
 {
 }
 
-void ShaderProgramParser::tokenizeLine(CString line, DynamicArrayAuto<StringAuto>& tokens) const
+void ShaderProgramParser::tokenizeLine(CString line, GenericMemoryPoolAllocator<U8> alloc, DynamicArray<String>& tokens)
 {
 	ANKI_ASSERT(line.getLength() > 0);
 
-	StringAuto l(m_alloc, line);
+	StringAuto l(alloc, line);
 
 	// Replace all tabs with spaces
 	for(char& c : l)
@@ -163,17 +276,51 @@ void ShaderProgramParser::tokenizeLine(CString line, DynamicArrayAuto<StringAuto
 	}
 
 	// Split
-	StringListAuto spaceTokens(m_alloc);
+	StringListAuto spaceTokens(alloc);
 	spaceTokens.splitString(l, ' ', false);
 
 	// Create the array
+	tokens.create(alloc, U32(spaceTokens.getSize()));
+	U32 count = 0;
 	for(const String& s : spaceTokens)
 	{
-		tokens.emplaceBack(m_alloc, s);
+		tokens[count++].create(alloc, s);
 	}
 }
 
-Error ShaderProgramParser::parsePragmaStart(const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+Error ShaderProgramParser::loadFile(CString fname, U64 timestamp, GenericMemoryPoolAllocator<U8> alloc, File& file)
+{
+	StringAuto txt(m_alloc);
+	ANKI_CHECK(m_fsystem->readAllText(fname, txt));
+
+	StringListAuto lines(m_alloc);
+	lines.splitString(txt.toCString(), '\n');
+	if(lines.getSize() < 1)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Source is empty");
+	}
+
+	file.m_filename.create(alloc, fname);
+	file.m_timestamp = timestamp;
+	file.m_lines.create(alloc, U32(lines.getSize()));
+
+	U32 count = 0;
+	for(const String& str : lines)
+	{
+		Line& line = file.m_lines[count++];
+		line.m_line.create(alloc, str.toCString());
+
+		if(str.find("pragma") != CString::NPOS || str.find("include") != CString::NPOS)
+		{
+			// Possibly a preprocessor directive we care
+			tokenizeLine(str.toCString(), alloc, line.m_tokens);
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error ShaderProgramParser::parsePragmaStart(const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -238,7 +385,7 @@ Error ShaderProgramParser::parsePragmaStart(const StringAuto* begin, const Strin
 	return Error::NONE;
 }
 
-Error ShaderProgramParser::parsePragmaEnd(const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+Error ShaderProgramParser::parsePragmaEnd(const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -262,7 +409,7 @@ Error ShaderProgramParser::parsePragmaEnd(const StringAuto* begin, const StringA
 }
 
 Error ShaderProgramParser::parsePragmaMutator(
-	const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+	const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -342,7 +489,7 @@ Error ShaderProgramParser::parsePragmaMutator(
 }
 
 Error ShaderProgramParser::parsePragmaRewriteMutation(
-	const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+	const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -484,13 +631,13 @@ Error ShaderProgramParser::parsePragmaRewriteMutation(
 }
 
 Error ShaderProgramParser::parseInclude(
-	const StringAuto* begin, const StringAuto* end, CString line, CString fname, U32 depth)
+	const String* begin, const String* end, CString line, CString fname, U32 depth)
 {
 	// Gather the path
 	StringAuto path(m_alloc);
 	for(; begin < end; ++begin)
 	{
-		path.append(*begin);
+		path.append(begin->toCString());
 	}
 
 	if(path.isEmpty())
@@ -520,15 +667,13 @@ Error ShaderProgramParser::parseInclude(
 	return Error::NONE;
 }
 
-Error ShaderProgramParser::parseLine(CString line, CString fname, Bool& foundPragmaOnce, U32 depth)
+Error ShaderProgramParser::parseLine(const Line& tokenizedLine, CString fname, Bool& foundPragmaOnce, U32 depth)
 {
-	// Tokenize
-	DynamicArrayAuto<StringAuto> tokens(m_alloc);
-	tokenizeLine(line, tokens);
-	ANKI_ASSERT(tokens.getSize() > 0);
+	const CString line = tokenizedLine.m_line;
+	ANKI_ASSERT(tokenizedLine.m_tokens.getSize() > 0);
 
-	const StringAuto* token = tokens.getBegin();
-	const StringAuto* end = tokens.getEnd();
+	const String* token = tokenizedLine.m_tokens.getBegin();
+	const String* end = tokenizedLine.m_tokens.getEnd();
 
 	// Skip the hash
 	Bool foundAloneHash = false;
@@ -624,34 +769,91 @@ Error ShaderProgramParser::parseFile(CString fname, U32 depth)
 		ANKI_SHADER_COMPILER_LOGE("The include depth is too high. Probably circular includance");
 	}
 
-	Bool foundPragmaOnce = false;
+	// Remember the dependency
+	U64 timestamp;
+	ANKI_CHECK(m_fsystem->getFileTimestamp(fname, timestamp));
 
-	// Load file in lines
-	StringAuto txt(m_alloc);
-	ANKI_CHECK(m_fsystem->readAllText(fname, txt));
+	Bool newDependency = true;
+	for(const Dependency& dep : m_dependencies)
+	{
+		if(dep.m_filename == fname)
+		{
+			newDependency = false;
+			break;
+		}
+	}
 
-	StringListAuto lines(m_alloc);
-	lines.splitString(txt.toCString(), '\n');
-	if(lines.getSize() < 1)
+	if(newDependency)
 	{
-		ANKI_SHADER_COMPILER_LOGE("Source is empty");
+		Dependency& dep = *m_dependencies.emplaceBack(m_alloc);
+		dep.m_filename.create(fname);
+		dep.m_timestamp = timestamp;
+	}
+
+	// Load the file in lines. Try the cache first
+	File* file = nullptr;
+	File* uncachedFile = nullptr;
+	if(m_includeCache && timestamp != 0)
+	{
+		file = m_includeCache->find(fname, timestamp);
+
+		if(!file)
+		{
+			File* newFile = m_includeCache->m_alloc.newInstance<File>();
+			const Error err = loadFile(fname, timestamp, m_includeCache->m_alloc, *newFile);
+			if(err)
+			{
+				ShaderProgramParserIncludeCache::destroyFile(m_includeCache->m_alloc, newFile);
+				return err;
+			}
+
+			file = m_includeCache->insert(newFile);
+		}
+	}
+	else
+	{
+		uncachedFile = m_alloc.newInstance<File>();
+		const Error err = loadFile(fname, timestamp, m_alloc, *uncachedFile);
+		if(err)
+		{
+			ShaderProgramParserIncludeCache::destroyFile(m_alloc, uncachedFile);
+			return err;
+		}
+
+		file = uncachedFile;
 	}
 
 	// Parse lines
-	for(const String& line : lines)
+	Bool foundPragmaOnce = false;
+	Error err = Error::NONE;
+	for(const Line& line : file->m_lines)
 	{
-		if(line.find("pragma") != CString::NPOS || line.find("include") != CString::NPOS)
+		if(line.m_tokens.getSize() > 0)
 		{
-			// Possibly a preprocessor directive we care
-			ANKI_CHECK(parseLine(line.toCString(), fname, foundPragmaOnce, depth));
+			err = parseLine(line, fname, foundPragmaOnce, depth);
+			if(err)
+			{
+				break;
+			}
 		}
 		else
 		{
 			// Just append the line
-			m_codeLines.pushBack(line.toCString());
+			m_codeLines.pushBack(line.m_line.toCString());
 		}
 	}
 
+	if(uncachedFile)
+	{
+		ShaderProgramParserIncludeCache::destroyFile(m_alloc, uncachedFile);
+	}
+	else
+	{
+		m_includeCache->release(file);
+	}
+
+	ANKI_CHECK(err);
+
 	if(foundPragmaOnce)
 	{
 		// Append the guard
@@ -709,7 +911,7 @@ Error ShaderProgramParser::parse()
 		m_codeLines.join("\n", m_codeSource);
 		m_codeLines.destroy();
 
-		m_codeSourceHash = appendHash(m_codeSource.getBegin(), m_codeSource.getLength(), SHADER_HEADER_HASH);
+		m_codeSourceHash = appendStableHash(m_codeSource.getBegin(), m_codeSource.getLength(), SHADER_HEADER_HASH);
 	}
 
 	return Error::NONE;
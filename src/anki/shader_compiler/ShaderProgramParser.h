@@ -9,6 +9,9 @@
 #include <anki/util/StringList.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/DynamicArray.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
 #include <anki/gr/utils/Functions.h>
 
 namespace anki
@@ -72,6 +75,70 @@ private:
 	Array<String, U(ShaderType::COUNT)> m_sources;
 };
 
+/// A cache of the files that ShaderProgramParser reads. The files are stored split in lines and the preprocessor
+/// directives are already tokenized. The key is the filename and the modification time of the file. It's thread-safe so
+/// many parsers, even in different threads, can share it.
+class ShaderProgramParserIncludeCache : public NonCopyable
+{
+	friend class ShaderProgramParser;
+
+public:
+	/// @param alloc It should be thread-safe if the cache is shared between threads.
+	ShaderProgramParserIncludeCache(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ShaderProgramParserIncludeCache();
+
+	U32 getHitCount() const
+	{
+		return m_hits.load();
+	}
+
+	U32 getMissCount() const
+	{
+		return m_misses.load();
+	}
+
+private:
+	class Line
+	{
+	public:
+		String m_line;
+		DynamicArray<String> m_tokens; ///< Empty if the line is not a directive the parser cares about.
+	};
+
+	class File
+	{
+	public:
+		String m_filename;
+		U64 m_timestamp = 0;
+		DynamicArray<Line> m_lines;
+		U32 m_refcount = 0; ///< The parsers that read it right now. Protected by m_mtx.
+		Bool m_stale = false; ///< It's not in m_files. It will be deleted when the last parser releases it.
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	HashMap<U64, File*> m_files; ///< Key is the hash of the filename.
+
+	Mutex m_mtx;
+	Atomic<U32> m_hits = {0};
+	Atomic<U32> m_misses = {0};
+
+	/// Find a file that has the same timestamp. Call release() when done with it.
+	File* find(CString filename, U64 timestamp);
+
+	/// Add a new file. If another parser added the same file first it will return that and delete the @a file. Call
+	/// release() when done with it.
+	File* insert(File* file);
+
+	/// Stop using a file that find() or insert() returned.
+	void release(File* file);
+
+	static void destroyFile(GenericMemoryPoolAllocator<U8> alloc, File* file);
+};
+
 /// This is a special preprocessor that run before the usual preprocessor. Its purpose is to add some meta information
 /// in the shader programs.
 ///
@@ -92,7 +159,8 @@ public:
 		ShaderProgramFilesystemInterface* fsystem,
 		GenericMemoryPoolAllocator<U8> alloc,
 		const GpuDeviceCapabilities& gpuCapabilities,
-		const BindlessLimits& bindlessLimits);
+		const BindlessLimits& bindlessLimits,
+		ShaderProgramParserIncludeCache* includeCache = nullptr);
 
 	~ShaderProgramParser();
 
@@ -107,6 +175,11 @@ public:
 	ANKI_USE_RESULT Error generateVariant(
 		ConstWeakArray<MutatorValue> mutation, ShaderProgramParserVariant& variant) const;
 
+	CString getFilename() const
+	{
+		return m_fname.toCString();
+	}
+
 	ConstWeakArray<ShaderProgramParserMutator> getMutators() const
 	{
 		return m_mutators;
@@ -123,6 +196,23 @@ public:
 		return m_codeSourceHash;
 	}
 
+	/// The number of files the program read. That's the program file and all its includes.
+	U32 getDependencyCount() const
+	{
+		return m_dependencies.getSize();
+	}
+
+	CString getDependencyFilename(U32 idx) const
+	{
+		return m_dependencies[idx].m_filename;
+	}
+
+	/// The modification time of the file when it was parsed. Zero if the filesystem doesn't know it.
+	U64 getDependencyTimestamp(U32 idx) const
+	{
+		return m_dependencies[idx].m_timestamp;
+	}
+
 	/// Generates the common header that will be used by all AnKi shaders.
 	static void generateAnkiShaderHeader(
 		const GpuDeviceCapabilities& caps, const BindlessLimits& limits, StringAuto& header);
@@ -155,11 +245,29 @@ private:
 		}
 	};
 
+	class Dependency
+	{
+	public:
+		StringAuto m_filename;
+		U64 m_timestamp = 0;
+
+		Dependency(GenericMemoryPoolAllocator<U8> alloc)
+			: m_filename(alloc)
+		{
+		}
+	};
+
+	using File = ShaderProgramParserIncludeCache::File;
+	using Line = ShaderProgramParserIncludeCache::Line;
+
 	static const U32 MAX_INCLUDE_DEPTH = 8;
 
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	StringAuto m_fname;
 	ShaderProgramFilesystemInterface* m_fsystem = nullptr;
+	ShaderProgramParserIncludeCache* m_includeCache = nullptr;
+
+	DynamicArrayAuto<Dependency> m_dependencies = {m_alloc};
 
 	StringListAuto m_codeLines = {m_alloc}; ///< The code.
 	StringAuto m_codeSource = {m_alloc};
@@ -174,17 +282,19 @@ private:
 	BindlessLimits m_bindlessLimits;
 
 	ANKI_USE_RESULT Error parseFile(CString fname, U32 depth);
-	ANKI_USE_RESULT Error parseLine(CString line, CString fname, Bool& foundPragmaOnce, U32 depth);
+	ANKI_USE_RESULT Error parseLine(const Line& line, CString fname, Bool& foundPragmaOnce, U32 depth);
 	ANKI_USE_RESULT Error parseInclude(
-		const StringAuto* begin, const StringAuto* end, CString line, CString fname, U32 depth);
-	ANKI_USE_RESULT Error parsePragmaMutator(
-		const StringAuto* begin, const StringAuto* end, CString line, CString fname);
-	ANKI_USE_RESULT Error parsePragmaStart(const StringAuto* begin, const StringAuto* end, CString line, CString fname);
-	ANKI_USE_RESULT Error parsePragmaEnd(const StringAuto* begin, const StringAuto* end, CString line, CString fname);
+		const String* begin, const String* end, CString line, CString fname, U32 depth);
+	ANKI_USE_RESULT Error parsePragmaMutator(const String* begin, const String* end, CString line, CString fname);
+	ANKI_USE_RESULT Error parsePragmaStart(const String* begin, const String* end, CString line, CString fname);
+	ANKI_USE_RESULT Error parsePragmaEnd(const String* begin, const String* end, CString line, CString fname);
 	ANKI_USE_RESULT Error parsePragmaRewriteMutation(
-		const StringAuto* begin, const StringAuto* end, CString line, CString fname);
+		const String* begin, const String* end, CString line, CString fname);
+
+	/// Read a file and split it in lines.
+	ANKI_USE_RESULT Error loadFile(CString fname, U64 timestamp, GenericMemoryPoolAllocator<U8> alloc, File& file);
 
-	void tokenizeLine(CString line, DynamicArrayAuto<StringAuto>& tokens) const;
+	static void tokenizeLine(CString line, GenericMemoryPoolAllocator<U8> alloc, DynamicArray<String>& tokens);
 
 	static Bool tokenIsComment(CString token)
 	{
@@ -0,0 +1,142 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/Hash.h>
+
+namespace anki
+{
+
+/// The header of every cache entry. The SPIR-V follows.
+class ShaderProgramSpirvCache::Header
+{
+public:
+	static constexpr const char* MAGIC = "ANKISPV1";
+
+	Array<char, 8> m_magic;
+	U64 m_sourceHash;
+	U64 m_spirvHash; ///< Used to detect corrupted or half written entries.
+	U32 m_spirvSize;
+	U32 _padding;
+};
+
+Error ShaderProgramSpirvCache::init(CString directory)
+{
+	m_dir.create(directory);
+
+	if(!directoryExists(directory))
+	{
+		ANKI_CHECK(createDirectory(directory));
+	}
+
+	return Error::NONE;
+}
+
+void ShaderProgramSpirvCache::getEntryFilename(U64 sourceHash, StringAuto& fname) const
+{
+	fname.sprintf("%s/%016" PRIx64 ".spv", m_dir.cstr(), sourceHash);
+}
+
+Error ShaderProgramSpirvCache::readEntry(CString fname, U64 sourceHash, DynamicArrayAuto<U8>& spirv) const
+{
+	File file;
+	ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	Header header;
+	if(file.getSize() < sizeof(header))
+	{
+		return Error::USER_DATA;
+	}
+
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+
+	if(memcmp(&header.m_magic[0], Header::MAGIC, sizeof(header.m_magic)) != 0 || header.m_sourceHash != sourceHash
+		|| header.m_spirvSize == 0 || file.getSize() != sizeof(header) + header.m_spirvSize)
+	{
+		return Error::USER_DATA;
+	}
+
+	spirv.create(header.m_spirvSize);
+	ANKI_CHECK(file.read(&spirv[0], header.m_spirvSize));
+
+	if(computeStableHash(&spirv[0], spirv.getSize()) != header.m_spirvHash)
+	{
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error ShaderProgramSpirvCache::writeEntry(CString fname, U64 sourceHash, ConstWeakArray<U8> spirv) const
+{
+	Header header;
+	memcpy(&header.m_magic[0], Header::MAGIC, sizeof(header.m_magic));
+	header.m_sourceHash = sourceHash;
+	header.m_spirvHash = computeStableHash(&spirv[0], spirv.getSize());
+	header.m_spirvSize = spirv.getSize();
+	header._padding = 0;
+
+	// Write to a unique temp file and then rename it so a reader never sees a half written entry
+	StringAuto tmpFname(m_dir.getAllocator());
+	tmpFname.sprintf("%s.%016" PRIx64 ".tmp", fname.cstr(), getRandom());
+	{
+		File file;
+		ANKI_CHECK(file.open(tmpFname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_CHECK(file.write(&header, sizeof(header)));
+		ANKI_CHECK(file.write(&spirv[0], spirv.getSize()));
+	}
+
+	return renameFile(tmpFname.toCString(), fname);
+}
+
+Bool ShaderProgramSpirvCache::find(U64 sourceHash, DynamicArrayAuto<U8>& spirv)
+{
+	StringAuto fname(m_dir.getAllocator());
+	getEntryFilename(sourceHash, fname);
+
+	Bool found = false;
+	if(fileExists(fname.toCString()))
+	{
+		if(readEntry(fname.toCString(), sourceHash, spirv))
+		{
+			// Don't fail, it will be recompiled and overwritten
+			ANKI_SHADER_COMPILER_LOGW("Ignoring corrupted SPIR-V cache entry: %s", fname.cstr());
+			spirv.destroy();
+		}
+		else
+		{
+			found = true;
+		}
+	}
+
+	if(found)
+	{
+		m_hits.fetchAdd(1);
+	}
+	else
+	{
+		m_misses.fetchAdd(1);
+	}
+
+	return found;
+}
+
+void ShaderProgramSpirvCache::store(U64 sourceHash, ConstWeakArray<U8> spirv)
+{
+	ANKI_ASSERT(spirv.getSize() > 0);
+
+	StringAuto fname(m_dir.getAllocator());
+	getEntryFilename(sourceHash, fname);
+
+	if(writeEntry(fname.toCString(), sourceHash, spirv))
+	{
+		// Not fatal, the cache is just an optimization
+		ANKI_SHADER_COMPILER_LOGW("Failed to write SPIR-V cache entry: %s", fname.cstr());
+	}
+}
+
+} // end namespace anki
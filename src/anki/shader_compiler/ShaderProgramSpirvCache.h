@@ -0,0 +1,65 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shader_compiler/Common.h>
+#include <anki/util/Atomic.h>
+
+namespace anki
+{
+
+/// @addtogroup shader_compiler
+/// @{
+
+/// A persistent SPIR-V cache that lives in a directory. Every entry is a file that holds the SPIR-V of a single shader
+/// stage and it's named after the hash of the preprocessed source. It's thread-safe.
+class ShaderProgramSpirvCache : public ShaderProgramSpirvCacheInterface
+{
+public:
+	ShaderProgramSpirvCache(GenericMemoryPoolAllocator<U8> alloc)
+		: m_dir(alloc)
+	{
+	}
+
+	/// @param directory The directory of the cache. It will be created if it doesn't exist.
+	ANKI_USE_RESULT Error init(CString directory);
+
+	Bool find(U64 sourceHash, DynamicArrayAuto<U8>& spirv) final;
+
+	void store(U64 sourceHash, ConstWeakArray<U8> spirv) final;
+
+	U32 getHitCount() const
+	{
+		return m_hits.load();
+	}
+
+	U32 getMissCount() const
+	{
+		return m_misses.load();
+	}
+
+	void resetStatistics()
+	{
+		m_hits.setNonAtomically(0);
+		m_misses.setNonAtomically(0);
+	}
+
+private:
+	class Header;
+
+	StringAuto m_dir;
+	Atomic<U32> m_hits = {0};
+	Atomic<U32> m_misses = {0};
+
+	void getEntryFilename(U64 sourceHash, StringAuto& fname) const;
+
+	ANKI_USE_RESULT Error readEntry(CString fname, U64 sourceHash, DynamicArrayAuto<U8>& spirv) const;
+
+	ANKI_USE_RESULT Error writeEntry(CString fname, U64 sourceHash, ConstWeakArray<U8> spirv) const;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,88 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/shader_compiler/SpirvStrip.h>
+
+namespace anki
+{
+
+static constexpr U32 SPIRV_MAGIC = 0x07230203;
+static constexpr U32 SPIRV_HEADER_WORD_COUNT = 5;
+
+/// The opcodes of the debug instructions.
+static constexpr Array<U16, 9> SPIRV_DEBUG_OPCODES = {{
+	2, // OpSourceContinued
+	3, // OpSource
+	4, // OpSourceExtension
+	5, // OpName
+	6, // OpMemberName
+	7, // OpString
+	8, // OpLine
+	317, // OpNoLine
+	330 // OpModuleProcessed
+}};
+
+Error stripSpirvDebugInfo(ConstWeakArray<U8> in, DynamicArrayAuto<U8>& out)
+{
+	if((in.getSize() % sizeof(U32)) != 0 || in.getSize() < SPIRV_HEADER_WORD_COUNT * sizeof(U32))
+	{
+		ANKI_SHADER_COMPILER_LOGE("Wrong SPIR-V size");
+		return Error::USER_DATA;
+	}
+
+	// Work with words. The input might not be aligned so copy it
+	const U32 wordCount = in.getSize() / sizeof(U32);
+	DynamicArrayAuto<U32> words(out.getAllocator(), wordCount);
+	memcpy(&words[0], &in[0], in.getSize());
+
+	if(words[0] != SPIRV_MAGIC)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Wrong SPIR-V magic or endianness");
+		return Error::USER_DATA;
+	}
+
+	// Walk the instructions and compact the array in place
+	U32 outWord = SPIRV_HEADER_WORD_COUNT;
+	U32 inWord = SPIRV_HEADER_WORD_COUNT;
+	while(inWord < wordCount)
+	{
+		const U32 instrWordCount = words[inWord] >> 16u;
+		const U16 opcode = U16(words[inWord] & 0xFFFFu);
+
+		if(instrWordCount == 0 || inWord + instrWordCount > wordCount)
+		{
+			ANKI_SHADER_COMPILER_LOGE("Corrupted SPIR-V instruction");
+			return Error::USER_DATA;
+		}
+
+		Bool debug = false;
+		for(U16 debugOpcode : SPIRV_DEBUG_OPCODES)
+		{
+			if(opcode == debugOpcode)
+			{
+				debug = true;
+				break;
+			}
+		}
+
+		if(!debug)
+		{
+			if(outWord != inWord)
+			{
+				memmove(&words[outWord], &words[inWord], instrWordCount * sizeof(U32));
+			}
+			outWord += instrWordCount;
+		}
+
+		inWord += instrWordCount;
+	}
+
+	out.resize(outWord * sizeof(U32));
+	memcpy(&out[0], &words[0], out.getSizeInBytes());
+
+	return Error::NONE;
+}
+
+} // end namespace anki
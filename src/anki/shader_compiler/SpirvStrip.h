@@ -0,0 +1,23 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shader_compiler/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup shader_compiler
+/// @{
+
+/// Remove the debug instructions from a SPIR-V module. Those are the names, the source info and the line info. The
+/// reflection needs the names so do it after the reflection.
+/// @param in The input SPIR-V.
+/// @param[out] out The stripped SPIR-V.
+ANKI_USE_RESULT Error stripSpirvDebugInfo(ConstWeakArray<U8> in, DynamicArrayAuto<U8>& out);
+/// @}
+
+} // end namespace anki
@@ -218,6 +218,13 @@ public:
 		return MAX_PTR_SIZE;
 	}
 
+	/// Check if the allocator has a memory pool.
+	/// @note This is AnKi specific
+	Bool isCreated() const
+	{
+		return m_pool != nullptr;
+	}
+
 	/// Get the memory pool
 	/// @note This is AnKi specific
 	const TPool& getMemoryPool() const
@@ -406,6 +413,15 @@ using StackAllocator = GenericPoolAllocator<T, StackMemoryPool>;
 /// Allocator that uses a ChainMemoryPool
 template<typename T>
 using ChainAllocator = GenericPoolAllocator<T, ChainMemoryPool>;
+
+/// Allocator that uses a SlabMemoryPool. Good for many small allocations from many threads
+template<typename T>
+using SlabAllocator = GenericPoolAllocator<T, SlabMemoryPool>;
+
+/// Allocator that uses a FrameMemoryPool. Good for temporary allocations from many threads that die at the end of the
+/// frame
+template<typename T>
+using FrameAllocator = GenericPoolAllocator<T, FrameMemoryPool>;
 /// @}
 
 } // end namespace anki
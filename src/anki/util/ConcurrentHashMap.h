@@ -0,0 +1,177 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/HashMap.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/Thread.h>
+#include <type_traits>
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// A hash map for caches that are read by many threads and rarely written. The lookups don't lock and don't write any
+/// shared memory so they scale with the number of threads, unlike a RWMutex that makes the readers fight over its
+/// cache line.
+///
+/// The map is split in shards using the top bits of the hash. Every shard has an open addressing table with linear
+/// probing and a lock for the writers. The writers publish an element by storing its hash with release semantics after
+/// the element is constructed and the readers load the hashes with acquire semantics. Elements can't be erased so they
+/// never move inside a table. When a table is full the writer copies it to a bigger one and publishes that. The old
+/// tables are retired and freed at destroy because readers might still be using them. The retired tables are at most
+/// as big as the live ones.
+///
+/// The keys and the values are copied when growing so they should be small and trivially copyable. Store pointers for
+/// anything else.
+/// @code
+/// const Foo* const* foo = map.find(key);
+/// if(foo == nullptr)
+/// {
+/// 	LockGuard<Mutex> lock(createMtx); // Optional. To avoid creating the same thing twice
+/// 	foo = map.find(key);
+/// 	if(foo == nullptr)
+/// 	{
+/// 		foo = &map.emplace(alloc, key, createFoo());
+/// 	}
+/// }
+/// @endcode
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class ConcurrentHashMap : public NonCopyable
+{
+	static_assert(std::is_trivially_copyable<TKey>::value && std::is_trivially_destructible<TKey>::value,
+		"The keys are copied and never destroyed");
+	static_assert(std::is_trivially_copyable<TValue>::value && std::is_trivially_destructible<TValue>::value,
+		"The values are copied and never destroyed");
+
+public:
+	using Key = TKey;
+	using Value = TValue;
+	using Hasher = THasher;
+
+	static constexpr U32 SHARD_COUNT_LOG2 = 4;
+	static constexpr U32 SHARD_COUNT = 1u << SHARD_COUNT_LOG2;
+
+	/// The min number of slots of a shard.
+	static constexpr U32 MIN_SLOT_COUNT = 16;
+
+	ConcurrentHashMap() = default;
+
+	/// You need to manually destroy the map.
+	/// @see ConcurrentHashMap::destroy
+	~ConcurrentHashMap()
+	{
+		for(const Shard& shard : m_shards)
+		{
+			ANKI_ASSERT(shard.m_table.getNonAtomically() == nullptr && "Forgot to call destroy");
+			(void)shard;
+		}
+	}
+
+	U32 getSize() const
+	{
+		return m_entryCount.load();
+	}
+
+	Bool isEmpty() const
+	{
+		return getSize() == 0;
+	}
+
+	/// Destroy the map. It's not thread-safe.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Find a value. It's thread-safe and lock-free. It might miss the elements that are being emplaced at the same
+	/// time.
+	/// @return The value or nullptr if it's not there. The pointer is valid until the map is destroyed.
+	const TValue* find(const TKey& key) const;
+
+	/// Construct an element. If the key is already there the value will not be replaced because readers might be
+	/// reading it. It's thread-safe.
+	/// @return The value of the key. The reference is valid until the map is destroyed.
+	template<typename TAllocator, typename... TArgs>
+	const TValue& emplace(TAllocator alloc, const TKey& key, TArgs&&... args);
+
+	/// Iterate the elements. It's not thread-safe with emplace.
+	/// @code
+	/// map.iterate([&](const Key& key, const Value& value) { ... });
+	/// @endcode
+	template<typename TFunc>
+	void iterate(TFunc func) const;
+
+	/// Check the validity of the map. It's not thread-safe with emplace.
+	void validate() const;
+
+private:
+	class Entry
+	{
+	public:
+		TKey m_key;
+		TValue m_value;
+	};
+
+	/// The header of a table. The hashes and the entries of the slots follow it in the same allocation. A slot is
+	/// empty if its hash is zero.
+	class Table
+	{
+	public:
+		Table* m_retired; ///< The previous table of the shard.
+		Atomic<U64>* m_hashes;
+		Entry* m_entries;
+		U32 m_slotCount;
+		U32 m_entryCount; ///< Only the writers touch it.
+
+		U32 wrap(U32 slot) const
+		{
+			return slot & (m_slotCount - 1);
+		}
+	};
+
+	/// Every shard is in its own cache line so that writing one doesn't slow down the readers of the others.
+	class alignas(ANKI_CACHE_LINE_SIZE) Shard
+	{
+	public:
+		Atomic<Table*> m_table = {nullptr};
+		SpinLock m_lock;
+	};
+
+	Array<Shard, SHARD_COUNT> m_shards;
+	Atomic<U32> m_entryCount = {0};
+
+	/// Hash the output of the THasher again because some of them are weak (eg the integer hashers just return the
+	/// integer). Zero marks the empty slots so it's not a valid hash.
+	static U64 hashKey(const TKey& key)
+	{
+		const U64 hash = detail::hashMix(THasher()(key), detail::HASH_SECRET_0);
+		return (hash) ? hash : 1;
+	}
+
+	static U32 getShardIndex(U64 hash)
+	{
+		return U32(hash >> (64 - SHARD_COUNT_LOG2));
+	}
+
+	/// Max number of elements of a table before growing. It's 3/4 of the slots.
+	static U32 computeMaxEntryCount(U32 slotCount)
+	{
+		return slotCount - slotCount / 4;
+	}
+
+	/// @return The slot of the key or MAX_U32.
+	static U32 findInternal(const Table& table, U64 hash, const TKey& key);
+
+	/// Create a table and copy the elements of another table there.
+	template<typename TAllocator>
+	static Table* newTable(TAllocator& alloc, U32 slotCount, const Table* oldTable);
+};
+/// @}
+
+} // end namespace anki
+
+#include <anki/util/ConcurrentHashMap.inl.h>
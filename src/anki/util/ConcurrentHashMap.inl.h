@@ -0,0 +1,233 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/ConcurrentHashMap.h>
+
+namespace anki
+{
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void ConcurrentHashMap<TKey, TValue, THasher>::destroy(TAllocator alloc)
+{
+	for(Shard& shard : m_shards)
+	{
+		Table* table = shard.m_table.getNonAtomically();
+		while(table)
+		{
+			Table* const retired = table->m_retired;
+			alloc.getMemoryPool().free(table);
+			table = retired;
+		}
+
+		shard.m_table.setNonAtomically(nullptr);
+	}
+
+	m_entryCount.setNonAtomically(0);
+}
+
+template<typename TKey, typename TValue, typename THasher>
+const TValue* ConcurrentHashMap<TKey, TValue, THasher>::find(const TKey& key) const
+{
+	const U64 hash = hashKey(key);
+	const Table* const table = m_shards[getShardIndex(hash)].m_table.load(AtomicMemoryOrder::ACQUIRE);
+	if(ANKI_UNLIKELY(table == nullptr))
+	{
+		return nullptr;
+	}
+
+	const U32 slot = findInternal(*table, hash, key);
+	return (slot != MAX_U32) ? &table->m_entries[slot].m_value : nullptr;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator, typename... TArgs>
+const TValue& ConcurrentHashMap<TKey, TValue, THasher>::emplace(TAllocator alloc, const TKey& key, TArgs&&... args)
+{
+	const U64 hash = hashKey(key);
+	Shard& shard = m_shards[getShardIndex(hash)];
+	LockGuard<SpinLock> lock(shard.m_lock);
+
+	// The writers are serialized so there is no need for ordering
+	Table* table = shard.m_table.load(AtomicMemoryOrder::RELAXED);
+
+	// Don't replace if it's already there
+	if(table)
+	{
+		const U32 slot = findInternal(*table, hash, key);
+		if(slot != MAX_U32)
+		{
+			return table->m_entries[slot].m_value;
+		}
+	}
+
+	// Grow. The new table is complete before it's published so the readers will see all of its elements
+	if(table == nullptr || table->m_entryCount == computeMaxEntryCount(table->m_slotCount))
+	{
+		table = newTable(alloc, (table) ? table->m_slotCount * 2 : MIN_SLOT_COUNT, table);
+		shard.m_table.store(table, AtomicMemoryOrder::RELEASE);
+	}
+
+	// Find an empty slot
+	U32 slot = table->wrap(U32(hash));
+	while(table->m_hashes[slot].load(AtomicMemoryOrder::RELAXED) != 0)
+	{
+		slot = table->wrap(slot + 1);
+	}
+
+	// Construct the element and then publish it
+	Entry& entry = table->m_entries[slot];
+	::new(&entry.m_key) TKey(key);
+	::new(&entry.m_value) TValue(std::forward<TArgs>(args)...);
+	table->m_hashes[slot].store(hash, AtomicMemoryOrder::RELEASE);
+
+	++table->m_entryCount;
+	m_entryCount.fetchAdd(1);
+
+	return entry.m_value;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TFunc>
+void ConcurrentHashMap<TKey, TValue, THasher>::iterate(TFunc func) const
+{
+	for(const Shard& shard : m_shards)
+	{
+		const Table* const table = shard.m_table.load(AtomicMemoryOrder::ACQUIRE);
+		if(table == nullptr)
+		{
+			continue;
+		}
+
+		for(U32 slot = 0; slot < table->m_slotCount; ++slot)
+		{
+			if(table->m_hashes[slot].load(AtomicMemoryOrder::ACQUIRE) != 0)
+			{
+				const Entry& entry = table->m_entries[slot];
+				func(entry.m_key, entry.m_value);
+			}
+		}
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 ConcurrentHashMap<TKey, TValue, THasher>::findInternal(const Table& table, U64 hash, const TKey& key)
+{
+	U32 slot = table.wrap(U32(hash));
+	while(true)
+	{
+		const U64 slotHash = table.m_hashes[slot].load(AtomicMemoryOrder::ACQUIRE);
+		if(slotHash == hash && table.m_entries[slot].m_key == key)
+		{
+			return slot;
+		}
+
+		// No erasing means no holes in the probe sequences
+		if(slotHash == 0)
+		{
+			return MAX_U32;
+		}
+
+		slot = table.wrap(slot + 1);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+typename ConcurrentHashMap<TKey, TValue, THasher>::Table* ConcurrentHashMap<TKey, TValue, THasher>::newTable(
+	TAllocator& alloc, U32 slotCount, const Table* oldTable)
+{
+	ANKI_ASSERT(isPowerOfTwo(slotCount) && slotCount >= MIN_SLOT_COUNT);
+
+	// Allocate the header, the hashes and the entries in one go
+	const PtrSize hashesOffset = getAlignedRoundUp(alignof(Atomic<U64>), sizeof(Table));
+	const PtrSize entriesOffset = getAlignedRoundUp(alignof(Entry), hashesOffset + slotCount * sizeof(Atomic<U64>));
+	const PtrSize size = entriesOffset + slotCount * sizeof(Entry);
+	const PtrSize alignment = max<PtrSize>(alignof(Table), max<PtrSize>(alignof(Atomic<U64>), alignof(Entry)));
+	U8* const mem = static_cast<U8*>(alloc.getMemoryPool().allocate(size, alignment));
+
+	Table* const table = reinterpret_cast<Table*>(mem);
+	table->m_retired = const_cast<Table*>(oldTable);
+	table->m_hashes = reinterpret_cast<Atomic<U64>*>(mem + hashesOffset);
+	table->m_entries = reinterpret_cast<Entry*>(mem + entriesOffset);
+	table->m_slotCount = slotCount;
+	table->m_entryCount = 0;
+
+	for(U32 slot = 0; slot < slotCount; ++slot)
+	{
+		::new(&table->m_hashes[slot]) Atomic<U64>(0);
+	}
+
+	// Copy the elements of the old table. Nobody else can see the new table yet
+	if(oldTable)
+	{
+		for(U32 oldSlot = 0; oldSlot < oldTable->m_slotCount; ++oldSlot)
+		{
+			const U64 hash = oldTable->m_hashes[oldSlot].load(AtomicMemoryOrder::RELAXED);
+			if(hash == 0)
+			{
+				continue;
+			}
+
+			U32 slot = table->wrap(U32(hash));
+			while(table->m_hashes[slot].getNonAtomically() != 0)
+			{
+				slot = table->wrap(slot + 1);
+			}
+
+			memcpy(&table->m_entries[slot], &oldTable->m_entries[oldSlot], sizeof(Entry));
+			table->m_hashes[slot].setNonAtomically(hash);
+			++table->m_entryCount;
+		}
+
+		ANKI_ASSERT(table->m_entryCount == oldTable->m_entryCount);
+	}
+
+	return table;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+void ConcurrentHashMap<TKey, TValue, THasher>::validate() const
+{
+	U32 entryCount = 0;
+	for(U32 shardIdx = 0; shardIdx < SHARD_COUNT; ++shardIdx)
+	{
+		const Table* const table = m_shards[shardIdx].m_table.load(AtomicMemoryOrder::ACQUIRE);
+		if(table == nullptr)
+		{
+			continue;
+		}
+
+		ANKI_ASSERT(table->m_entryCount <= computeMaxEntryCount(table->m_slotCount));
+
+		U32 fullSlotCount = 0;
+		for(U32 slot = 0; slot < table->m_slotCount; ++slot)
+		{
+			const U64 hash = table->m_hashes[slot].load(AtomicMemoryOrder::ACQUIRE);
+			if(hash == 0)
+			{
+				continue;
+			}
+
+			++fullSlotCount;
+			ANKI_ASSERT(hash == hashKey(table->m_entries[slot].m_key));
+			ANKI_ASSERT(getShardIndex(hash) == shardIdx);
+
+			// No holes between the home slot and the slot
+			for(U32 s = table->wrap(U32(hash)); s != slot; s = table->wrap(s + 1))
+			{
+				ANKI_ASSERT(table->m_hashes[s].load(AtomicMemoryOrder::RELAXED) != 0);
+			}
+		}
+
+		ANKI_ASSERT(fullSlotCount == table->m_entryCount);
+		entryCount += fullSlotCount;
+	}
+
+	ANKI_ASSERT(entryCount == getSize());
+	(void)entryCount;
+}
+
+} // end namespace anki
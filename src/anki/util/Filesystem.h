@@ -43,6 +43,11 @@ ANKI_USE_RESULT Error removeDirectory(const CString& dir, GenericMemoryPoolAlloc
 /// Equivalent to: mkdir dir
 ANKI_USE_RESULT Error createDirectory(const CString& dir);
 
+/// Equivalent to: mv oldName newName
+/// It replaces @a newName if it exists. On POSIX systems the replacement is atomic so the readers see either the old or
+/// the new file.
+ANKI_USE_RESULT Error renameFile(const CString& oldName, const CString& newName);
+
 /// Get the home directory.
 /// Write the home directory to @a buff. The @a buffSize is the size of the @a buff. If the @buffSize is not enough the
 /// function will throw an exception.
@@ -51,6 +56,13 @@ ANKI_USE_RESULT Error getHomeDirectory(StringAuto& out);
 /// Get the time the file was last modified.
 ANKI_USE_RESULT Error getFileModificationTime(
 	CString filename, U32& year, U32& month, U32& day, U32& hour, U32& min, U32& second);
+
+/// Get the time the file was last modified in nanoseconds. The resolution depends on the filesystem. Use it to compare
+/// times and not as a date.
+ANKI_USE_RESULT Error getFileModificationTime(CString filename, U64& nanoseconds);
+
+/// Get the size of a file without opening it.
+ANKI_USE_RESULT Error getFileSize(CString filename, PtrSize& size);
 /// @}
 
 } // end namespace anki
@@ -12,6 +12,7 @@
 #include <anki/util/Assert.h>
 #include <anki/util/Thread.h>
 #include <cstring>
+#include <cstdio>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -196,6 +197,17 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldName, const CString& newName)
+{
+	if(rename(oldName.cstr(), newName.cstr()))
+	{
+		ANKI_UTIL_LOGE("%s : %s -> %s", strerror(errno), oldName.cstr(), newName.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	return Error::NONE;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	const char* home = getenv("HOME");
@@ -228,4 +240,30 @@ Error getFileModificationTime(CString filename, U32& year, U32& month, U32& day,
 	return Error::NONE;
 }
 
+Error getFileModificationTime(CString filename, U64& nanoseconds)
+{
+	struct stat buff;
+	if(stat(filename.cstr(), &buff))
+	{
+		ANKI_UTIL_LOGE("stat() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	nanoseconds = U64(buff.st_mtim.tv_sec) * 1000000000ull + U64(buff.st_mtim.tv_nsec);
+	return Error::NONE;
+}
+
+Error getFileSize(CString filename, PtrSize& size)
+{
+	struct stat buff;
+	if(stat(filename.cstr(), &buff))
+	{
+		ANKI_UTIL_LOGE("stat() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	size = PtrSize(buff.st_size);
+	return Error::NONE;
+}
+
 } // end namespace anki
@@ -66,6 +66,47 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldName, const CString& newName)
+{
+	if(MoveFileExA(oldName.cstr(), newName.cstr(), MOVEFILE_REPLACE_EXISTING) == 0)
+	{
+		ANKI_UTIL_LOGE("Failed to rename %s to %s", oldName.cstr(), newName.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	return Error::NONE;
+}
+
+Error getFileModificationTime(CString filename, U64& nanoseconds)
+{
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA(filename.cstr(), &data);
+	if(handle == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("FindFirstFileA() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+	FindClose(handle);
+
+	// FILETIME is in 100 nanosecond intervals
+	const U64 intervals = (U64(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+	nanoseconds = intervals * 100;
+	return Error::NONE;
+}
+
+Error getFileSize(CString filename, PtrSize& size)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if(!GetFileAttributesExA(filename.cstr(), GetFileExInfoStandard, &data))
+	{
+		ANKI_UTIL_LOGE("GetFileAttributesExA() failed: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	size = PtrSize((U64(data.nFileSizeHigh) << 32) | data.nFileSizeLow);
+	return Error::NONE;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	char path[MAX_PATH];
@@ -0,0 +1,467 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/HashMap.h>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+namespace detail
+{
+
+/// A group of control bytes of the FlatHashMap. The bits of the masks it returns are the slots of the group that match.
+class FlatHashMapGroup
+{
+public:
+	static constexpr U32 SIZE = 16;
+
+	/// The control byte of an empty slot. Full slots hold the 7 top bits of the hash.
+	static constexpr U8 EMPTY = 0x80;
+
+	/// Iterate the set bits of a mask.
+	class Mask
+	{
+	public:
+		U64 m_bits;
+
+		explicit operator Bool() const
+		{
+			return m_bits != 0;
+		}
+
+		/// Get the slot of the lowest set bit.
+		U32 getFirst() const
+		{
+			ANKI_ASSERT(m_bits);
+			return U32(__builtin_ctzll(m_bits)) >> BITS_PER_SLOT_LOG2;
+		}
+
+		void removeFirst()
+		{
+			m_bits &= m_bits - 1;
+		}
+	};
+
+	explicit FlatHashMapGroup(const U8* ctrl)
+	{
+#if ANKI_SIMD_SSE
+		m_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif ANKI_SIMD_NEON
+		m_ctrl = vld1q_u8(ctrl);
+#else
+		memcpy(&m_ctrl[0], ctrl, SIZE);
+#endif
+	}
+
+	/// Get the slots with a specific control byte.
+	Mask match(U8 h2) const
+	{
+#if ANKI_SIMD_SSE
+		return {U64(_mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(I8(h2)))))};
+#elif ANKI_SIMD_NEON
+		return toMask(vceqq_u8(m_ctrl, vdupq_n_u8(h2)));
+#else
+		U64 bits = 0;
+		for(U32 i = 0; i < SIZE; ++i)
+		{
+			bits |= U64(m_ctrl[i] == h2) << i;
+		}
+		return {bits};
+#endif
+	}
+
+	/// Get the empty slots.
+	Mask matchEmpty() const
+	{
+#if ANKI_SIMD_SSE
+		return {U64(_mm_movemask_epi8(m_ctrl))};
+#elif ANKI_SIMD_NEON
+		return toMask(vcltq_s8(vreinterpretq_s8_u8(m_ctrl), vdupq_n_s8(0)));
+#else
+		U64 bits = 0;
+		for(U32 i = 0; i < SIZE; ++i)
+		{
+			bits |= U64(m_ctrl[i] >> 7) << i;
+		}
+		return {bits};
+#endif
+	}
+
+	/// Get the full slots.
+	Mask matchFull() const
+	{
+#if ANKI_SIMD_SSE
+		return {U64(_mm_movemask_epi8(m_ctrl) ^ 0xFFFF)};
+#elif ANKI_SIMD_NEON
+		return toMask(vcgeq_s8(vreinterpretq_s8_u8(m_ctrl), vdupq_n_s8(0)));
+#else
+		return {matchEmpty().m_bits ^ 0xFFFF};
+#endif
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	static constexpr U32 BITS_PER_SLOT_LOG2 = 0;
+	__m128i m_ctrl;
+#elif ANKI_SIMD_NEON
+	static constexpr U32 BITS_PER_SLOT_LOG2 = 2;
+	uint8x16_t m_ctrl;
+
+	/// Narrow the 0xFF bytes of a comparison to 4 bits per slot and keep one of them.
+	static Mask toMask(uint8x16_t cmp)
+	{
+		const uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+		return {vget_lane_u64(vreinterpret_u64_u8(narrow), 0) & 0x8888888888888888};
+	}
+#else
+	static constexpr U32 BITS_PER_SLOT_LOG2 = 0;
+	Array<U8, SIZE> m_ctrl;
+#endif
+};
+
+} // end namespace detail
+
+/// FlatHashMap iterator. It iterates the slots starting from a slot after an empty one.
+template<typename TMapPtr, typename TValueReference, typename TValuePointer>
+class FlatHashMapIterator
+{
+	template<typename, typename, typename>
+	friend class FlatHashMap;
+
+	template<typename, typename, typename>
+	friend class FlatHashMapIterator;
+
+public:
+	FlatHashMapIterator() = default;
+
+	FlatHashMapIterator(TMapPtr map, U32 firstSlot, U32 offset)
+		: m_map(map)
+		, m_firstSlot(firstSlot)
+		, m_offset(offset)
+	{
+		ANKI_ASSERT(map);
+	}
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YMapPtr, typename YValueReference, typename YValuePointer>
+	FlatHashMapIterator(const FlatHashMapIterator<YMapPtr, YValueReference, YValuePointer>& b)
+		: m_map(b.m_map)
+		, m_firstSlot(b.m_firstSlot)
+		, m_offset(b.m_offset)
+	{
+	}
+
+	TValueReference operator*() const
+	{
+		return m_map->m_entries[getSlot()].m_value;
+	}
+
+	TValuePointer operator->() const
+	{
+		return &m_map->m_entries[getSlot()].m_value;
+	}
+
+	/// Get the key of the element.
+	const auto& getKey() const
+	{
+		return m_map->m_entries[getSlot()].m_key;
+	}
+
+	FlatHashMapIterator& operator++()
+	{
+		getSlot();
+		m_offset = m_map->findFullSlotOffset(m_firstSlot, m_offset + 1);
+		return *this;
+	}
+
+	FlatHashMapIterator operator++(int)
+	{
+		FlatHashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	Bool operator==(const FlatHashMapIterator& b) const
+	{
+		ANKI_ASSERT(m_map == b.m_map);
+		return m_offset == b.m_offset;
+	}
+
+	Bool operator!=(const FlatHashMapIterator& b) const
+	{
+		return !(*this == b);
+	}
+
+private:
+	TMapPtr m_map = nullptr;
+	U32 m_firstSlot = 0;
+	U32 m_offset = MAX_U32; ///< The distance from m_firstSlot. It's the slot count for the end iterator.
+
+	U32 getSlot() const
+	{
+		ANKI_ASSERT(m_map && m_offset < m_map->m_slotCount);
+		const U32 slot = m_map->wrap(m_firstSlot + m_offset);
+		ANKI_ASSERT(m_map->m_ctrl[slot] != detail::FlatHashMapGroup::EMPTY);
+		return slot;
+	}
+};
+
+/// An open addressing hash map. It's faster than HashMap and it stores the keys so the hashes don't need to be unique.
+/// The slots are probed linearly 16 at a time by comparing their control bytes using SIMD. Erasing shifts the next
+/// slots back so there are no tombstones and the probes never get longer after erasing. The iteration starts after an
+/// empty slot so the shifting never moves an element before the iterator and erasing while iterating visits every
+/// element once:
+/// @code
+/// for(auto it = map.getBegin(); it != map.getEnd();)
+/// {
+/// 	if(shouldErase(*it))
+/// 	{
+/// 		it = map.erase(alloc, it);
+/// 	}
+/// 	else
+/// 	{
+/// 		++it;
+/// 	}
+/// }
+/// @endcode
+/// Lookups can use any type the THasher can hash and TKey can compare with (eg a CString for String keys).
+/// @note Emplacing and erasing move the elements around so they invalidate the pointers to them.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>>
+class FlatHashMap : public NonCopyable
+{
+	template<typename, typename, typename>
+	friend class FlatHashMapIterator;
+
+public:
+	using Key = TKey;
+	using Value = TValue;
+	using Hasher = THasher;
+	using Iterator = FlatHashMapIterator<FlatHashMap*, TValue&, TValue*>;
+	using ConstIterator = FlatHashMapIterator<const FlatHashMap*, const TValue&, const TValue*>;
+
+	/// The min number of slots.
+	static constexpr U32 MIN_SLOT_COUNT = detail::FlatHashMapGroup::SIZE;
+
+	FlatHashMap() = default;
+
+	/// Move.
+	FlatHashMap(FlatHashMap&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// You need to manually destroy the map.
+	/// @see FlatHashMap::destroy
+	~FlatHashMap()
+	{
+		ANKI_ASSERT(m_entries == nullptr && m_ctrl == nullptr && "Forgot to call destroy");
+	}
+
+	/// Move.
+	FlatHashMap& operator=(FlatHashMap&& b)
+	{
+		ANKI_ASSERT(m_entries == nullptr && m_ctrl == nullptr && "Forgot to call destroy");
+		m_entries = b.m_entries;
+		m_ctrl = b.m_ctrl;
+		m_entryCount = b.m_entryCount;
+		m_slotCount = b.m_slotCount;
+		b.resetMembers();
+		return *this;
+	}
+
+	Iterator getBegin()
+	{
+		const U32 firstSlot = findFirstSlot();
+		return Iterator(this, firstSlot, findFullSlotOffset(firstSlot, 0));
+	}
+
+	ConstIterator getBegin() const
+	{
+		const U32 firstSlot = findFirstSlot();
+		return ConstIterator(this, firstSlot, findFullSlotOffset(firstSlot, 0));
+	}
+
+	Iterator getEnd()
+	{
+		return Iterator(this, 0, m_slotCount);
+	}
+
+	ConstIterator getEnd() const
+	{
+		return ConstIterator(this, 0, m_slotCount);
+	}
+
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	U32 getSize() const
+	{
+		return m_entryCount;
+	}
+
+	Bool isEmpty() const
+	{
+		return m_entryCount == 0;
+	}
+
+	/// Destroy the map and free its elements.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Make room for some elements to avoid growing while emplacing them.
+	template<typename TAllocator>
+	void reserve(TAllocator alloc, U32 elementCount);
+
+	/// Construct an element inside the map. If the key is already there its value will be replaced.
+	template<typename TAllocator, typename... TArgs>
+	Iterator emplace(TAllocator alloc, const TKey& key, TArgs&&... args);
+
+	/// Erase an element.
+	/// @return The iterator of the next element to visit if @a it is used to iterate.
+	template<typename TAllocator>
+	Iterator erase(TAllocator alloc, Iterator it);
+
+	/// Find a value using a key or anything that can be compared to the key.
+	template<typename TOtherKey>
+	Iterator find(const TOtherKey& key)
+	{
+		const U32 slot = findInternal(key);
+		return (slot != MAX_U32) ? Iterator(this, slot, 0) : getEnd();
+	}
+
+	/// Find a value using a key or anything that can be compared to the key.
+	template<typename TOtherKey>
+	ConstIterator find(const TOtherKey& key) const
+	{
+		const U32 slot = findInternal(key);
+		return (slot != MAX_U32) ? ConstIterator(this, slot, 0) : getEnd();
+	}
+
+	/// Check the validity of the map.
+	void validate() const;
+
+private:
+	using Group = detail::FlatHashMapGroup;
+
+	class Entry
+	{
+	public:
+		TKey m_key;
+		TValue m_value;
+
+		template<typename... TArgs>
+		Entry(const TKey& key, TArgs&&... args)
+			: m_key(key)
+			, m_value(std::forward<TArgs>(args)...)
+		{
+		}
+	};
+
+	/// The elements. One for every slot.
+	Entry* m_entries = nullptr;
+
+	/// The control bytes of the slots. The first Group::SIZE-1 are duplicated at the end so that a group can be loaded
+	/// from any slot without wrapping around.
+	U8* m_ctrl = nullptr;
+
+	U32 m_entryCount = 0;
+	U32 m_slotCount = 0;
+
+	/// Hash the output of the THasher again because some of them are weak (eg the integer hashers just return the
+	/// integer).
+	template<typename TOtherKey>
+	static U64 hashKey(const TOtherKey& key)
+	{
+		return detail::hashMix(THasher()(key), detail::HASH_SECRET_0);
+	}
+
+	/// Get the control byte of a full slot.
+	static U8 getH2(U64 hash)
+	{
+		return U8(hash >> 57);
+	}
+
+	/// Max number of elements before growing. It's 7/8 of the slots.
+	static U32 computeMaxEntryCount(U32 slotCount)
+	{
+		return slotCount - slotCount / 8;
+	}
+
+	U32 wrap(U32 slot) const
+	{
+		return slot & (m_slotCount - 1);
+	}
+
+	void setCtrl(U32 slot, U8 ctrl)
+	{
+		m_ctrl[slot] = ctrl;
+		if(slot < Group::SIZE - 1)
+		{
+			m_ctrl[m_slotCount + slot] = ctrl;
+		}
+	}
+
+	/// @return The slot of the key or MAX_U32.
+	template<typename TOtherKey>
+	U32 findInternal(const TOtherKey& key) const;
+
+	/// Find the first empty slot starting from a slot.
+	U32 findEmptySlot(U32 slot) const;
+
+	/// Get the first slot of the iteration. It's the one after an empty slot because the elements are never shifted
+	/// over an empty slot.
+	U32 findFirstSlot() const
+	{
+		return (m_entryCount) ? wrap(findEmptySlot(0) + 1) : 0;
+	}
+
+	/// Find the first full slot starting from an offset from the first slot of the iteration.
+	/// @return The offset of the slot or the slot count if there are no more.
+	U32 findFullSlotOffset(U32 firstSlot, U32 offset) const;
+
+	/// Allocate new slots and move the elements there.
+	template<typename TAllocator>
+	void rehash(TAllocator& alloc, U32 slotCount);
+
+	void resetMembers()
+	{
+		m_entries = nullptr;
+		m_ctrl = nullptr;
+		m_entryCount = 0;
+		m_slotCount = 0;
+	}
+};
+/// @}
+
+} // end namespace anki
+
+#include <anki/util/FlatHashMap.inl.h>
@@ -0,0 +1,266 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/FlatHashMap.h>
+
+namespace anki
+{
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::destroy(TAllocator alloc)
+{
+	if(m_entries)
+	{
+		for(U32 slot = 0; slot < m_slotCount; ++slot)
+		{
+			if(m_ctrl[slot] != Group::EMPTY)
+			{
+				m_entries[slot].~Entry();
+			}
+		}
+
+		alloc.getMemoryPool().free(m_entries);
+		alloc.getMemoryPool().free(m_ctrl);
+	}
+
+	resetMembers();
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::rehash(TAllocator& alloc, U32 slotCount)
+{
+	ANKI_ASSERT(isPowerOfTwo(slotCount) && slotCount >= MIN_SLOT_COUNT);
+	ANKI_ASSERT(computeMaxEntryCount(slotCount) >= m_entryCount);
+
+	Entry* const oldEntries = m_entries;
+	U8* const oldCtrl = m_ctrl;
+	const U32 oldSlotCount = m_slotCount;
+
+	m_entries = static_cast<Entry*>(alloc.getMemoryPool().allocate(slotCount * sizeof(Entry), alignof(Entry)));
+	m_ctrl = static_cast<U8*>(alloc.getMemoryPool().allocate(slotCount + Group::SIZE - 1, Group::SIZE));
+	memset(m_ctrl, Group::EMPTY, slotCount + Group::SIZE - 1);
+	m_slotCount = slotCount;
+
+	// Move the elements to the new slots
+	for(U32 oldSlot = 0; oldSlot < oldSlotCount; ++oldSlot)
+	{
+		if(oldCtrl[oldSlot] == Group::EMPTY)
+		{
+			continue;
+		}
+
+		Entry& oldEntry = oldEntries[oldSlot];
+		const U64 hash = hashKey(oldEntry.m_key);
+		const U32 slot = findEmptySlot(U32(hash));
+		setCtrl(slot, getH2(hash));
+		::new(&m_entries[slot]) Entry(std::move(oldEntry));
+		oldEntry.~Entry();
+	}
+
+	if(oldEntries)
+	{
+		alloc.getMemoryPool().free(oldEntries);
+		alloc.getMemoryPool().free(oldCtrl);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+void FlatHashMap<TKey, TValue, THasher>::reserve(TAllocator alloc, U32 elementCount)
+{
+	U32 slotCount = (m_slotCount) ? m_slotCount : MIN_SLOT_COUNT;
+	while(computeMaxEntryCount(slotCount) < elementCount)
+	{
+		slotCount *= 2;
+	}
+
+	if(slotCount != m_slotCount)
+	{
+		rehash(alloc, slotCount);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator, typename... TArgs>
+typename FlatHashMap<TKey, TValue, THasher>::Iterator FlatHashMap<TKey, TValue, THasher>::emplace(
+	TAllocator alloc, const TKey& key, TArgs&&... args)
+{
+	// Replace if it's already there
+	U32 slot = findInternal(key);
+	if(slot != MAX_U32)
+	{
+		TValue& value = m_entries[slot].m_value;
+		value.~TValue();
+		::new(&value) TValue(std::forward<TArgs>(args)...);
+		return Iterator(this, slot, 0);
+	}
+
+	if(m_entryCount == computeMaxEntryCount(m_slotCount))
+	{
+		rehash(alloc, (m_slotCount) ? m_slotCount * 2 : MIN_SLOT_COUNT);
+	}
+
+	const U64 hash = hashKey(key);
+	slot = findEmptySlot(U32(hash));
+	setCtrl(slot, getH2(hash));
+	::new(&m_entries[slot]) Entry(key, std::forward<TArgs>(args)...);
+	++m_entryCount;
+
+	return Iterator(this, slot, 0);
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TAllocator>
+typename FlatHashMap<TKey, TValue, THasher>::Iterator FlatHashMap<TKey, TValue, THasher>::erase(
+	TAllocator alloc, Iterator it)
+{
+	(void)alloc;
+	ANKI_ASSERT(it.m_map == this);
+	U32 emptySlot = it.getSlot();
+
+	m_entries[emptySlot].~Entry();
+	setCtrl(emptySlot, Group::EMPTY);
+	--m_entryCount;
+
+	// Shift back the next elements that are not in their home slot. This way there are no holes in the probe sequences
+	U32 slot = emptySlot;
+	while(true)
+	{
+		slot = wrap(slot + 1);
+		if(m_ctrl[slot] == Group::EMPTY)
+		{
+			break;
+		}
+
+		Entry& entry = m_entries[slot];
+		const U32 home = wrap(U32(hashKey(entry.m_key)));
+		if(wrap(slot - home) >= wrap(slot - emptySlot))
+		{
+			// The empty slot is between the home and the current slot, move the element there
+			setCtrl(emptySlot, m_ctrl[slot]);
+			::new(&m_entries[emptySlot]) Entry(std::move(entry));
+			entry.~Entry();
+
+			setCtrl(slot, Group::EMPTY);
+			emptySlot = slot;
+		}
+	}
+
+	// The elements were shifted towards the iterator so continue from the erased slot
+	return Iterator(this, it.m_firstSlot, findFullSlotOffset(it.m_firstSlot, it.m_offset));
+}
+
+template<typename TKey, typename TValue, typename THasher>
+template<typename TOtherKey>
+U32 FlatHashMap<TKey, TValue, THasher>::findInternal(const TOtherKey& key) const
+{
+	if(ANKI_UNLIKELY(m_entryCount == 0))
+	{
+		return MAX_U32;
+	}
+
+	const U64 hash = hashKey(key);
+	const U8 h2 = getH2(hash);
+	U32 slot = wrap(U32(hash));
+	while(true)
+	{
+		const Group group(&m_ctrl[slot]);
+
+		Group::Mask mask = group.match(h2);
+		while(mask)
+		{
+			const U32 matchSlot = wrap(slot + mask.getFirst());
+			if(ANKI_LIKELY(m_entries[matchSlot].m_key == key))
+			{
+				return matchSlot;
+			}
+
+			mask.removeFirst();
+		}
+
+		// The elements are stored before the first empty slot after their home slot
+		if(ANKI_LIKELY(group.matchEmpty().m_bits != 0))
+		{
+			return MAX_U32;
+		}
+
+		slot = wrap(slot + Group::SIZE);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findEmptySlot(U32 slot) const
+{
+	ANKI_ASSERT(m_slotCount > 0 && m_entryCount < m_slotCount);
+	slot = wrap(slot);
+	while(true)
+	{
+		const Group::Mask mask = Group(&m_ctrl[slot]).matchEmpty();
+		if(ANKI_LIKELY(mask.m_bits != 0))
+		{
+			return wrap(slot + mask.getFirst());
+		}
+
+		slot = wrap(slot + Group::SIZE);
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher>
+U32 FlatHashMap<TKey, TValue, THasher>::findFullSlotOffset(U32 firstSlot, U32 offset) const
+{
+	while(offset < m_slotCount)
+	{
+		const Group::Mask mask = Group(&m_ctrl[wrap(firstSlot + offset)]).matchFull();
+		if(mask.m_bits != 0)
+		{
+			return min(offset + mask.getFirst(), m_slotCount);
+		}
+
+		offset += Group::SIZE;
+	}
+
+	return m_slotCount;
+}
+
+template<typename TKey, typename TValue, typename THasher>
+void FlatHashMap<TKey, TValue, THasher>::validate() const
+{
+	if(m_slotCount == 0)
+	{
+		ANKI_ASSERT(m_entryCount == 0 && m_entries == nullptr && m_ctrl == nullptr);
+		return;
+	}
+
+	ANKI_ASSERT(m_entryCount <= computeMaxEntryCount(m_slotCount));
+
+	U32 fullSlotCount = 0;
+	for(U32 slot = 0; slot < m_slotCount + Group::SIZE - 1; ++slot)
+	{
+		const U8 ctrl = m_ctrl[slot];
+		ANKI_ASSERT(ctrl == m_ctrl[wrap(slot)] && "The copies of the control bytes are wrong");
+		if(slot >= m_slotCount || ctrl == Group::EMPTY)
+		{
+			continue;
+		}
+
+		++fullSlotCount;
+		const U64 hash = hashKey(m_entries[slot].m_key);
+		ANKI_ASSERT(getH2(hash) == ctrl);
+
+		// No holes between the home slot and the slot
+		for(U32 s = wrap(U32(hash)); s != slot; s = wrap(s + 1))
+		{
+			ANKI_ASSERT(m_ctrl[s] != Group::EMPTY);
+		}
+		(void)hash;
+	}
+
+	ANKI_ASSERT(fullSlotCount == m_entryCount);
+	(void)fullSlotCount;
+}
+
+} // end namespace anki
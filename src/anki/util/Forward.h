@@ -35,6 +35,8 @@ class SparseArray;
 
 class String;
 class StringAuto;
+class SsoString;
+class InternedString;
 
 class ThreadHive;
 
@@ -5,14 +5,249 @@
 
 #include <anki/util/Hash.h>
 #include <anki/util/Assert.h>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
 
 namespace anki
 {
 
+namespace detail
+{
+
+/// Bigger than that and the hash uses 4 lanes of accumulators.
+constexpr PtrSize HASH_BULK_MIN_SIZE = 256;
+
+constexpr PtrSize HASH_STRIPE_SIZE = 32;
+constexpr PtrSize HASH_STRIPES_PER_BLOCK = 8;
+constexpr PtrSize HASH_BLOCK_SIZE = HASH_STRIPE_SIZE * HASH_STRIPES_PER_BLOCK;
+constexpr U64 HASH_SCRAMBLE_PRIME = 0x9E3779B1;
+
+/// Every stripe of a block uses 4 consecutive values starting from its index. The last 4 are used by the scramble.
+alignas(16) static const U64 HASH_BULK_SECRET[HASH_STRIPES_PER_BLOCK + 4] = {0xc0e16b163a85a4dc,
+	0x890acd8dd443c47c,
+	0xb3889d8a6dc47761,
+	0x6a0398e528f0ae6a,
+	0x048344ece48a855e,
+	0xf175cfea21871330,
+	0x391ceef02702c2fd,
+	0x4baf8cac4784cb12,
+	0x3547744583a3f88e,
+	0xd9cf2b15c6b6c90e,
+	0x961facc76d5fe21c,
+	0x0094ab49d50f11f9};
+
+/// The 4 accumulators of the bulk path. Every lane adds the product of the two halves of the input mixed with the
+/// secret and the input itself goes to the neighbour lane so no bits are lost.
+class HashAccumulators
+{
+public:
+#if ANKI_SIMD_SSE
+	__m128i m_acc[2];
+
+	void init()
+	{
+		m_acc[0] = _mm_set_epi64x(I64(HASH_SECRET_1), I64(HASH_SECRET_0));
+		m_acc[1] = _mm_set_epi64x(I64(HASH_SECRET_3), I64(HASH_SECRET_2));
+	}
+
+	void accumulate(const U8* p, const U64* secret)
+	{
+		for(U32 i = 0; i < 2; ++i)
+		{
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i);
+			const __m128i k = _mm_xor_si128(d, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+			const __m128i product = _mm_mul_epu32(k, _mm_srli_epi64(k, 32));
+			const __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+			m_acc[i] = _mm_add_epi64(m_acc[i], _mm_add_epi64(product, swapped));
+		}
+	}
+
+	void scramble(const U64* secret)
+	{
+		const __m128i prime = _mm_set1_epi32(I32(HASH_SCRAMBLE_PRIME));
+		for(U32 i = 0; i < 2; ++i)
+		{
+			__m128i a = m_acc[i];
+			a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+			a = _mm_xor_si128(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+
+			const __m128i lo = _mm_mul_epu32(a, prime);
+			const __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+			m_acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+		}
+	}
+
+	void store(U64 out[4]) const
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), m_acc[0]);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out) + 1, m_acc[1]);
+	}
+#elif ANKI_SIMD_NEON
+	uint64x2_t m_acc[2];
+
+	void init()
+	{
+		const U64 init[4] = {HASH_SECRET_0, HASH_SECRET_1, HASH_SECRET_2, HASH_SECRET_3};
+		m_acc[0] = vld1q_u64(&init[0]);
+		m_acc[1] = vld1q_u64(&init[2]);
+	}
+
+	void accumulate(const U8* p, const U64* secret)
+	{
+		for(U32 i = 0; i < 2; ++i)
+		{
+			const uint64x2_t d = vreinterpretq_u64_u8(vld1q_u8(p + i * 16));
+			const uint64x2_t k = veorq_u64(d, vld1q_u64(secret + i * 2));
+			const uint64x2_t product = vmull_u32(vmovn_u64(k), vshrn_n_u64(k, 32));
+			const uint64x2_t swapped = vextq_u64(d, d, 1);
+			m_acc[i] = vaddq_u64(m_acc[i], vaddq_u64(product, swapped));
+		}
+	}
+
+	void scramble(const U64* secret)
+	{
+		const uint32x2_t prime = vdup_n_u32(U32(HASH_SCRAMBLE_PRIME));
+		for(U32 i = 0; i < 2; ++i)
+		{
+			uint64x2_t a = m_acc[i];
+			a = veorq_u64(a, vshrq_n_u64(a, 47));
+			a = veorq_u64(a, vld1q_u64(secret + i * 2));
+
+			const uint64x2_t lo = vmull_u32(vmovn_u64(a), prime);
+			const uint64x2_t hi = vmull_u32(vshrn_n_u64(a, 32), prime);
+			m_acc[i] = vaddq_u64(lo, vshlq_n_u64(hi, 32));
+		}
+	}
+
+	void store(U64 out[4]) const
+	{
+		vst1q_u64(&out[0], m_acc[0]);
+		vst1q_u64(&out[2], m_acc[1]);
+	}
+#else
+	U64 m_acc[4];
+
+	void init()
+	{
+		m_acc[0] = HASH_SECRET_0;
+		m_acc[1] = HASH_SECRET_1;
+		m_acc[2] = HASH_SECRET_2;
+		m_acc[3] = HASH_SECRET_3;
+	}
+
+	void accumulate(const U8* p, const U64* secret)
+	{
+		for(U32 i = 0; i < 4; ++i)
+		{
+			const U64 d = hashRead8(p + i * 8);
+			const U64 k = d ^ secret[i];
+			m_acc[i] += (k & 0xFFFFFFFF) * (k >> 32);
+			m_acc[i ^ 1] += d;
+		}
+	}
+
+	void scramble(const U64* secret)
+	{
+		for(U32 i = 0; i < 4; ++i)
+		{
+			U64 a = m_acc[i];
+			a ^= a >> 47;
+			a ^= secret[i];
+			m_acc[i] = a * HASH_SCRAMBLE_PRIME;
+		}
+	}
+
+	void store(U64 out[4]) const
+	{
+		for(U32 i = 0; i < 4; ++i)
+		{
+			out[i] = m_acc[i];
+		}
+	}
+#endif
+};
+
+U64 computeLongHash(const U8* p, PtrSize size, U64 seed)
+{
+	ANKI_ASSERT(size > 32);
+	const U8* const end = p + size;
+
+	if(size <= HASH_BULK_MIN_SIZE)
+	{
+		// 3 independent multiplications per iteration
+		PtrSize i = size;
+		if(i > 48)
+		{
+			U64 seed1 = seed;
+			U64 seed2 = seed;
+			do
+			{
+				seed = hashMix(hashRead8(p) ^ HASH_SECRET_1, hashRead8(p + 8) ^ seed);
+				seed1 = hashMix(hashRead8(p + 16) ^ HASH_SECRET_2, hashRead8(p + 24) ^ seed1);
+				seed2 = hashMix(hashRead8(p + 32) ^ HASH_SECRET_3, hashRead8(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while(i > 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while(i > 16)
+		{
+			seed = hashMix(hashRead8(p) ^ HASH_SECRET_1, hashRead8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+	}
+	else
+	{
+		HashAccumulators acc;
+		acc.init();
+
+		// Full blocks. Leave at least one byte for the tail
+		const PtrSize blockCount = (size - 1) / HASH_BLOCK_SIZE;
+		for(PtrSize b = 0; b < blockCount; ++b)
+		{
+			for(PtrSize s = 0; s < HASH_STRIPES_PER_BLOCK; ++s)
+			{
+				acc.accumulate(p, &HASH_BULK_SECRET[s]);
+				p += HASH_STRIPE_SIZE;
+			}
+
+			acc.scramble(&HASH_BULK_SECRET[HASH_STRIPES_PER_BLOCK]);
+		}
+
+		// Full stripes of the last block
+		const PtrSize stripeCount = (PtrSize(end - p) - 1) / HASH_STRIPE_SIZE;
+		for(PtrSize s = 0; s < stripeCount; ++s)
+		{
+			acc.accumulate(p, &HASH_BULK_SECRET[s]);
+			p += HASH_STRIPE_SIZE;
+		}
+
+		// The last stripe overlaps with the previous one
+		acc.accumulate(end - HASH_STRIPE_SIZE, &HASH_BULK_SECRET[HASH_STRIPES_PER_BLOCK]);
+
+		U64 lanes[4];
+		acc.store(lanes);
+		seed = hashMix(lanes[0] ^ HASH_SECRET_1, lanes[1] ^ seed);
+		seed ^= hashMix(lanes[2] ^ HASH_SECRET_2, lanes[3] ^ HASH_SECRET_3);
+	}
+
+	const U64 h = hashFinalize(hashRead8(end - 16), hashRead8(end - 8), seed, size);
+	ANKI_ASSERT(h != 0);
+	return h;
+}
+
+} // end namespace detail
+
 constexpr U64 HASH_M = 0xc6a4a7935bd1e995;
 constexpr U64 HASH_R = 47;
 
-U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
+U64 appendStableHash(const void* buffer, PtrSize bufferSize, U64 h)
 {
 	const U64* data = static_cast<const U64*>(buffer);
 	const U64* const end = data + (bufferSize / sizeof(U64));
@@ -58,10 +293,10 @@ U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
 	return h;
 }
 
-U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed)
+U64 computeStableHash(const void* buffer, PtrSize bufferSize, U64 seed)
 {
 	const U64 h = seed ^ (bufferSize * HASH_M);
-	return appendHash(buffer, bufferSize, h);
+	return appendStableHash(buffer, bufferSize, h);
 }
 
 } // end namespace anki
@@ -6,6 +6,11 @@
 #pragma once
 
 #include <anki/util/StdTypes.h>
+#include <anki/util/Assert.h>
+#include <cstring>
+#if ANKI_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 
 namespace anki
 {
@@ -13,19 +18,137 @@ namespace anki
 /// @addtogroup util_other
 /// @{
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+namespace detail
+{
+
+constexpr U64 HASH_SECRET_0 = 0xa0761d6478bd642f;
+constexpr U64 HASH_SECRET_1 = 0xe7037ed1a0b428db;
+constexpr U64 HASH_SECRET_2 = 0x8ebc6af09c88c6e3;
+constexpr U64 HASH_SECRET_3 = 0x589965cc75374cc3;
+
+inline U64 hashRead8(const U8* p)
+{
+	U64 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline U64 hashRead4(const U8* p)
+{
+	U32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/// 64x64 to 128 bit multiplication.
+inline void hashMultiply(U64& a, U64& b)
+{
+#if ANKI_COMPILER_GCC_COMPATIBLE
+	const __uint128_t r = __uint128_t(a) * b;
+	a = U64(r);
+	b = U64(r >> 64);
+#else
+	U64 hi;
+	a = _umul128(a, b, &hi);
+	b = hi;
+#endif
+}
+
+/// Multiply and fold the 128 bit result.
+inline U64 hashMix(U64 a, U64 b)
+{
+	hashMultiply(a, b);
+	return a ^ b;
+}
+
+inline U64 hashFinalize(U64 a, U64 b, U64 seed, PtrSize size)
+{
+	a ^= HASH_SECRET_1;
+	b ^= seed;
+	hashMultiply(a, b);
+	return hashMix(a ^ HASH_SECRET_0 ^ size, b ^ HASH_SECRET_1);
+}
+
+/// The path of computeHash for buffers bigger than 32 bytes.
+ANKI_USE_RESULT U64 computeLongHash(const U8* p, PtrSize size, U64 seed);
+
+} // end namespace detail
+
+/// Computes a hash of a buffer. It's based on wyhash and for big buffers it uses SIMD. The keys up to 32 bytes are
+/// hashed inline so when the size is known at compile time the hashing is just a few instructions. The result is the
+/// same in all platforms but it might change between versions of the engine so don't store it in files, see
+/// computeStableHash().
+/// @param[in] buffer The buffer to hash.
+/// @param bufferSize The size of the buffer.
+/// @param seed A unique seed.
+/// @return The hash.
+ANKI_USE_RESULT inline U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123)
+{
+	using namespace detail;
+
+	const U8* p = static_cast<const U8*>(buffer);
+	seed ^= hashMix(seed ^ HASH_SECRET_0, HASH_SECRET_1);
+
+	U64 a, b;
+	if(ANKI_LIKELY(bufferSize <= 16))
+	{
+		if(bufferSize >= 4)
+		{
+			const PtrSize mid = (bufferSize >> 3) << 2;
+			a = (hashRead4(p) << 32) | hashRead4(p + mid);
+			b = (hashRead4(p + bufferSize - 4) << 32) | hashRead4(p + bufferSize - 4 - mid);
+		}
+		else if(bufferSize > 0)
+		{
+			a = (U64(p[0]) << 16) | (U64(p[bufferSize >> 1]) << 8) | p[bufferSize - 1];
+			b = 0;
+		}
+		else
+		{
+			a = b = 0;
+		}
+	}
+	else if(bufferSize <= 32)
+	{
+		seed = hashMix(hashRead8(p) ^ HASH_SECRET_1, hashRead8(p + 8) ^ seed);
+		a = hashRead8(p + bufferSize - 16);
+		b = hashRead8(p + bufferSize - 8);
+	}
+	else
+	{
+		return computeLongHash(p, bufferSize, seed);
+	}
+
+	const U64 h = hashFinalize(a, b, seed, bufferSize);
+	ANKI_ASSERT(h != 0);
+	return h;
+}
+
+/// Computes a hash of a buffer and combines it with a previous hash.
+/// @param[in] buffer The buffer to hash.
+/// @param bufferSize The size of the buffer.
+/// @param prevHash The hash to append to.
+/// @return The new hash.
+ANKI_USE_RESULT inline U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash)
+{
+	return computeHash(buffer, bufferSize, prevHash);
+}
+
+/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby. It's slower than
+/// computeHash() but its output will never change so use it for hashes that are stored in files.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param seed A unique seed.
 /// @return The hash.
-ANKI_USE_RESULT U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123);
+ANKI_USE_RESULT U64 computeStableHash(const void* buffer, PtrSize bufferSize, U64 seed = 123);
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby. See
+/// computeStableHash().
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param prevHash The hash to append to.
 /// @return The new hash.
-ANKI_USE_RESULT U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash);
+ANKI_USE_RESULT U64 appendStableHash(const void* buffer, PtrSize bufferSize, U64 prevHash);
 /// @}
 
 } // end namespace anki
@@ -7,6 +7,7 @@
 
 #include <anki/util/Allocator.h>
 #include <anki/util/Functions.h>
+#include <anki/util/Hash.h>
 #include <anki/util/NonCopyable.h>
 #include <anki/util/SparseArray.h>
 
@@ -16,12 +17,14 @@ namespace anki
 /// @addtogroup util_containers
 /// @{
 
-/// Default hasher.
+/// Default hasher. It accepts anything with a computeHash() so it can hash the types that are compared with the key in
+/// heterogeneous lookups (eg a CString for String keys).
 template<typename TKey>
 class DefaultHasher
 {
 public:
-	U64 operator()(const TKey& a) const
+	template<typename TOtherKey>
+	U64 operator()(const TOtherKey& a) const
 	{
 		return a.computeHash();
 	}
@@ -0,0 +1,207 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/InternedString.h>
+#include <anki/util/ConcurrentHashMap.h>
+#include <anki/util/Logger.h>
+
+namespace anki
+{
+
+namespace
+{
+
+/// The key of the table. It points to the interned characters.
+class InternedStringKey
+{
+public:
+	const char* m_ptr;
+	U32 m_length;
+
+	Bool operator==(const InternedStringKey& b) const
+	{
+		return m_length == b.m_length && memcmp(m_ptr, b.m_ptr, m_length) == 0;
+	}
+
+	U64 computeHash() const
+	{
+		return anki::computeHash(m_ptr, m_length);
+	}
+};
+
+/// The global table of the interned strings.
+class InternedStringTable
+{
+public:
+	static constexpr U32 IDS_PER_BLOCK = 4 * 1024;
+	static constexpr U32 MAX_BLOCK_COUNT = 1024;
+	static constexpr U32 CHARS_PER_CHUNK = 64 * 1024;
+
+	InternedStringTable()
+	{
+		for(Atomic<const char**>& block : m_blocks)
+		{
+			block.setNonAtomically(nullptr);
+		}
+	}
+
+	~InternedStringTable()
+	{
+		m_ids.destroy(m_alloc);
+
+		for(Atomic<const char**>& block : m_blocks)
+		{
+			if(block.getNonAtomically())
+			{
+				m_alloc.deleteArray(block.getNonAtomically(), IDS_PER_BLOCK);
+			}
+		}
+
+		for(char* chars : m_charAllocations)
+		{
+			m_alloc.getMemoryPool().free(chars);
+		}
+		m_charAllocations.destroy(m_alloc);
+	}
+
+	U32 intern(CString str);
+
+	Bool tryFind(CString str, U32& id) const
+	{
+		const U32* out = m_ids.find(InternedStringKey{str.cstr(), str.getLength()});
+		if(out)
+		{
+			id = *out;
+		}
+
+		return out != nullptr;
+	}
+
+	const char* getString(U32 id) const
+	{
+		ANKI_ASSERT(id > 0 && id < MAX_BLOCK_COUNT * IDS_PER_BLOCK);
+		const char* const* block = m_blocks[id / IDS_PER_BLOCK].load(AtomicMemoryOrder::ACQUIRE);
+		ANKI_ASSERT(block && block[id % IDS_PER_BLOCK]);
+		return block[id % IDS_PER_BLOCK];
+	}
+
+private:
+	HeapAllocator<U8> m_alloc{allocAligned, nullptr};
+	ConcurrentHashMap<InternedStringKey, U32> m_ids;
+
+	/// Maps the IDs to the strings. The blocks never move so the readers don't need to lock.
+	Array<Atomic<const char**>, MAX_BLOCK_COUNT> m_blocks;
+
+	Mutex m_mtx; ///< Serializes the writers.
+	U32 m_idCount = 1; ///< Zero is the empty string.
+	char* m_chunk = nullptr;
+	U32 m_chunkPos = 0;
+	DynamicArray<char*> m_charAllocations;
+
+	char* allocateChars(U32 size);
+};
+
+U32 InternedStringTable::intern(CString str)
+{
+	if(str.isEmpty())
+	{
+		return 0;
+	}
+
+	const U32 length = str.getLength();
+
+	// Fast path
+	InternedStringKey key{str.cstr(), length};
+	const U32* id = m_ids.find(key);
+	if(ANKI_LIKELY(id != nullptr))
+	{
+		return *id;
+	}
+
+	LockGuard<Mutex> lock(m_mtx);
+
+	// Someone might have added it in the meantime
+	id = m_ids.find(key);
+	if(id)
+	{
+		return *id;
+	}
+
+	const U32 newId = m_idCount;
+	if(ANKI_UNLIKELY(newId == MAX_BLOCK_COUNT * IDS_PER_BLOCK))
+	{
+		ANKI_UTIL_LOGF("Too many interned strings");
+	}
+
+	char* chars = allocateChars(length + 1);
+	memcpy(chars, str.cstr(), length + 1);
+
+	// Store the string before the ID is visible to the other threads
+	const U32 blockIdx = newId / IDS_PER_BLOCK;
+	const char** block = m_blocks[blockIdx].load();
+	if(block == nullptr)
+	{
+		block = m_alloc.newArray<const char*>(IDS_PER_BLOCK, static_cast<const char*>(nullptr));
+		m_blocks[blockIdx].store(block, AtomicMemoryOrder::RELEASE);
+	}
+	block[newId % IDS_PER_BLOCK] = chars;
+	++m_idCount;
+
+	key.m_ptr = chars;
+	return m_ids.emplace(m_alloc, key, newId);
+}
+
+char* InternedStringTable::allocateChars(U32 size)
+{
+	// Big strings get their own allocation
+	if(size > CHARS_PER_CHUNK / 4)
+	{
+		char* chars = static_cast<char*>(m_alloc.getMemoryPool().allocate(size, 1));
+		m_charAllocations.emplaceBack(m_alloc, chars);
+		return chars;
+	}
+
+	if(m_chunk == nullptr || m_chunkPos + size > CHARS_PER_CHUNK)
+	{
+		m_chunk = static_cast<char*>(m_alloc.getMemoryPool().allocate(CHARS_PER_CHUNK, 1));
+		m_chunkPos = 0;
+		m_charAllocations.emplaceBack(m_alloc, m_chunk);
+	}
+
+	char* chars = m_chunk + m_chunkPos;
+	m_chunkPos += size;
+	return chars;
+}
+
+InternedStringTable& getInternedStringTable()
+{
+	static InternedStringTable table;
+	return table;
+}
+
+} // end anonymous namespace
+
+InternedString::InternedString(CString str)
+	: m_id(getInternedStringTable().intern(str))
+{
+}
+
+Bool InternedString::tryFind(CString str, InternedString& out)
+{
+	if(str.isEmpty())
+	{
+		out = InternedString();
+		return true;
+	}
+
+	return getInternedStringTable().tryFind(str, out.m_id);
+}
+
+CString InternedString::toCString() const
+{
+	return (m_id == 0) ? CString("") : CString(getInternedStringTable().getString(m_id));
+}
+
+} // end namespace anki
@@ -0,0 +1,80 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/String.h>
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// A string that is stored once in a global table and is represented by a 32bit ID. Comparing and hashing interned
+/// strings doesn't touch the characters. Interning a string that is already in the table doesn't lock and doesn't
+/// allocate.
+///
+/// The strings are never removed from the table so intern only names that come from a limited set (filenames, names
+/// of assets, tracer events). The characters of an interned string are valid until the program exits.
+class InternedString
+{
+public:
+	/// The empty string.
+	InternedString() = default;
+
+	/// Intern a string. It's thread-safe.
+	explicit InternedString(CString str);
+
+	/// Find a string that is already interned without interning it. It's thread-safe and lock-free.
+	/// @return False if the string hasn't been interned.
+	static Bool tryFind(CString str, InternedString& out);
+
+	U32 getId() const
+	{
+		return m_id;
+	}
+
+	Bool isEmpty() const
+	{
+		return m_id == 0;
+	}
+
+	/// Get the characters. It's thread-safe.
+	CString toCString() const;
+
+	const char* cstr() const
+	{
+		return toCString().cstr();
+	}
+
+	/// The IDs are unique so the ID is a perfect hash.
+	U64 computeHash() const
+	{
+		return m_id;
+	}
+
+	Bool operator==(const InternedString& b) const
+	{
+		return m_id == b.m_id;
+	}
+
+	Bool operator!=(const InternedString& b) const
+	{
+		return m_id != b.m_id;
+	}
+
+	/// Compares the IDs and not the characters. Use it to group the strings.
+	Bool operator<(const InternedString& b) const
+	{
+		return m_id < b.m_id;
+	}
+
+private:
+	U32 m_id = 0;
+};
+/// @}
+
+} // end namespace anki
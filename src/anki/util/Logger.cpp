@@ -6,6 +6,9 @@
 #include <anki/util/File.h>
 #include <anki/util/Logger.h>
 #include <anki/util/System.h>
+#include <anki/util/Memory.h>
+#include <anki/util/Hash.h>
+#include <anki/util/HighRezTimer.h>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -22,13 +25,91 @@ namespace anki
 
 static const Array<const char*, static_cast<U>(LoggerMessageType::COUNT)> MSG_TEXT = {{"I", "E", "W", "F"}};
 
+/// A queued message.
+class Logger::Message
+{
+public:
+	const char* m_file;
+	const char* m_func;
+	const char* m_subsystem;
+	ThreadId m_tid;
+	I32 m_line;
+	LoggerMessageType m_type;
+	Array<char, MAX_ASYNC_MESSAGE_LENGTH> m_msg;
+};
+
+/// A single producer single consumer ring buffer. The producer is the thread that owns the queue and the consumer is
+/// whoever holds Logger::m_mutex.
+class alignas(ANKI_CACHE_LINE_SIZE) Logger::ThreadQueue
+{
+public:
+	Atomic<U64> m_writeCount = {0};
+
+	/// The previous message of the producer. To find the repeated messages.
+	LoggerMessageInfo m_prevInfo = {};
+	U64 m_prevMsgHash = 0;
+	Second m_prevTime = 0.0;
+	U32 m_repeatCount = 0; ///< The repeated messages that were dropped.
+
+	/// It's in its own cache line because only the consumer writes it.
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U64> m_readCount = {0};
+
+	Array<Message, ASYNC_MESSAGES_PER_THREAD> m_messages;
+
+	static_assert(sizeof(Message) == 512, "Keep the messages in whole cache lines");
+};
+
+/// Gives a queue to a thread and takes it back when the thread exits.
+class Logger::ThreadSlot
+{
+public:
+	Logger* m_logger = nullptr;
+	U32 m_queueIdx = MAX_U32;
+
+	~ThreadSlot()
+	{
+		if(m_logger)
+		{
+			m_logger->releaseThreadQueue(m_queueIdx);
+		}
+	}
+};
+
+static_assert(Logger::MAX_ASYNC_THREADS == 64, "The queues are a 64bit mask");
+
+thread_local Logger::ThreadSlot Logger::m_threadSlot;
+
 Logger::Logger()
+	: m_asyncThread("anki_logger")
 {
+	for(Atomic<ThreadQueue*>& queue : m_queues)
+	{
+		queue.setNonAtomically(nullptr);
+	}
+
 	addMessageHandler(this, &defaultSystemMessageHandler);
 }
 
 Logger::~Logger()
 {
+	disableAsync();
+
+	// The other threads should have exited already
+	if(m_threadSlot.m_logger == this)
+	{
+		releaseThreadQueue(m_threadSlot.m_queueIdx);
+	}
+	flush();
+
+	for(Atomic<ThreadQueue*>& queue : m_queues)
+	{
+		ThreadQueue* q = queue.getNonAtomically();
+		if(q)
+		{
+			q->~ThreadQueue();
+			freeAligned(q);
+		}
+	}
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -68,16 +149,21 @@ void Logger::write(const char* file,
 	ThreadId tid,
 	const char* msg)
 {
-	m_mutex.lock();
-
 	LoggerMessageInfo inf = {file, line, func, type, msg, subsystem, tid};
 
-	U count = m_handlersCount;
-	while(count-- != 0)
+	if(isAsync() && type != LoggerMessageType::FATAL && writeAsync(inf))
 	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
+		return;
 	}
 
+	m_mutex.lock();
+
+	// Pass the queued messages first to keep the order of the messages of this thread. It also flushes everything
+	// before a FATAL
+	consumeQueues();
+
+	callHandlers(inf);
+
 	m_mutex.unlock();
 
 	if(type == LoggerMessageType::FATAL)
@@ -128,6 +214,266 @@ void Logger::writeFormated(const char* file,
 	}
 }
 
+void Logger::callHandlers(const LoggerMessageInfo& info)
+{
+	U count = m_handlersCount;
+	while(count-- != 0)
+	{
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
+	}
+}
+
+void Logger::enableAsync()
+{
+	if(isAsync())
+	{
+		return;
+	}
+
+	m_asyncThreadQuit = false;
+	m_asyncThread.start(this, asyncThreadMain);
+	m_async.store(1);
+}
+
+void Logger::disableAsync()
+{
+	if(!isAsync())
+	{
+		return;
+	}
+
+	m_async.store(0);
+
+	{
+		LockGuard<Mutex> lock(m_asyncThreadMtx);
+		m_asyncThreadQuit = true;
+		m_asyncThreadCondVar.notifyOne();
+	}
+
+	const Error err = m_asyncThread.join();
+	(void)err;
+
+	flush();
+}
+
+void Logger::flush()
+{
+	LockGuard<Mutex> lock(m_mutex);
+	consumeQueues();
+}
+
+Error Logger::asyncThreadMain(ThreadCallbackInfo& info)
+{
+	Logger& self = *static_cast<Logger*>(info.m_userData);
+
+	while(true)
+	{
+		{
+			LockGuard<Mutex> lock(self.m_asyncThreadMtx);
+			while(self.m_queuedMessageCount.load() == 0 && !self.m_asyncThreadQuit)
+			{
+				self.m_asyncThreadCondVar.wait(self.m_asyncThreadMtx);
+			}
+
+			if(self.m_asyncThreadQuit)
+			{
+				break;
+			}
+		}
+
+		self.flush();
+	}
+
+	return Error::NONE;
+}
+
+Bool Logger::writeAsync(const LoggerMessageInfo& info)
+{
+	const PtrSize msgLength = strlen(info.m_msg);
+	if(msgLength >= MAX_ASYNC_MESSAGE_LENGTH)
+	{
+		return false;
+	}
+
+	ThreadQueue* queue = getThreadQueue();
+	if(queue == nullptr)
+	{
+		return false;
+	}
+
+	// Drop the message if it's the same as the previous one and the previous one was written recently
+	const Second now = HighRezTimer::getCurrentTime();
+	const U64 msgHash = computeHash(info.m_msg, msgLength + 1);
+	const LoggerMessageInfo& prev = queue->m_prevInfo;
+	if(prev.m_file == info.m_file && prev.m_line == info.m_line && prev.m_type == info.m_type
+		&& queue->m_prevMsgHash == msgHash && now - queue->m_prevTime < ASYNC_REPEAT_INTERVAL)
+	{
+		++queue->m_repeatCount;
+		return true;
+	}
+
+	pushRepeatCount(*queue);
+	pushMessage(*queue, info, U32(msgLength));
+
+	queue->m_prevInfo = info;
+	queue->m_prevInfo.m_msg = nullptr;
+	queue->m_prevMsgHash = msgHash;
+	queue->m_prevTime = now;
+
+	return true;
+}
+
+Logger::ThreadQueue* Logger::getThreadQueue()
+{
+	ThreadSlot& slot = m_threadSlot;
+	if(ANKI_LIKELY(slot.m_logger == this))
+	{
+		// Might be null if the allocation failed
+		return m_queues[slot.m_queueIdx].load();
+	}
+
+	if(slot.m_logger != nullptr)
+	{
+		// The thread has a queue in another logger
+		return nullptr;
+	}
+
+	// Find a free queue
+	U64 used = m_usedQueueMask.load(AtomicMemoryOrder::ACQUIRE);
+	while(used != MAX_U64)
+	{
+		const U32 idx = U32(__builtin_ctzll(~used));
+		if(!m_usedQueueMask.compareExchange(
+			   used, used | (U64(1) << U64(idx)), AtomicMemoryOrder::ACQ_REL, AtomicMemoryOrder::ACQUIRE))
+		{
+			continue;
+		}
+
+		// Set the slot before allocating because the allocation might log
+		slot.m_logger = this;
+		slot.m_queueIdx = idx;
+
+		ThreadQueue* queue = m_queues[idx].load(AtomicMemoryOrder::ACQUIRE);
+		if(queue == nullptr)
+		{
+			void* mem = mallocAligned(sizeof(ThreadQueue), alignof(ThreadQueue));
+			if(mem == nullptr)
+			{
+				return nullptr;
+			}
+
+			queue = ::new(mem) ThreadQueue();
+			m_queues[idx].store(queue, AtomicMemoryOrder::RELEASE);
+		}
+		else
+		{
+			// The queue was used by a thread that exited
+			queue->m_prevInfo = {};
+			queue->m_repeatCount = 0;
+		}
+
+		return queue;
+	}
+
+	// No free queues
+	return nullptr;
+}
+
+void Logger::releaseThreadQueue(U32 queueIdx)
+{
+	ThreadQueue* queue = m_queues[queueIdx].load();
+	if(queue)
+	{
+		pushRepeatCount(*queue);
+	}
+
+	m_usedQueueMask.fetchAnd(~(U64(1) << U64(queueIdx)), AtomicMemoryOrder::RELEASE);
+	m_threadSlot.m_logger = nullptr;
+	m_threadSlot.m_queueIdx = MAX_U32;
+}
+
+void Logger::pushMessage(ThreadQueue& queue, const LoggerMessageInfo& info, U32 msgLength)
+{
+	ANKI_ASSERT(msgLength < MAX_ASYNC_MESSAGE_LENGTH);
+
+	// Only this thread writes the write count
+	const U64 writeCount = queue.m_writeCount.load();
+	if(writeCount - queue.m_readCount.load(AtomicMemoryOrder::ACQUIRE) == ASYNC_MESSAGES_PER_THREAD)
+	{
+		// Full, make some room
+		flush();
+	}
+
+	// Count it before it's visible so that the count can't go negative
+	const I32 prevQueuedCount = m_queuedMessageCount.fetchAdd(1);
+
+	Message& msg = queue.m_messages[writeCount % ASYNC_MESSAGES_PER_THREAD];
+	msg.m_file = info.m_file;
+	msg.m_func = info.m_func;
+	msg.m_subsystem = info.m_subsystem;
+	msg.m_tid = info.m_tid;
+	msg.m_line = info.m_line;
+	msg.m_type = info.m_type;
+	memcpy(&msg.m_msg[0], info.m_msg, msgLength + 1);
+
+	queue.m_writeCount.store(writeCount + 1, AtomicMemoryOrder::RELEASE);
+
+	// Wake the thread if it might be sleeping
+	if(prevQueuedCount == 0)
+	{
+		LockGuard<Mutex> lock(m_asyncThreadMtx);
+		m_asyncThreadCondVar.notifyOne();
+	}
+}
+
+void Logger::pushRepeatCount(ThreadQueue& queue)
+{
+	if(queue.m_repeatCount == 0)
+	{
+		return;
+	}
+
+	Array<char, 64> msg;
+	const I len = snprintf(&msg[0], msg.getSize(), "The previous message repeated %u more times", queue.m_repeatCount);
+	queue.m_repeatCount = 0;
+
+	LoggerMessageInfo info = queue.m_prevInfo;
+	info.m_msg = &msg[0];
+	pushMessage(queue, info, U32(len));
+}
+
+void Logger::consumeQueues()
+{
+	I32 consumedCount = 0;
+	for(Atomic<ThreadQueue*>& q : m_queues)
+	{
+		ThreadQueue* queue = q.load(AtomicMemoryOrder::ACQUIRE);
+		if(queue == nullptr)
+		{
+			continue;
+		}
+
+		// Only the consumer writes the read count
+		const U64 writeCount = queue->m_writeCount.load(AtomicMemoryOrder::ACQUIRE);
+		for(U64 readCount = queue->m_readCount.load(); readCount < writeCount; ++readCount)
+		{
+			const Message& msg = queue->m_messages[readCount % ASYNC_MESSAGES_PER_THREAD];
+			const LoggerMessageInfo info = {
+				msg.m_file, msg.m_line, msg.m_func, msg.m_type, &msg.m_msg[0], msg.m_subsystem, msg.m_tid};
+			callHandlers(info);
+
+			// Give the slot back to the producer
+			queue->m_readCount.store(readCount + 1, AtomicMemoryOrder::RELEASE);
+			++consumedCount;
+		}
+	}
+
+	if(consumedCount)
+	{
+		m_queuedMessageCount.fetchSub(consumedCount);
+	}
+}
+
 void Logger::defaultSystemMessageHandler(void*, const LoggerMessageInfo& info)
 {
 #if ANKI_OS_LINUX
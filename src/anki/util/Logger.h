@@ -51,9 +51,24 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 /// thread safe.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
+///
+/// By default the messages are passed to the handlers before write() returns. In async mode write() copies the message
+/// to a queue of the calling thread and a background thread passes it to the handlers later. Writing to the queue
+/// doesn't lock or allocate. The order of the messages is kept only for the messages of the same thread. If a thread
+/// sends the same message many times in a row only one per ASYNC_REPEAT_INTERVAL reaches the handlers, followed by a
+/// message with the number of the dropped ones. The FATAL messages flush all the queues before aborting.
 class Logger
 {
 public:
+	/// Max number of threads that have a queue at the same time. The rest write synchronously.
+	static constexpr U32 MAX_ASYNC_THREADS = 64;
+
+	/// The size of the queue of a thread. If the queue is full the thread flushes all the queues.
+	static constexpr U32 ASYNC_MESSAGES_PER_THREAD = 64;
+
+	/// The max length of a queued message including the null terminator. The longer ones are written synchronously.
+	static constexpr U32 MAX_ASYNC_MESSAGE_LENGTH = 472;
+
 	/// Initialize the logger and add the default message handler
 	Logger();
 
@@ -88,6 +103,21 @@ public:
 		const char* fmt,
 		...);
 
+	/// Start a thread that passes the messages to the handlers. It's not thread-safe with disableAsync.
+	void enableAsync();
+
+	/// Flush the queues and stop the thread of enableAsync. It's not thread-safe with enableAsync. The messages that
+	/// other threads write at the same time might stay in the queues until the next flush.
+	void disableAsync();
+
+	Bool isAsync() const
+	{
+		return m_async.load() != 0;
+	}
+
+	/// Pass all the queued messages to the handlers before returning.
+	void flush();
+
 private:
 	class Handler
 	{
@@ -106,10 +136,51 @@ private:
 		}
 	};
 
-	Mutex m_mutex; ///< For thread safety
+	class Message;
+	class ThreadQueue;
+	class ThreadSlot;
+
+	static constexpr Second ASYNC_REPEAT_INTERVAL = 1.0;
+
+	Mutex m_mutex; ///< For thread safety. Whoever holds it is the consumer of the queues.
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 
+	Atomic<U32> m_async = {0};
+	Array<Atomic<ThreadQueue*>, MAX_ASYNC_THREADS> m_queues; ///< They are created on demand and never deleted.
+	Atomic<U64> m_usedQueueMask = {0};
+
+	/// The messages that are queued but not consumed. It's incremented before a message is queued.
+	Atomic<I32> m_queuedMessageCount = {0};
+
+	Thread m_asyncThread;
+	Mutex m_asyncThreadMtx;
+	ConditionVariable m_asyncThreadCondVar;
+	Bool m_asyncThreadQuit = false;
+
+	static thread_local ThreadSlot m_threadSlot;
+
+	/// @return False if the message can't be queued.
+	Bool writeAsync(const LoggerMessageInfo& info);
+
+	ThreadQueue* getThreadQueue();
+
+	void releaseThreadQueue(U32 queueIdx);
+
+	/// Copy a message to the queue of the thread.
+	void pushMessage(ThreadQueue& queue, const LoggerMessageInfo& info, U32 msgLength);
+
+	/// Queue a message with the number of the dropped repeated messages.
+	void pushRepeatCount(ThreadQueue& queue);
+
+	/// Pass the queued messages to the handlers. Needs m_mutex.
+	void consumeQueues();
+
+	/// Needs m_mutex.
+	void callHandlers(const LoggerMessageInfo& info);
+
+	static Error asyncThreadMain(ThreadCallbackInfo& info);
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
 };
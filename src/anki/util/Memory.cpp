@@ -750,4 +750,868 @@ void ChainMemoryPool::destroyChunk(Chunk* ch)
 	m_allocCb(m_allocCbUserData, ch, 0, 0);
 }
 
+/// The header of a slab. It's placed in the beginning of the slab's memory.
+class SlabMemoryPool::Slab
+{
+public:
+	SlabMemoryPool::ThreadCache* m_owner; ///< nullptr for big allocations.
+	Slab* m_prev;
+	Slab* m_next;
+	void* m_localFreeList; ///< Only the owner touches it.
+	Atomic<void*> m_remoteFreeList; ///< Other threads push blocks here.
+	U32 m_blockSize;
+	U32 m_blockCount;
+	U32 m_usedCount; ///< Counts the blocks in m_remoteFreeList as well.
+	U32 m_bumpCount; ///< The blocks that were ever allocated.
+	U8 m_classIdx;
+	Bool m_inFullList;
+
+	U8* getBlocksBegin()
+	{
+		return reinterpret_cast<U8*>(this) + getAlignedRoundUp(ANKI_CACHE_LINE_SIZE, sizeof(Slab));
+	}
+
+	static Slab* fromPointer(void* ptr)
+	{
+		return numberToPtr<Slab*>(getAlignedRoundDown(SLAB_SIZE, ptrToNumber(ptr)));
+	}
+};
+
+class SlabMemoryPool::SlabMapLeaf
+{
+public:
+	Array<Atomic<U64>, (1u << SLAB_MAP_LEAF_BITS) / 64> m_bits;
+
+	SlabMapLeaf()
+	{
+		for(Atomic<U64>& bits : m_bits)
+		{
+			bits.setNonAtomically(0);
+		}
+	}
+};
+
+class SlabMemoryPool::SlabMapNode
+{
+public:
+	Array<Atomic<SlabMapLeaf*>, 1u << SLAB_MAP_NODE_BITS> m_leafs;
+
+	SlabMapNode()
+	{
+		for(Atomic<SlabMapLeaf*>& leaf : m_leafs)
+		{
+			leaf.setNonAtomically(nullptr);
+		}
+	}
+};
+
+static_assert(SlabMemoryPool::SLAB_SIZE == 1u << 16, "The slab map assumes that");
+
+/// Get the entry of the slab map or create it if it's not there.
+template<typename T>
+static T* getOrCreateSlabMapEntry(Atomic<T*>& entry, AllocAlignedCallback allocCb, void* allocCbUserData)
+{
+	T* crnt = entry.load(AtomicMemoryOrder::ACQUIRE);
+	if(crnt)
+	{
+		return crnt;
+	}
+
+	void* mem = allocCb(allocCbUserData, nullptr, sizeof(T), alignof(T));
+	if(ANKI_UNLIKELY(mem == nullptr))
+	{
+		return nullptr;
+	}
+
+	T* newEntry = ::new(mem) T();
+	while(!entry.compareExchange(crnt, newEntry, AtomicMemoryOrder::ACQ_REL, AtomicMemoryOrder::ACQUIRE))
+	{
+		if(crnt)
+		{
+			// Another thread created it first
+			newEntry->~T();
+			allocCb(allocCbUserData, newEntry, 0, 0);
+			return crnt;
+		}
+	}
+
+	return newEntry;
+}
+
+const Array<U16, SlabMemoryPool::CLASS_COUNT> SlabMemoryPool::CLASS_SIZES = {
+	{16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792,
+		2048}};
+
+/// The index of a thread in the per-thread data of SlabMemoryPool and FrameMemoryPool. A thread gets one the first time
+/// it uses any of these pools and gives it back when it exits.
+class ThreadSlot
+{
+public:
+	U32 m_idx = MAX_U32;
+	Bool m_initialized = false;
+
+	~ThreadSlot()
+	{
+		if(m_idx != MAX_U32)
+		{
+			m_usedSlots.fetchAnd(~(U64(1) << U64(m_idx)));
+			m_idx = MAX_U32;
+		}
+	}
+
+	U32 get()
+	{
+		if(ANKI_UNLIKELY(!m_initialized))
+		{
+			m_initialized = true;
+
+			U64 used = m_usedSlots.load();
+			while(used != MAX_U64)
+			{
+				const U32 idx = U32(__builtin_ctzll(~used));
+				if(m_usedSlots.compareExchange(used, used | (U64(1) << U64(idx))))
+				{
+					m_idx = idx;
+					break;
+				}
+			}
+		}
+
+		return m_idx;
+	}
+
+private:
+	static Atomic<U64> m_usedSlots;
+};
+
+static_assert(SlabMemoryPool::MAX_THREAD_CACHES == 64, "The slots are a 64bit mask");
+static_assert(FrameMemoryPool::MAX_THREAD_ARENAS == 64, "The slots are a 64bit mask");
+
+Atomic<U64> ThreadSlot::m_usedSlots = {0};
+static thread_local ThreadSlot g_threadSlot;
+
+template<typename T>
+static void listPushFront(T*& head, T* node)
+{
+	node->m_prev = nullptr;
+	node->m_next = head;
+	if(head)
+	{
+		head->m_prev = node;
+	}
+	head = node;
+}
+
+template<typename T>
+static void listRemove(T*& head, T* node)
+{
+	if(node->m_prev)
+	{
+		node->m_prev->m_next = node->m_next;
+	}
+	else
+	{
+		ANKI_ASSERT(head == node);
+		head = node->m_next;
+	}
+
+	if(node->m_next)
+	{
+		node->m_next->m_prev = node->m_prev;
+	}
+}
+
+SlabMemoryPool::SlabMemoryPool()
+	: BaseMemoryPool(Type::SLAB)
+{
+}
+
+SlabMemoryPool::~SlabMemoryPool()
+{
+	if(!isCreated())
+	{
+		return;
+	}
+
+	const U32 count = getAllocationsCountInternal();
+	if(count != 0)
+	{
+		ANKI_UTIL_LOGW("Memory pool destroyed before all memory being released (%u deallocations missed)", count);
+	}
+
+	for(ThreadCache& cache : m_threadCaches)
+	{
+		destroyCache(cache);
+	}
+	destroyCache(m_sharedCache);
+
+	for(Atomic<SlabMapNode*>& nodeEntry : m_slabMap)
+	{
+		SlabMapNode* node = nodeEntry.getNonAtomically();
+		if(node == nullptr)
+		{
+			continue;
+		}
+
+		for(Atomic<SlabMapLeaf*>& leafEntry : node->m_leafs)
+		{
+			SlabMapLeaf* leaf = leafEntry.getNonAtomically();
+			if(leaf)
+			{
+				leaf->~SlabMapLeaf();
+				m_allocCb(m_allocCbUserData, leaf, 0, 0);
+			}
+		}
+
+		node->~SlabMapNode();
+		m_allocCb(m_allocCbUserData, node, 0, 0);
+	}
+}
+
+void SlabMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData)
+{
+	ANKI_ASSERT(!isCreated());
+	ANKI_ASSERT(allocCb != nullptr);
+
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+
+	for(ThreadCache& cache : m_threadCaches)
+	{
+		for(Atomic<U32>& count : cache.m_remoteFreeCounts)
+		{
+			count.setNonAtomically(0);
+		}
+	}
+
+	for(Atomic<U32>& count : m_sharedCache.m_remoteFreeCounts)
+	{
+		count.setNonAtomically(0);
+	}
+
+	for(Atomic<SlabMapNode*>& node : m_slabMap)
+	{
+		node.setNonAtomically(nullptr);
+	}
+
+	U32 classIdx = 0;
+	for(U32 i = 0; i < m_sizeToClass.getSize(); ++i)
+	{
+		const U32 size = (i + 1) * 16;
+		while(CLASS_SIZES[classIdx] < size)
+		{
+			++classIdx;
+		}
+
+		m_sizeToClass[i] = U8(classIdx);
+	}
+}
+
+void SlabMemoryPool::destroyCache(ThreadCache& cache)
+{
+	for(U32 c = 0; c < CLASS_COUNT; ++c)
+	{
+		for(Slab* head : {cache.m_partialSlabs[c], cache.m_fullSlabs[c]})
+		{
+			while(head)
+			{
+				Slab* next = head->m_next;
+				invalidateMemory(head, SLAB_SIZE);
+				m_allocCb(m_allocCbUserData, head, 0, 0);
+				head = next;
+			}
+		}
+	}
+}
+
+SlabMemoryPool::ThreadCache* SlabMemoryPool::getThreadCache(SlabMemoryPool& pool)
+{
+	const U32 idx = g_threadSlot.get();
+	return (idx != MAX_U32) ? &pool.m_threadCaches[idx] : nullptr;
+}
+
+void* SlabMemoryPool::allocate(PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(isCreated());
+	ANKI_ASSERT(size > 0 && alignment > 0);
+
+	if(size > MAX_SLAB_ALLOCATION_SIZE || alignment > ANKI_CACHE_LINE_SIZE)
+	{
+		return allocateBig(size, alignment);
+	}
+
+	U32 classIdx = m_sizeToClass[(size - 1) / 16];
+	while(CLASS_SIZES[classIdx] % alignment != 0)
+	{
+		// The blocks of a slab are aligned to their size so find a size that satisfies the alignment
+		++classIdx;
+		if(classIdx == CLASS_COUNT)
+		{
+			return allocateBig(size, alignment);
+		}
+	}
+
+	ThreadCache* cache = getThreadCache(*this);
+	void* out;
+	if(ANKI_LIKELY(cache != nullptr))
+	{
+		out = allocateFromCache(*cache, classIdx);
+	}
+	else
+	{
+		LockGuard<SpinLock> lock(m_sharedCacheLock);
+		out = allocateFromCache(m_sharedCache, classIdx);
+	}
+
+	return out;
+}
+
+void* SlabMemoryPool::allocateFromCache(ThreadCache& cache, U32 classIdx)
+{
+	Slab* slab = cache.m_partialSlabs[classIdx];
+	while(true)
+	{
+		if(slab == nullptr)
+		{
+			slab = refillCache(cache, classIdx);
+			if(ANKI_UNLIKELY(slab == nullptr))
+			{
+				ANKI_OOM_ACTION();
+				return nullptr;
+			}
+		}
+
+		void* out = nullptr;
+		if(slab->m_localFreeList)
+		{
+			out = slab->m_localFreeList;
+			slab->m_localFreeList = *static_cast<void**>(out);
+		}
+		else if(slab->m_bumpCount < slab->m_blockCount)
+		{
+			out = slab->getBlocksBegin() + slab->m_bumpCount * slab->m_blockSize;
+			++slab->m_bumpCount;
+		}
+		else if(slab->m_remoteFreeList.load())
+		{
+			// Take the blocks that other threads freed
+			void* list = slab->m_remoteFreeList.exchange(nullptr, AtomicMemoryOrder::ACQUIRE);
+			out = list;
+			list = *static_cast<void**>(list);
+			U32 count = 1;
+			while(list)
+			{
+				void* next = *static_cast<void**>(list);
+				*static_cast<void**>(list) = slab->m_localFreeList;
+				slab->m_localFreeList = list;
+				list = next;
+				++count;
+			}
+
+			ANKI_ASSERT(slab->m_usedCount >= count);
+			slab->m_usedCount -= count;
+		}
+
+		if(out)
+		{
+			++slab->m_usedCount;
+			cache.m_allocationsCount.fetchAdd(1);
+			return out;
+		}
+
+		// The slab is full, move it out of the way
+		listRemove(cache.m_partialSlabs[classIdx], slab);
+		listPushFront(cache.m_fullSlabs[classIdx], slab);
+		slab->m_inFullList = true;
+		slab = cache.m_partialSlabs[classIdx];
+	}
+}
+
+SlabMemoryPool::Slab* SlabMemoryPool::refillCache(ThreadCache& cache, U32 classIdx)
+{
+	// First check if other threads freed blocks of the full slabs
+	if(cache.m_remoteFreeCounts[classIdx].load() > 0)
+	{
+		cache.m_remoteFreeCounts[classIdx].exchange(0);
+
+		Slab* slab = cache.m_fullSlabs[classIdx];
+		while(slab)
+		{
+			Slab* next = slab->m_next;
+			if(slab->m_remoteFreeList.load())
+			{
+				listRemove(cache.m_fullSlabs[classIdx], slab);
+				listPushFront(cache.m_partialSlabs[classIdx], slab);
+				slab->m_inFullList = false;
+			}
+
+			slab = next;
+		}
+
+		if(cache.m_partialSlabs[classIdx])
+		{
+			return cache.m_partialSlabs[classIdx];
+		}
+	}
+
+	// Create a new slab
+	void* mem = m_allocCb(m_allocCbUserData, nullptr, SLAB_SIZE, SLAB_SIZE);
+	if(ANKI_UNLIKELY(mem == nullptr))
+	{
+		return nullptr;
+	}
+
+	if(ANKI_UNLIKELY(!setSlabMapBit(mem, true)))
+	{
+		m_allocCb(m_allocCbUserData, mem, 0, 0);
+		return nullptr;
+	}
+
+	invalidateMemory(mem, SLAB_SIZE);
+
+	Slab* slab = ::new(mem) Slab();
+	slab->m_owner = &cache;
+	slab->m_localFreeList = nullptr;
+	slab->m_remoteFreeList.setNonAtomically(nullptr);
+	slab->m_blockSize = CLASS_SIZES[classIdx];
+	slab->m_blockCount = U32((static_cast<U8*>(mem) + SLAB_SIZE - slab->getBlocksBegin()) / slab->m_blockSize);
+	slab->m_usedCount = 0;
+	slab->m_bumpCount = 0;
+	slab->m_classIdx = U8(classIdx);
+	slab->m_inFullList = false;
+
+	listPushFront(cache.m_partialSlabs[classIdx], slab);
+	return slab;
+}
+
+void* SlabMemoryPool::allocateBig(PtrSize size, PtrSize alignment)
+{
+	// Store the pointer that the callback returned right before the memory so free() can find it
+	alignment = max<PtrSize>(alignment, ANKI_SAFE_ALIGNMENT);
+	const PtrSize headerSize = getAlignedRoundUp(alignment, sizeof(void*));
+	void* mem = m_allocCb(m_allocCbUserData, nullptr, headerSize + size, alignment);
+	if(ANKI_UNLIKELY(mem == nullptr))
+	{
+		ANKI_OOM_ACTION();
+		return nullptr;
+	}
+
+	U8* out = static_cast<U8*>(mem) + headerSize;
+	reinterpret_cast<void**>(out)[-1] = mem;
+	ANKI_ASSERT(!isInSlab(out));
+
+	m_sharedCache.m_allocationsCount.fetchAdd(1);
+	return out;
+}
+
+Bool SlabMemoryPool::setSlabMapBit(const void* slab, Bool inSlab)
+{
+	ANKI_ASSERT(isAligned(SLAB_SIZE, slab));
+	const PtrSize slabIdx = ptrToNumber(slab) / SLAB_SIZE;
+	ANKI_ASSERT((slabIdx >> (SLAB_MAP_ROOT_BITS + SLAB_MAP_NODE_BITS + SLAB_MAP_LEAF_BITS)) == 0);
+
+	const PtrSize rootIdx = slabIdx >> (SLAB_MAP_NODE_BITS + SLAB_MAP_LEAF_BITS);
+	const PtrSize nodeIdx = (slabIdx >> SLAB_MAP_LEAF_BITS) & ((1u << SLAB_MAP_NODE_BITS) - 1);
+	const PtrSize bitIdx = slabIdx & ((1u << SLAB_MAP_LEAF_BITS) - 1);
+
+	SlabMapNode* node = getOrCreateSlabMapEntry(m_slabMap[rootIdx], m_allocCb, m_allocCbUserData);
+	if(ANKI_UNLIKELY(node == nullptr))
+	{
+		return false;
+	}
+
+	SlabMapLeaf* leaf = getOrCreateSlabMapEntry(node->m_leafs[nodeIdx], m_allocCb, m_allocCbUserData);
+	if(ANKI_UNLIKELY(leaf == nullptr))
+	{
+		return false;
+	}
+
+	const U64 mask = U64(1) << U64(bitIdx % 64);
+	if(inSlab)
+	{
+		leaf->m_bits[bitIdx / 64].fetchOr(mask);
+	}
+	else
+	{
+		leaf->m_bits[bitIdx / 64].fetchAnd(~mask);
+	}
+
+	return true;
+}
+
+Bool SlabMemoryPool::isInSlab(const void* ptr) const
+{
+	const PtrSize slabIdx = ptrToNumber(ptr) / SLAB_SIZE;
+	const PtrSize rootIdx = slabIdx >> (SLAB_MAP_NODE_BITS + SLAB_MAP_LEAF_BITS);
+	const PtrSize nodeIdx = (slabIdx >> SLAB_MAP_LEAF_BITS) & ((1u << SLAB_MAP_NODE_BITS) - 1);
+	const PtrSize bitIdx = slabIdx & ((1u << SLAB_MAP_LEAF_BITS) - 1);
+
+	const SlabMapNode* node = m_slabMap[rootIdx].load(AtomicMemoryOrder::ACQUIRE);
+	if(node == nullptr)
+	{
+		return false;
+	}
+
+	const SlabMapLeaf* leaf = node->m_leafs[nodeIdx].load(AtomicMemoryOrder::ACQUIRE);
+	if(leaf == nullptr)
+	{
+		return false;
+	}
+
+	return (leaf->m_bits[bitIdx / 64].load(AtomicMemoryOrder::RELAXED) >> (bitIdx % 64)) & 1;
+}
+
+void SlabMemoryPool::free(void* ptr)
+{
+	ANKI_ASSERT(isCreated());
+
+	if(ANKI_UNLIKELY(ptr == nullptr))
+	{
+		return;
+	}
+
+	if(!isInSlab(ptr))
+	{
+		// Big allocation
+		void* mem = static_cast<void**>(ptr)[-1];
+		m_sharedCache.m_allocationsCount.fetchSub(1);
+		m_allocCb(m_allocCbUserData, mem, 0, 0);
+		return;
+	}
+
+	Slab* slab = Slab::fromPointer(ptr);
+	ThreadCache* owner = slab->m_owner;
+	ANKI_ASSERT(owner);
+
+	ANKI_ASSERT(ptrToNumber(ptr) >= ptrToNumber(slab->getBlocksBegin()));
+	ANKI_ASSERT((ptrToNumber(ptr) - ptrToNumber(slab->getBlocksBegin())) % slab->m_blockSize == 0);
+	invalidateMemory(ptr, slab->m_blockSize);
+
+	ThreadCache* cache = getThreadCache(*this);
+	if(owner == cache)
+	{
+		freeToCache(*cache, *slab, ptr);
+	}
+	else if(owner == &m_sharedCache && cache == nullptr)
+	{
+		LockGuard<SpinLock> lock(m_sharedCacheLock);
+		freeToCache(m_sharedCache, *slab, ptr);
+	}
+	else
+	{
+		// Another thread owns the slab. Read what's needed before the push, the slab might get released right after
+		const U32 classIdx = slab->m_classIdx;
+
+		void* head = slab->m_remoteFreeList.load();
+		do
+		{
+			*static_cast<void**>(ptr) = head;
+		} while(!slab->m_remoteFreeList.compareExchange(
+			head, ptr, AtomicMemoryOrder::RELEASE, AtomicMemoryOrder::RELAXED));
+
+		owner->m_remoteFreeCounts[classIdx].fetchAdd(1);
+
+		ThreadCache& myCache = (cache) ? *cache : m_sharedCache;
+		myCache.m_allocationsCount.fetchSub(1);
+	}
+}
+
+void SlabMemoryPool::freeToCache(ThreadCache& cache, Slab& slab, void* ptr)
+{
+	*static_cast<void**>(ptr) = slab.m_localFreeList;
+	slab.m_localFreeList = ptr;
+	ANKI_ASSERT(slab.m_usedCount > 0);
+	--slab.m_usedCount;
+	cache.m_allocationsCount.fetchSub(1);
+
+	const U32 classIdx = slab.m_classIdx;
+	if(slab.m_inFullList)
+	{
+		listRemove(cache.m_fullSlabs[classIdx], &slab);
+		listPushFront(cache.m_partialSlabs[classIdx], &slab);
+		slab.m_inFullList = false;
+	}
+
+	// Release the slab if it's empty and it's not the only one
+	if(slab.m_usedCount == 0 && (slab.m_prev || slab.m_next))
+	{
+		listRemove(cache.m_partialSlabs[classIdx], &slab);
+		const Bool ok = setSlabMapBit(&slab, false);
+		ANKI_ASSERT(ok && "The map entries of the slab are already there");
+		(void)ok;
+		invalidateMemory(&slab, SLAB_SIZE);
+		m_allocCb(m_allocCbUserData, &slab, 0, 0);
+	}
+}
+
+U32 SlabMemoryPool::getAllocationsCountInternal() const
+{
+	I32 count = m_sharedCache.m_allocationsCount.load();
+	for(const ThreadCache& cache : m_threadCaches)
+	{
+		count += cache.m_allocationsCount.load();
+	}
+
+	ANKI_ASSERT(count >= 0);
+	return U32(count);
+}
+
+/// The header of the FrameMemoryPool chunks. The memory of the chunk follows.
+class FrameMemoryPool::Chunk
+{
+public:
+	Chunk* m_next;
+	PtrSize m_size; ///< The size of the memory that follows.
+};
+
+FrameMemoryPool::FrameMemoryPool()
+	: BaseMemoryPool(Type::FRAME)
+{
+}
+
+FrameMemoryPool::~FrameMemoryPool()
+{
+	for(Arena& arena : m_arenas)
+	{
+		destroyArena(arena);
+	}
+
+	destroyArena(m_sharedArena);
+}
+
+void FrameMemoryPool::create(
+	AllocAlignedCallback allocCb, void* allocCbUserData, PtrSize arenaSize, PtrSize alignmentBytes)
+{
+	ANKI_ASSERT(!isCreated());
+	ANKI_ASSERT(allocCb);
+	ANKI_ASSERT(arenaSize > 0);
+	ANKI_ASSERT(alignmentBytes > 0);
+
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+	m_arenaSize = arenaSize;
+	m_alignmentBytes = alignmentBytes;
+}
+
+void* FrameMemoryPool::allocate(PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(isCreated());
+	ANKI_ASSERT(size > 0 && alignment > 0);
+
+	alignment = max(alignment, m_alignmentBytes);
+	size = getAlignedRoundUp(m_alignmentBytes, size);
+
+	const U32 idx = g_threadSlot.get();
+	void* out;
+	if(ANKI_LIKELY(idx != MAX_U32))
+	{
+		out = allocateFromArena(m_arenas[idx], size, alignment);
+	}
+	else
+	{
+		LockGuard<SpinLock> lock(m_sharedArenaLock);
+		out = allocateFromArena(m_sharedArena, size, alignment);
+	}
+
+	if(ANKI_UNLIKELY(out == nullptr))
+	{
+		ANKI_OOM_ACTION();
+	}
+
+	return out;
+}
+
+void FrameMemoryPool::free(void* ptr)
+{
+	ANKI_ASSERT(isCreated());
+	(void)ptr;
+}
+
+void FrameMemoryPool::reset()
+{
+	ANKI_ASSERT(isCreated());
+	++m_frame;
+}
+
+void* FrameMemoryPool::allocateFromArena(Arena& arena, PtrSize size, PtrSize alignment)
+{
+	if(arena.m_frame != m_frame)
+	{
+		resetArena(arena);
+	}
+
+	U8* out = nullptr;
+	if(arena.m_crntChunk)
+	{
+		const U8* end = reinterpret_cast<const U8*>(arena.m_crntChunk + 1) + arena.m_crntChunk->m_size;
+		out = numberToPtr<U8*>(getAlignedRoundUp(alignment, ptrToNumber(arena.m_top)));
+		out = (out + size <= end) ? out : nullptr;
+	}
+
+	if(ANKI_UNLIKELY(out == nullptr))
+	{
+		if(!nextChunk(arena, size, alignment))
+		{
+			return nullptr;
+		}
+
+		out = numberToPtr<U8*>(getAlignedRoundUp(alignment, ptrToNumber(arena.m_top)));
+	}
+
+	arena.m_top = out + size;
+	++arena.m_allocationsCount;
+	return out;
+}
+
+Bool FrameMemoryPool::nextChunk(Arena& arena, PtrSize size, PtrSize alignment)
+{
+	if(arena.m_crntChunk)
+	{
+		arena.m_usedBeforeCrntChunk += PtrSize(arena.m_top - reinterpret_cast<U8*>(arena.m_crntChunk + 1));
+	}
+
+	// Try to use the chunks that are left from the previous frames
+	const PtrSize minChunkSize = size + alignment;
+	Chunk* prev = arena.m_crntChunk;
+	Chunk* chunk = (prev) ? prev->m_next : arena.m_firstChunk;
+	while(chunk && chunk->m_size < minChunkSize)
+	{
+		prev = chunk;
+		chunk = chunk->m_next;
+	}
+
+	if(chunk == nullptr)
+	{
+		// Create a new one
+		const PtrSize chunkSize = getAlignedRoundUp(ANKI_CACHE_LINE_SIZE, max(m_arenaSize, minChunkSize));
+		void* mem = m_allocCb(m_allocCbUserData, nullptr, sizeof(Chunk) + chunkSize, ANKI_CACHE_LINE_SIZE);
+		if(ANKI_UNLIKELY(mem == nullptr))
+		{
+			return false;
+		}
+
+		invalidateMemory(mem, sizeof(Chunk) + chunkSize);
+		chunk = static_cast<Chunk*>(mem);
+		chunk->m_next = nullptr;
+		chunk->m_size = chunkSize;
+
+		if(prev)
+		{
+			prev->m_next = chunk;
+		}
+		else
+		{
+			arena.m_firstChunk = chunk;
+		}
+	}
+
+	arena.m_crntChunk = chunk;
+	arena.m_top = reinterpret_cast<U8*>(chunk + 1);
+	return true;
+}
+
+void FrameMemoryPool::resetArena(Arena& arena)
+{
+	const PtrSize used = getUsedMemory(arena);
+	arena.m_highWaterMark = max(arena.m_highWaterMark, used);
+
+	// If the arena needed more than one chunk replace them with a single chunk that is big enough for the worst frame
+	if(arena.m_firstChunk && arena.m_firstChunk->m_next)
+	{
+		destroyArena(arena);
+
+		const PtrSize chunkSize = getAlignedRoundUp(ANKI_CACHE_LINE_SIZE, max(m_arenaSize, arena.m_highWaterMark));
+		void* mem = m_allocCb(m_allocCbUserData, nullptr, sizeof(Chunk) + chunkSize, ANKI_CACHE_LINE_SIZE);
+		if(mem)
+		{
+			arena.m_firstChunk = static_cast<Chunk*>(mem);
+			arena.m_firstChunk->m_next = nullptr;
+			arena.m_firstChunk->m_size = chunkSize;
+		}
+	}
+
+	arena.m_crntChunk = arena.m_firstChunk;
+	arena.m_top = (arena.m_crntChunk) ? reinterpret_cast<U8*>(arena.m_crntChunk + 1) : nullptr;
+	arena.m_usedBeforeCrntChunk = 0;
+	arena.m_allocationsCount = 0;
+	arena.m_frame = m_frame;
+
+	if(arena.m_crntChunk)
+	{
+		invalidateMemory(arena.m_top, arena.m_crntChunk->m_size);
+	}
+}
+
+PtrSize FrameMemoryPool::getUsedMemory(const Arena& arena) const
+{
+	PtrSize used = arena.m_usedBeforeCrntChunk;
+	if(arena.m_crntChunk)
+	{
+		used += PtrSize(arena.m_top - reinterpret_cast<const U8*>(arena.m_crntChunk + 1));
+	}
+
+	return used;
+}
+
+void FrameMemoryPool::destroyArena(Arena& arena)
+{
+	Chunk* chunk = arena.m_firstChunk;
+	while(chunk)
+	{
+		Chunk* next = chunk->m_next;
+		invalidateMemory(chunk, sizeof(Chunk) + chunk->m_size);
+		m_allocCb(m_allocCbUserData, chunk, 0, 0);
+		chunk = next;
+	}
+
+	arena.m_firstChunk = nullptr;
+	arena.m_crntChunk = nullptr;
+	arena.m_top = nullptr;
+	arena.m_usedBeforeCrntChunk = 0;
+}
+
+U32 FrameMemoryPool::getAllocationsCountInternal() const
+{
+	U32 count = (m_sharedArena.m_frame == m_frame) ? m_sharedArena.m_allocationsCount : 0;
+	for(const Arena& arena : m_arenas)
+	{
+		count += (arena.m_frame == m_frame) ? arena.m_allocationsCount : 0;
+	}
+
+	return count;
+}
+
+PtrSize FrameMemoryPool::getHighWaterMark(U32 arenaIdx) const
+{
+	const Arena& arena = getArena(arenaIdx);
+	PtrSize mark = arena.m_highWaterMark;
+	if(arena.m_frame == m_frame)
+	{
+		mark = max(mark, getUsedMemory(arena));
+	}
+
+	return mark;
+}
+
+void FrameMemoryPool::logHighWaterMarks(const char* poolName) const
+{
+	for(U32 i = 0; i <= MAX_THREAD_ARENAS; ++i)
+	{
+		const PtrSize mark = getHighWaterMark(i);
+		if(mark == 0)
+		{
+			continue;
+		}
+
+		if(i < MAX_THREAD_ARENAS)
+		{
+			ANKI_UTIL_LOGI("%s: Arena %u high water mark %uKB", poolName, i, U32(mark / 1024));
+		}
+		else
+		{
+			ANKI_UTIL_LOGI("%s: Shared arena high water mark %uKB", poolName, U32(mark / 1024));
+		}
+	}
+}
+
 } // end namespace anki
@@ -49,7 +49,7 @@ using AllocationSignature = U32;
 ///         returns nullptr
 void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 
-/// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool or ChainMemoryPool.
+/// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool or ChainMemoryPool or SlabMemoryPool.
 class BaseMemoryPool : public NonCopyable
 {
 public:
@@ -90,10 +90,7 @@ public:
 	}
 
 	/// Return number of allocations
-	U32 getAllocationsCount() const
-	{
-		return m_allocationsCount.load();
-	}
+	U32 getAllocationsCount() const;
 
 protected:
 	/// Pool type.
@@ -102,7 +99,9 @@ protected:
 		NONE,
 		HEAP,
 		STACK,
-		CHAIN
+		CHAIN,
+		SLAB,
+		FRAME
 	};
 
 	/// User allocation function.
@@ -371,6 +370,194 @@ private:
 	void destroyChunk(Chunk* ch);
 };
 
+/// A thread caching memory pool for small objects. Allocations are grouped by size in slabs. Every thread allocates
+/// from its own slabs without locking and frees to other threads' slabs are lock-free. Big allocations go directly to
+/// the allocation callback with the alignment the caller asked for.
+class SlabMemoryPool : public BaseMemoryPool
+{
+public:
+	/// The max size of an allocation that will be served by a slab.
+	static constexpr PtrSize MAX_SLAB_ALLOCATION_SIZE = 2048;
+
+	/// The size and the alignment of the slabs.
+	static constexpr PtrSize SLAB_SIZE = 64 * 1024;
+
+	/// The max number of threads that have their own cache. The rest share one.
+	static constexpr U32 MAX_THREAD_CACHES = 64;
+
+	SlabMemoryPool();
+
+	~SlabMemoryPool() final;
+
+	/// The real constructor.
+	/// @param allocCb The allocation function callback
+	/// @param allocCbUserData The user data to pass to the allocation function
+	void create(AllocAlignedCallback allocCb, void* allocCbUserData);
+
+	/// Allocate memory. This operation is thread safe
+	void* allocate(PtrSize size, PtrSize alignment);
+
+	/// Free memory. This operation is thread safe and the memory can be freed by any thread.
+	/// @param[in, out] ptr Memory block to deallocate.
+	void free(void* ptr);
+
+	/// Sum the allocations of all threads.
+	U32 getAllocationsCountInternal() const;
+
+private:
+	class Slab;
+
+	/// The slab size classes.
+	static constexpr U32 CLASS_COUNT = 24;
+	static const Array<U16, CLASS_COUNT> CLASS_SIZES;
+
+	/// The slabs of a thread.
+	class alignas(ANKI_CACHE_LINE_SIZE) ThreadCache
+	{
+	public:
+		Array<Slab*, CLASS_COUNT> m_partialSlabs = {}; ///< Slabs with free blocks. Only the owner touches them.
+		Array<Slab*, CLASS_COUNT> m_fullSlabs = {}; ///< Only the owner touches them.
+
+		/// Other threads freed blocks of the full slabs. Written by other threads.
+		Array<Atomic<U32>, CLASS_COUNT> m_remoteFreeCounts;
+
+		/// Allocations minus frees that this thread did.
+		Atomic<I32> m_allocationsCount = {0};
+	};
+
+	Array<ThreadCache, MAX_THREAD_CACHES> m_threadCaches;
+
+	/// The cache of the threads that don't have their own.
+	ThreadCache m_sharedCache;
+	SpinLock m_sharedCacheLock;
+
+	/// Map (size - 1) / 16 to the size class.
+	Array<U8, MAX_SLAB_ALLOCATION_SIZE / 16> m_sizeToClass;
+
+	/// @name Slab map
+	/// Marks the memory of the slabs so free() can tell a slab block apart from a big allocation. It's a radix tree of
+	/// bits indexed by the address bits [16, 48), one bit per slab.
+	/// @{
+	static constexpr U32 SLAB_MAP_ROOT_BITS = 12;
+	static constexpr U32 SLAB_MAP_NODE_BITS = 10;
+	static constexpr U32 SLAB_MAP_LEAF_BITS = 10;
+
+	class SlabMapNode;
+	class SlabMapLeaf;
+
+	Array<Atomic<SlabMapNode*>, 1u << SLAB_MAP_ROOT_BITS> m_slabMap;
+	/// @}
+
+	static ThreadCache* getThreadCache(SlabMemoryPool& pool);
+
+	void* allocateFromCache(ThreadCache& cache, U32 classIdx);
+	void freeToCache(ThreadCache& cache, Slab& slab, void* ptr);
+	Slab* refillCache(ThreadCache& cache, U32 classIdx);
+	void* allocateBig(PtrSize size, PtrSize alignment);
+	void destroyCache(ThreadCache& cache);
+
+	/// Mark or unmark the memory of a slab in the slab map.
+	ANKI_USE_RESULT Bool setSlabMapBit(const void* slab, Bool inSlab);
+	Bool isInSlab(const void* ptr) const;
+};
+
+/// A memory pool for allocations that live until the end of a frame. Every thread bump allocates from its own arena
+/// so allocations don't touch memory that other threads write. Freeing does nothing, reset() releases everything.
+class FrameMemoryPool : public BaseMemoryPool
+{
+public:
+	/// The max number of threads that have their own arena. The rest share one.
+	static constexpr U32 MAX_THREAD_ARENAS = 64;
+
+	FrameMemoryPool();
+
+	~FrameMemoryPool() final;
+
+	/// The real constructor.
+	/// @param allocCb The allocation function callback
+	/// @param allocCbUserData The user data to pass to the allocation function
+	/// @param arenaSize The initial size of the arena of every thread. The arenas grow if needed and after a reset they
+	///                  are resized to the max memory they used in a frame.
+	/// @param alignmentBytes The minimum alignment of the returned memory.
+	void create(AllocAlignedCallback allocCb,
+		void* allocCbUserData,
+		PtrSize arenaSize,
+		PtrSize alignmentBytes = ANKI_SAFE_ALIGNMENT);
+
+	/// Allocate memory from the arena of the calling thread. This operation is thread safe.
+	void* allocate(PtrSize size, PtrSize alignment);
+
+	/// It does nothing. The memory will be released on reset().
+	void free(void* ptr);
+
+	/// Release all the allocations of all threads. It's O(1), the arenas reset themselves the next time they are used.
+	/// It's not thread safe.
+	void reset();
+
+	/// The allocations that happened since the last reset. It's not thread safe.
+	U32 getAllocationsCountInternal() const;
+
+	/// Get the max memory an arena used in a single frame. It's not thread safe.
+	/// @param arenaIdx The index of the arena. MAX_THREAD_ARENAS is the arena of the threads that don't have their own.
+	PtrSize getHighWaterMark(U32 arenaIdx) const;
+
+	/// Log the high water mark of all the arenas that have been used. It's not thread safe.
+	void logHighWaterMarks(const char* poolName) const;
+
+private:
+	class Chunk;
+
+	class alignas(ANKI_CACHE_LINE_SIZE) Arena
+	{
+	public:
+		Chunk* m_firstChunk = nullptr;
+		Chunk* m_crntChunk = nullptr;
+		U8* m_top = nullptr; ///< The next allocation of the m_crntChunk.
+		PtrSize m_usedBeforeCrntChunk = 0; ///< The memory used by the chunks before the m_crntChunk.
+		PtrSize m_highWaterMark = 0;
+		U32 m_frame = 0; ///< The frame the arena was last reset.
+		U32 m_allocationsCount = 0; ///< Allocations of m_frame.
+	};
+
+	Array<Arena, MAX_THREAD_ARENAS> m_arenas;
+
+	/// The arena of the threads that don't have their own.
+	Arena m_sharedArena;
+	SpinLock m_sharedArenaLock;
+
+	PtrSize m_arenaSize = 0;
+	PtrSize m_alignmentBytes = 0;
+
+	/// The current frame. reset() increments it.
+	U32 m_frame = 1;
+
+	const Arena& getArena(U32 arenaIdx) const
+	{
+		ANKI_ASSERT(arenaIdx <= MAX_THREAD_ARENAS);
+		return (arenaIdx < MAX_THREAD_ARENAS) ? m_arenas[arenaIdx] : m_sharedArena;
+	}
+
+	void* allocateFromArena(Arena& arena, PtrSize size, PtrSize alignment);
+	Bool nextChunk(Arena& arena, PtrSize size, PtrSize alignment);
+	void resetArena(Arena& arena);
+	PtrSize getUsedMemory(const Arena& arena) const;
+	void destroyArena(Arena& arena);
+};
+
+inline U32 BaseMemoryPool::getAllocationsCount() const
+{
+	if(m_type == Type::SLAB)
+	{
+		return static_cast<const SlabMemoryPool*>(this)->getAllocationsCountInternal();
+	}
+	else if(m_type == Type::FRAME)
+	{
+		return static_cast<const FrameMemoryPool*>(this)->getAllocationsCountInternal();
+	}
+
+	return m_allocationsCount.load();
+}
+
 inline void* BaseMemoryPool::allocate(PtrSize size, PtrSize alignmentBytes)
 {
 	void* out = nullptr;
@@ -382,6 +569,12 @@ inline void* BaseMemoryPool::allocate(PtrSize size, PtrSize alignmentBytes)
 	case Type::STACK:
 		out = static_cast<StackMemoryPool*>(this)->allocate(size, alignmentBytes);
 		break;
+	case Type::SLAB:
+		out = static_cast<SlabMemoryPool*>(this)->allocate(size, alignmentBytes);
+		break;
+	case Type::FRAME:
+		out = static_cast<FrameMemoryPool*>(this)->allocate(size, alignmentBytes);
+		break;
 	default:
 		ANKI_ASSERT(m_type == Type::CHAIN);
 		out = static_cast<ChainMemoryPool*>(this)->allocate(size, alignmentBytes);
@@ -400,6 +593,12 @@ inline void BaseMemoryPool::free(void* ptr)
 	case Type::STACK:
 		static_cast<StackMemoryPool*>(this)->free(ptr);
 		break;
+	case Type::SLAB:
+		static_cast<SlabMemoryPool*>(this)->free(ptr);
+		break;
+	case Type::FRAME:
+		static_cast<FrameMemoryPool*>(this)->free(ptr);
+		break;
 	default:
 		ANKI_ASSERT(m_type == Type::CHAIN);
 		static_cast<ChainMemoryPool*>(this)->free(ptr);
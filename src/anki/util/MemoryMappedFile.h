@@ -0,0 +1,77 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/String.h>
+#include <anki/util/NonCopyable.h>
+
+namespace anki
+{
+
+/// @addtogroup util_file
+/// @{
+
+/// Maps a regular file to memory. The mapping is private and copy-on-write: The memory can be written but the changes
+/// never reach the file. The pages that are never written are shared with every other process that maps the same file.
+class MemoryMappedFile : public NonCopyable
+{
+public:
+	MemoryMappedFile() = default;
+
+	MemoryMappedFile(MemoryMappedFile&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// Unmaps the file.
+	~MemoryMappedFile()
+	{
+		close();
+	}
+
+	MemoryMappedFile& operator=(MemoryMappedFile&& b)
+	{
+		close();
+		m_data = b.m_data;
+		m_size = b.m_size;
+		m_handle = b.m_handle;
+		b.m_data = nullptr;
+		b.m_size = 0;
+		b.m_handle = nullptr;
+		return *this;
+	}
+
+	/// Map a file. The memory is at least ANKI_SAFE_ALIGNMENT aligned.
+	ANKI_USE_RESULT Error open(CString filename);
+
+	/// Unmap the file.
+	void close();
+
+	Bool isOpen() const
+	{
+		return m_data != nullptr;
+	}
+
+	void* getData() const
+	{
+		ANKI_ASSERT(isOpen());
+		return m_data;
+	}
+
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(isOpen());
+		return m_size;
+	}
+
+private:
+	void* m_data = nullptr;
+	PtrSize m_size = 0;
+	void* m_handle = nullptr; ///< Platform specific.
+};
+/// @}
+
+} // end namespace anki
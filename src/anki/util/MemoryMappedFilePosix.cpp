@@ -0,0 +1,65 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/MemoryMappedFile.h>
+#include <anki/util/Logger.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace anki
+{
+
+Error MemoryMappedFile::open(CString filename)
+{
+	close();
+
+	const int fd = ::open(filename.cstr(), O_RDONLY);
+	if(fd < 0)
+	{
+		ANKI_UTIL_LOGE("open() failed for %s: %s", filename.cstr(), strerror(errno));
+		return Error::FILE_ACCESS;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		ANKI_UTIL_LOGE("Empty file or fstat() failed: %s", filename.cstr());
+		::close(fd);
+		return Error::FILE_ACCESS;
+	}
+
+	// Private mapping so the writes are copy-on-write
+	void* data = mmap(nullptr, PtrSize(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// The mapping holds a reference to the file, no need to keep the descriptor
+	::close(fd);
+
+	if(data == MAP_FAILED)
+	{
+		ANKI_UTIL_LOGE("mmap() failed for %s: %s", filename.cstr(), strerror(errno));
+		return Error::FILE_ACCESS;
+	}
+
+	ANKI_ASSERT(isAligned(ANKI_SAFE_ALIGNMENT, data));
+	m_data = data;
+	m_size = PtrSize(st.st_size);
+	return Error::NONE;
+}
+
+void MemoryMappedFile::close()
+{
+	if(m_data)
+	{
+		munmap(m_data, m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,72 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/MemoryMappedFile.h>
+#include <anki/util/Logger.h>
+#include <anki/util/Win32Minimal.h>
+
+namespace anki
+{
+
+Error MemoryMappedFile::open(CString filename)
+{
+	close();
+
+	HANDLE file = CreateFileA(
+		filename.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("CreateFileA() failed for %s: %u", filename.cstr(), GetLastError());
+		return Error::FILE_ACCESS;
+	}
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+	{
+		ANKI_UTIL_LOGE("Empty file or GetFileSizeEx() failed: %s", filename.cstr());
+		CloseHandle(file);
+		return Error::FILE_ACCESS;
+	}
+
+	// Copy-on-write mapping
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	// The mapping holds a reference to the file
+	CloseHandle(file);
+
+	if(mapping == nullptr)
+	{
+		ANKI_UTIL_LOGE("CreateFileMappingA() failed for %s: %u", filename.cstr(), GetLastError());
+		return Error::FILE_ACCESS;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if(data == nullptr)
+	{
+		ANKI_UTIL_LOGE("MapViewOfFile() failed for %s: %u", filename.cstr(), GetLastError());
+		CloseHandle(mapping);
+		return Error::FILE_ACCESS;
+	}
+
+	ANKI_ASSERT(isAligned(ANKI_SAFE_ALIGNMENT, data));
+	m_data = data;
+	m_size = PtrSize(size.QuadPart);
+	m_handle = mapping;
+	return Error::NONE;
+}
+
+void MemoryMappedFile::close()
+{
+	if(m_data)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_handle);
+		m_data = nullptr;
+		m_size = 0;
+		m_handle = nullptr;
+	}
+}
+
+} // end namespace anki
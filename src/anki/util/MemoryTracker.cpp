@@ -0,0 +1,282 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/MemoryTracker.h>
+#include <anki/util/File.h>
+#include <anki/util/Logger.h>
+#include <anki/util/System.h>
+#include <anki/util/Tracer.h>
+#include <cstdio>
+#include <cinttypes>
+
+namespace anki
+{
+
+/// It's placed right before the memory of every allocation.
+class alignas(MemoryTracker::HEADER_ALIGNMENT) MemoryTracker::Header
+{
+public:
+	PtrSize m_size;
+	PtrSize m_offset; ///< From the memory of the allocation callback to the header.
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+	Header* m_prev;
+	Header* m_next;
+	Array<void*, CALL_SITE_DEPTH> m_callSite;
+	U32 m_callSiteDepth;
+#endif
+};
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+namespace
+{
+
+/// Write the call site of an allocation to a file or the log.
+class CallSiteWalker : public BackTraceWalker
+{
+public:
+	File* m_file = nullptr;
+	Error m_err = Error::NONE;
+
+	void operator()(const char* symbol) override
+	{
+		if(m_file)
+		{
+			if(!m_err)
+			{
+				m_err = m_file->writeText("\t\t\t%s\n", symbol);
+			}
+		}
+		else
+		{
+			ANKI_UTIL_LOGW("\t%s", symbol);
+		}
+	}
+};
+
+} // end anonymous namespace
+#endif
+
+MemoryTracker::~MemoryTracker()
+{
+#if ANKI_MEM_TRACKER_CALL_SITES
+	// The leaked memory can't be freed after this point, forget about it
+	m_liveAllocations = nullptr;
+#endif
+}
+
+void MemoryTracker::init(CString name, AllocAlignedCallback allocCb, void* allocCbUserData)
+{
+	ANKI_ASSERT(allocCb);
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+
+	snprintf(&m_name[0], sizeof(m_name), "%s", name.cstr());
+	Array<char, 64> counterName;
+	snprintf(&counterName[0], sizeof(counterName), "MEM_%s_LIVE_BYTES", name.cstr());
+	m_liveBytesCounterName = InternedString(&counterName[0]);
+	snprintf(&counterName[0], sizeof(counterName), "MEM_%s_ALLOCATIONS", name.cstr());
+	m_allocationsCounterName = InternedString(&counterName[0]);
+
+	m_liveBytes.setNonAtomically(0);
+	m_peakBytes.setNonAtomically(0);
+	m_allocationCount.setNonAtomically(0);
+	m_freeCount.setNonAtomically(0);
+	for(Atomic<U64>& count : m_sizeClassAllocationCounts)
+	{
+		count.setNonAtomically(0);
+	}
+}
+
+U32 MemoryTracker::computeSizeClass(PtrSize size)
+{
+	U32 sizeClass = 0;
+	PtrSize maxSize = 16;
+	while(size > maxSize && sizeClass < SIZE_CLASS_COUNT - 1)
+	{
+		maxSize <<= 1;
+		++sizeClass;
+	}
+
+	return sizeClass;
+}
+
+void* MemoryTracker::allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(userData);
+	MemoryTracker& self = *static_cast<MemoryTracker*>(userData);
+
+	void* out = nullptr;
+	if(ptr == nullptr)
+	{
+		out = self.allocate(size, alignment);
+	}
+	else
+	{
+		self.free(ptr);
+	}
+
+	return out;
+}
+
+void* MemoryTracker::allocate(PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(size > 0);
+	ANKI_ASSERT(alignment > 0 && isPowerOfTwo(alignment));
+	static_assert(sizeof(Header) % HEADER_ALIGNMENT == 0, "The memory after the header should be aligned");
+
+	// For alignments bigger than the header's there is padding in front of the header
+	alignment = max<PtrSize>(alignment, alignof(Header));
+	const PtrSize offset = getAlignedRoundUp(alignment, sizeof(Header));
+	U8* mem = static_cast<U8*>(m_allocCb(m_allocCbUserData, nullptr, offset + size, alignment));
+	if(ANKI_UNLIKELY(mem == nullptr))
+	{
+		return nullptr;
+	}
+
+	Header* header = reinterpret_cast<Header*>(mem + offset) - 1;
+	header->m_size = size;
+	header->m_offset = offset - sizeof(Header);
+
+	const PtrSize liveBytes = m_liveBytes.fetchAdd(size) + size;
+	m_peakBytes.max(liveBytes);
+	m_allocationCount.fetchAdd(1);
+	m_sizeClassAllocationCounts[computeSizeClass(size)].fetchAdd(1);
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+	header->m_callSiteDepth = getBackTraceAddresses(&header->m_callSite[0], CALL_SITE_DEPTH);
+
+	LockGuard<Mutex> lock(m_liveAllocationsMtx);
+	header->m_prev = nullptr;
+	header->m_next = m_liveAllocations;
+	if(m_liveAllocations)
+	{
+		m_liveAllocations->m_prev = header;
+	}
+	m_liveAllocations = header;
+#endif
+
+	return header + 1;
+}
+
+void MemoryTracker::free(void* ptr)
+{
+	Header* header = static_cast<Header*>(ptr) - 1;
+	ANKI_ASSERT(header->m_size > 0);
+
+	m_liveBytes.fetchSub(header->m_size);
+	m_freeCount.fetchAdd(1);
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+	{
+		LockGuard<Mutex> lock(m_liveAllocationsMtx);
+		if(header->m_prev)
+		{
+			header->m_prev->m_next = header->m_next;
+		}
+		else
+		{
+			ANKI_ASSERT(m_liveAllocations == header);
+			m_liveAllocations = header->m_next;
+		}
+
+		if(header->m_next)
+		{
+			header->m_next->m_prev = header->m_prev;
+		}
+	}
+#endif
+
+	m_allocCb(m_allocCbUserData, reinterpret_cast<U8*>(header) - header->m_offset, 0, 0);
+}
+
+void MemoryTracker::traceCounters()
+{
+#if ANKI_ENABLE_TRACE
+	const U64 allocationCount = m_allocationCount.load();
+	ANKI_ASSERT(allocationCount >= m_tracedAllocationCount);
+
+	TracerSingleton::get().incrementCounter(m_liveBytesCounterName, m_liveBytes.load());
+	TracerSingleton::get().incrementCounter(m_allocationsCounterName, allocationCount - m_tracedAllocationCount);
+
+	m_tracedAllocationCount = allocationCount;
+#endif
+}
+
+U64 MemoryTracker::logLeaks() const
+{
+	const U64 leakCount = m_allocationCount.load() - m_freeCount.load();
+	if(leakCount == 0)
+	{
+		return 0;
+	}
+
+	ANKI_UTIL_LOGW("%s: %" PRIu64 " allocations (%" PRIu64 " bytes) were not freed",
+		getName().cstr(),
+		leakCount,
+		U64(m_liveBytes.load()));
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+	LockGuard<Mutex> lock(m_liveAllocationsMtx);
+	const Header* header = m_liveAllocations;
+	while(header)
+	{
+		ANKI_UTIL_LOGW("%s: Leaked %" PRIu64 " bytes from:", getName().cstr(), U64(header->m_size));
+
+		CallSiteWalker walker;
+		walker.exec(&header->m_callSite[0], header->m_callSiteDepth);
+
+		header = header->m_next;
+	}
+#endif
+
+	return leakCount;
+}
+
+Error MemoryTracker::writeReport(File& file) const
+{
+	ANKI_CHECK(file.writeText("%s\n", getName().cstr()));
+	ANKI_CHECK(file.writeText("\tLive: %" PRIu64 " bytes\n", U64(m_liveBytes.load())));
+	ANKI_CHECK(file.writeText("\tPeak: %" PRIu64 " bytes\n", U64(m_peakBytes.load())));
+	ANKI_CHECK(file.writeText("\tAllocations: %" PRIu64 "\n", m_allocationCount.load()));
+	ANKI_CHECK(file.writeText("\tFrees: %" PRIu64 "\n", m_freeCount.load()));
+
+	ANKI_CHECK(file.writeText("\tAllocations per size class:\n"));
+	for(U32 i = 0; i < SIZE_CLASS_COUNT; ++i)
+	{
+		const U64 count = m_sizeClassAllocationCounts[i].load();
+		if(i < SIZE_CLASS_COUNT - 1)
+		{
+			ANKI_CHECK(file.writeText("\t\t<= %" PRIu64 ": %" PRIu64 "\n", U64(16) << U64(i), count));
+		}
+		else
+		{
+			ANKI_CHECK(file.writeText("\t\t> %" PRIu64 ": %" PRIu64 "\n", U64(16) << U64(i - 1), count));
+		}
+	}
+
+	const U64 leakCount = m_allocationCount.load() - m_freeCount.load();
+	ANKI_CHECK(file.writeText("\tLeaks: %" PRIu64 "\n", leakCount));
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+	LockGuard<Mutex> lock(m_liveAllocationsMtx);
+	const Header* header = m_liveAllocations;
+	while(header)
+	{
+		ANKI_CHECK(file.writeText("\t\t%" PRIu64 " bytes from:\n", U64(header->m_size)));
+
+		CallSiteWalker walker;
+		walker.m_file = &file;
+		walker.exec(&header->m_callSite[0], header->m_callSiteDepth);
+		ANKI_CHECK(walker.m_err);
+
+		header = header->m_next;
+	}
+#endif
+
+	return Error::NONE;
+}
+
+} // end namespace anki
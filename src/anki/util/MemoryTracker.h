@@ -0,0 +1,131 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/Memory.h>
+#include <anki/util/InternedString.h>
+
+namespace anki
+{
+
+// Forward
+class File;
+
+/// @addtogroup util_memory
+/// @{
+
+/// Store the call sites of the allocations. It's expensive so only the debug builds do it.
+#define ANKI_MEM_TRACKER_CALL_SITES ANKI_EXTRA_CHECKS
+
+/// Tracks the memory that goes through an allocation callback. It sits between a subsystem and the real allocation
+/// callback and counts the live and the peak memory, the allocations per size class and in debug builds it remembers
+/// where the live allocations came from.
+class MemoryTracker : public NonCopyable
+{
+public:
+	/// The size classes of the histogram. Size class N holds the allocations up to 16 << N bytes and the last one the
+	/// rest.
+	static constexpr U32 SIZE_CLASS_COUNT = 16;
+
+	/// The alignment of the header that the tracker puts in front of every allocation. Bigger alignments are supported
+	/// with some extra padding.
+	static constexpr PtrSize HEADER_ALIGNMENT = 64;
+
+	/// The depth of the call sites.
+	static constexpr U32 CALL_SITE_DEPTH = 12;
+
+	MemoryTracker() = default;
+
+	~MemoryTracker();
+
+	/// Initialize.
+	/// @param name The name of the subsystem. It's used in the reports and the tracer counters.
+	/// @param allocCb The allocation callback to forward the allocations to.
+	/// @param allocCbUserData The user data of @a allocCb.
+	void init(CString name, AllocAlignedCallback allocCb, void* allocCbUserData);
+
+	/// The allocation callback to give to the subsystem. The user data should be the tracker.
+	static void* allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
+
+	CString getName() const
+	{
+		return &m_name[0];
+	}
+
+	/// The memory that the subsystem hasn't freed yet.
+	PtrSize getLiveBytes() const
+	{
+		return m_liveBytes.load();
+	}
+
+	/// The max value of getLiveBytes() so far.
+	PtrSize getPeakBytes() const
+	{
+		return m_peakBytes.load();
+	}
+
+	U64 getAllocationCount() const
+	{
+		return m_allocationCount.load();
+	}
+
+	U64 getFreeCount() const
+	{
+		return m_freeCount.load();
+	}
+
+	/// The number of allocations of a size class.
+	U64 getSizeClassAllocationCount(U32 sizeClass) const
+	{
+		return m_sizeClassAllocationCounts[sizeClass].load();
+	}
+
+	/// Get the size class of an allocation.
+	static U32 computeSizeClass(PtrSize size);
+
+	/// Increment the tracer counters with the live memory and the allocations since the last call. Call it once per
+	/// frame. It's not thread safe.
+	void traceCounters();
+
+	/// Log the allocations that haven't been freed. The debug builds log their call sites as well.
+	/// @return The number of allocations that haven't been freed.
+	U64 logLeaks() const;
+
+	/// Write all the stats, the histogram and the leaks to a text file.
+	ANKI_USE_RESULT Error writeReport(File& file) const;
+
+private:
+	class Header;
+
+	AllocAlignedCallback m_allocCb = nullptr;
+	void* m_allocCbUserData = nullptr;
+
+	Array<char, 32> m_name = {};
+
+	Atomic<PtrSize> m_liveBytes = {0};
+	Atomic<PtrSize> m_peakBytes = {0};
+	Atomic<U64> m_allocationCount = {0};
+	Atomic<U64> m_freeCount = {0};
+	Array<Atomic<U64>, SIZE_CLASS_COUNT> m_sizeClassAllocationCounts;
+
+	/// @name Tracer counters
+	/// @{
+	InternedString m_liveBytesCounterName;
+	InternedString m_allocationsCounterName;
+	U64 m_tracedAllocationCount = 0;
+	/// @}
+
+#if ANKI_MEM_TRACKER_CALL_SITES
+	Header* m_liveAllocations = nullptr;
+	mutable Mutex m_liveAllocationsMtx;
+#endif
+
+	void* allocate(PtrSize size, PtrSize alignment);
+	void free(void* ptr);
+};
+/// @}
+
+} // end namespace anki
@@ -41,4 +41,34 @@ Error BinarySerializer::doDynamicArrayBasicType(const void* arr, PtrSize size, U
 	return Error::NONE;
 }
 
+Error BinaryDeserializer::patchPointers(
+	U8* baseAddress, PtrSize dataSize, const U8* pointerArray, PtrSize pointerCount)
+{
+	const PtrSize baseAddressNumber = ptrToNumber(baseAddress);
+	for(PtrSize i = 0; i < pointerCount; ++i)
+	{
+		// Read the location of the pointer. The array might not be aligned
+		PtrSize offsetFromBeginOfData;
+		memcpy(&offsetFromBeginOfData, pointerArray + i * sizeof(PtrSize), sizeof(offsetFromBeginOfData));
+		if(dataSize < sizeof(PtrSize) || offsetFromBeginOfData > dataSize - sizeof(PtrSize)
+		   || !isAligned(alignof(PtrSize), offsetFromBeginOfData))
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+
+		// Add to the location the actual base address
+		PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(baseAddress + offsetFromBeginOfData);
+		if(ptrValue >= dataSize)
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer");
+			return Error::USER_DATA;
+		}
+
+		ptrValue += baseAddressNumber;
+	}
+
+	return Error::NONE;
+}
+
 } // end namespace anki
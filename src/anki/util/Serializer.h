@@ -188,12 +188,23 @@ private:
 class BinaryDeserializer : public NonCopyable
 {
 public:
-	/// Serialize a class.
+	/// Serialize a class. The data and the pointer array are read with a single read and the pointers are patched in
+	/// place so all the structures and the arrays live in one allocation.
 	/// @param x The struct to read.
-	/// @param allocator The allocator to use to allocate the new structures.
-	/// @param file The file to read from.
+	/// @param allocator The allocator to use to allocate the new structures. The allocation includes the pointer array
+	///        of the file.
+	/// @param file The file to read from. It can be a File or anything with the same read(), seek() and getSize(). It
+	///        should be at its beginning.
+	template<typename T, typename TFile>
+	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, TFile& file);
+
+	/// Deserialize a file that is already in memory (a MemoryMappedFile for example) without copying it. Only the
+	/// pointers are patched, everything else stays in place.
+	/// @param x The struct to read. It points inside @a data.
+	/// @param data The whole file. The data after the header should be ANKI_SAFE_ALIGNMENT aligned.
+	/// @param dataSize The size of the file.
 	template<typename T>
-	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file);
+	static ANKI_USE_RESULT Error deserializeInPlace(T*& x, void* data, PtrSize dataSize);
 
 	/// Read a single value. Can't call this directly.
 	template<typename T>
@@ -222,6 +233,15 @@ public:
 	{
 		// Do nothing
 	}
+
+private:
+	/// Convert the pointers from offsets to addresses.
+	/// @param baseAddress The data after the header.
+	/// @param dataSize The size of the data.
+	/// @param pointerArray The offsets of the pointers in the data. It might not be aligned.
+	/// @param pointerCount The size of pointerArray.
+	static ANKI_USE_RESULT Error patchPointers(
+		U8* baseAddress, PtrSize dataSize, const U8* pointerArray, PtrSize pointerCount);
 };
 /// @}
 
@@ -15,12 +15,13 @@ class alignas(ANKI_SAFE_ALIGNMENT) BinarySerializerHeader
 {
 public:
 	Array<U8, 8> m_magic;
+	PtrSize m_dataFilePosition; ///< Where the data start.
 	PtrSize m_dataSize;
 	PtrSize m_pointerArrayFilePosition; ///< Points to an array of file positions that contain pointers.
 	PtrSize m_pointerCount; ///< The size of the above.
 };
 
-static constexpr const char* BINARY_SERIALIZER_MAGIC = "ANKIBIN1";
+static constexpr const char* BINARY_SERIALIZER_MAGIC = "ANKIBIN2";
 
 } // end namespace detail
 
@@ -79,6 +80,7 @@ Error BinarySerializer::serializeInternal(const T& x, GenericMemoryPoolAllocator
 
 	// Write the header
 	memcpy(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, sizeof(header.m_magic));
+	header.m_dataFilePosition = dataFilePos;
 	header.m_dataSize = m_eofPos - dataFilePos;
 	ANKI_CHECK(m_file->seek(headerFilePos, FileSeekOrigin::BEGINNING));
 	ANKI_CHECK(m_file->write(&header, sizeof(header)));
@@ -163,14 +165,14 @@ Error BinarySerializer::doDynamicArrayComplexType(const T* arr, PtrSize size, Pt
 	return Error::NONE;
 }
 
-template<typename T>
-Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file)
+template<typename T, typename TFile>
+Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, TFile& file)
 {
 	x = nullptr;
 
 	detail::BinarySerializerHeader header;
 	ANKI_CHECK(file.read(&header, sizeof(header)));
-	const PtrSize dataFilePos = file.tell();
+	const PtrSize dataFilePos = header.m_dataFilePosition;
 
 	// Sanity checks
 	{
@@ -186,6 +188,12 @@ Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allo
 			return Error::USER_DATA;
 		}
 
+		if(dataFilePos < sizeof(header) || dataFilePos > file.getSize())
+		{
+			ANKI_UTIL_LOGE("Wrong data file position");
+			return Error::USER_DATA;
+		}
+
 		const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
 		const PtrSize actualSizeAfterHeader = file.getSize() - dataFilePos;
 		if(expectedSizeAfterHeader > actualSizeAfterHeader)
@@ -195,39 +203,99 @@ Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allo
 		}
 	}
 
-	// Allocate & read data
-	U8* const baseAddress =
-		static_cast<U8*>(allocator.getMemoryPool().allocate(header.m_dataSize, ANKI_SAFE_ALIGNMENT));
-	ANKI_CHECK(file.read(baseAddress, header.m_dataSize));
+	if(dataFilePos != sizeof(header))
+	{
+		ANKI_CHECK(file.seek(dataFilePos, FileSeekOrigin::BEGINNING));
+	}
+
+	// Allocate and read the data and the pointer array with one read. The serializer writes the array right after the
+	// data
+	const PtrSize pointerArraySize = header.m_pointerCount * sizeof(PtrSize);
+	if(header.m_pointerCount > 0 && header.m_pointerArrayFilePosition != dataFilePos + header.m_dataSize)
+	{
+		ANKI_UTIL_LOGE("Pointer array is not after the data");
+		return Error::USER_DATA;
+	}
+
+	U8* const baseAddress = static_cast<U8*>(
+		allocator.getMemoryPool().allocate(header.m_dataSize + pointerArraySize, ANKI_SAFE_ALIGNMENT));
+	Error err = file.read(baseAddress, header.m_dataSize + pointerArraySize);
 
 	// Fix pointers
-	if(header.m_pointerCount)
+	if(!err)
+	{
+		err = patchPointers(baseAddress, header.m_dataSize, baseAddress + header.m_dataSize, header.m_pointerCount);
+	}
+
+	if(err)
+	{
+		allocator.getMemoryPool().free(baseAddress);
+		return err;
+	}
+
+	// Done
+	x = reinterpret_cast<T*>(baseAddress);
+	return Error::NONE;
+}
+
+template<typename T>
+Error BinaryDeserializer::deserializeInPlace(T*& x, void* data, PtrSize dataSize)
+{
+	ANKI_ASSERT(data);
+	x = nullptr;
+
+	if(dataSize < sizeof(detail::BinarySerializerHeader))
+	{
+		ANKI_UTIL_LOGE("Data too small");
+		return Error::USER_DATA;
+	}
+
+	const detail::BinarySerializerHeader& header = *static_cast<const detail::BinarySerializerHeader*>(data);
+	const PtrSize dataFilePos = header.m_dataFilePosition;
+	U8* const baseAddress = static_cast<U8*>(data) + dataFilePos;
+
+	// Sanity checks
 	{
-		ANKI_CHECK(file.seek(header.m_pointerArrayFilePosition, FileSeekOrigin::BEGINNING));
-		for(PtrSize i = 0; i < header.m_pointerCount; ++i)
+		if(memcmp(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, 8) != 0)
+		{
+			ANKI_UTIL_LOGE("Wrong magic work in header");
+			return Error::USER_DATA;
+		}
+
+		if(dataFilePos < sizeof(header) || dataFilePos > dataSize)
+		{
+			ANKI_UTIL_LOGE("Wrong data file position");
+			return Error::USER_DATA;
+		}
+
+		if(header.m_dataSize < sizeof(T))
 		{
-			// Read the location of the pointer
-			PtrSize offsetFromBeginOfData;
-			ANKI_CHECK(file.read(&offsetFromBeginOfData, sizeof(offsetFromBeginOfData)));
-			if(offsetFromBeginOfData >= header.m_dataSize)
-			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::USER_DATA;
-			}
-
-			// Add to the location the actual base address
-			U8* ptrLocation = baseAddress + offsetFromBeginOfData;
-			PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(ptrLocation);
-			if(ptrValue >= header.m_dataSize)
-			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::USER_DATA;
-			}
-
-			ptrValue += ptrToNumber(baseAddress);
+			ANKI_UTIL_LOGE("Wrong data size");
+			return Error::USER_DATA;
+		}
+
+		const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
+		const PtrSize actualSizeAfterHeader = dataSize - dataFilePos;
+		if(expectedSizeAfterHeader > actualSizeAfterHeader
+		   || header.m_pointerArrayFilePosition + header.m_pointerCount * sizeof(PtrSize) > dataSize)
+		{
+			ANKI_UTIL_LOGE("File size doesn't match expectations");
+			return Error::USER_DATA;
+		}
+
+		if(!isAligned(ANKI_SAFE_ALIGNMENT, baseAddress))
+		{
+			ANKI_UTIL_LOGE("Data are not aligned");
+			return Error::USER_DATA;
 		}
 	}
 
+	// Fix pointers
+	ANKI_CHECK(patchPointers(baseAddress,
+		header.m_dataSize,
+		static_cast<const U8*>(data) + header.m_pointerArrayFilePosition,
+		header.m_pointerCount));
+
 	// Done
 	x = reinterpret_cast<T*>(baseAddress);
 	return Error::NONE;
@@ -584,11 +584,10 @@ public:
 		return toCString().toNumber(out);
 	}
 
-	/// Compute the hash.
+	/// Compute the hash. It's the same as the hash of the CString.
 	U64 computeHash() const
 	{
-		checkInit();
-		return anki::computeHash(&m_data[0], m_data.getSize());
+		return toCString().computeHash();
 	}
 
 	/// Replace all occurrences of "from" with "to".
@@ -787,6 +786,130 @@ private:
 	}
 };
 
+/// A string that keeps the short strings inside itself and allocates memory only for the longer ones. It's meant for
+/// names that are created often. Like String it needs to be destroyed manually.
+class SsoString : public NonCopyable
+{
+public:
+	using Char = char;
+	using Allocator = GenericMemoryPoolAllocator<Char>;
+
+	/// The strings that are that long or shorter don't allocate.
+	static constexpr U32 MAX_INLINE_LENGTH = 23;
+
+	SsoString()
+	{
+		m_inline[0] = '\0';
+	}
+
+	/// Move constructor.
+	SsoString(SsoString&& b)
+	{
+		*this = std::move(b);
+	}
+
+	SsoString(Allocator alloc, CString str)
+		: SsoString()
+	{
+		create(alloc, str);
+	}
+
+	~SsoString()
+	{
+		ANKI_ASSERT(!isAllocated() && "Forgot to call destroy");
+	}
+
+	/// Move.
+	SsoString& operator=(SsoString&& b)
+	{
+		ANKI_ASSERT(this != &b && !isAllocated());
+		if(b.isAllocated())
+		{
+			m_ptr = b.m_ptr;
+		}
+		else
+		{
+			m_inline = b.m_inline;
+		}
+		m_length = b.m_length;
+
+		b.m_length = 0;
+		b.m_inline[0] = '\0';
+		return *this;
+	}
+
+	/// Initialize the string.
+	void create(Allocator alloc, CString str)
+	{
+		ANKI_ASSERT(!isAllocated());
+		m_length = (str.isEmpty()) ? 0 : str.getLength();
+		Char* chars = &m_inline[0];
+		if(isAllocated())
+		{
+			m_ptr = alloc.newArray<Char>(m_length + 1);
+			chars = m_ptr;
+		}
+
+		if(m_length > 0)
+		{
+			memcpy(chars, str.cstr(), m_length);
+		}
+		chars[m_length] = '\0';
+	}
+
+	void destroy(Allocator alloc)
+	{
+		if(isAllocated())
+		{
+			alloc.deleteArray(m_ptr, m_length + 1);
+		}
+
+		m_length = 0;
+		m_inline[0] = '\0';
+	}
+
+	CString toCString() const
+	{
+		return (isAllocated()) ? m_ptr : &m_inline[0];
+	}
+
+	const Char* cstr() const
+	{
+		return toCString().cstr();
+	}
+
+	U32 getLength() const
+	{
+		return m_length;
+	}
+
+	Bool isEmpty() const
+	{
+		return m_length == 0;
+	}
+
+	/// Compute the hash. It's the same as the hash of the CString.
+	U64 computeHash() const
+	{
+		return toCString().computeHash();
+	}
+
+	/// Return true if the string didn't fit inside the object.
+	Bool isAllocated() const
+	{
+		return m_length > MAX_INLINE_LENGTH;
+	}
+
+private:
+	union
+	{
+		Array<Char, MAX_INLINE_LENGTH + 1> m_inline;
+		Char* m_ptr;
+	};
+
+	U32 m_length = 0;
+};
+
 #define ANKI_STRING_COMPARE_OPERATOR(TypeA, TypeB, op) \
 	inline Bool operator op(TypeA a, TypeB b) \
 	{ \
@@ -45,28 +45,48 @@ void BackTraceWalker::exec()
 	void** array = static_cast<void**>(malloc(m_stackSize * sizeof(void*)));
 	if(array)
 	{
-		I32 size = backtrace(array, I32(m_stackSize));
+		const U32 size = getBackTraceAddresses(array, U32(m_stackSize));
+		exec(array, size);
+		free(array);
+	}
+#else
+	ANKI_UTIL_LOGW("BackTraceWalker::exec() Not supported in this platform");
+#endif
+}
 
-		// Get symbols
-		char** strings = backtrace_symbols(array, size);
+void BackTraceWalker::exec(void* const* addresses, U32 addressCount)
+{
+#if ANKI_POSIX && !ANKI_OS_ANDROID
+	// Get symbols
+	char** strings = backtrace_symbols(addresses, I32(addressCount));
 
-		if(strings)
+	if(strings)
+	{
+		for(U32 i = 0; i < addressCount; ++i)
 		{
-			for(I32 i = 0; i < size; ++i)
-			{
-				operator()(strings[i]);
-			}
-
-			free(strings);
+			operator()(strings[i]);
 		}
 
-		free(array);
+		free(strings);
 	}
 #else
+	(void)addresses;
+	(void)addressCount;
 	ANKI_UTIL_LOGW("BackTraceWalker::exec() Not supported in this platform");
 #endif
 }
 
+U32 getBackTraceAddresses(void** addresses, U32 maxAddressCount)
+{
+#if ANKI_POSIX && !ANKI_OS_ANDROID
+	return U32(backtrace(addresses, I32(maxAddressCount)));
+#else
+	(void)addresses;
+	(void)maxAddressCount;
+	return 0;
+#endif
+}
+
 Bool runningFromATerminal()
 {
 #if ANKI_POSIX
@@ -33,10 +33,19 @@ public:
 
 	void exec();
 
+	/// Visit the symbols of some addresses that getBackTraceAddresses() returned.
+	void exec(void* const* addresses, U32 addressCount);
+
 private:
 	U m_stackSize;
 };
 
+/// Get the addresses of the program stack without resolving the symbols. It's much faster than BackTraceWalker.
+/// @param[out] addresses Where to write the addresses.
+/// @param maxAddressCount The size of @a addresses.
+/// @return The number of addresses written.
+U32 getBackTraceAddresses(void** addresses, U32 maxAddressCount);
+
 /// Return true if the engine is running from a terminal emulator.
 Bool runningFromATerminal();
 /// @}
@@ -5,30 +5,37 @@
 
 #include <anki/util/Tracer.h>
 #include <anki/util/HighRezTimer.h>
-#include <anki/util/HashMap.h>
-#include <anki/util/List.h>
 
 namespace anki
 {
 
-class Tracer::Chunk : public IntrusiveListEnabled<Chunk>
+/// An event or a counter.
+class Tracer::Record
 {
 public:
-	Array<TracerEvent, EVENTS_PER_CHUNK> m_events;
-	U32 m_eventCount = 0;
-	Array<TracerCounter, COUNTERS_PER_CHUNK> m_counters;
-	U32 m_counterCount = 0;
+	InternedString m_name;
+	Second m_start; ///< Only for events.
+	Second m_duration; ///< Only for events.
+	U64 m_counterValue; ///< Only for counters.
+	RecordType m_type;
 };
 
-/// Thread local storage.
+/// Thread local storage. The thread is the only writer of its ring buffer.
 class alignas(ANKI_CACHE_LINE_SIZE) Tracer::ThreadLocal
 {
 public:
 	ThreadId m_tid = 0;
+	Record* m_records = nullptr;
 
-	Chunk* m_currentChunk = nullptr;
-	IntrusiveList<Chunk> m_allChunks;
-	SpinLock m_currentChunkLock;
+	/// Incremented before a record is written. flush() uses it to find the records that were overwritten while it was
+	/// reading them.
+	Atomic<U64> m_reservedCount = {0};
+
+	/// Incremented after a record is written.
+	Atomic<U64> m_writtenCount = {0};
+
+	/// The records that flush() has already read. It's in its own cache line because only flush() touches it.
+	alignas(ANKI_CACHE_LINE_SIZE) U64 m_readCount = 0;
 };
 
 thread_local Tracer::ThreadLocal* Tracer::m_threadLocal = nullptr;
@@ -38,6 +45,7 @@ Tracer::~Tracer()
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
+		m_alloc.deleteArray(tlocal->m_records, RECORDS_PER_THREAD);
 		m_alloc.deleteInstance(tlocal);
 	}
 	m_allThreadLocal.destroy(m_alloc);
@@ -50,6 +58,7 @@ Tracer::ThreadLocal& Tracer::getThreadLocal()
 	{
 		out = m_alloc.newInstance<ThreadLocal>();
 		out->m_tid = Thread::getCurrentThreadId();
+		out->m_records = m_alloc.newArray<Record>(RECORDS_PER_THREAD);
 		m_threadLocal = out;
 
 		// Store it
@@ -60,25 +69,23 @@ Tracer::ThreadLocal& Tracer::getThreadLocal()
 	return *out;
 }
 
-Tracer::Chunk& Tracer::getOrCreateChunk(ThreadLocal& tlocal)
+void Tracer::writeRecord(RecordType type, InternedString name, Second start, Second duration, U64 counterValue)
 {
-	Chunk* out;
+	ThreadLocal& tlocal = getThreadLocal();
 
-	if(tlocal.m_currentChunk && tlocal.m_currentChunk->m_eventCount < EVENTS_PER_CHUNK
-		&& tlocal.m_currentChunk->m_counterCount < COUNTERS_PER_CHUNK)
-	{
-		// There is a chunk and it has enough space
-		out = tlocal.m_currentChunk;
-	}
-	else
-	{
-		// Create a new
-		out = m_alloc.newInstance<Chunk>();
-		tlocal.m_currentChunk = out;
-		tlocal.m_allChunks.pushBack(out);
-	}
+	// Only this thread writes the counts so there is no need for ordering when reading them
+	const U64 pos = tlocal.m_writtenCount.load(AtomicMemoryOrder::RELAXED);
+	tlocal.m_reservedCount.store(pos + 1, AtomicMemoryOrder::RELAXED);
+	std::atomic_thread_fence(std::memory_order_release);
 
-	return *out;
+	Record& record = tlocal.m_records[pos & (RECORDS_PER_THREAD - 1)];
+	record.m_name = name;
+	record.m_start = start;
+	record.m_duration = duration;
+	record.m_counterValue = counterValue;
+	record.m_type = type;
+
+	tlocal.m_writtenCount.store(pos + 1, AtomicMemoryOrder::RELEASE);
 }
 
 TracerEventHandle Tracer::beginEvent()
@@ -97,102 +104,116 @@ TracerEventHandle Tracer::beginEvent()
 	return out;
 }
 
-void Tracer::endEvent(const char* eventName, TracerEventHandle event)
+void Tracer::endEvent(InternedString eventName, TracerEventHandle event)
 {
 	if(!m_enabled || event.m_start == 0.0)
 	{
 		return;
 	}
 
-	// Get the time before the lock and everything
+	// Get the time before everything
 	const Second duration = HighRezTimer::getCurrentTime() - event.m_start;
 	if(duration == 0.0)
 	{
 		return;
 	}
 
-	ThreadLocal& tlocal = getThreadLocal();
-
-	// Write the event
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
-
-	TracerEvent& writeEvent = chunk.m_events[chunk.m_eventCount++];
-	writeEvent.m_name = eventName;
-	writeEvent.m_start = event.m_start;
-	writeEvent.m_duration = duration;
-
-	// Write counter as well. In ns
-	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
-	writeCounter.m_name = eventName;
-	writeCounter.m_value = U64(writeEvent.m_duration * 1000000000.0);
+	writeRecord(RecordType::EVENT, eventName, event.m_start, duration, 0);
 }
 
-void Tracer::addCustomEvent(const char* eventName, Second start, Second duration)
+void Tracer::addCustomEvent(InternedString eventName, Second start, Second duration)
 {
-	ANKI_ASSERT(eventName && start >= 0.0 && duration >= 0.0);
+	ANKI_ASSERT(!eventName.isEmpty() && start >= 0.0 && duration >= 0.0);
 	if(!m_enabled || duration == 0.0)
 	{
 		return;
 	}
 
-	ThreadLocal& tlocal = getThreadLocal();
-
-	// Write the event
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
-
-	TracerEvent& writeEvent = chunk.m_events[chunk.m_eventCount++];
-	writeEvent.m_name = eventName;
-	writeEvent.m_start = start;
-	writeEvent.m_duration = duration;
-
-	// Write counter as well. In ns
-	TracerCounter& writeCounter = chunk.m_counters[chunk.m_counterCount++];
-	writeCounter.m_name = eventName;
-	writeCounter.m_value = U64(duration * 1000000000.0);
+	writeRecord(RecordType::EVENT, eventName, start, duration, 0);
 }
 
-void Tracer::incrementCounter(const char* counterName, U64 value)
+void Tracer::incrementCounter(InternedString counterName, U64 value)
 {
 	if(!m_enabled)
 	{
 		return;
 	}
 
-	ThreadLocal& tlocal = getThreadLocal();
-
-	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
-	Chunk& chunk = getOrCreateChunk(tlocal);
-
-	TracerCounter& writeTo = chunk.m_counters[chunk.m_counterCount++];
-	writeTo.m_name = counterName;
-	writeTo.m_value = value;
+	writeRecord(RecordType::COUNTER, counterName, 0.0, 0.0, value);
 }
 
 void Tracer::flush(TracerFlushCallback callback, void* callbackUserData)
 {
 	ANKI_ASSERT(callback);
 
+	Array<Record, RECORDS_PER_FLUSH> records;
+	Array<TracerEvent, RECORDS_PER_FLUSH> events;
+	Array<TracerCounter, RECORDS_PER_FLUSH> counters;
+	U64 lostRecordCount = 0;
+
 	LockGuard<Mutex> lock(m_allThreadLocalMtx);
 	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
-		LockGuard<SpinLock> lock2(tlocal->m_currentChunkLock);
+		// The records before the last RECORDS_PER_THREAD are gone
+		const U64 writtenCount = tlocal->m_writtenCount.load(AtomicMemoryOrder::ACQUIRE);
+		U64 begin = (writtenCount > RECORDS_PER_THREAD) ? writtenCount - RECORDS_PER_THREAD : 0;
+		begin = max(begin, tlocal->m_readCount);
+		lostRecordCount += begin - tlocal->m_readCount;
 
-		while(!tlocal->m_allChunks.isEmpty())
+		while(begin < writtenCount)
 		{
-			Chunk* chunk = tlocal->m_allChunks.popFront();
-
-			callback(callbackUserData,
-				tlocal->m_tid,
-				WeakArray<TracerEvent>(&chunk->m_events[0], chunk->m_eventCount),
-				WeakArray<TracerCounter>(&chunk->m_counters[0], chunk->m_counterCount));
-
-			m_alloc.deleteInstance(chunk);
+			const U32 count = U32(min<U64>(writtenCount - begin, RECORDS_PER_FLUSH));
+			for(U32 i = 0; i < count; ++i)
+			{
+				records[i] = tlocal->m_records[(begin + i) & (RECORDS_PER_THREAD - 1)];
+			}
+
+			// The thread might have overwritten some of the records while copying them. Skip those
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const U64 reservedCount = tlocal->m_reservedCount.load(AtomicMemoryOrder::RELAXED);
+			const U64 firstValid = (reservedCount > RECORDS_PER_THREAD) ? reservedCount - RECORDS_PER_THREAD : 0;
+			const U32 first = U32(min<U64>((firstValid > begin) ? firstValid - begin : 0, count));
+			lostRecordCount += first;
+
+			U32 eventCount = 0;
+			U32 counterCount = 0;
+			for(U32 i = first; i < count; ++i)
+			{
+				const Record& record = records[i];
+				TracerCounter& counter = counters[counterCount++];
+				counter.m_name = record.m_name;
+
+				if(record.m_type == RecordType::EVENT)
+				{
+					TracerEvent& event = events[eventCount++];
+					event.m_name = record.m_name;
+					event.m_start = record.m_start;
+					event.m_duration = record.m_duration;
+
+					// Write a counter as well. In ns
+					counter.m_value = U64(record.m_duration * 1000000000.0);
+				}
+				else
+				{
+					counter.m_value = record.m_counterValue;
+				}
+			}
+
+			if(counterCount > 0)
+			{
+				callback(callbackUserData,
+					tlocal->m_tid,
+					WeakArray<TracerEvent>(&events[0], eventCount),
+					WeakArray<TracerCounter>(&counters[0], counterCount));
+			}
+
+			begin += count;
 		}
 
-		tlocal->m_currentChunk = nullptr;
+		tlocal->m_readCount = writtenCount;
 	}
+
+	m_lostRecordCount.fetchAdd(lostRecordCount);
 }
 
 } // end namespace anki
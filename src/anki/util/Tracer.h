@@ -9,7 +9,7 @@
 #include <anki/util/WeakArray.h>
 #include <anki/util/DynamicArray.h>
 #include <anki/util/Singleton.h>
-#include <anki/util/String.h>
+#include <anki/util/InternedString.h>
 
 namespace anki
 {
@@ -30,7 +30,7 @@ private:
 class TracerEvent
 {
 public:
-	CString m_name;
+	InternedString m_name;
 	Second m_start;
 	Second m_duration;
 
@@ -44,7 +44,7 @@ public:
 class TracerCounter
 {
 public:
-	CString m_name;
+	InternedString m_name;
 	U64 m_value;
 
 	TracerCounter()
@@ -58,10 +58,16 @@ public:
 using TracerFlushCallback = void (*)(
 	void* userData, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters);
 
-/// Tracer.
+/// Tracer. Every thread writes its events and counters to its own ring buffer without locking or allocating (besides
+/// the first time a thread writes something). When a ring buffer is full the oldest records are overwritten so the
+/// tracer can always stay enabled and keep a rolling window of the last records. flush() reads the records that were
+/// written since the previous flush.
 class Tracer : public NonCopyable
 {
 public:
+	/// The size of the rolling window of every thread. Power of two.
+	static constexpr U32 RECORDS_PER_THREAD = 16 * 1024;
+
 	Tracer(GenericMemoryPoolAllocator<U8> alloc)
 		: m_alloc(alloc)
 	{
@@ -74,21 +80,28 @@ public:
 	ANKI_USE_RESULT TracerEventHandle beginEvent();
 
 	/// End the event that got started with beginEvent().
-	/// @note It's thread-safe.
-	void endEvent(const char* eventName, TracerEventHandle event);
+	/// @note It's thread-safe and wait-free.
+	void endEvent(InternedString eventName, TracerEventHandle event);
 
 	/// Add a custom event.
-	/// @note It's thread-safe.
-	void addCustomEvent(const char* eventName, Second start, Second duration);
+	/// @note It's thread-safe and wait-free.
+	void addCustomEvent(InternedString eventName, Second start, Second duration);
 
 	/// Increment a counter.
-	/// @note It's thread-safe.
-	void incrementCounter(const char* counterName, U64 value);
+	/// @note It's thread-safe and wait-free.
+	void incrementCounter(InternedString counterName, U64 value);
 
-	/// Flush all counters and events and start clean. The callback will be called multiple times.
+	/// Flush all counters and events and start clean. The callback will be called multiple times. Every event also
+	/// gives a counter with its duration in ns.
 	/// @note It's thread-safe.
 	void flush(TracerFlushCallback callback, void* callbackUserData);
 
+	/// Get the number of records that got overwritten before a flush() could read them.
+	U64 getLostRecordCount() const
+	{
+		return m_lostRecordCount.load();
+	}
+
 	Bool getEnabled() const
 	{
 		return m_enabled;
@@ -100,11 +113,17 @@ public:
 	}
 
 private:
-	static constexpr U32 EVENTS_PER_CHUNK = 256;
-	static constexpr U32 COUNTERS_PER_CHUNK = 512;
+	/// The records that flush() processes at a time.
+	static constexpr U32 RECORDS_PER_FLUSH = 256;
 
+	enum class RecordType : U8
+	{
+		EVENT,
+		COUNTER
+	};
+
+	class Record;
 	class ThreadLocal;
-	class Chunk;
 
 	GenericMemoryPoolAllocator<U8> m_alloc;
 
@@ -112,14 +131,16 @@ private:
 	DynamicArray<ThreadLocal*> m_allThreadLocal; ///< The Tracer should know about all the ThreadLocal.
 	Mutex m_allThreadLocalMtx;
 
+	Atomic<U64> m_lostRecordCount = {0};
+
 	Bool m_enabled = false;
 
 	/// Get the thread local ThreadLocal structure.
 	/// @note Thread-safe.
 	ThreadLocal& getThreadLocal();
 
-	/// Get or create a new chunk.
-	Chunk& getOrCreateChunk(ThreadLocal& tlocal);
+	/// Write a record to the ring buffer of the thread.
+	void writeRecord(RecordType type, InternedString name, Second start, Second duration, U64 counterValue);
 };
 
 /// The global tracer.
@@ -129,7 +150,7 @@ using TracerSingleton = SingletonInit<Tracer>;
 class TracerScopedEvent
 {
 public:
-	TracerScopedEvent(const char* name)
+	TracerScopedEvent(InternedString name)
 		: m_name(name)
 		, m_tracer(&TracerSingleton::get())
 	{
@@ -142,16 +163,28 @@ public:
 	}
 
 private:
-	const char* m_name;
+	InternedString m_name;
 	TracerEventHandle m_handle;
 	Tracer* m_tracer;
 };
 
 #if ANKI_ENABLE_TRACE
-#	define ANKI_TRACE_SCOPED_EVENT(name_) TracerScopedEvent _tse##name_(#	name_)
+/// The names are interned once per call site.
+#	define ANKI_TRACE_SCOPED_EVENT(name_) \
+		static const InternedString _tseName##name_(#name_); \
+		TracerScopedEvent _tse##name_(_tseName##name_)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) \
-		TracerSingleton::get().addCustomEvent(#name_, start_, duration_)
-#	define ANKI_TRACE_INC_COUNTER(name_, val_) TracerSingleton::get().incrementCounter(#	name_, val_)
+		do \
+		{ \
+			static const InternedString _tceName(#name_); \
+			TracerSingleton::get().addCustomEvent(_tceName, start_, duration_); \
+		} while(false)
+#	define ANKI_TRACE_INC_COUNTER(name_, val_) \
+		do \
+		{ \
+			static const InternedString _ticName(#name_); \
+			TracerSingleton::get().incrementCounter(_ticName, val_); \
+		} while(false)
 #else
 #	define ANKI_TRACE_SCOPED_EVENT(name_) ((void)0)
 #	define ANKI_TRACE_CUSTOM_EVENT(name_, start_, duration_) ((void)0)
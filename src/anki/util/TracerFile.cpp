@@ -0,0 +1,308 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/TracerFile.h>
+#include <anki/util/Logger.h>
+
+namespace anki
+{
+
+static const char TRACER_FILE_MAGIC[8] = {'A', 'N', 'K', 'I', 'T', 'R', 'C', '1'};
+
+enum class TracerFileBlockType : U8
+{
+	NAME,
+	EVENTS
+};
+
+namespace
+{
+
+/// Reads the parts of a TracerFileWriter file that is in memory.
+class TracerFileReader
+{
+public:
+	const U8* m_ptr;
+	const U8* m_end;
+
+	Bool isAtEnd() const
+	{
+		return m_ptr == m_end;
+	}
+
+	ANKI_USE_RESULT Error readBytes(PtrSize size, const U8*& out)
+	{
+		if(PtrSize(m_end - m_ptr) < size)
+		{
+			ANKI_UTIL_LOGE("Tracer file is truncated");
+			return Error::USER_DATA;
+		}
+
+		out = m_ptr;
+		m_ptr += size;
+		return Error::NONE;
+	}
+
+	ANKI_USE_RESULT Error readVarint(U64& value)
+	{
+		value = 0;
+		for(U32 shift = 0; shift < 64; shift += 7)
+		{
+			const U8* byte;
+			ANKI_CHECK(readBytes(1, byte));
+			value |= U64(*byte & 0x7F) << shift;
+			if((*byte & 0x80) == 0)
+			{
+				return Error::NONE;
+			}
+		}
+
+		ANKI_UTIL_LOGE("Tracer file has a wrong varint");
+		return Error::USER_DATA;
+	}
+};
+
+/// A name in the memory of the file. It's not null terminated.
+class TracerFileName
+{
+public:
+	const char* m_ptr;
+	U32 m_length;
+};
+
+} // end anonymous namespace
+
+TracerFileWriter::~TracerFileWriter()
+{
+	if(m_file.isOpen())
+	{
+		const Error err = flush();
+		(void)err;
+	}
+
+	m_nameIndices.destroy(m_alloc);
+	m_buffer.destroy(m_alloc);
+}
+
+Error TracerFileWriter::open(GenericMemoryPoolAllocator<U8> alloc, CString filename)
+{
+	ANKI_ASSERT(!m_file.isOpen());
+	m_alloc = alloc;
+	ANKI_CHECK(m_file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	m_buffer.create(m_alloc, BUFFER_SIZE);
+	m_bufferPos = 0;
+
+	ANKI_CHECK(writeBytes(&TRACER_FILE_MAGIC[0], sizeof(TRACER_FILE_MAGIC)));
+	return Error::NONE;
+}
+
+Error TracerFileWriter::flush()
+{
+	ANKI_ASSERT(m_file.isOpen());
+	if(m_bufferPos > 0)
+	{
+		ANKI_CHECK(m_file.write(&m_buffer[0], m_bufferPos));
+		m_bufferPos = 0;
+	}
+
+	return Error::NONE;
+}
+
+Error TracerFileWriter::writeBytes(const void* data, PtrSize size)
+{
+	if(m_bufferPos + size > BUFFER_SIZE)
+	{
+		ANKI_CHECK(flush());
+	}
+
+	if(size > BUFFER_SIZE)
+	{
+		ANKI_CHECK(m_file.write(data, size));
+	}
+	else
+	{
+		memcpy(&m_buffer[m_bufferPos], data, size);
+		m_bufferPos += U32(size);
+	}
+
+	return Error::NONE;
+}
+
+Error TracerFileWriter::writeVarint(U64 value)
+{
+	Array<U8, 10> bytes;
+	U32 count = 0;
+	while(value >= 0x80)
+	{
+		bytes[count++] = U8(value | 0x80);
+		value >>= 7;
+	}
+	bytes[count++] = U8(value);
+
+	return writeBytes(&bytes[0], count);
+}
+
+Error TracerFileWriter::getOrWriteName(InternedString name, U32& index)
+{
+	const U32 id = name.getId();
+	if(id >= m_nameIndices.getSize())
+	{
+		m_nameIndices.resize(m_alloc, max(id + 1, m_nameIndices.getSize() * 2), MAX_U32);
+	}
+
+	if(m_nameIndices[id] != MAX_U32)
+	{
+		index = m_nameIndices[id];
+		return Error::NONE;
+	}
+
+	index = m_nameCount++;
+	m_nameIndices[id] = index;
+
+	const CString str = name.toCString();
+	const TracerFileBlockType type = TracerFileBlockType::NAME;
+	ANKI_CHECK(writeBytes(&type, sizeof(type)));
+	ANKI_CHECK(writeVarint(str.getLength()));
+	ANKI_CHECK(writeBytes(str.cstr(), str.getLength()));
+	return Error::NONE;
+}
+
+Error TracerFileWriter::writeEvents(ThreadId tid, ConstWeakArray<TracerEvent> events)
+{
+	ANKI_ASSERT(m_file.isOpen());
+	if(events.getSize() == 0)
+	{
+		return Error::NONE;
+	}
+
+	// Write the new names first because they can't be in the middle of the events
+	for(const TracerEvent& event : events)
+	{
+		U32 nameIndex;
+		ANKI_CHECK(getOrWriteName(event.m_name, nameIndex));
+	}
+
+	const TracerFileBlockType type = TracerFileBlockType::EVENTS;
+	ANKI_CHECK(writeBytes(&type, sizeof(type)));
+	ANKI_CHECK(writeVarint(tid));
+	ANKI_CHECK(writeVarint(events.getSize()));
+
+	I64 prevStart = 0;
+	for(const TracerEvent& event : events)
+	{
+		const I64 start = I64(event.m_start * 1000000000.0);
+		const U64 duration = U64(event.m_duration * 1000000000.0);
+
+		// The events are usually sorted so the deltas are small but they can be negative
+		const I64 delta = start - prevStart;
+		prevStart = start;
+
+		ANKI_CHECK(writeVarint(m_nameIndices[event.m_name.getId()]));
+		ANKI_CHECK(writeVarint((U64(delta) << 1) ^ U64(delta >> 63)));
+		ANKI_CHECK(writeVarint(duration));
+	}
+
+	return Error::NONE;
+}
+
+Error convertTracerFileToJson(CString tracerFilename, CString jsonFilename, GenericMemoryPoolAllocator<U8> alloc)
+{
+	// Read the whole file
+	DynamicArrayAuto<U8, PtrSize> data(alloc);
+	{
+		File file;
+		ANKI_CHECK(file.open(tracerFilename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+		if(file.getSize() < sizeof(TRACER_FILE_MAGIC))
+		{
+			ANKI_UTIL_LOGE("Tracer file is too small: %s", tracerFilename.cstr());
+			return Error::USER_DATA;
+		}
+
+		data.create(file.getSize());
+		ANKI_CHECK(file.read(&data[0], data.getSize()));
+	}
+
+	TracerFileReader reader;
+	reader.m_ptr = data.getBegin();
+	reader.m_end = data.getEnd();
+
+	const U8* magic;
+	ANKI_CHECK(reader.readBytes(sizeof(TRACER_FILE_MAGIC), magic));
+	if(memcmp(magic, &TRACER_FILE_MAGIC[0], sizeof(TRACER_FILE_MAGIC)) != 0)
+	{
+		ANKI_UTIL_LOGE("Wrong tracer file magic: %s", tracerFilename.cstr());
+		return Error::USER_DATA;
+	}
+
+	File json;
+	ANKI_CHECK(json.open(jsonFilename, FileOpenFlag::WRITE));
+	ANKI_CHECK(json.writeText("[\n"));
+
+	DynamicArrayAuto<TracerFileName> names(alloc);
+	Bool firstEvent = true;
+	while(!reader.isAtEnd())
+	{
+		const U8* type;
+		ANKI_CHECK(reader.readBytes(1, type));
+
+		if(*type == U8(TracerFileBlockType::NAME))
+		{
+			U64 length;
+			ANKI_CHECK(reader.readVarint(length));
+			const U8* chars;
+			ANKI_CHECK(reader.readBytes(length, chars));
+
+			TracerFileName name;
+			name.m_ptr = reinterpret_cast<const char*>(chars);
+			name.m_length = U32(length);
+			names.emplaceBack(name);
+		}
+		else if(*type == U8(TracerFileBlockType::EVENTS))
+		{
+			U64 tid, count;
+			ANKI_CHECK(reader.readVarint(tid));
+			ANKI_CHECK(reader.readVarint(count));
+
+			I64 start = 0;
+			for(U64 i = 0; i < count; ++i)
+			{
+				U64 nameIndex, delta, duration;
+				ANKI_CHECK(reader.readVarint(nameIndex));
+				ANKI_CHECK(reader.readVarint(delta));
+				ANKI_CHECK(reader.readVarint(duration));
+
+				if(nameIndex >= names.getSize())
+				{
+					ANKI_UTIL_LOGE("Tracer file has a wrong name index");
+					return Error::USER_DATA;
+				}
+
+				start += I64((delta >> 1) ^ (~(delta & 1) + 1));
+				const TracerFileName& name = names[U32(nameIndex)];
+
+				// The times are in microseconds
+				ANKI_CHECK(json.writeText("%s{\"name\": \"%.*s\", \"cat\": \"PERF\", \"ph\": \"X\", \"pid\": 1, "
+										  "\"tid\": %llu, \"ts\": %.3f, \"dur\": %.3f}",
+					(firstEvent) ? "" : ",\n",
+					I32(name.m_length),
+					name.m_ptr,
+					tid,
+					F64(start) / 1000.0,
+					F64(duration) / 1000.0));
+				firstEvent = false;
+			}
+		}
+		else
+		{
+			ANKI_UTIL_LOGE("Tracer file has a wrong block type");
+			return Error::USER_DATA;
+		}
+	}
+
+	ANKI_CHECK(json.writeText("\n]\n"));
+	return Error::NONE;
+}
+
+} // end namespace anki
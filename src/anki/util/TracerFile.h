@@ -0,0 +1,69 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/Tracer.h>
+#include <anki/util/File.h>
+
+namespace anki
+{
+
+/// @addtogroup util_other
+/// @{
+
+/// Writes the events of the Tracer to a compact binary file. Every name is written once and then referenced by its
+/// index. The times are in ns and they are written as deltas from the previous event of the same block using variable
+/// length integers. Format:
+/// @code
+/// "ANKITRC1"
+/// Then a number of blocks that start with a U8 type:
+/// NAME:   varint length, the characters. The name gets the next name index
+/// EVENTS: varint thread ID, varint event count and then for every event:
+///         varint name index, zigzag varint start delta from the previous event, varint duration
+/// @endcode
+/// Use convertTracerFileToJson() or the trace_converter tool to view it.
+class TracerFileWriter : public NonCopyable
+{
+public:
+	TracerFileWriter() = default;
+
+	~TracerFileWriter();
+
+	ANKI_USE_RESULT Error open(GenericMemoryPoolAllocator<U8> alloc, CString filename);
+
+	Bool isOpen() const
+	{
+		return m_file.isOpen();
+	}
+
+	/// Write the events of a thread.
+	ANKI_USE_RESULT Error writeEvents(ThreadId tid, ConstWeakArray<TracerEvent> events);
+
+	/// Write to the file what is buffered.
+	ANKI_USE_RESULT Error flush();
+
+private:
+	static constexpr U32 BUFFER_SIZE = 64 * 1024;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	File m_file;
+	DynamicArray<U32> m_nameIndices; ///< Maps the IDs of the interned names to the indices of the file.
+	U32 m_nameCount = 0;
+	DynamicArray<U8> m_buffer;
+	U32 m_bufferPos = 0;
+
+	ANKI_USE_RESULT Error writeBytes(const void* data, PtrSize size);
+	ANKI_USE_RESULT Error writeVarint(U64 value);
+	ANKI_USE_RESULT Error getOrWriteName(InternedString name, U32& index);
+};
+
+/// Convert a file written by TracerFileWriter to the Chrome trace JSON format. chrome://tracing and Perfetto can open
+/// it.
+ANKI_USE_RESULT Error convertTracerFileToJson(
+	CString tracerFilename, CString jsonFilename, GenericMemoryPoolAllocator<U8> alloc);
+/// @}
+
+} // end namespace anki
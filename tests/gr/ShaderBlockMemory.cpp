@@ -0,0 +1,72 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/gr/utils/Functions.h>
+
+ANKI_TEST(Gr, ShaderBlockMemoryRanges)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// A std140 block: vec3 at 0, float at 12, mat3 at 16, vec4 at 64, mat4[2] at 80 (a builtin)
+	ShaderVariableBlockInfo vec3Info;
+	vec3Info.m_offset = 0;
+	vec3Info.m_arraySize = 1;
+	ShaderVariableBlockInfo floatInfo;
+	floatInfo.m_offset = 12;
+	floatInfo.m_arraySize = 1;
+	ShaderVariableBlockInfo mat3Info;
+	mat3Info.m_offset = 16;
+	mat3Info.m_arraySize = 1;
+	mat3Info.m_matrixStride = 16;
+	ShaderVariableBlockInfo vec4Info;
+	vec4Info.m_offset = 64;
+	vec4Info.m_arraySize = 1;
+	ShaderVariableBlockInfo mat4Info;
+	mat4Info.m_offset = 80;
+	mat4Info.m_arraySize = 2;
+	mat4Info.m_arrayStride = 64;
+	mat4Info.m_matrixStride = 16;
+
+	DynamicArrayAuto<ShaderBlockMemoryRange> builtinRanges(alloc);
+	getShaderBlockMemoryRanges(ShaderVariableDataType::MAT4, mat4Info, 2, builtinRanges);
+	ANKI_TEST_EXPECT_EQ(builtinRanges.getSize(), 8);
+	ANKI_TEST_EXPECT_EQ(builtinRanges[7].m_offset, 80 + 64 + 48);
+
+	// The mat3 rows have padding between them. It should be merged with the rest
+	DynamicArrayAuto<ShaderBlockMemoryRange> ranges(alloc);
+	getShaderBlockMemoryRanges(ShaderVariableDataType::VEC4, vec4Info, 1, ranges);
+	getShaderBlockMemoryRanges(ShaderVariableDataType::MAT3, mat3Info, 1, ranges);
+	getShaderBlockMemoryRanges(ShaderVariableDataType::FLOAT, floatInfo, 1, ranges);
+	getShaderBlockMemoryRanges(ShaderVariableDataType::VEC3, vec3Info, 1, ranges);
+	ANKI_TEST_EXPECT_EQ(ranges.getSize(), 6);
+
+	mergeShaderBlockMemoryRanges(ranges, builtinRanges);
+	ANKI_TEST_EXPECT_EQ(ranges.getSize(), 1);
+	ANKI_TEST_EXPECT_EQ(ranges[0].m_offset, 0);
+	ANKI_TEST_EXPECT_EQ(ranges[0].m_size, 80);
+
+	// Now the vec4 is after the builtin. It shouldn't be merged
+	vec4Info.m_offset = 80 + 128;
+	ranges.destroy();
+	getShaderBlockMemoryRanges(ShaderVariableDataType::VEC3, vec3Info, 1, ranges);
+	getShaderBlockMemoryRanges(ShaderVariableDataType::VEC4, vec4Info, 1, ranges);
+	mergeShaderBlockMemoryRanges(ranges, builtinRanges);
+	ANKI_TEST_EXPECT_EQ(ranges.getSize(), 2);
+	ANKI_TEST_EXPECT_EQ(ranges[1].m_offset, 80 + 128);
+
+	// Copy
+	Array<U8, 256> src;
+	Array<U8, 256> dst;
+	for(U32 i = 0; i < src.getSize(); ++i)
+	{
+		src[i] = U8(i);
+	}
+	memset(&dst[0], 0, sizeof(dst));
+	copyShaderBlockMemoryRanges(ranges, &src[0], &dst[0], &dst[0] + dst.getSize());
+	ANKI_TEST_EXPECT_EQ(dst[11], 11);
+	ANKI_TEST_EXPECT_EQ(dst[12], 0);
+	ANKI_TEST_EXPECT_EQ(dst[80 + 128 + 15], 80 + 128 + 15);
+}
@@ -390,3 +390,28 @@ ANKI_TEST(Math, Mat3x4)
 		ANKI_TEST_EXPECT_EQ(m * v, Vec3(20, 44, 68));
 	}
 }
+
+ANKI_TEST(Math, Octahedral)
+{
+	const Array<Vec3, 8> vecs = {{Vec3(1.0f, 0.0f, 0.0f),
+		Vec3(0.0f, -1.0f, 0.0f),
+		Vec3(0.0f, 0.0f, 1.0f),
+		Vec3(0.0f, 0.0f, -1.0f),
+		Vec3(1.0f, 2.0f, 3.0f).getNormalized(),
+		Vec3(-1.0f, 2.0f, -3.0f).getNormalized(),
+		Vec3(0.5f, -0.1f, -0.9f).getNormalized(),
+		Vec3(-0.3f, -0.3f, 0.2f).getNormalized()}};
+
+	for(const Vec3& vec : vecs)
+	{
+		const Vec2 oct = packUnitVectorToOctahedral(vec);
+		ANKI_TEST_EXPECT_LEQ(absolute(oct.x()), 1.0f);
+		ANKI_TEST_EXPECT_LEQ(absolute(oct.y()), 1.0f);
+
+		const Vec3 vec2 = unpackOctahedralToUnitVector<Vec3>(oct);
+		for(U32 i = 0; i < 3; ++i)
+		{
+			ANKI_TEST_EXPECT_NEAR(vec[i], vec2[i], 0.0001f);
+		}
+	}
+}
@@ -0,0 +1,100 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "anki/resource/ResourceBinaryConverter.h"
+#include "anki/util/Xml.h"
+#include "anki/util/File.h"
+
+namespace anki
+{
+
+ANKI_TEST(Resource, ResourceBinary)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StackAllocator<U8> binaryAlloc(allocAligned, nullptr, 1_KB);
+
+	const CString skeletonXml = R"(<skeleton><bones>
+		<bone><name>root</name>
+			<transform>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</transform>
+			<boneTransform>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</boneTransform></bone>
+		<bone><name>child</name>
+			<transform>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 2</transform>
+			<boneTransform>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 3</boneTransform>
+			<parent>root</parent></bone>
+	</bones></skeleton>)";
+
+	// Convert
+	SkeletonBinary* binary = nullptr;
+	{
+		XmlDocument xml;
+		ANKI_TEST_EXPECT_NO_ERR(xml.parse(skeletonXml, alloc));
+		ANKI_TEST_EXPECT_NO_ERR(convertResourceXml(xml, 123, binaryAlloc, binary));
+	}
+
+	ANKI_TEST_EXPECT_EQ(binary->m_sourceHash, 123);
+	ANKI_TEST_EXPECT_EQ(binary->m_bones.getSize(), 2);
+	ANKI_TEST_EXPECT_EQ(CString(&binary->m_bones[1].m_name[0]), "child");
+	ANKI_TEST_EXPECT_EQ(binary->m_bones[0].m_parent, MAX_U32);
+	ANKI_TEST_EXPECT_EQ(binary->m_bones[1].m_parent, 0);
+	ANKI_TEST_EXPECT_EQ(binary->m_bones[1].m_vertexTransform[15], 3.0f);
+
+	// Serialize and deserialize
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("test.ankiskelbin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(*binary, alloc, file));
+	}
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("test.ankiskelbin", FileOpenFlag::READ | FileOpenFlag::BINARY));
+		SkeletonBinary* binary2 = nullptr;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserialize(binary2, alloc, file));
+
+		ANKI_TEST_EXPECT_EQ(memcmp(&binary2->m_magic[0], ResourceBinaryTraits<SkeletonBinary>::MAGIC, 8), 0);
+		ANKI_TEST_EXPECT_EQ(binary2->m_bones.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(CString(&binary2->m_bones[0].m_name[0]), "root");
+		ANKI_TEST_EXPECT_EQ(binary2->m_bones[1].m_parent, 0);
+		ANKI_TEST_EXPECT_EQ(binary2->m_bones[1].m_transform[15], 2.0f);
+
+		alloc.deleteInstance(binary2);
+	}
+
+	// A skeleton without a root should fail
+	{
+		XmlDocument xml;
+		ANKI_TEST_EXPECT_NO_ERR(xml.parse(R"(<skeleton><bones><bone><name>a</name>
+			<transform>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</transform>
+			<boneTransform>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</boneTransform>
+			<parent>b</parent></bone></bones></skeleton>)",
+			alloc));
+		SkeletonBinary* badBinary = nullptr;
+		ANKI_TEST_EXPECT_ERR(convertResourceXml(xml, 0, binaryAlloc, badBinary), Error::USER_DATA);
+	}
+
+	// Animation
+	{
+		XmlDocument xml;
+		ANKI_TEST_EXPECT_NO_ERR(xml.parse(R"(<animation><channels><channel><name>ch</name>
+			<positionKeys><key><time>0.5</time><value>1 2 3</value></key></positionKeys>
+			<rotationKeys><key><time>1.0</time><value>0 0 0 1</value></key>
+				<key><time>2.0</time><value>0 1 0 0</value></key></rotationKeys>
+			</channel></channels></animation>)",
+			alloc));
+		AnimationBinary* anim = nullptr;
+		ANKI_TEST_EXPECT_NO_ERR(convertResourceXml(xml, 0, binaryAlloc, anim));
+		ANKI_TEST_EXPECT_EQ(anim->m_channels.getSize(), 1);
+		const AnimationBinaryChannel& ch = anim->m_channels[0];
+		ANKI_TEST_EXPECT_EQ(ch.m_positionKeys.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(ch.m_positionKeys[0].m_value[2], 3.0f);
+		ANKI_TEST_EXPECT_EQ(ch.m_rotationKeys.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(ch.m_rotationKeys[1].m_time, 2.0);
+		ANKI_TEST_EXPECT_EQ(ch.m_scaleKeys.getSize(), 0);
+	}
+}
+
+} // end namespace anki
@@ -5,6 +5,9 @@
 
 #include "tests/framework/Framework.h"
 #include "anki/resource/ResourceFilesystem.h"
+#include "anki/resource/ResourceLoadPlan.h"
+#include "anki/util/Filesystem.h"
+#include "anki/util/ThreadPool.h"
 
 namespace anki
 {
@@ -33,6 +36,191 @@ ANKI_TEST(Resource, ResourceFilesystem)
 		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
 		ANKI_TEST_EXPECT_EQ(txt, "hell\n");
 	}
+
+	{
+		ANKI_TEST_EXPECT_NO_ERR(createResourcePack("data/dir", "./dir.ankipak", true, alloc));
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./dir.ankipak"));
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir0/hello.txt", file));
+		StringAuto txt(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+		ANKI_TEST_EXPECT_EQ(txt, "hello\n");
+	}
+}
+
+ANKI_TEST(Resource, ResourcePack)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Create a file that spans a few compression blocks
+	const U32 count = U32(ResourcePackBinary::BLOCK_SIZE * 17 / 2 / sizeof(U32));
+	ANKI_TEST_EXPECT_NO_ERR(createDirectory("pack_test"));
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("pack_test/big.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		for(U32 i = 0; i < count; ++i)
+		{
+			const U32 value = i % 1000;
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&value, sizeof(value)));
+		}
+	}
+
+	// Empty files are skipped
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("pack_test/empty.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(createResourcePack("pack_test", "./pack_test.ankipak", true, alloc));
+	ANKI_TEST_EXPECT_NO_ERR(removeDirectory("pack_test", alloc));
+
+	ResourceFilesystem fs(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./pack_test.ankipak"));
+	fs.m_packThreadPool = alloc.newInstance<ThreadPool>(4u);
+
+	ResourceFilePtr file;
+	ANKI_TEST_EXPECT_NO_ERR(fs.openFile("big.bin", file));
+	ANKI_TEST_EXPECT_EQ(file->getSize(), count * sizeof(U32));
+
+	// Read all
+	DynamicArrayAuto<U32> values(alloc, count);
+	ANKI_TEST_EXPECT_NO_ERR(file->read(&values[0], values.getSizeInBytes()));
+	for(U32 i = 0; i < count; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(values[i], i % 1000);
+	}
+
+	// Random access
+	const U32 idx = count - 10;
+	ANKI_TEST_EXPECT_NO_ERR(file->seek(idx * sizeof(U32), FileSeekOrigin::BEGINNING));
+	U32 value;
+	ANKI_TEST_EXPECT_NO_ERR(file->readU32(value));
+	ANKI_TEST_EXPECT_EQ(value, idx % 1000);
+	ANKI_TEST_EXPECT_ANY_ERR(file->seek(100, FileSeekOrigin::END));
+
+	ANKI_TEST_EXPECT_ANY_ERR(fs.openFile("empty.bin", file));
+}
+
+ANKI_TEST(Resource, ResourceFilesystemZipSeek)
+{
+	printf("Test requires the data dir\n");
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ResourceFilesystem fs(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./data/big.ankizip"));
+
+	// The file contains U32 values i % 1000 and it's large enough to have a few inflate checkpoints
+	ResourceFilePtr file;
+	ANKI_TEST_EXPECT_NO_ERR(fs.openFile("big.bin", file));
+	const U32 count = U32(file->getSize() / sizeof(U32));
+	ANKI_TEST_EXPECT_GT(count, 0);
+
+	const Array<U32, 6> indices = {{count - 1, 10, count / 2, count / 2 + 1, 0, count / 3}};
+	for(U32 idx : indices)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(idx * sizeof(U32), FileSeekOrigin::BEGINNING));
+		U32 value;
+		ANKI_TEST_EXPECT_NO_ERR(file->readU32(value));
+		ANKI_TEST_EXPECT_EQ(value, idx % 1000);
+	}
+
+	// The handle goes back to the pool and gets reused
+	file.reset(nullptr);
+	ANKI_TEST_EXPECT_NO_ERR(fs.openFile("big.bin", file));
+	DynamicArrayAuto<U32> values(alloc, count);
+	ANKI_TEST_EXPECT_NO_ERR(file->read(&values[0], values.getSizeInBytes()));
+	for(U32 i = 0; i < count; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(values[i], i % 1000);
+	}
+}
+
+ANKI_TEST(Resource, ResourceFilesystemPrefetch)
+{
+	printf("Test requires the data dir\n");
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ResourceFilesystem fs(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("data/dir/"));
+	fs.m_prefetchThreadCount = 2;
+	fs.m_prefetchMemoryBudget = 1; // Smaller than any file so the threads read one file at a time
+
+	// Record
+	StringListAuto filenames(alloc);
+	fs.setOpenFileCallback(
+		[](CString filename, void* userData) {
+			static_cast<StringListAuto*>(userData)->pushBackSprintf("%s", filename.cstr());
+		},
+		&filenames);
+	{
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir0/hello.txt", file));
+		fs.setOpenFileCallback(nullptr, nullptr);
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir0/hello.txt", file));
+	}
+	ANKI_TEST_EXPECT_EQ(filenames.getSize(), 1);
+	ANKI_TEST_EXPECT_EQ(filenames.getFront(), "subdir0/hello.txt");
+
+	// Save and load a plan
+	ResourceLoadPlan plan(alloc);
+	const U32 root = plan.addResource("a.ankimtl", MAX_U32);
+	const U32 child = plan.addResource("b.ankiprog", root);
+	plan.addFile("subdir1/subdir2/file.txt", MAX_U32);
+	plan.addFile("subdir0/hello.txt", child);
+	plan.addFile("subdir0/hello.txt", root);
+	ANKI_TEST_EXPECT_EQ(plan.getFileCount(), 2);
+	plan.sortFiles();
+	ANKI_TEST_EXPECT_EQ(plan.getFileFilename(0), "subdir0/hello.txt");
+	ANKI_TEST_EXPECT_EQ(plan.getFileResource(0), child);
+	ANKI_TEST_EXPECT_EQ(plan.getFileResource(1), MAX_U32);
+	for(U32 i = 0; i < plan.getFileCount(); ++i)
+	{
+		U64 timestamp;
+		ANKI_TEST_EXPECT_NO_ERR(fs.getFileTimestamp(plan.getFileFilename(i), timestamp));
+		plan.setFileTimestamp(i, timestamp);
+	}
+	ANKI_TEST_EXPECT_NO_ERR(plan.save("./test.ankiloadplan"));
+
+	ResourceLoadPlan plan2(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(plan2.load("./test.ankiloadplan"));
+	ANKI_TEST_EXPECT_EQ(plan == plan2, true);
+	ANKI_TEST_EXPECT_EQ(plan2.getResourceParent(1), root);
+	ANKI_TEST_EXPECT_EQ(plan2.getResourceFilename(1), "b.ankiprog");
+	ANKI_TEST_EXPECT_EQ(plan2.getFileResource(0), child);
+
+	// A level that loads nothing has a valid plan
+	{
+		ResourceLoadPlan empty(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(empty.save("./test_empty.ankiloadplan"));
+		ResourceLoadPlan empty2(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(empty2.load("./test_empty.ankiloadplan"));
+		ANKI_TEST_EXPECT_EQ(empty == empty2, true);
+	}
+
+	// Prefetch and read from memory
+	Array<CString, 2> prefetch = {{plan2.getFileFilename(0), plan2.getFileFilename(1)}};
+	fs.prefetchFiles(prefetch);
+	{
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir0/hello.txt", file));
+		StringAuto txt(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+		ANKI_TEST_EXPECT_EQ(txt, "hello\n");
+
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir1/subdir2/file.txt", file));
+		StringAuto txt2(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt2));
+		ANKI_TEST_EXPECT_EQ(txt2, "123\n");
+
+		ANKI_TEST_EXPECT_EQ(fs.m_prefetchedFiles.isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(fs.m_prefetchedBytes, 0);
+	}
+	fs.dropPrefetchedFiles();
+
+	// Drop files that no one opened
+	fs.prefetchFiles(prefetch);
+	fs.dropPrefetchedFiles();
+	ANKI_TEST_EXPECT_EQ(fs.m_prefetchedFiles.isEmpty(), true);
 }
 
 } // end namespace anki
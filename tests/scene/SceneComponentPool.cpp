@@ -0,0 +1,174 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SceneComponentPool.h>
+#include <vector>
+
+namespace anki
+{
+
+class SceneComponentPoolTestComponent : public SceneComponent
+{
+public:
+	U32 m_value;
+	U32 m_updateCount = 0;
+
+	SceneComponentPoolTestComponent(U32 value)
+		: SceneComponent(SceneComponentType::NONE)
+		, m_value(value)
+	{
+	}
+
+	ANKI_USE_RESULT Error update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated) override
+	{
+		++m_updateCount;
+		updated = true;
+		return Error::NONE;
+	}
+};
+
+ANKI_TEST(Scene, SceneComponentPool)
+{
+	SceneAllocator<U8> alloc(allocAligned, nullptr);
+	const SceneComponentClassInfo& classInfo = SceneComponentClassInfo::get<SceneComponentPoolTestComponent>();
+	ANKI_TEST_EXPECT_EQ(&classInfo, &SceneComponentClassInfo::get<SceneComponentPoolTestComponent>());
+	ANKI_TEST_EXPECT_EQ(classInfo.m_componentSize, sizeof(SceneComponentPoolTestComponent));
+
+	SceneComponentPool pool(classInfo);
+	SceneNode* node = reinterpret_cast<SceneNode*>(&pool); // Only stored, never dereferenced
+
+	// The chunks fit in the slabs
+	const U32 perChunk = pool.getComponentsPerChunk();
+	ANKI_TEST_EXPECT_GT(perChunk, 1);
+	ANKI_TEST_EXPECT_LEQ(perChunk * classInfo.m_componentSize, SlabMemoryPool::MAX_SLAB_ALLOCATION_SIZE);
+
+	// Allocate more than a chunk
+	const U32 count = perChunk * 2 + perChunk / 2;
+	std::vector<SceneComponentPoolTestComponent*> comps;
+	for(U32 i = 0; i < count; ++i)
+	{
+		U32 poolIndex;
+		void* mem = pool.allocate(alloc, poolIndex);
+		ANKI_TEST_EXPECT_EQ(poolIndex, i);
+		ANKI_TEST_EXPECT_EQ(PtrSize(mem) % classInfo.m_componentAlignment, 0);
+
+		SceneComponentPoolTestComponent* comp = ::new(mem) SceneComponentPoolTestComponent(i);
+		pool.initComponent(*comp, *node, poolIndex);
+		comps.push_back(comp);
+	}
+
+	ANKI_TEST_EXPECT_EQ(pool.getChunkCount(), 3);
+	ANKI_TEST_EXPECT_EQ(pool.getComponentCount(), count);
+
+	// Delete some and re-use their slots
+	const U32 deletedIdx = perChunk + 1;
+	pool.deleteComponent(alloc, *comps[0]);
+	pool.deleteComponent(alloc, *comps[deletedIdx]);
+	ANKI_TEST_EXPECT_EQ(pool.getComponentCount(), count - 2);
+
+	U32 poolIndex;
+	void* mem = pool.allocate(alloc, poolIndex);
+	ANKI_TEST_EXPECT_EQ(poolIndex, 0);
+	ANKI_TEST_EXPECT_EQ(mem, static_cast<void*>(comps[0]));
+	comps[0] = ::new(mem) SceneComponentPoolTestComponent(0);
+	pool.initComponent(*comps[0], *node, poolIndex);
+
+	// The rest didn't move
+	for(U32 i = 0; i < count; ++i)
+	{
+		if(i != deletedIdx)
+		{
+			ANKI_TEST_EXPECT_EQ(comps[i]->m_value, i);
+		}
+	}
+
+	// Update all of them through the class info
+	U32 iterated = 0;
+	ANKI_TEST_EXPECT_NO_ERR(pool.iterateComponents([&](SceneComponent& comp) -> Error {
+		Bool updated = false;
+		ANKI_CHECK(pool.getClassInfo().m_updateCallback(comp, comp.getSceneNode(), 0.0, 1.0, updated));
+		ANKI_TEST_EXPECT_EQ(updated, true);
+		++iterated;
+		return Error::NONE;
+	}));
+	ANKI_TEST_EXPECT_EQ(iterated, count - 1);
+
+	// Empty the middle chunk. It keeps its index because the components of the last chunk refer to it
+	for(U32 i = perChunk; i < perChunk * 2; ++i)
+	{
+		if(i != deletedIdx)
+		{
+			pool.deleteComponent(alloc, *comps[i]);
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(pool.getChunkCount(), 3);
+	ANKI_TEST_EXPECT_EQ(pool.getComponentCount(), count - perChunk);
+
+	iterated = 0;
+	ANKI_TEST_EXPECT_NO_ERR(pool.iterateComponents([&](SceneComponent& comp) -> Error {
+		ANKI_TEST_EXPECT_EQ(static_cast<SceneComponentPoolTestComponent&>(comp).m_updateCount, 1);
+		++iterated;
+		return Error::NONE;
+	}));
+	ANKI_TEST_EXPECT_EQ(iterated, count - perChunk);
+
+	// Its slots are the first to be reused
+	mem = pool.allocate(alloc, poolIndex);
+	ANKI_TEST_EXPECT_EQ(poolIndex, perChunk);
+	comps[perChunk] = ::new(mem) SceneComponentPoolTestComponent(perChunk);
+	pool.initComponent(*comps[perChunk], *node, poolIndex);
+	pool.deleteComponent(alloc, *comps[perChunk]);
+
+	// Emptying the last chunks releases them
+	for(U32 i = perChunk * 2; i < count; ++i)
+	{
+		pool.deleteComponent(alloc, *comps[i]);
+	}
+
+	ANKI_TEST_EXPECT_EQ(pool.getChunkCount(), 1);
+
+	for(U32 i = 0; i < perChunk; ++i)
+	{
+		pool.deleteComponent(alloc, *comps[i]);
+	}
+
+	ANKI_TEST_EXPECT_EQ(pool.getComponentCount(), 0);
+	ANKI_TEST_EXPECT_EQ(pool.getChunkCount(), 0);
+	pool.destroy(alloc);
+}
+
+ANKI_TEST(Scene, SceneComponentUpdateStage)
+{
+	// Every type has its own stage
+	for(U32 i = 1; i < U32(SceneComponentType::COUNT); ++i)
+	{
+		const U32 stage = getSceneComponentUpdateStage(SceneComponentType(i));
+		ANKI_TEST_EXPECT_LT(stage, SCENE_COMPONENT_UPDATE_STAGE_COUNT);
+		ANKI_TEST_EXPECT_EQ(stage & 1, 1);
+
+		for(U32 j = 1; j < i; ++j)
+		{
+			ANKI_TEST_EXPECT_NEQ(stage, getSceneComponentUpdateStage(SceneComponentType(j)));
+		}
+	}
+
+	// The moves are before the spatials and the spatials before the renderables
+	ANKI_TEST_EXPECT_LT(getSceneComponentUpdateStage(SceneComponentType::BODY),
+		getSceneComponentUpdateStage(SceneComponentType::MOVE));
+	ANKI_TEST_EXPECT_LT(getSceneComponentUpdateStage(SceneComponentType::MOVE),
+		getSceneComponentUpdateStage(SceneComponentType::SPATIAL));
+	ANKI_TEST_EXPECT_LT(getSceneComponentUpdateStage(SceneComponentType::SPATIAL),
+		getSceneComponentUpdateStage(SceneComponentType::RENDER));
+
+	// Feedback components
+	const U32 moveStage = getSceneComponentUpdateStage(SceneComponentType::MOVE);
+	ANKI_TEST_EXPECT_EQ(computeSceneComponentUpdateStage(SceneComponentType::NONE, MAX_U32), 0);
+	ANKI_TEST_EXPECT_EQ(computeSceneComponentUpdateStage(SceneComponentType::NONE, moveStage), moveStage + 1);
+	ANKI_TEST_EXPECT_EQ(computeSceneComponentUpdateStage(SceneComponentType::MOVE, MAX_U32), moveStage);
+}
+
+} // end namespace anki
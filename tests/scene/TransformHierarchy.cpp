@@ -0,0 +1,124 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/TransformHierarchy.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+static Transform translation(F32 x, F32 y, F32 z)
+{
+	return Transform(Vec4(x, y, z, 0.0f), Mat3x4::getIdentity(), 1.0f);
+}
+
+ANKI_TEST(Scene, TransformHierarchy)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc);
+	TransformHierarchy hierarchy(SceneAllocator<U8>(allocAligned, nullptr));
+
+	// Root -> middle -> leaves. More leaves than a task batch so the level is split across the threads
+	const U32 leafCount = 300;
+	MoveComponent root;
+	MoveComponent middle;
+	Array<MoveComponent, leafCount> leaves;
+	MoveComponent other;
+
+	hierarchy.addComponent(root, nullptr);
+	hierarchy.addComponent(middle, &root);
+	for(MoveComponent& leaf : leaves)
+	{
+		hierarchy.addComponent(leaf, &middle);
+	}
+	hierarchy.addComponent(other, nullptr);
+
+	ANKI_TEST_EXPECT_EQ(hierarchy.getComponentCount(), leafCount + 3);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getLevelCount(), 3);
+
+	// Multi-level propagation
+	root.setLocalTransform(translation(1.0f, 0.0f, 0.0f));
+	middle.setLocalTransform(translation(0.0f, 2.0f, 0.0f));
+	for(U32 i = 0; i < leafCount; ++i)
+	{
+		leaves[i].setLocalTransform(translation(0.0f, 0.0f, F32(i)));
+	}
+	other.setLocalTransform(translation(5.0f, 5.0f, 5.0f));
+
+	ANKI_TEST_EXPECT_NO_ERR(hierarchy.update(hive));
+
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(root), true);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(middle).getOrigin(), Vec4(1.0f, 2.0f, 0.0f, 0.0f));
+	for(U32 i = 0; i < leafCount; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(leaves[i]), true);
+		ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(leaves[i]).getOrigin(), Vec4(1.0f, 2.0f, F32(i), 0.0f));
+	}
+
+	// Nothing moved
+	ANKI_TEST_EXPECT_NO_ERR(hierarchy.update(hive));
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(root), false);
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(leaves[0]), false);
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(other), false);
+
+	// Moving the middle dirties its subtree only
+	middle.setLocalTransform(translation(0.0f, 3.0f, 0.0f));
+	ANKI_TEST_EXPECT_NO_ERR(hierarchy.update(hive));
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(root), false);
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(other), false);
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(middle), true);
+	for(U32 i = 0; i < leafCount; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(leaves[i]), true);
+		ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(leaves[i]).getOrigin(), Vec4(1.0f, 3.0f, F32(i), 0.0f));
+	}
+
+	// Reparent the middle under the other root. The leaves move down a level with it
+	hierarchy.setParent(middle, &other);
+	hierarchy.setParent(other, &root);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getLevelCount(), 4);
+	ANKI_TEST_EXPECT_NO_ERR(hierarchy.update(hive));
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(root), false);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(other).getOrigin(), Vec4(6.0f, 5.0f, 5.0f, 0.0f));
+	ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(middle).getOrigin(), Vec4(6.0f, 8.0f, 5.0f, 0.0f));
+	for(U32 i = 0; i < leafCount; ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(leaves[i]).getOrigin(), Vec4(6.0f, 8.0f, 5.0f + F32(i), 0.0f));
+	}
+
+	// Remove some leaves from the middle of the level. The rest keep their transforms
+	hierarchy.removeComponent(leaves[0]);
+	hierarchy.removeComponent(leaves[leafCount / 2]);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getComponentCount(), leafCount + 1);
+	ANKI_TEST_EXPECT_NO_ERR(hierarchy.update(hive));
+	ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(leaves[leafCount - 1]).getOrigin(),
+		Vec4(6.0f, 8.0f, 5.0f + F32(leafCount - 1), 0.0f));
+
+	// Removing a component turns its children into roots
+	hierarchy.removeComponent(other);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getLevelCount(), 2);
+	ANKI_TEST_EXPECT_NO_ERR(hierarchy.update(hive));
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(root), false);
+	ANKI_TEST_EXPECT_EQ(hierarchy.isDirty(middle), true);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(middle).getOrigin(), Vec4(0.0f, 3.0f, 0.0f, 0.0f));
+	ANKI_TEST_EXPECT_EQ(hierarchy.getWorldTransform(leaves[1]).getOrigin(), Vec4(0.0f, 3.0f, 1.0f, 0.0f));
+
+	// Clean up
+	for(U32 i = 1; i < leafCount; ++i)
+	{
+		if(i != leafCount / 2)
+		{
+			hierarchy.removeComponent(leaves[i]);
+		}
+	}
+	hierarchy.removeComponent(middle);
+	hierarchy.removeComponent(root);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getComponentCount(), 0);
+	ANKI_TEST_EXPECT_EQ(hierarchy.getLevelCount(), 0);
+}
+
+} // end namespace anki
@@ -139,8 +139,17 @@ void main()
 	ShaderProgramBinaryWrapper binary(alloc);
 	BindlessLimits bindlessLimits;
 	GpuDeviceCapabilities gpuCapabilities;
-	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram(
-		"test.glslp", fsystem, nullptr, &taskManager, alloc, gpuCapabilities, bindlessLimits, binary));
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp",
+		fsystem,
+		nullptr,
+		&taskManager,
+		nullptr,
+		nullptr,
+		ShaderProgramCompilerOptions(),
+		alloc,
+		gpuCapabilities,
+		bindlessLimits,
+		binary));
 
 #if 1
 	StringAuto dis(alloc);
@@ -336,8 +345,17 @@ void main()
 	ShaderProgramBinaryWrapper binary(alloc);
 	BindlessLimits bindlessLimits;
 	GpuDeviceCapabilities gpuCapabilities;
-	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram(
-		"test.glslp", fsystem, nullptr, &taskManager, alloc, gpuCapabilities, bindlessLimits, binary));
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp",
+		fsystem,
+		nullptr,
+		&taskManager,
+		nullptr,
+		nullptr,
+		ShaderProgramCompilerOptions(),
+		alloc,
+		gpuCapabilities,
+		bindlessLimits,
+		binary));
 
 #if 1
 	StringAuto dis(alloc);
@@ -63,3 +63,92 @@ ANKI_TEST(ShaderCompiler, ShaderCompilerParser)
 
 	// printf("%s\n", variant.getSource(ShaderType::VERTEX).cstr());
 }
+
+ANKI_TEST(ShaderCompiler, ShaderCompilerParserIncludeCache)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	class FilesystemInterface : public ShaderProgramFilesystemInterface
+	{
+	public:
+		U32 m_readCount = 0;
+		U64 m_includeTimestamp = 1;
+
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			++m_readCount;
+
+			if(filename == "program.ankiprog")
+			{
+				txt = R"(
+#include "include.glsl"
+#pragma anki mutator M0 1 2
+
+#pragma anki start comp
+#pragma anki end
+)";
+			}
+			else if(filename == "include.glsl")
+			{
+				txt = R"(
+#pragma once
+const F32 A = 1.0;
+)";
+			}
+			else
+			{
+				return Error::FUNCTION_FAILED;
+			}
+
+			return Error::NONE;
+		}
+
+		Error getFileTimestamp(CString filename, U64& timestamp) final
+		{
+			timestamp = (filename == "include.glsl") ? m_includeTimestamp : 1;
+			return Error::NONE;
+		}
+	} interface;
+
+	BindlessLimits bindlessLimits;
+	GpuDeviceCapabilities gpuCapabilities;
+	ShaderProgramParserIncludeCache cache(alloc);
+
+	U64 hash;
+	{
+		ShaderProgramParser parser("program.ankiprog", &interface, alloc, gpuCapabilities, bindlessLimits, &cache);
+		ANKI_TEST_EXPECT_NO_ERR(parser.parse());
+		hash = parser.getHash();
+
+		ANKI_TEST_EXPECT_EQ(interface.m_readCount, 2);
+		ANKI_TEST_EXPECT_EQ(parser.getDependencyCount(), 2);
+		ANKI_TEST_EXPECT_EQ(parser.getDependencyFilename(0), "program.ankiprog");
+		ANKI_TEST_EXPECT_EQ(parser.getDependencyFilename(1), "include.glsl");
+	}
+
+	// Everything should come from the cache
+	{
+		ShaderProgramParser parser("program.ankiprog", &interface, alloc, gpuCapabilities, bindlessLimits, &cache);
+		ANKI_TEST_EXPECT_NO_ERR(parser.parse());
+		ANKI_TEST_EXPECT_EQ(parser.getHash(), hash);
+		ANKI_TEST_EXPECT_EQ(interface.m_readCount, 2);
+	}
+
+	// Touch the include
+	{
+		interface.m_includeTimestamp = 2;
+		ShaderProgramParser parser("program.ankiprog", &interface, alloc, gpuCapabilities, bindlessLimits, &cache);
+		ANKI_TEST_EXPECT_NO_ERR(parser.parse());
+		ANKI_TEST_EXPECT_EQ(parser.getHash(), hash);
+		ANKI_TEST_EXPECT_EQ(interface.m_readCount, 3);
+		ANKI_TEST_EXPECT_EQ(parser.getDependencyTimestamp(1), 2);
+	}
+
+	// No cache
+	{
+		ShaderProgramParser parser("program.ankiprog", &interface, alloc, gpuCapabilities, bindlessLimits);
+		ANKI_TEST_EXPECT_NO_ERR(parser.parse());
+		ANKI_TEST_EXPECT_EQ(parser.getHash(), hash);
+		ANKI_TEST_EXPECT_EQ(interface.m_readCount, 5);
+	}
+}
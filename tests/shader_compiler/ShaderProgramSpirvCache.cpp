@@ -0,0 +1,68 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+
+ANKI_TEST(ShaderCompiler, ShaderProgramSpirvCache)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const CString dir = "spirv_cache_test";
+	if(directoryExists(dir))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+	}
+
+	const Array<U8, 8> spirv = {{1, 2, 3, 4, 5, 6, 7, 8}};
+
+	{
+		ShaderProgramSpirvCache cache(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(dir));
+
+		// Miss
+		DynamicArrayAuto<U8> out(alloc);
+		ANKI_TEST_EXPECT_EQ(cache.find(123, out), false);
+
+		// Store and hit
+		cache.store(123, ConstWeakArray<U8>(&spirv[0], spirv.getSize()));
+		ANKI_TEST_EXPECT_EQ(cache.find(123, out), true);
+		ANKI_TEST_EXPECT_EQ(out.getSize(), spirv.getSize());
+		ANKI_TEST_EXPECT_EQ(memcmp(&out[0], &spirv[0], spirv.getSize()), 0);
+
+		ANKI_TEST_EXPECT_EQ(cache.getHitCount(), 1);
+		ANKI_TEST_EXPECT_EQ(cache.getMissCount(), 1);
+	}
+
+	// It should persist
+	{
+		ShaderProgramSpirvCache cache(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(dir));
+
+		DynamicArrayAuto<U8> out(alloc);
+		ANKI_TEST_EXPECT_EQ(cache.find(123, out), true);
+		ANKI_TEST_EXPECT_EQ(out[7], 8);
+	}
+
+	// Corrupted entries are misses
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(
+			file.open("spirv_cache_test/000000000000007b.spv", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_TEST_EXPECT_NO_ERR(file.write(&spirv[0], spirv.getSize()));
+	}
+
+	{
+		ShaderProgramSpirvCache cache(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(dir));
+
+		DynamicArrayAuto<U8> out(alloc);
+		ANKI_TEST_EXPECT_EQ(cache.find(123, out), false);
+		ANKI_TEST_EXPECT_EQ(cache.getMissCount(), 1);
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+}
@@ -0,0 +1,47 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/shader_compiler/SpirvStrip.h>
+
+ANKI_TEST(ShaderCompiler, SpirvStrip)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Header, OpCapability Shader, OpName %1 "a", OpMemoryModel Logical GLSL450, OpLine %2 1 1
+	const Array<U32, 15> spirv = {{0x07230203,
+		0x00010000,
+		0,
+		3,
+		0,
+		(2u << 16u) | 17u,
+		1,
+		(3u << 16u) | 5u,
+		1,
+		0x61,
+		(3u << 16u) | 14u,
+		0,
+		1,
+		(4u << 16u) | 8u,
+		2}};
+
+	// The OpLine is incomplete
+	DynamicArrayAuto<U8> out(alloc);
+	ANKI_TEST_EXPECT_EQ(
+		stripSpirvDebugInfo(ConstWeakArray<U8>(reinterpret_cast<const U8*>(&spirv[0]), sizeof(spirv)), out),
+		Error::USER_DATA);
+
+	// Now complete
+	Array<U32, 17> spirv2;
+	memcpy(&spirv2[0], &spirv[0], sizeof(spirv));
+	spirv2[15] = 1;
+	spirv2[16] = 1;
+	ANKI_TEST_EXPECT_NO_ERR(
+		stripSpirvDebugInfo(ConstWeakArray<U8>(reinterpret_cast<const U8*>(&spirv2[0]), sizeof(spirv2)), out));
+
+	const Array<U32, 10> expected = {{0x07230203, 0x00010000, 0, 3, 0, (2u << 16u) | 17u, 1, (3u << 16u) | 14u, 0, 1}};
+	ANKI_TEST_EXPECT_EQ(out.getSize(), sizeof(expected));
+	ANKI_TEST_EXPECT_EQ(memcmp(&out[0], &expected[0], sizeof(expected)), 0);
+}
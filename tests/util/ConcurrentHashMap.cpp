@@ -0,0 +1,233 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "anki/util/ConcurrentHashMap.h"
+#include "anki/util/FlatHashMap.h"
+#include "anki/util/ThreadPool.h"
+#include "anki/util/HighRezTimer.h"
+#include "anki/util/DynamicArray.h"
+#include <unordered_map>
+
+using namespace anki;
+
+/// Put all the keys in a few slots to test the probing.
+class BadConcurrentHasher
+{
+public:
+	U64 operator()(U32 x) const
+	{
+		return U64(x & 3);
+	}
+};
+
+/// Emplace and find the same keys from many threads.
+class ConcurrentHashMapTestTask : public ThreadPoolTask
+{
+public:
+	HeapAllocator<U8> m_alloc;
+	ConcurrentHashMap<U32, U64>* m_map = nullptr;
+	U32 m_keyCount = 0;
+	Atomic<U32> m_errors = {0};
+
+	Error operator()(U32 taskId, PtrSize threadCount)
+	{
+		for(U32 i = 0; i < m_keyCount; ++i)
+		{
+			// Every thread starts from a different key so the threads read and write at the same time
+			const U32 key = U32((i + taskId * m_keyCount / threadCount) % m_keyCount);
+			const U64* value = m_map->find(key);
+			if(value == nullptr)
+			{
+				value = &m_map->emplace(m_alloc, key, U64(key) * 3);
+			}
+
+			if(*value != U64(key) * 3)
+			{
+				m_errors.fetchAdd(1);
+			}
+		}
+
+		return Error::NONE;
+	}
+};
+
+ANKI_TEST(Util, ConcurrentHashMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Simple
+	{
+		ConcurrentHashMap<U64, int> map;
+		ANKI_TEST_EXPECT_EQ(map.find(20), nullptr);
+
+		map.emplace(alloc, 20, 1);
+		map.emplace(alloc, 21, 2);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(21), 2);
+		ANKI_TEST_EXPECT_EQ(map.find(22), nullptr);
+
+		// Don't replace
+		const int& value = map.emplace(alloc, 21, 3);
+		ANKI_TEST_EXPECT_EQ(value, 2);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+
+		map.destroy(alloc);
+	}
+
+	// Grow and iterate. The pointers should be valid after growing
+	{
+		ConcurrentHashMap<U32, U32, BadConcurrentHasher> map;
+		const U32* first = &map.emplace(alloc, 0, 100);
+		for(U32 i = 1; i < 1000; ++i)
+		{
+			map.emplace(alloc, i, i + 100);
+		}
+
+		map.validate();
+		ANKI_TEST_EXPECT_EQ(*first, 100);
+		ANKI_TEST_EXPECT_EQ(*map.find(0), 100);
+
+		std::unordered_map<U32, U32> stdMap;
+		map.iterate([&](U32 key, U32 value) { stdMap[key] = value; });
+		ANKI_TEST_EXPECT_EQ(stdMap.size(), 1000);
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(stdMap[i], i + 100);
+			ANKI_TEST_EXPECT_EQ(*map.find(i), i + 100);
+		}
+
+		ANKI_TEST_EXPECT_EQ(map.find(1000), nullptr);
+		map.destroy(alloc);
+	}
+
+	// Multithreaded
+	{
+		const U32 threadCount = 8;
+		ThreadPool pool(threadCount);
+
+		for(U32 keyCount : {100u, 10000u, 100000u})
+		{
+			ConcurrentHashMap<U32, U64> map;
+
+			ConcurrentHashMapTestTask task;
+			task.m_alloc = alloc;
+			task.m_map = &map;
+			task.m_keyCount = keyCount;
+			for(U32 i = 0; i < threadCount; ++i)
+			{
+				pool.assignNewTask(i, &task);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+
+			ANKI_TEST_EXPECT_EQ(task.m_errors.load(), 0);
+			ANKI_TEST_EXPECT_EQ(map.getSize(), keyCount);
+			map.validate();
+
+			map.destroy(alloc);
+		}
+	}
+}
+
+/// Find from many threads using a ConcurrentHashMap or a FlatHashMap behind a RWMutex.
+class ConcurrentHashMapBenchTask : public ThreadPoolTask
+{
+public:
+	const ConcurrentHashMap<U64, U64>* m_map = nullptr;
+	const FlatHashMap<U64, U64>* m_lockedMap = nullptr;
+	RWMutex* m_mtx = nullptr;
+	const U64* m_keys = nullptr;
+	U32 m_keyCount = 0;
+	U32 m_iterations = 0;
+	Atomic<U64> m_sum = {0}; ///< To avoid compiler opts
+
+	Error operator()(U32 taskId, PtrSize threadCount)
+	{
+		U64 sum = 0;
+		for(U32 it = 0; it < m_iterations; ++it)
+		{
+			for(U32 i = 0; i < m_keyCount; ++i)
+			{
+				const U64 key = m_keys[(i + taskId * 97) % m_keyCount];
+				if(m_map)
+				{
+					sum += *m_map->find(key);
+				}
+				else
+				{
+					RLockGuard<RWMutex> lock(*m_mtx);
+					sum += *m_lockedMap->find(key);
+				}
+			}
+		}
+
+		m_sum.fetchAdd(sum);
+		return Error::NONE;
+	}
+};
+
+ANKI_TEST(Util, ConcurrentHashMapBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	HighRezTimer timer;
+
+	// Something like the pipeline cache
+	const U32 KEY_COUNT = 2048;
+	DynamicArrayAuto<U64> keys(alloc);
+	keys.create(KEY_COUNT);
+
+	ConcurrentHashMap<U64, U64> map;
+	FlatHashMap<U64, U64> lockedMap;
+	RWMutex mtx;
+	for(U32 i = 0; i < KEY_COUNT; ++i)
+	{
+		keys[i] = computeHash(&i, sizeof(i));
+		map.emplace(alloc, keys[i], i);
+		lockedMap.emplace(alloc, keys[i], i);
+	}
+
+	for(U32 threadCount : {1u, 4u, 16u})
+	{
+		ThreadPool pool(threadCount);
+
+		ConcurrentHashMapBenchTask task;
+		task.m_keys = &keys[0];
+		task.m_keyCount = KEY_COUNT;
+		task.m_iterations = 1000;
+
+		// RWMutex
+		task.m_lockedMap = &lockedMap;
+		task.m_mtx = &mtx;
+		timer.start();
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			pool.assignNewTask(i, &task);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+		timer.stop();
+		const Second lockedTime = timer.getElapsedTime();
+
+		// Lock-free
+		task.m_map = &map;
+		timer.start();
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			pool.assignNewTask(i, &task);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Find bench %u threads: RWMutex+FlatHashMap %f ConcurrentHashMap %f | %f%% (%lu)",
+			threadCount,
+			lockedTime,
+			time,
+			lockedTime / time * 100.0,
+			task.m_sum.load() & 1);
+	}
+
+	map.destroy(alloc);
+	lockedMap.destroy(alloc);
+}
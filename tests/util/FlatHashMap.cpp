@@ -0,0 +1,306 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "tests/util/Foo.h"
+#include "anki/util/FlatHashMap.h"
+#include "anki/util/DynamicArray.h"
+#include "anki/util/HighRezTimer.h"
+#include "anki/util/String.h"
+#include <unordered_map>
+#include <algorithm>
+
+using namespace anki;
+
+/// Put all the keys in a few slots to test the probing.
+class BadHasher
+{
+public:
+	U64 operator()(int x) const
+	{
+		return U64(x & 3);
+	}
+};
+
+ANKI_TEST(Util, FlatHashMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const int vals[] = {20, 15, 5, 1, 10, 0, 18, 6, 7, 11, 13, 3};
+	const U32 valsSize = sizeof(vals) / sizeof(vals[0]);
+
+	// Simple
+	{
+		FlatHashMap<U64, int> map;
+		map.emplace(alloc, 20, 1);
+		map.emplace(alloc, 21, 2);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(U64(21)), 2);
+		ANKI_TEST_EXPECT_EQ(map.find(U64(22)), map.getEnd());
+
+		// Replace
+		map.emplace(alloc, 21, 3);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(*map.find(U64(21)), 3);
+
+		map.destroy(alloc);
+	}
+
+	// Iterate and erase while iterating
+	{
+		FlatHashMap<I64, int> map;
+		for(U32 i = 0; i < valsSize; ++i)
+		{
+			map.emplace(alloc, vals[i], vals[i] * 10);
+		}
+
+		U32 count = 0;
+		for(auto it = map.getBegin(); it != map.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(*it, it.getKey() * 10);
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, valsSize);
+
+		// Erase the odd
+		count = 0;
+		for(auto it = map.getBegin(); it != map.getEnd();)
+		{
+			++count;
+			if(it.getKey() & 1)
+			{
+				it = map.erase(alloc, it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		ANKI_TEST_EXPECT_EQ(count, valsSize);
+		map.validate();
+
+		for(U32 i = 0; i < valsSize; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(map.find(I64(vals[i])) == map.getEnd(), (vals[i] & 1) != 0);
+		}
+
+		map.destroy(alloc);
+	}
+
+	// Heterogeneous lookup
+	{
+		FlatHashMap<StringAuto, int> map;
+		for(U32 i = 0; i < valsSize; ++i)
+		{
+			StringAuto str(alloc);
+			str.sprintf("%d", vals[i]);
+			map.emplace(alloc, str, vals[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(*map.find(CString("13")), 13);
+		ANKI_TEST_EXPECT_EQ(map.find(CString("14")), map.getEnd());
+
+		map.destroy(alloc);
+	}
+
+	// Non-trivial values
+	{
+		Foo::reset();
+		FlatHashMap<U64, Foo> map;
+		for(U32 i = 0; i < 100; ++i)
+		{
+			map.emplace(alloc, i, I32(i));
+		}
+
+		for(U32 i = 0; i < 100; i += 2)
+		{
+			map.erase(alloc, map.find(U64(i)));
+		}
+
+		ANKI_TEST_EXPECT_EQ(Foo::constructorCallCount - Foo::destructorCallCount, 50);
+		map.destroy(alloc);
+		ANKI_TEST_EXPECT_EQ(Foo::constructorCallCount, Foo::destructorCallCount);
+	}
+
+	// Fuzzy test with a bad hasher to have long probe sequences
+	{
+		FlatHashMap<int, int, BadHasher> map;
+		std::unordered_map<int, int> stdMap;
+
+		for(U32 i = 0; i < 10000; ++i)
+		{
+			const int key = rand() % 500;
+			if(rand() % 3 == 0)
+			{
+				auto it = map.find(key);
+				ANKI_TEST_EXPECT_EQ(it != map.getEnd(), stdMap.find(key) != stdMap.end());
+				if(it != map.getEnd())
+				{
+					map.erase(alloc, it);
+					stdMap.erase(key);
+				}
+			}
+			else
+			{
+				map.emplace(alloc, key, key + 1);
+				stdMap[key] = key + 1;
+			}
+
+			if(i % 128 == 0)
+			{
+				map.validate();
+			}
+		}
+
+		map.validate();
+		ANKI_TEST_EXPECT_EQ(map.getSize(), stdMap.size());
+		for(auto it : stdMap)
+		{
+			auto it2 = map.find(it.first);
+			ANKI_TEST_EXPECT_NEQ(it2, map.getEnd());
+			ANKI_TEST_EXPECT_EQ(*it2, it.second);
+		}
+
+		map.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, FlatHashMapBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	HighRezTimer timer;
+
+	// The keys of the engine's maps are hashes
+	const U32 COUNT = 1024 * 1024;
+	DynamicArrayAuto<U64> keys(alloc);
+	keys.create(COUNT);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		keys[i] = computeHash(&i, sizeof(i));
+	}
+
+	HashMap<U64, U64> map;
+	FlatHashMap<U64, U64> flatMap;
+
+	// Insert
+	{
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			map.emplace(alloc, keys[i], i);
+		}
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			flatMap.emplace(alloc, keys[i], i);
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI(
+			"Inserting bench: HashMap %f FlatHashMap %f | %f%%", time, flatTime, time / flatTime * 100.0);
+	}
+
+	// Find
+	{
+		std::random_shuffle(keys.begin(), keys.end());
+		U64 count = 0; // To avoid compiler opts
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *map.find(keys[i]);
+		}
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += *flatMap.find(keys[i]);
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		// And the misses
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += map.find(keys[i] + 1) != map.getEnd();
+		}
+		timer.stop();
+		const Second missTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			count += flatMap.find(keys[i] + 1) != flatMap.getEnd();
+		}
+		timer.stop();
+		const Second flatMissTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Find bench: HashMap %f FlatHashMap %f | %f%%", time, flatTime, time / flatTime * 100.0);
+		ANKI_TEST_LOGI("Find miss bench: HashMap %f FlatHashMap %f | %f%% (%lu)",
+			missTime,
+			flatMissTime,
+			missTime / flatMissTime * 100.0,
+			count);
+	}
+
+	// Iterate
+	{
+		U64 count = 0;
+
+		timer.start();
+		for(U64 v : map)
+		{
+			count += v;
+		}
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		timer.start();
+		for(U64 v : flatMap)
+		{
+			count += v;
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Iterate bench: HashMap %f FlatHashMap %f | %f%% (%lu)",
+			time,
+			flatTime,
+			time / flatTime * 100.0,
+			count);
+	}
+
+	// Erase
+	{
+		std::random_shuffle(keys.begin(), keys.end());
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			map.erase(alloc, map.find(keys[i]));
+		}
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			flatMap.erase(alloc, flatMap.find(keys[i]));
+		}
+		timer.stop();
+		const Second flatTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Erasing bench: HashMap %f FlatHashMap %f | %f%%", time, flatTime, time / flatTime * 100.0);
+	}
+
+	map.destroy(alloc);
+	flatMap.destroy(alloc);
+}
@@ -0,0 +1,162 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "anki/util/Hash.h"
+#include "anki/util/HighRezTimer.h"
+#include "anki/util/DynamicArray.h"
+#include <unordered_set>
+
+using namespace anki;
+
+class HashTestValue
+{
+public:
+	PtrSize m_size;
+	U64 m_hash;
+};
+
+static void initHashTestBuffer(U8* buff, PtrSize size)
+{
+	for(PtrSize i = 0; i < size; ++i)
+	{
+		buff[i] = U8(i * 31 + 7);
+	}
+}
+
+ANKI_TEST(Util, Hash)
+{
+	Array<U8, 2048 + 16> buff;
+	initHashTestBuffer(&buff[0], buff.getSize());
+
+	// The SIMD and the scalar paths should give the same values
+	{
+		static const HashTestValue values[] = {{0, 0xc707339c8b600ebc},
+			{1, 0x740074253456baff},
+			{3, 0x706bb3f60912f1fb},
+			{4, 0x3dc313a045846b7d},
+			{7, 0x384cec938c56e081},
+			{8, 0xeacea78a210b40d2},
+			{12, 0x9d4fafa415fe7b16},
+			{16, 0x7b447958720cbabf},
+			{17, 0x8ca7d8730f99df67},
+			{24, 0xde33d9cb3189bbe2},
+			{32, 0xfa2b2ad9cdfdab45},
+			{33, 0x936020ec2fd85caa},
+			{48, 0x0ab80fe2c99534c3},
+			{49, 0xa80cb7bdfae24d5b},
+			{64, 0xd548a2ee8c84ca97},
+			{100, 0xc68dd804c07b9507},
+			{128, 0xbe37a16b90463438},
+			{256, 0x039b5b0771e4bdd7},
+			{257, 0xf3572111b3b12580},
+			{300, 0x96b177ec389ec38c},
+			{512, 0x2aa469257c3a37e2},
+			{1024, 0x18ba467305dbd2d3},
+			{1500, 0x219f049fee6ba6f2},
+			{2048, 0x253cf846e66551c6}};
+
+		for(const HashTestValue& v : values)
+		{
+			ANKI_TEST_EXPECT_EQ(computeHash(&buff[0], v.m_size), v.m_hash);
+		}
+	}
+
+	// The stable hash should never change
+	{
+		static const HashTestValue values[] = {{1, 0x630c4b28bd170eb4},
+			{8, 0x73d15e03beb5b0e4},
+			{13, 0x8f9b4fd5c1a6b00e},
+			{64, 0xc2a5e2bf2a30e9ef},
+			{1000, 0x594ed05cc7124201}};
+
+		for(const HashTestValue& v : values)
+		{
+			ANKI_TEST_EXPECT_EQ(computeStableHash(&buff[0], v.m_size), v.m_hash);
+		}
+	}
+
+	// Alignment doesn't matter
+	{
+		Array<U8, 2048 + 16> buff2;
+		for(PtrSize size = 0; size <= 2048; ++size)
+		{
+			const U64 hash = computeHash(&buff[0], size, size);
+			for(U32 offset = 1; offset < 16; offset += 5)
+			{
+				memcpy(&buff2[offset], &buff[0], size);
+				ANKI_TEST_EXPECT_EQ(computeHash(&buff2[offset], size, size), hash);
+			}
+		}
+	}
+
+	// Flipping a bit or changing the size or the seed gives a different hash
+	{
+		std::unordered_set<U64> hashes;
+		U32 count = 0;
+		for(PtrSize size = 1; size <= 600; size += 7)
+		{
+			for(PtrSize bit = 0; bit < size * 8; bit += 13)
+			{
+				buff[bit / 8] ^= U8(1 << (bit % 8));
+				hashes.insert(computeHash(&buff[0], size));
+				buff[bit / 8] ^= U8(1 << (bit % 8));
+				++count;
+			}
+
+			hashes.insert(computeHash(&buff[0], size, 1));
+			hashes.insert(appendHash(&buff[0], size, 2));
+			count += 2;
+		}
+
+		ANKI_TEST_EXPECT_EQ(hashes.size(), count);
+	}
+}
+
+ANKI_TEST(Util, HashBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	HighRezTimer timer;
+
+	DynamicArrayAuto<U8> buff(alloc);
+	buff.create(64_KB);
+	initHashTestBuffer(&buff[0], buff.getSize());
+
+	// The sizes the engine usually hashes. Small keys for the hash maps, 32 to 256 bytes for the GPU state and big
+	// buffers for the shaders
+	const Array<PtrSize, 9> sizes = {{4, 8, 16, 32, 64, 128, 256, 1_KB, 64_KB}};
+	const PtrSize bytesPerSize = 512_MB;
+
+	for(PtrSize size : sizes)
+	{
+		const PtrSize iterations = max<PtrSize>(bytesPerSize / (size * 16), 1024);
+		U64 result = 0; // To avoid compiler opts
+
+		timer.start();
+		for(PtrSize i = 0; i < iterations; ++i)
+		{
+			// Change the seed every time to avoid hoisting the hash outside the loop
+			result ^= computeStableHash(&buff[0], size, i);
+		}
+		timer.stop();
+		const Second stableTime = timer.getElapsedTime();
+
+		timer.start();
+		for(PtrSize i = 0; i < iterations; ++i)
+		{
+			result ^= computeHash(&buff[0], size, i);
+		}
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		const F64 gbs = F64(size * iterations) / (1024.0 * 1024.0 * 1024.0);
+		ANKI_TEST_LOGI("Hash bench %luB: stable %f GB/s, new %f GB/s | %f%% (%lu)",
+			size,
+			gbs / stableTime,
+			gbs / time,
+			stableTime / time * 100.0,
+			result & 1);
+	}
+}
@@ -0,0 +1,216 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/InternedString.h>
+#include <anki/util/ThreadPool.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/HighRezTimer.h>
+#include <string>
+
+using namespace anki;
+
+/// Intern the same strings from many threads.
+class InternedStringTestTask : public ThreadPoolTask
+{
+public:
+	static constexpr U32 STRING_COUNT = 1000;
+
+	Array<InternedString, STRING_COUNT> m_strings[4];
+
+	Error operator()(U32 taskId, PtrSize threadCount)
+	{
+		for(U32 i = 0; i < STRING_COUNT; ++i)
+		{
+			// Every thread starts from a different string so the threads read and write at the same time
+			const U32 idx = (i + taskId * STRING_COUNT / U32(threadCount)) % STRING_COUNT;
+			const std::string str = "InternedStringTestTask_" + std::to_string(idx);
+			m_strings[taskId][idx] = InternedString(str.c_str());
+		}
+
+		return Error::NONE;
+	}
+};
+
+ANKI_TEST(Util, InternedString)
+{
+	// Basic
+	{
+		const InternedString a("InternedStringTest_A");
+		const InternedString b("InternedStringTest_B");
+		const InternedString a2(std::string("InternedStringTest_A").c_str());
+
+		ANKI_TEST_EXPECT_EQ(a == a2, true);
+		ANKI_TEST_EXPECT_EQ(a != b, true);
+		ANKI_TEST_EXPECT_EQ(a.toCString(), "InternedStringTest_A");
+		ANKI_TEST_EXPECT_EQ(b.toCString(), "InternedStringTest_B");
+		ANKI_TEST_EXPECT_EQ(a.isEmpty(), false);
+
+		InternedString c;
+		ANKI_TEST_EXPECT_EQ(InternedString::tryFind("InternedStringTest_A", c), true);
+		ANKI_TEST_EXPECT_EQ(c == a, true);
+		ANKI_TEST_EXPECT_EQ(InternedString::tryFind("InternedStringTest_Never", c), false);
+	}
+
+	// Empty
+	{
+		const InternedString a;
+		const InternedString b("");
+		ANKI_TEST_EXPECT_EQ(a == b, true);
+		ANKI_TEST_EXPECT_EQ(a.isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(a.toCString(), "");
+	}
+
+	// A long one
+	{
+		const std::string str(100 * 1024, 'a');
+		const InternedString a(str.c_str());
+		ANKI_TEST_EXPECT_EQ(a.toCString(), str.c_str());
+	}
+
+	// Many threads
+	{
+		const U32 threadCount = 4;
+		ThreadPool pool(threadCount);
+
+		InternedStringTestTask task;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			pool.assignNewTask(i, &task);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+
+		for(U32 i = 0; i < InternedStringTestTask::STRING_COUNT; ++i)
+		{
+			const std::string str = "InternedStringTestTask_" + std::to_string(i);
+			for(U32 t = 0; t < threadCount; ++t)
+			{
+				ANKI_TEST_EXPECT_EQ(task.m_strings[t][i] == task.m_strings[0][i], true);
+				ANKI_TEST_EXPECT_EQ(task.m_strings[t][i].toCString(), str.c_str());
+			}
+		}
+	}
+
+	// As a key
+	{
+		HeapAllocator<U8> alloc(allocAligned, nullptr);
+		HashMap<InternedString, U32> map;
+		map.emplace(alloc, InternedString("InternedStringTest_Key0"), 0);
+		map.emplace(alloc, InternedString("InternedStringTest_Key1"), 1);
+
+		ANKI_TEST_EXPECT_EQ(*map.find(InternedString("InternedStringTest_Key1")), 1);
+		ANKI_TEST_EXPECT_EQ(*map.find(InternedString("InternedStringTest_Key0")), 0);
+		map.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, SsoString)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Inline
+	{
+		SsoString a(alloc, "Short");
+		ANKI_TEST_EXPECT_EQ(a.isAllocated(), false);
+		ANKI_TEST_EXPECT_EQ(a.getLength(), 5);
+		ANKI_TEST_EXPECT_EQ(a.toCString(), "Short");
+
+		const std::string maxInline(SsoString::MAX_INLINE_LENGTH, 'a');
+		SsoString b(alloc, maxInline.c_str());
+		ANKI_TEST_EXPECT_EQ(b.isAllocated(), false);
+		ANKI_TEST_EXPECT_EQ(b.toCString(), maxInline.c_str());
+
+		SsoString c(std::move(b));
+		ANKI_TEST_EXPECT_EQ(b.isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(c.toCString(), maxInline.c_str());
+
+		a.destroy(alloc);
+		b.destroy(alloc);
+		c.destroy(alloc);
+	}
+
+	// Allocated
+	{
+		const std::string str(SsoString::MAX_INLINE_LENGTH + 1, 'b');
+		SsoString a(alloc, str.c_str());
+		ANKI_TEST_EXPECT_EQ(a.isAllocated(), true);
+		ANKI_TEST_EXPECT_EQ(a.toCString(), str.c_str());
+		ANKI_TEST_EXPECT_EQ(a.computeHash(), computeHash(str.c_str(), str.length()));
+
+		SsoString b;
+		b = std::move(a);
+		ANKI_TEST_EXPECT_EQ(a.isAllocated(), false);
+		ANKI_TEST_EXPECT_EQ(b.isAllocated(), true);
+		ANKI_TEST_EXPECT_EQ(b.toCString(), str.c_str());
+
+		a.destroy(alloc);
+		b.destroy(alloc);
+	}
+
+	// Empty
+	{
+		SsoString a(alloc, CString());
+		ANKI_TEST_EXPECT_EQ(a.isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(a.toCString(), "");
+		a.destroy(alloc);
+	}
+}
+
+ANKI_TEST(Util, InternedStringBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const U32 nameCount = 256;
+	const U32 lookupCount = 1000000;
+
+	DynamicArrayAuto<String> names(alloc);
+	names.create(nameCount);
+	HashMap<CString, U32> stringMap;
+	HashMap<InternedString, U32> internedMap;
+	DynamicArrayAuto<InternedString> internedNames(alloc);
+	internedNames.create(nameCount);
+	for(U32 i = 0; i < nameCount; ++i)
+	{
+		names[i].sprintf(alloc, "scene/nodes/InternedStringBenchNode_%u", i);
+		stringMap.emplace(alloc, names[i].toCString(), i);
+		internedNames[i] = InternedString(names[i].toCString());
+		internedMap.emplace(alloc, internedNames[i], i);
+	}
+
+	U64 expectedSum = 0;
+	for(U32 i = 0; i < lookupCount; ++i)
+	{
+		expectedSum += i % nameCount;
+	}
+
+	HighRezTimer timer;
+	U64 sum = 0;
+
+	timer.start();
+	for(U32 i = 0; i < lookupCount; ++i)
+	{
+		sum += *stringMap.find(names[i % nameCount].toCString());
+	}
+	timer.stop();
+	const Second stringTime = timer.getElapsedTime();
+
+	timer.start();
+	for(U32 i = 0; i < lookupCount; ++i)
+	{
+		sum += *internedMap.find(internedNames[i % nameCount]);
+	}
+	timer.stop();
+	const Second internedTime = timer.getElapsedTime();
+
+	ANKI_TEST_EXPECT_EQ(sum, expectedSum * 2);
+	ANKI_TEST_LOGI(
+		"Lookup time: string %f interned %f | %f%%", stringTime, internedTime, stringTime / internedTime * 100.0);
+
+	for(String& name : names)
+	{
+		name.destroy(alloc);
+	}
+	stringMap.destroy(alloc);
+	internedMap.destroy(alloc);
+}
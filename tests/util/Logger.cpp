@@ -0,0 +1,173 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/Logger.h>
+#include <anki/util/ThreadPool.h>
+#include <anki/util/HighRezTimer.h>
+#include <string>
+#include <vector>
+
+using namespace anki;
+
+/// Gathers the messages.
+class LoggerTestHandler
+{
+public:
+	Mutex m_mtx;
+	std::vector<std::string> m_msgs;
+	Second m_sleepTime = 0.0;
+
+	static void callback(void* data, const LoggerMessageInfo& info)
+	{
+		LoggerTestHandler& self = *static_cast<LoggerTestHandler*>(data);
+		if(self.m_sleepTime > 0.0)
+		{
+			HighRezTimer::sleep(self.m_sleepTime);
+		}
+
+		LockGuard<Mutex> lock(self.m_mtx);
+		self.m_msgs.push_back(info.m_msg);
+	}
+};
+
+#define ANKI_TEST_LOGGER_WRITE(logger_, ...) \
+	logger_.writeFormated( \
+		ANKI_FILE, __LINE__, ANKI_FUNC, "TEST", LoggerMessageType::NORMAL, Thread::getCurrentThreadId(), __VA_ARGS__)
+
+/// Write some messages.
+class LoggerTestTask : public ThreadPoolTask
+{
+public:
+	Logger* m_logger = nullptr;
+	U32 m_msgCount = 0;
+
+	Error operator()(U32 taskId, PtrSize threadCount)
+	{
+		for(U32 i = 0; i < m_msgCount; ++i)
+		{
+			ANKI_TEST_LOGGER_WRITE((*m_logger), "%u %u", taskId, i);
+		}
+
+		return Error::NONE;
+	}
+};
+
+ANKI_TEST(Util, LoggerAsync)
+{
+	LoggerTestHandler handler;
+	Logger logger;
+	logger.addMessageHandler(&handler, &LoggerTestHandler::callback);
+	logger.enableAsync();
+
+	// Many threads. The messages of every thread should be in order
+	{
+		const U32 threadCount = 4;
+		const U32 msgCount = 50;
+		ThreadPool pool(threadCount);
+
+		LoggerTestTask task;
+		task.m_logger = &logger;
+		task.m_msgCount = msgCount;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			pool.assignNewTask(i, &task);
+		}
+		ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+		logger.flush();
+
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs.size(), threadCount * msgCount);
+		std::vector<U32> nextMsg(threadCount, 0);
+		for(const std::string& msg : handler.m_msgs)
+		{
+			U32 taskId, i;
+			ANKI_TEST_EXPECT_EQ(sscanf(msg.c_str(), "%u %u", &taskId, &i), 2);
+			ANKI_TEST_EXPECT_EQ(i, nextMsg[taskId]);
+			++nextMsg[taskId];
+		}
+
+		handler.m_msgs.clear();
+	}
+
+	// Repeated messages
+	{
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			ANKI_TEST_LOGGER_WRITE(logger, "Repeated");
+		}
+		ANKI_TEST_LOGGER_WRITE(logger, "Something else");
+		logger.flush();
+
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs.size(), 3);
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs[0], "Repeated");
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs[1], "The previous message repeated 999 more times");
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs[2], "Something else");
+		handler.m_msgs.clear();
+	}
+
+	// A long message is written synchronously but after the queued ones
+	{
+		ANKI_TEST_LOGGER_WRITE(logger, "Short");
+		const std::string longMsg(Logger::MAX_ASYNC_MESSAGE_LENGTH * 2, 'a');
+		ANKI_TEST_LOGGER_WRITE(logger, "%s", longMsg.c_str());
+
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs.size(), 2);
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs[0], "Short");
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs[1], longMsg);
+		handler.m_msgs.clear();
+	}
+
+	// Fill the queue of a thread
+	{
+		for(U32 i = 0; i < Logger::ASYNC_MESSAGES_PER_THREAD * 3; ++i)
+		{
+			ANKI_TEST_LOGGER_WRITE(logger, "%u", i);
+		}
+
+		logger.disableAsync();
+		ANKI_TEST_EXPECT_EQ(handler.m_msgs.size(), Logger::ASYNC_MESSAGES_PER_THREAD * 3);
+		for(U32 i = 0; i < handler.m_msgs.size(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(handler.m_msgs[i], std::to_string(i));
+		}
+	}
+
+	logger.removeMessageHandler(&handler, &LoggerTestHandler::callback);
+}
+
+ANKI_TEST(Util, LoggerAsyncBench)
+{
+	// A handler that is as slow as writing to a file
+	LoggerTestHandler handler;
+	handler.m_sleepTime = 50.0 / 1000000.0;
+	Logger logger;
+	logger.addMessageHandler(&handler, &LoggerTestHandler::callback);
+
+	const U32 msgCount = 50;
+	HighRezTimer timer;
+
+	timer.start();
+	for(U32 i = 0; i < msgCount; ++i)
+	{
+		ANKI_TEST_LOGGER_WRITE(logger, "Sync %u", i);
+	}
+	timer.stop();
+	const Second syncTime = timer.getElapsedTime();
+
+	logger.enableAsync();
+	timer.start();
+	for(U32 i = 0; i < msgCount; ++i)
+	{
+		ANKI_TEST_LOGGER_WRITE(logger, "Async %u", i);
+	}
+	timer.stop();
+	const Second asyncTime = timer.getElapsedTime();
+	logger.disableAsync();
+
+	ANKI_TEST_EXPECT_EQ(handler.m_msgs.size(), msgCount * 2);
+	ANKI_TEST_LOGI("Writer time: sync %f async %f | %f%%", syncTime, asyncTime, syncTime / asyncTime * 100.0);
+
+	logger.removeMessageHandler(&handler, &LoggerTestHandler::callback);
+}
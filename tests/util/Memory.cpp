@@ -218,3 +218,261 @@ ANKI_TEST(Util, ChainMemoryPool)
 		ANKI_TEST_EXPECT_EQ(pool.getChunksCount(), 0);
 	}
 }
+
+ANKI_TEST(Util, SlabMemoryPool)
+{
+	// Simple
+	{
+		SlabMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+
+		Array<void*, 3> ptrs;
+		ptrs[0] = pool.allocate(1, 1);
+		ptrs[1] = pool.allocate(100, 32);
+		ptrs[2] = pool.allocate(10 * 1024, 16);
+		for(void* ptr : ptrs)
+		{
+			ANKI_TEST_EXPECT_NEQ(ptr, nullptr);
+		}
+		ANKI_TEST_EXPECT_EQ(isAligned(32, ptrs[1]), true);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 3);
+
+		memset(ptrs[0], 0xFF, 1);
+		memset(ptrs[1], 0xFF, 100);
+		memset(ptrs[2], 0xFF, 10 * 1024);
+
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+	}
+
+	// Big allocations keep the alignment they asked for
+	{
+		SlabMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+
+		Array<void*, 4> ptrs;
+		ptrs[0] = pool.allocate(3 * 1024, 1);
+		ptrs[1] = pool.allocate(3 * 1024, 256);
+		ptrs[2] = pool.allocate(128, 4096);
+		ptrs[3] = pool.allocate(200 * 1024, 64);
+		ANKI_TEST_EXPECT_EQ(isAligned(256, ptrs[1]), true);
+		ANKI_TEST_EXPECT_EQ(isAligned(4096, ptrs[2]), true);
+		ANKI_TEST_EXPECT_EQ(isAligned(64, ptrs[3]), true);
+
+		// Mix them with slab blocks
+		void* small = pool.allocate(16, 16);
+		memset(ptrs[3], 0xFF, 200 * 1024);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 5);
+
+		pool.free(small);
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+	}
+
+	// Many slabs, reuse
+	{
+		SlabMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+
+		const U32 count = 10000;
+		std::vector<U32*> ptrs;
+		for(U32 i = 0; i < count; ++i)
+		{
+			U32* ptr = static_cast<U32*>(pool.allocate(sizeof(U32) * 8, alignof(U32)));
+			*ptr = i;
+			ptrs.push_back(ptr);
+		}
+
+		for(U32 i = 0; i < count; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(*ptrs[i], i);
+		}
+
+		for(U32 i = 0; i < count; i += 2)
+		{
+			pool.free(ptrs[i]);
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), count / 2);
+
+		for(U32 i = 1; i < count; i += 2)
+		{
+			pool.free(ptrs[i]);
+		}
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+	}
+
+	// Threads free what other threads allocated
+	{
+		SlabMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+
+		const U32 THREAD_COUNT = 4;
+		const U32 ALLOCATIONS_PER_THREAD = 10000;
+		std::vector<void*> ptrs(THREAD_COUNT * ALLOCATIONS_PER_THREAD, nullptr);
+
+		class Task : public ThreadPoolTask
+		{
+		public:
+			SlabMemoryPool* m_pool;
+			std::vector<void*>* m_ptrs;
+			Bool m_allocate;
+
+			Error operator()(U32 taskId, PtrSize threadsCount) override
+			{
+				for(U32 i = 0; i < ALLOCATIONS_PER_THREAD; ++i)
+				{
+					if(m_allocate)
+					{
+						const PtrSize size = (i % 64) * 32 + 1;
+						void* ptr = m_pool->allocate(size, 1);
+						memset(ptr, I32(taskId), size);
+						(*m_ptrs)[i * threadsCount + taskId] = ptr;
+					}
+					else
+					{
+						// Free the allocations of the next thread
+						const U32 otherTask = U32((taskId + 1) % threadsCount);
+						void*& ptr = (*m_ptrs)[i * threadsCount + otherTask];
+						if(*static_cast<U8*>(ptr) != otherTask)
+						{
+							return Error::FUNCTION_FAILED;
+						}
+
+						m_pool->free(ptr);
+						ptr = nullptr;
+					}
+				}
+
+				return Error::NONE;
+			}
+		};
+
+		ThreadPool threadPool(THREAD_COUNT);
+		Task task;
+		task.m_pool = &pool;
+		task.m_ptrs = &ptrs;
+
+		for(U32 round = 0; round < 3; ++round)
+		{
+			task.m_allocate = true;
+			for(U32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				threadPool.assignNewTask(i, &task);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), THREAD_COUNT * ALLOCATIONS_PER_THREAD);
+
+			task.m_allocate = false;
+			for(U32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				threadPool.assignNewTask(i, &task);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+		}
+	}
+}
+
+ANKI_TEST(Util, FrameMemoryPool)
+{
+	// Simple
+	{
+		FrameMemoryPool pool;
+		pool.create(allocAligned, nullptr, 1024);
+
+		void* a = pool.allocate(10, 1);
+		void* b = pool.allocate(100, 64);
+		ANKI_TEST_EXPECT_NEQ(a, nullptr);
+		ANKI_TEST_EXPECT_NEQ(b, nullptr);
+		ANKI_TEST_EXPECT_EQ(isAligned(ANKI_SAFE_ALIGNMENT, a), true);
+		ANKI_TEST_EXPECT_EQ(isAligned(64, b), true);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 2);
+
+		// Doesn't fit in the first chunk
+		void* c = pool.allocate(2000, 16);
+		ANKI_TEST_EXPECT_NEQ(c, nullptr);
+		memset(c, 0xFF, 2000);
+		pool.free(c);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 3);
+
+		pool.reset();
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), 0);
+
+		// After the reset the arena has a single chunk that fits the previous frame
+		U8* d = static_cast<U8*>(pool.allocate(10, 1));
+		U8* e = static_cast<U8*>(pool.allocate(2000, 16));
+		ANKI_TEST_EXPECT_EQ(e > d && e - d < 64, true);
+	}
+
+	// Threads
+	{
+		FrameMemoryPool pool;
+		pool.create(allocAligned, nullptr, 4 * 1024);
+
+		const U32 THREAD_COUNT = 4;
+		const U32 ALLOCATIONS_PER_THREAD = 1000;
+
+		class Task : public ThreadPoolTask
+		{
+		public:
+			FrameMemoryPool* m_pool;
+			Array<U8*, ALLOCATIONS_PER_THREAD * THREAD_COUNT> m_ptrs;
+
+			Error operator()(U32 taskId, PtrSize threadsCount) override
+			{
+				for(U32 i = 0; i < ALLOCATIONS_PER_THREAD; ++i)
+				{
+					const PtrSize size = (i % 16) * 8 + 1;
+					U8* ptr = static_cast<U8*>(m_pool->allocate(size, 8));
+					memset(ptr, I32(taskId), size);
+					m_ptrs[i * threadsCount + taskId] = ptr;
+				}
+
+				// Check that no other thread touched the memory
+				for(U32 i = 0; i < ALLOCATIONS_PER_THREAD; ++i)
+				{
+					const PtrSize size = (i % 16) * 8 + 1;
+					const U8* ptr = m_ptrs[i * threadsCount + taskId];
+					for(PtrSize j = 0; j < size; ++j)
+					{
+						if(ptr[j] != taskId)
+						{
+							return Error::FUNCTION_FAILED;
+						}
+					}
+				}
+
+				return Error::NONE;
+			}
+		};
+
+		ThreadPool threadPool(THREAD_COUNT);
+		Task task;
+		task.m_pool = &pool;
+
+		for(U32 frame = 0; frame < 3; ++frame)
+		{
+			for(U32 i = 0; i < THREAD_COUNT; ++i)
+			{
+				threadPool.assignNewTask(i, &task);
+			}
+			ANKI_TEST_EXPECT_NO_ERR(threadPool.waitForAllThreadsToFinish());
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationsCount(), THREAD_COUNT * ALLOCATIONS_PER_THREAD);
+
+			pool.reset();
+		}
+
+		PtrSize highWaterMarkSum = 0;
+		for(U32 i = 0; i <= FrameMemoryPool::MAX_THREAD_ARENAS; ++i)
+		{
+			highWaterMarkSum += pool.getHighWaterMark(i);
+		}
+		ANKI_TEST_EXPECT_GEQ(highWaterMarkSum, THREAD_COUNT * ALLOCATIONS_PER_THREAD * 8);
+	}
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include "anki/util/MemoryTracker.h"
+#include "anki/util/Allocator.h"
+#include "anki/util/File.h"
+
+ANKI_TEST(Util, MemoryTracker)
+{
+	MemoryTracker tracker;
+	tracker.init("TEST", allocAligned, nullptr);
+
+	ANKI_TEST_EXPECT_EQ(MemoryTracker::computeSizeClass(1), 0);
+	ANKI_TEST_EXPECT_EQ(MemoryTracker::computeSizeClass(16), 0);
+	ANKI_TEST_EXPECT_EQ(MemoryTracker::computeSizeClass(17), 1);
+	ANKI_TEST_EXPECT_EQ(MemoryTracker::computeSizeClass(1024), 6);
+	ANKI_TEST_EXPECT_EQ(MemoryTracker::computeSizeClass(100_MB), MemoryTracker::SIZE_CLASS_COUNT - 1);
+
+	// Use it through an allocator
+	{
+		HeapAllocator<U8> alloc(MemoryTracker::allocCallback, &tracker);
+
+		U8* a = alloc.newArray<U8>(10);
+		U64* b = alloc.newArray<U64>(200);
+		ANKI_TEST_EXPECT_EQ(isAligned(alignof(U64), b), true);
+		ANKI_TEST_EXPECT_GEQ(tracker.getLiveBytes(), 10 + 200 * sizeof(U64));
+
+		U64 allocationCount = 0;
+		for(U32 i = 0; i < MemoryTracker::SIZE_CLASS_COUNT; ++i)
+		{
+			allocationCount += tracker.getSizeClassAllocationCount(i);
+		}
+		ANKI_TEST_EXPECT_EQ(allocationCount, tracker.getAllocationCount());
+
+		const PtrSize peak = tracker.getLiveBytes();
+		alloc.deleteArray(b, 200);
+		alloc.deleteArray(a, 10);
+
+		ANKI_TEST_EXPECT_EQ(tracker.getPeakBytes(), peak);
+
+		// Only the memory pool is alive
+		ANKI_TEST_EXPECT_EQ(tracker.getAllocationCount() - tracker.getFreeCount(), 1);
+	}
+
+	// The allocator's pool was freed as well
+	ANKI_TEST_EXPECT_EQ(tracker.getLiveBytes(), 0);
+	ANKI_TEST_EXPECT_EQ(tracker.getAllocationCount(), tracker.getFreeCount());
+
+	// Alignments bigger than the header's
+	{
+		void* a = MemoryTracker::allocCallback(&tracker, nullptr, 100, 64 * 1024);
+		void* b = MemoryTracker::allocCallback(&tracker, nullptr, 64 * 1024, 64 * 1024);
+		ANKI_TEST_EXPECT_EQ(isAligned(64 * 1024, a), true);
+		ANKI_TEST_EXPECT_EQ(isAligned(64 * 1024, b), true);
+		memset(b, 0xFF, 64 * 1024);
+		ANKI_TEST_EXPECT_EQ(tracker.getLiveBytes(), 100 + 64 * 1024);
+
+		MemoryTracker::allocCallback(&tracker, a, 0, 0);
+		MemoryTracker::allocCallback(&tracker, b, 0, 0);
+		ANKI_TEST_EXPECT_EQ(tracker.getLiveBytes(), 0);
+	}
+
+	// Leak something
+	void* leak = MemoryTracker::allocCallback(&tracker, nullptr, 128, 16);
+	ANKI_TEST_EXPECT_EQ(tracker.logLeaks(), 1);
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("MemoryTrackerReport.txt", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(tracker.writeReport(file));
+	}
+
+	MemoryTracker::allocCallback(&tracker, leak, 0, 0);
+	ANKI_TEST_EXPECT_EQ(tracker.logLeaks(), 0);
+}
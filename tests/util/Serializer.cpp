@@ -5,6 +5,8 @@
 
 #include <tests/framework/Framework.h>
 #include <anki/util/Serializer.h>
+#include <anki/util/MemoryMappedFile.h>
+#include <anki/util/HighRezTimer.h>
 #include <tests/util/SerializerTest.h>
 
 ANKI_TEST(Util, BinarySerializer)
@@ -67,3 +69,138 @@ ANKI_TEST(Util, BinarySerializer)
 		alloc.deleteInstance(pa);
 	}
 }
+
+ANKI_TEST(Util, BinarySerializerInPlace)
+{
+	Array<ClassB, 1> b = {};
+	b[0].m_array[2] = 42;
+	Array<U32, 2> bDarr = {{0xFF12EE34, 0xAA12BB34}};
+	b[0].m_darray = bDarr;
+
+	ClassA a = {};
+	a.m_u32 = 321;
+	a.m_darray = b;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(a, alloc, file));
+	}
+
+	{
+		MemoryMappedFile file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin"));
+
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserializeInPlace(pa, file.getData(), file.getSize()));
+		ANKI_TEST_EXPECT_EQ(ptrToNumber(pa) > ptrToNumber(file.getData()), true);
+		ANKI_TEST_EXPECT_EQ(ptrToNumber(pa) < ptrToNumber(file.getData()) + file.getSize(), true);
+
+		ANKI_TEST_EXPECT_EQ(pa->m_u32, a.m_u32);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_array[2], 42);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray[1], 0xAA12BB34);
+
+		// Corrupted
+		ANKI_TEST_EXPECT_ERR(BinaryDeserializer::deserializeInPlace(pa, file.getData(), 16), Error::USER_DATA);
+	}
+
+	// Corrupted pointer locations
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::READ | FileOpenFlag::BINARY));
+		const PtrSize size = file.getSize();
+		U8* data = static_cast<U8*>(alloc.getMemoryPool().allocate(size, ANKI_SAFE_ALIGNMENT));
+		ANKI_TEST_EXPECT_NO_ERR(file.read(data, size));
+
+		const detail::BinarySerializerHeader& header = *reinterpret_cast<detail::BinarySerializerHeader*>(data);
+		ANKI_TEST_EXPECT_GT(header.m_pointerCount, 0);
+		U8* firstPointerLocation = data + header.m_pointerArrayFilePosition;
+
+		// An offset that wraps around when the size of the pointer is added to it
+		const PtrSize wrappingOffset = MAX_PTR_SIZE - sizeof(PtrSize) + 2;
+		memcpy(firstPointerLocation, &wrappingOffset, sizeof(PtrSize));
+		ClassA* pa;
+		ANKI_TEST_EXPECT_ERR(BinaryDeserializer::deserializeInPlace(pa, data, size), Error::USER_DATA);
+
+		// A misaligned offset
+		const PtrSize misalignedOffset = 1;
+		memcpy(firstPointerLocation, &misalignedOffset, sizeof(PtrSize));
+		ANKI_TEST_EXPECT_ERR(BinaryDeserializer::deserializeInPlace(pa, data, size), Error::USER_DATA);
+
+		alloc.getMemoryPool().free(data);
+	}
+}
+
+ANKI_TEST(Util, BinarySerializerBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Something with as many pointers as a big shader program binary
+	const U32 B_COUNT = 64 * 1024;
+	DynamicArrayAuto<ClassB> b(alloc);
+	b.create(B_COUNT);
+	Array<U32, 4> bDarr = {{1, 2, 3, 4}};
+	for(ClassB& el : b)
+	{
+		el = {};
+		el.m_darray = bDarr;
+	}
+
+	ClassA a = {};
+	a.m_darray = WeakArray<ClassB>(&b[0], B_COUNT);
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_bench.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(a, alloc, file));
+	}
+
+	const U32 ITERATIONS = 20;
+	HighRezTimer timer;
+
+	// Copy
+	StackAllocator<U8> stackAlloc(allocAligned, nullptr, 8_MB);
+	Second copyTime = 0.0;
+	for(U32 i = 0; i < ITERATIONS; ++i)
+	{
+		timer.start();
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_bench.bin", FileOpenFlag::READ | FileOpenFlag::BINARY));
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserialize(pa, stackAlloc, file));
+		timer.stop();
+		copyTime += timer.getElapsedTime();
+
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), B_COUNT);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[B_COUNT - 1].m_darray[3], 4);
+		stackAlloc.getMemoryPool().reset();
+	}
+
+	// In place
+	Second inPlaceTime = 0.0;
+	for(U32 i = 0; i < ITERATIONS; ++i)
+	{
+		timer.start();
+		MemoryMappedFile file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized_bench.bin"));
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserializeInPlace(pa, file.getData(), file.getSize()));
+		timer.stop();
+		inPlaceTime += timer.getElapsedTime();
+
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), B_COUNT);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[B_COUNT - 1].m_darray[3], 4);
+	}
+
+	ANKI_TEST_LOGI("Deserialize %u pointers: copy %f in place %f | %f%%",
+		B_COUNT + 1,
+		copyTime / ITERATIONS,
+		inPlaceTime / ITERATIONS,
+		copyTime / inPlaceTime * 100.0);
+}
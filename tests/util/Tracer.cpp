@@ -6,7 +6,11 @@
 #include <tests/framework/Framework.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/CoreTracer.h>
+#include <anki/util/TracerFile.h>
 #include <anki/util/HighRezTimer.h>
+#include <anki/util/ThreadPool.h>
+
+using namespace anki;
 
 #if ANKI_ENABLE_TRACE
 ANKI_TEST(Util, Tracer)
@@ -54,3 +58,160 @@ ANKI_TEST(Util, Tracer)
 	tracer.flushFrame(4);
 }
 #endif
+
+/// Gather what Tracer::flush() gives.
+class TracerTestFlushContext
+{
+public:
+	U64 m_counterCount = 0;
+	U64 m_eventCount = 0;
+	U64 m_prevValue = 0;
+	Bool m_valuesInOrder = true;
+};
+
+static void tracerTestFlushCallback(
+	void* userData, ThreadId tid, ConstWeakArray<TracerEvent> events, ConstWeakArray<TracerCounter> counters)
+{
+	(void)tid;
+	TracerTestFlushContext& ctx = *static_cast<TracerTestFlushContext*>(userData);
+	ctx.m_eventCount += events.getSize();
+	ctx.m_counterCount += counters.getSize();
+	for(const TracerCounter& counter : counters)
+	{
+		if(counter.m_name == InternedString("COUNTER"))
+		{
+			ctx.m_valuesInOrder = ctx.m_valuesInOrder && counter.m_value > ctx.m_prevValue;
+			ctx.m_prevValue = counter.m_value;
+		}
+	}
+}
+
+/// Write counters with increasing values.
+class TracerTestTask : public ThreadPoolTask
+{
+public:
+	Tracer* m_tracer = nullptr;
+	U32 m_count = 0;
+
+	Error operator()(U32 taskId, PtrSize threadCount)
+	{
+		const InternedString name("COUNTER");
+		for(U32 i = 1; i <= m_count; ++i)
+		{
+			m_tracer->incrementCounter(name, i);
+		}
+
+		return Error::NONE;
+	}
+};
+
+ANKI_TEST(Util, TracerRingBuffer)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Overwrite the oldest records
+	{
+		Tracer tracer(alloc);
+		tracer.setEnabled(true);
+
+		const U32 extraCount = 1000;
+		const InternedString name("COUNTER");
+		for(U32 i = 1; i <= Tracer::RECORDS_PER_THREAD + extraCount; ++i)
+		{
+			tracer.incrementCounter(name, i);
+		}
+		tracer.addCustomEvent(InternedString("EVENT"), 1.0, 0.5);
+
+		TracerTestFlushContext ctx;
+		tracer.flush(tracerTestFlushCallback, &ctx);
+
+		// The event gives an extra counter
+		ANKI_TEST_EXPECT_EQ(ctx.m_counterCount, Tracer::RECORDS_PER_THREAD);
+		ANKI_TEST_EXPECT_EQ(ctx.m_eventCount, 1);
+		ANKI_TEST_EXPECT_EQ(ctx.m_valuesInOrder, true);
+		ANKI_TEST_EXPECT_EQ(ctx.m_prevValue, Tracer::RECORDS_PER_THREAD + extraCount);
+		ANKI_TEST_EXPECT_EQ(tracer.getLostRecordCount(), extraCount + 1);
+
+		// Start clean
+		ctx = TracerTestFlushContext();
+		tracer.flush(tracerTestFlushCallback, &ctx);
+		ANKI_TEST_EXPECT_EQ(ctx.m_counterCount, 0);
+	}
+
+	// Flush while other threads write
+	{
+		Tracer tracer(alloc);
+		tracer.setEnabled(true);
+
+		const U32 threadCount = 4;
+		ThreadPool pool(threadCount);
+		TracerTestTask task;
+		task.m_tracer = &tracer;
+		task.m_count = 100000;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			pool.assignNewTask(i, &task);
+		}
+
+		TracerTestFlushContext ctx;
+		for(U32 i = 0; i < 100; ++i)
+		{
+			tracer.flush(tracerTestFlushCallback, &ctx);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+		tracer.flush(tracerTestFlushCallback, &ctx);
+
+		ANKI_TEST_EXPECT_EQ(ctx.m_counterCount + tracer.getLostRecordCount(), threadCount * task.m_count);
+	}
+}
+
+ANKI_TEST(Util, TracerFile)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	Array<TracerEvent, 3> events;
+	events[0].m_name = InternedString("EVENT_A");
+	events[0].m_start = 10.0;
+	events[0].m_duration = 0.5;
+	events[1].m_name = InternedString("EVENT_B");
+	events[1].m_start = 10.25;
+	events[1].m_duration = 0.125;
+	events[2].m_name = InternedString("EVENT_A");
+	events[2].m_start = 9.0; // Not sorted
+	events[2].m_duration = 0.001;
+
+	{
+		TracerFileWriter writer;
+		ANKI_TEST_EXPECT_NO_ERR(writer.open(alloc, "./trace_test.ankitrace"));
+		ANKI_TEST_EXPECT_NO_ERR(writer.writeEvents(123, ConstWeakArray<TracerEvent>(&events[0], 2)));
+		ANKI_TEST_EXPECT_NO_ERR(writer.writeEvents(321, ConstWeakArray<TracerEvent>(&events[0], 3)));
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(convertTracerFileToJson("./trace_test.ankitrace", "./trace_test.json", alloc));
+
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./trace_test.json", FileOpenFlag::READ));
+	StringAuto json(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(file.readAllText(json));
+
+	const char* expected = R"([
+{"name": "EVENT_A", "cat": "PERF", "ph": "X", "pid": 1, "tid": 123, "ts": 10000000.000, "dur": 500000.000},
+{"name": "EVENT_B", "cat": "PERF", "ph": "X", "pid": 1, "tid": 123, "ts": 10250000.000, "dur": 125000.000},
+{"name": "EVENT_A", "cat": "PERF", "ph": "X", "pid": 1, "tid": 321, "ts": 10000000.000, "dur": 500000.000},
+{"name": "EVENT_B", "cat": "PERF", "ph": "X", "pid": 1, "tid": 321, "ts": 10250000.000, "dur": 125000.000},
+{"name": "EVENT_A", "cat": "PERF", "ph": "X", "pid": 1, "tid": 321, "ts": 9000000.000, "dur": 1000.000}
+]
+)";
+	ANKI_TEST_EXPECT_EQ(json, expected);
+
+	// A file smaller than the header is an error
+	{
+		File small;
+		ANKI_TEST_EXPECT_NO_ERR(small.open("./trace_test_small.ankitrace", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		const U16 value = 0;
+		ANKI_TEST_EXPECT_NO_ERR(small.write(&value, sizeof(value)));
+	}
+	ANKI_TEST_EXPECT_ERR(
+		convertTracerFileToJson("./trace_test_small.ankitrace", "./trace_test_small.json", alloc), Error::USER_DATA);
+}
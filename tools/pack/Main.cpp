@@ -0,0 +1,77 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourcePack.h>
+#include <anki/Util.h>
+using namespace anki;
+
+static const char* USAGE = R"(Usage: %s data_dir out_file.ankipak [options]
+Options:
+-compress <0|1>        : Compress the entries that benefit from it. Default is 1
+)";
+
+class CmdLineArgs
+{
+public:
+	HeapAllocator<U8> m_alloc{allocAligned, nullptr};
+	StringAuto m_dataDir = {m_alloc};
+	StringAuto m_outFname = {m_alloc};
+	Bool m_compress = true;
+};
+
+static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
+{
+	// Parse config
+	if(argc < 3)
+	{
+		return Error::USER_DATA;
+	}
+
+	info.m_dataDir.create(argv[1]);
+	info.m_outFname.create(argv[2]);
+
+	for(I i = 3; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-compress") == 0)
+		{
+			++i;
+
+			if(i < argc)
+			{
+				I compress = 1;
+				ANKI_CHECK(CString(argv[i]).toNumber(compress));
+				info.m_compress = compress != 0;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else
+		{
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	CmdLineArgs info;
+	if(parseCommandLineArgs(argc, argv, info))
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	if(createResourcePack(info.m_dataDir.toCString(), info.m_outFname.toCString(), info.m_compress, info.m_alloc))
+	{
+		ANKI_LOGE("Failed to create the resource pack");
+		return 1;
+	}
+
+	return 0;
+}
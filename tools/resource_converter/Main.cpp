@@ -0,0 +1,60 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ResourceBinaryConverter.h>
+#include <anki/Util.h>
+using namespace anki;
+
+static const char* USAGE = R"(Usage: %s data_dir
+Converts all the materials, models, skeletons and animations of data_dir to binary. The binary of "foo.ankimtl" is
+written next to it as "foo.ankimtlbin".
+)";
+
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StringListAuto filenames(alloc);
+	const CString dataDir = argv[1];
+
+	const Error err = walkDirectoryTree(dataDir, &filenames, [](const CString& fname, void* ud, Bool isDir) -> Error {
+		if(!isDir && resourceFileHasBinary(fname))
+		{
+			static_cast<StringListAuto*>(ud)->pushBackSprintf("%s", fname.cstr());
+		}
+		return Error::NONE;
+	});
+
+	if(err)
+	{
+		ANKI_LOGE("Failed to walk the directory: %s", dataDir.cstr());
+		return 1;
+	}
+
+	U32 convertedCount = 0;
+	for(const String& fname : filenames)
+	{
+		StringAuto inFname(alloc);
+		inFname.sprintf("%s/%s", dataDir.cstr(), fname.cstr());
+		StringAuto outFname(alloc);
+		outFname.sprintf("%s%s", inFname.cstr(), RESOURCE_BINARY_SUFFIX);
+
+		if(convertResourceFile(inFname.toCString(), outFname.toCString(), alloc))
+		{
+			ANKI_LOGE("Failed to convert: %s", inFname.cstr());
+			return 1;
+		}
+
+		++convertedCount;
+	}
+
+	ANKI_LOGI("Converted %u files", convertedCount);
+	return 0;
+}
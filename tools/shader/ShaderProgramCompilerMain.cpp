@@ -4,14 +4,19 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/shader_compiler/ShaderProgramSpirvCache.h>
 #include <anki/Util.h>
 using namespace anki;
 
 static const char* USAGE = R"(Usage: %s shader_program_file [options]
 Options:
--o <name of output>    : The name of the output binary
+-o <name of output>    : The name of the output binary or the JSON report if -bench is set
 -j <thread count>      : Number of threads. Defaults to system's max
 -I <include path>      : The path of the #include files
+-cache <dir>           : A directory to cache the SPIR-V of the variants
+-nostrip               : Keep the debug info in the SPIR-V
+-bench                 : Treat shader_program_file as a directory and compile all the programs in it with 1 up to
+                         -j threads. Write the timings to a JSON report
 )";
 
 class CmdLineArgs
@@ -21,7 +26,10 @@ public:
 	StringAuto m_inputFname = {m_alloc};
 	StringAuto m_outFname = {m_alloc};
 	StringAuto m_includePath = {m_alloc};
+	StringAuto m_spirvCacheDir = {m_alloc};
 	U32 m_threadCount = getCpuCoresCount();
+	ShaderProgramCompilerOptions m_compilerOptions;
+	Bool m_bench = false;
 };
 
 static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
@@ -89,6 +97,27 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 				return Error::USER_DATA;
 			}
 		}
+		else if(strcmp(argv[i], "-cache") == 0)
+		{
+			++i;
+
+			if(i < argc && std::strlen(argv[i]) > 0)
+			{
+				info.m_spirvCacheDir.sprintf("%s", argv[i]);
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(strcmp(argv[i], "-nostrip") == 0)
+		{
+			info.m_compilerOptions.m_stripDebugInfo = false;
+		}
+		else if(strcmp(argv[i], "-bench") == 0)
+		{
+			info.m_bench = true;
+		}
 		else
 		{
 			return Error::USER_DATA;
@@ -98,78 +127,94 @@ static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
 	return Error::NONE;
 }
 
-static Error work(const CmdLineArgs& info)
+class FSystem : public ShaderProgramFilesystemInterface
 {
-	HeapAllocator<U8> alloc{allocAligned, nullptr};
+public:
+	CString m_includePath;
 
-	// Load interface
-	class FSystem : public ShaderProgramFilesystemInterface
+	Error readAllText(CString filename, StringAuto& txt) final
 	{
-	public:
-		CString m_includePath;
+		StringAuto fname(txt.getAllocator());
+		fname.sprintf("%s/%s", m_includePath.cstr(), filename.cstr());
 
-		Error readAllText(CString filename, StringAuto& txt) final
-		{
-			StringAuto fname(txt.getAllocator());
-			fname.sprintf("%s/%s", m_includePath.cstr(), filename.cstr());
+		File file;
+		ANKI_CHECK(file.open(fname, FileOpenFlag::READ));
+		ANKI_CHECK(file.readAllText(txt));
+		return Error::NONE;
+	}
+};
 
-			File file;
-			ANKI_CHECK(file.open(fname, FileOpenFlag::READ));
-			ANKI_CHECK(file.readAllText(txt));
-			return Error::NONE;
-		}
-	} fsystem;
-	fsystem.m_includePath = info.m_includePath;
+class TaskManager : public ShaderProgramAsyncTaskInterface
+{
+public:
+	ThreadHive* m_hive = nullptr;
+	HeapAllocator<U8> m_alloc;
 
-	// Threading interface
-	class TaskManager : public ShaderProgramAsyncTaskInterface
+	void enqueueTask(void (*callback)(void* userData), void* userData)
 	{
-	public:
-		ThreadHive* m_hive = nullptr;
-		HeapAllocator<U8> m_alloc;
-
-		void enqueueTask(void (*callback)(void* userData), void* userData)
+		struct Ctx
 		{
-			struct Ctx
-			{
-				void (*m_callback)(void* userData);
-				void* m_userData;
-				HeapAllocator<U8> m_alloc;
-			};
-			Ctx* ctx = m_alloc.newInstance<Ctx>();
-			ctx->m_callback = callback;
-			ctx->m_userData = userData;
-			ctx->m_alloc = m_alloc;
-
-			m_hive->submitTask(
-				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-					Ctx* ctx = static_cast<Ctx*>(userData);
-					ctx->m_callback(ctx->m_userData);
-					auto alloc = ctx->m_alloc;
-					alloc.deleteInstance(ctx);
-				},
-				ctx);
-		}
+			void (*m_callback)(void* userData);
+			void* m_userData;
+			HeapAllocator<U8> m_alloc;
+		};
+		Ctx* ctx = m_alloc.newInstance<Ctx>();
+		ctx->m_callback = callback;
+		ctx->m_userData = userData;
+		ctx->m_alloc = m_alloc;
 
-		Error joinTasks()
-		{
-			m_hive->waitAllTasks();
-			return Error::NONE;
-		}
-	} taskManager;
-	taskManager.m_hive =
-		(info.m_threadCount) ? alloc.newInstance<ThreadHive>(info.m_threadCount, alloc, true) : nullptr;
-	taskManager.m_alloc = alloc;
+		m_hive->submitTask(
+			[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+				Ctx* ctx = static_cast<Ctx*>(userData);
+				ctx->m_callback(ctx->m_userData);
+				auto alloc = ctx->m_alloc;
+				alloc.deleteInstance(ctx);
+			},
+			ctx);
+	}
 
-	// Some dummy caps
-	GpuDeviceCapabilities caps;
+	Error joinTasks()
+	{
+		m_hive->waitAllTasks();
+		return Error::NONE;
+	}
+};
+
+/// Some dummy caps.
+static void getDummyCapabilities(GpuDeviceCapabilities& caps, BindlessLimits& limits)
+{
 	caps.m_gpuVendor = GpuVendor::AMD;
 	caps.m_minorApiVersion = 1;
 	caps.m_majorApiVersion = 1;
 
-	BindlessLimits limits;
 	limits.m_bindlessImageCount = 16;
 	limits.m_bindlessTextureCount = 16;
+}
+
+static Error work(const CmdLineArgs& info)
+{
+	HeapAllocator<U8> alloc{allocAligned, nullptr};
+
+	// Load interface
+	FSystem fsystem;
+	fsystem.m_includePath = info.m_includePath;
+
+	// Threading interface
+	TaskManager taskManager;
+	taskManager.m_hive =
+		(info.m_threadCount) ? alloc.newInstance<ThreadHive>(info.m_threadCount, alloc, true) : nullptr;
+	taskManager.m_alloc = alloc;
+
+	GpuDeviceCapabilities caps;
+	BindlessLimits limits;
+	getDummyCapabilities(caps, limits);
+
+	// SPIR-V cache
+	ShaderProgramSpirvCache spirvCache(alloc);
+	if(!info.m_spirvCacheDir.isEmpty())
+	{
+		ANKI_CHECK(spirvCache.init(info.m_spirvCacheDir));
+	}
 
 	// Compile
 	ShaderProgramBinaryWrapper binary(alloc);
@@ -177,11 +222,21 @@ static Error work(const CmdLineArgs& info)
 		fsystem,
 		nullptr,
 		(info.m_threadCount) ? &taskManager : nullptr,
+		(!info.m_spirvCacheDir.isEmpty()) ? &spirvCache : nullptr,
+		nullptr,
+		info.m_compilerOptions,
 		alloc,
 		caps,
 		limits,
 		binary));
 
+	if(!info.m_spirvCacheDir.isEmpty())
+	{
+		ANKI_LOGI("SPIR-V cache hits %u misses %u", spirvCache.getHitCount(), spirvCache.getMissCount());
+	}
+
+	ANKI_LOGI("SPIR-V size %uB, %uB before stripping", U32(binary.getSpirvSize()), U32(binary.getOriginalSpirvSize()));
+
 	// Store the binary
 	ANKI_CHECK(binary.serializeToFile(info.m_outFname));
 
@@ -191,6 +246,164 @@ static Error work(const CmdLineArgs& info)
 	return Error::NONE;
 }
 
+/// Escape a string so it can be written inside a JSON string.
+static void escapeJsonString(CString in, StringAuto& out)
+{
+	DynamicArrayAuto<char> chars(out.getAllocator());
+	for(const char* c = in.cstr(); *c != '\0'; ++c)
+	{
+		if(*c == '"' || *c == '\\')
+		{
+			chars.emplaceBack('\\');
+			chars.emplaceBack(*c);
+		}
+		else if(U8(*c) < 0x20)
+		{
+			Array<char, 7> escaped;
+			snprintf(&escaped[0], escaped.getSize(), "\\u%04x", U32(*c));
+			for(U32 k = 0; k < 6; ++k)
+			{
+				chars.emplaceBack(escaped[k]);
+			}
+		}
+		else
+		{
+			chars.emplaceBack(*c);
+		}
+	}
+
+	chars.emplaceBack('\0');
+	out.create(CString(&chars[0]));
+}
+
+static Error bench(const CmdLineArgs& info)
+{
+	HeapAllocator<U8> alloc{allocAligned, nullptr};
+
+	// Gather the programs
+	class WalkCtx
+	{
+	public:
+		HeapAllocator<U8> m_alloc;
+		CString m_dir;
+		DynamicArrayAuto<String> m_programs{m_alloc};
+	} walkCtx;
+	walkCtx.m_alloc = alloc;
+	walkCtx.m_dir = info.m_inputFname;
+
+	ANKI_CHECK(walkDirectoryTree(info.m_inputFname, &walkCtx, [](const CString& fname, void* ud, Bool isDir) -> Error {
+		WalkCtx& ctx = *static_cast<WalkCtx*>(ud);
+		StringAuto extension(ctx.m_alloc);
+		getFilepathExtension(fname, extension);
+		if(!isDir && extension == "ankiprog")
+		{
+			ctx.m_programs.emplaceBack()->sprintf(ctx.m_alloc, "%s/%s", ctx.m_dir.cstr(), fname.cstr());
+		}
+
+		return Error::NONE;
+	}));
+
+	std::sort(walkCtx.m_programs.getBegin(), walkCtx.m_programs.getEnd());
+	const ConstWeakArray<String> programs(walkCtx.m_programs);
+
+	FSystem fsystem;
+	fsystem.m_includePath = info.m_includePath;
+
+	GpuDeviceCapabilities caps;
+	BindlessLimits limits;
+	getDummyCapabilities(caps, limits);
+
+	// Compile all the programs once per thread count. No caches so every run does all the work
+	File json;
+	ANKI_CHECK(json.open(info.m_outFname, FileOpenFlag::WRITE));
+	ANKI_CHECK(json.writeText("{\n\t\"runs\": [\n"));
+
+	const U32 maxThreadCount = max(1u, info.m_threadCount);
+	for(U32 threadCount = 1; threadCount <= maxThreadCount; ++threadCount)
+	{
+		TaskManager taskManager;
+		taskManager.m_hive = alloc.newInstance<ThreadHive>(threadCount, alloc, true);
+		taskManager.m_alloc = alloc;
+
+		ANKI_CHECK(json.writeText("\t\t{\n\t\t\t\"threadCount\": %u,\n\t\t\t\"programs\": [\n", threadCount));
+
+		ShaderProgramCompilerStats total;
+		for(U32 i = 0; i < programs.getSize(); ++i)
+		{
+			ShaderProgramBinaryWrapper binary(alloc);
+			ANKI_CHECK(compileShaderProgram(programs[i].toCString(),
+				fsystem,
+				nullptr,
+				&taskManager,
+				nullptr,
+				nullptr,
+				info.m_compilerOptions,
+				alloc,
+				caps,
+				limits,
+				binary));
+
+			const ShaderProgramCompilerStats& stats = binary.getStats();
+			total.m_totalTime += stats.m_totalTime;
+			total.m_parseTime += stats.m_parseTime;
+			total.m_preprocessTime += stats.m_preprocessTime;
+			total.m_glslangTime += stats.m_glslangTime;
+			total.m_reflectionTime += stats.m_reflectionTime;
+			total.m_maxVariantTime = max(total.m_maxVariantTime, stats.m_maxVariantTime);
+			total.m_variantCount += stats.m_variantCount;
+
+			StringAuto name(alloc);
+			escapeJsonString(programs[i].toCString(), name);
+
+			ANKI_CHECK(json.writeText("\t\t\t\t{\"name\": \"%s\", \"variantCount\": %u, \"totalTime\": %f, "
+									  "\"parseTime\": %f, \"preprocessTime\": %f, \"glslangTime\": %f, "
+									  "\"reflectionTime\": %f, \"averageVariantTime\": %f, \"maxVariantTime\": %f, "
+									  "\"spirvSize\": %u}%s\n",
+				name.cstr(),
+				stats.m_variantCount,
+				stats.m_totalTime,
+				stats.m_parseTime,
+				stats.m_preprocessTime,
+				stats.m_glslangTime,
+				stats.m_reflectionTime,
+				(stats.m_preprocessTime + stats.m_glslangTime) / max(1u, stats.m_variantCount),
+				stats.m_maxVariantTime,
+				U32(binary.getSpirvSize()),
+				(i + 1 < programs.getSize()) ? "," : ""));
+		}
+
+		ANKI_CHECK(json.writeText("\t\t\t],\n\t\t\t\"variantCount\": %u,\n\t\t\t\"totalTime\": %f,\n"
+								  "\t\t\t\"parseTime\": %f,\n\t\t\t\"preprocessTime\": %f,\n"
+								  "\t\t\t\"glslangTime\": %f,\n\t\t\t\"reflectionTime\": %f,\n"
+								  "\t\t\t\"maxVariantTime\": %f\n\t\t}%s\n",
+			total.m_variantCount,
+			total.m_totalTime,
+			total.m_parseTime,
+			total.m_preprocessTime,
+			total.m_glslangTime,
+			total.m_reflectionTime,
+			total.m_maxVariantTime,
+			(threadCount < maxThreadCount) ? "," : ""));
+
+		ANKI_LOGI("%u threads: %u programs, %u variants in %.3fs",
+			threadCount,
+			programs.getSize(),
+			total.m_variantCount,
+			total.m_totalTime);
+
+		alloc.deleteInstance(taskManager.m_hive);
+	}
+
+	ANKI_CHECK(json.writeText("\t]\n}\n"));
+
+	for(String& program : walkCtx.m_programs)
+	{
+		program.destroy(alloc);
+	}
+
+	return Error::NONE;
+}
+
 int main(int argc, char** argv)
 {
 	CmdLineArgs info;
@@ -202,7 +415,14 @@ int main(int argc, char** argv)
 
 	if(info.m_outFname.isEmpty())
 	{
-		info.m_outFname.sprintf("%sbin", info.m_inputFname.cstr());
+		if(info.m_bench)
+		{
+			info.m_outFname.create("ShaderCompilerBench.json");
+		}
+		else
+		{
+			info.m_outFname.sprintf("%sbin", info.m_inputFname.cstr());
+		}
 	}
 
 	if(info.m_includePath.isEmpty())
@@ -210,7 +430,7 @@ int main(int argc, char** argv)
 		info.m_includePath.create("./");
 	}
 
-	if(work(info))
+	if((info.m_bench) ? bench(info) : work(info))
 	{
 		ANKI_LOGE("Failed");
 		return 1;
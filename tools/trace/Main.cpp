@@ -0,0 +1,29 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/Util.h>
+using namespace anki;
+
+static const char* USAGE = R"(Convert a binary trace to Chrome trace JSON (chrome://tracing and Perfetto open it)
+Usage: %s in_file.ankitrace out_file.json
+)";
+
+int main(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		ANKI_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	if(convertTracerFileToJson(argv[1], argv[2], alloc))
+	{
+		ANKI_LOGE("Failed to convert the trace");
+		return 1;
+	}
+
+	return 0;
+}